@@ -36,6 +36,7 @@
 #include "crypto_error.h"
 #include "crypto_events.h"
 #include "crypto_print.h"
+#include "crypto_trace.h"
 #include "crypto_structs.h"
 #include "sa_interface.h"
 #include "cryptography_interface.h"
@@ -56,6 +57,7 @@
 ** SAVE FILE NAME/LOCATION
 */
 #define CRYPTO_SA_SAVE "sa_save_file.bin"
+#define CRYPTO_SA_JOURNAL "sa_save_file.jnl"
 
 /*
 ** TC_BLOCK_SIZE
@@ -82,6 +84,7 @@ extern int32_t Crypto_Config_Kmc_Crypto_Service(char* protocol, char* kmc_crypto
                                                 uint8_t kmc_ignore_ssl_hostname_validation, char* mtls_client_cert_path,
                                                 char* mtls_client_cert_type, char* mtls_client_key_path,
                                                 char* mtls_client_key_pass, char* mtls_issuer_cert);
+extern int32_t Crypto_Config_SA_Lease(uint32_t lease_frames);
 extern int32_t Crypto_Config_Cam(uint8_t cam_enabled, char* cookie_file_path, char* keytab_file_path, uint8_t login_method, char* access_manager_uri, char* username, char* cam_home);
 // extern int32_t Crypto_Config_Add_Gvcid_Managed_Parameter(uint8_t tfvn, uint16_t scid, uint8_t vcid, uint8_t has_fecf,
 //                                                          uint8_t has_segmentation_hdr, uint8_t has_ocf, uint16_t max_frame_size, uint8_t aos_has_fhec,
@@ -105,9 +108,13 @@ extern int32_t Crypto_Shutdown(void); // Free all allocated memory
 extern int32_t Crypto_TC_ApplySecurity(const uint8_t* p_in_frame, const uint16_t in_frame_length,
                                        uint8_t** pp_enc_frame, uint16_t* p_enc_frame_len);
 extern int32_t Crypto_TC_ProcessSecurity(uint8_t* ingest, int *len_ingest, TC_t* tc_sdls_processed_frame);
+extern int32_t Crypto_TC_ApplySecurity_Into(const uint8_t* p_in_frame, const uint16_t in_frame_length, uint8_t* p_out,
+                                           uint16_t len_out, uint16_t* p_enc_frame_len);
+extern int32_t Crypto_TC_Get_Max_Output_Len(uint16_t spi, uint16_t* p_max_len);
 extern int32_t Crypto_TC_ApplySecurity_Cam(const uint8_t* p_in_frame, const uint16_t in_frame_length,
                                        uint8_t** pp_enc_frame, uint16_t* p_enc_frame_len, char* cam_cookies);
 extern int32_t Crypto_TC_ProcessSecurity_Cam(uint8_t* ingest, int *len_ingest, TC_t* tc_sdls_processed_frame, char* cam_cookies);
+extern int32_t Crypto_TC_ProcessSecurity_Batch(uint8_t** ingest, int* len_ingest, TC_t* tc_sdls_processed_frames, uint32_t count, int32_t* results);
 
 int32_t Crypto_TC_Get_SA_Service_Type(uint8_t* sa_service_type, SecurityAssociation_t* sa_ptr);
 int32_t Crypto_TC_Parse_Check_FECF(uint8_t* ingest, int* len_ingest, TC_t* tc_sdls_processed_frame);
@@ -148,10 +155,28 @@ int32_t Crypto_TC_Set_IV(SecurityAssociation_t* sa_ptr, uint8_t* p_new_enc_frame
 
 // Telemetry (TM)
 extern int32_t Crypto_TM_ApplySecurity(uint8_t* pTfBuffer);
+extern int32_t Crypto_TM_ApplySecurity_Batch(uint8_t** frames, uint32_t count, int32_t* results);
 extern int32_t Crypto_TM_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_t** pp_processed_frame, uint16_t *p_decrypted_length);
+extern int32_t Crypto_TM_ProcessSecurity_Into(uint8_t* p_ingest, uint16_t len_ingest, uint8_t* p_out, uint16_t len_out,
+                                              uint16_t* p_pdu_offset, uint16_t* p_pdu_len, uint16_t* p_decrypted_length);
+// Telemetry (TM) ProcessSecurity Worker Pool
+extern int32_t Crypto_TM_Pool_Start(uint32_t num_workers);
+extern int32_t Crypto_TM_Pool_Submit(uint8_t* p_ingest, uint16_t len_ingest, void* user_ctx);
+extern int32_t Crypto_TM_Pool_Collect(TM_Pool_Frame_t* frames, uint32_t max_frames, uint32_t* count);
+extern int32_t Crypto_TM_Pool_Stop(void);
+// Asynchronous TC/TM ApplySecurity
+extern int32_t Crypto_TC_ApplySecurity_Async(const uint8_t* p_in_frame, const uint16_t in_frame_length, uint8_t* p_out,
+                                             uint16_t len_out, Crypto_Async_Callback_t callback, void* ctx);
+extern int32_t Crypto_TM_ApplySecurity_Async(uint8_t* pTfBuffer, Crypto_Async_Callback_t callback, void* ctx);
+extern int32_t Crypto_Async_Poll(int32_t timeout_ms, uint32_t* delivered);
+extern uint32_t Crypto_Async_Pending(void);
+// Metrics
+extern int32_t Crypto_Get_Metrics(Crypto_Metrics_t* metrics);
 // Advanced Orbiting Systems (AOS)
 extern int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer);
 extern int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_t** pp_processed_frame, uint16_t* p_decrypted_length);
+extern int32_t Crypto_AOS_ProcessSecurity_Into(uint8_t* p_ingest, uint16_t len_ingest, uint8_t* p_out, uint16_t len_out,
+                                               uint16_t* p_pdu_offset, uint16_t* p_pdu_len, uint16_t* p_decrypted_length);
 
 
 // Crypo Error Support Functions
@@ -171,6 +196,7 @@ int32_t Crypto_TM_Get_Keys(crypto_key_t** ekp, crypto_key_t** akp, SecurityAssoc
 int32_t Crypto_TM_Do_Encrypt_NONPLAINTEXT(uint8_t sa_service_type, uint16_t* aad_len, int* mac_loc, uint16_t* idx_p, uint16_t pdu_len, uint8_t* pTfBuffer, uint8_t* aad, SecurityAssociation_t* sa_ptr);
 int32_t Crypto_TM_Do_Encrypt_NONPLAINTEXT_AEAD_Logic(uint8_t sa_service_type, uint8_t ecs_is_aead_algorithm, uint8_t* pTfBuffer, uint16_t pdu_len, uint16_t data_loc, crypto_key_t* ekp, crypto_key_t* akp, uint32_t pkcs_padding, int* mac_loc, uint16_t* aad_len, uint8_t* aad, SecurityAssociation_t* sa_ptr);
 int32_t Crypto_TM_Do_Encrypt_Handle_Increment(uint8_t sa_service_type, SecurityAssociation_t* sa_ptr);
+int32_t Crypto_TM_ApplySecurity_Frame(uint8_t* pTfBuffer, SecurityAssociation_t* sa_ptr, crypto_key_t* ekp, crypto_key_t* akp, uint8_t* aad);
 int32_t Crypto_TM_Do_Encrypt(uint8_t sa_service_type, SecurityAssociation_t* sa_ptr, uint16_t* aad_len, int* mac_loc, uint16_t* idx_p, uint16_t pdu_len, uint8_t* pTfBuffer, uint8_t* aad, uint8_t ecs_is_aead_algorithm, uint16_t data_loc, crypto_key_t* ekp, crypto_key_t* akp, uint32_t pkcs_padding, uint16_t* new_fecf);
 void Crypto_TM_ApplySecurity_Debug_Print(uint16_t idx, uint16_t pdu_len, SecurityAssociation_t* sa_ptr);
 int32_t Crypto_TM_Process_Setup(uint16_t len_ingest, uint16_t* byte_idx, uint8_t* p_ingest, uint8_t* secondary_hdr_len);
@@ -198,9 +224,31 @@ void Crypto_Local_Config(void);
 void Crypto_Local_Init(void);
 // int32_t  Crypto_gcm_err(int gcm_err);
 int32_t Crypto_window(uint8_t* actual, uint8_t* expected, int length, int window);
+uint8_t Crypto_Counter_Diff(const uint8_t* a, const uint8_t* b, int length, uint64_t* diff);
+int32_t Crypto_Replay_Check(SecurityAssociation_t* sa_ptr, uint8_t* actual, uint8_t* expected, int length, uint8_t tracked,
+                            int8_t* ahead);
+void Crypto_Replay_Update(SecurityAssociation_t* sa_ptr, uint8_t* actual, uint8_t* expected, int length, int8_t ahead);
 // int32_t Crypto_compare_less_equal(uint8_t* actual, uint8_t* expected, int length);
 // int32_t  Crypto_FECF(int fecf, uint8_t* ingest, int len_ingest,TC_t* tc_frame);
 uint16_t Crypto_Calc_FECF(const uint8_t* ingest, int len_ingest);
+uint16_t Crypto_Calc_FECF_Bitwise(const uint8_t* ingest, int len_ingest);
+void Crypto_Calc_FECF_Init(void);
+void Crypto_Arena_Reset(void);
+uint8_t* Crypto_Arena_Alloc(uint32_t len);
+int32_t Crypto_Async_AEAD_Encrypt(uint8_t* data_out, size_t len_data_out, uint8_t* data_in, size_t len_data_in,
+                                  uint8_t* key, uint32_t len_key, SecurityAssociation_t* sa_ptr, uint8_t* iv,
+                                  uint32_t iv_len, uint8_t* mac, uint32_t mac_size, uint8_t* aad, uint32_t aad_len,
+                                  uint8_t encrypt_bool, uint8_t authenticate_bool, uint8_t aad_bool, uint8_t* ecs,
+                                  uint8_t* acs, char* cam_cookies);
+uint8_t Crypto_Async_Defer_FECF(uint16_t fecf_loc);
+void Crypto_Async_Reset(void);
+int32_t Crypto_Calc_FECF_Set_Engine(uint8_t engine);
+uint8_t Crypto_Calc_FECF_Get_Engine(void);
+void Crypto_Apply_ABM(const uint8_t* buffer, uint16_t len_aad, const uint8_t* abm, uint8_t* aad);
+void Crypto_Apply_ABM_Bytewise(const uint8_t* buffer, uint16_t len_aad, const uint8_t* abm, uint8_t* aad);
+void Crypto_Apply_ABM_Init(void);
+int32_t Crypto_Apply_ABM_Set_Engine(uint8_t engine);
+uint8_t Crypto_Apply_ABM_Get_Engine(void);
 void Crypto_Calc_CRC_Init_Table(void);
 uint16_t Crypto_Calc_CRC16(uint8_t* data, int size);
 int32_t Crypto_Check_Anti_Replay(SecurityAssociation_t *sa_ptr, uint8_t *arsn, uint8_t *iv);
@@ -208,14 +256,38 @@ int32_t Crypto_Get_ECS_Algo_Keylen(uint8_t algo);
 int32_t Crypto_Get_ACS_Algo_Keylen(uint8_t algo);
 
 int32_t Crypto_Check_Anti_Replay_Verify_Pointers(SecurityAssociation_t* sa_ptr, uint8_t* arsn, uint8_t* iv);
-int32_t Crypto_Check_Anti_Replay_ARSNW(SecurityAssociation_t* sa_ptr, uint8_t* arsn, int8_t* arsn_valid);
-int32_t Crypto_Check_Anti_Replay_GCM(SecurityAssociation_t* sa_ptr, uint8_t* iv, int8_t* iv_valid);
+int32_t Crypto_Check_Anti_Replay_ARSNW(SecurityAssociation_t* sa_ptr, uint8_t* arsn, int8_t* arsn_valid,
+                                       int8_t* arsn_ahead);
+int32_t Crypto_Check_Anti_Replay_GCM(SecurityAssociation_t* sa_ptr, uint8_t* iv, int8_t* iv_valid, int8_t* iv_ahead);
 
 // Key Management Functions
 int32_t Crypto_Key_OTAR(void);
 int32_t Crypto_Key_update(uint8_t state);
 int32_t Crypto_Key_inventory(uint8_t* );
 int32_t Crypto_Key_verify(uint8_t* , TC_t* tc_frame);
+void Crypto_Key_Invalidate_Cache(uint16_t key_id);
+
+// Thread Safety Functions
+void Crypto_SA_Lock(SecurityAssociation_t* sa_ptr);
+int32_t Crypto_SA_Lock_State(SecurityAssociation_t* sa_ptr, uint8_t sa_state);
+int32_t Crypto_SA_Lock_GVCID(SecurityAssociation_t* sa_ptr, uint8_t tfvn, uint16_t scid, uint16_t vcid, uint8_t mapid);
+void Crypto_SA_Unlock(void);
+void Crypto_Mgmt_Lock(void);
+void Crypto_Mgmt_Unlock(void);
+int32_t Crypto_SA_Held_SPI(void);
+uint32_t Crypto_Mgmt_Epoch(void);
+
+// Metrics Functions
+void Crypto_Metrics_Frame(uint8_t type, uint8_t applied, const uint8_t* p_frame, uint32_t frame_len, int32_t status);
+#if defined(CRYPTO_METRICS_LATENCY) || defined(CRYPTO_TRACE)
+void Crypto_Metrics_Stage_Start(uint8_t stage);
+void Crypto_Metrics_Stage_Stop(uint8_t stage);
+#define CRYPTO_STAGE_START(stage) Crypto_Metrics_Stage_Start(stage)
+#define CRYPTO_STAGE_STOP(stage) Crypto_Metrics_Stage_Stop(stage)
+#else
+#define CRYPTO_STAGE_START(stage)
+#define CRYPTO_STAGE_STOP(stage)
+#endif
 
 // Security Monitoring & Control Procedure
 int32_t Crypto_MC_ping(uint8_t* ingest);
@@ -225,6 +297,8 @@ int32_t Crypto_MC_erase(uint8_t* ingest);
 int32_t Crypto_MC_selftest(uint8_t* ingest);
 int32_t Crypto_SA_readARSN(uint8_t* ingest);
 int32_t Crypto_MC_resetalarm(void);
+void Crypto_Event_Log(uint8_t emt, const uint8_t* emv);
+void Crypto_Event_Log_Reset(void);
 
 // User Functions
 int32_t Crypto_User_IdleTrigger(uint8_t* ingest);
@@ -242,6 +316,9 @@ int32_t sa_perform_save(SecurityAssociation_t* sa);
 // Clean REF
 void clean_ekref(SecurityAssociation_t* sa);
 void clean_akref(SecurityAssociation_t* sa);
+SecurityAssociation_t* Crypto_SA_Alloc(void);
+uint8_t Crypto_SA_Lease_Renew(SecurityAssociation_t* sa_ptr, SecurityAssociationLease_t* lease);
+int32_t Crypto_SA_Save(SecurityAssociation_t* sa_ptr);
 
 // Determine Payload Data Unit
 int32_t Crypto_Process_Extended_Procedure_Pdu(TC_t* tc_sdls_processed_frame, uint8_t* ingest);
@@ -252,6 +329,9 @@ int32_t Crypto_Get_Security_Header_Length(SecurityAssociation_t* sa_ptr);
 int32_t Crypto_Get_Security_Trailer_Length(SecurityAssociation_t* sa_ptr);
 
 // Managed Parameter Functions
+int32_t Crypto_Get_Managed_Parameters_Ptr(uint8_t tfvn, uint16_t scid, uint8_t vcid,
+                                          const GvcidManagedParameters_t** managed_parameters_out);
+void Crypto_Managed_Parameters_Index_Build(void);
 int32_t Crypto_Get_Managed_Parameters_For_Gvcid(uint8_t tfvn, uint16_t scid, uint8_t vcid,
                                                        GvcidManagedParameters_t* managed_parameters_in,
                                                        GvcidManagedParameters_t* managed_parameters_out);
@@ -269,14 +349,14 @@ extern char* crypto_deep_copy_string(char* src_string);
 ** Extern Global Variables
 */ 
 // Data stores used in multiple components
-extern CCSDS_t sdls_frame;
+extern CRYPTO_THREAD_LOCAL CCSDS_t sdls_frame;
 // extern TM_t tm_frame;
-extern uint8_t tm_frame[1786];
-extern TM_FramePrimaryHeader_t tm_frame_pri_hdr; 
-extern TM_FrameSecurityHeader_t tm_frame_sec_hdr; // Used to reduce bit math duplication
+extern CRYPTO_THREAD_LOCAL uint8_t tm_frame[1786];
+extern CRYPTO_THREAD_LOCAL TM_FramePrimaryHeader_t tm_frame_pri_hdr; 
+extern CRYPTO_THREAD_LOCAL TM_FrameSecurityHeader_t tm_frame_sec_hdr; // Used to reduce bit math duplication
 // exterm AOS_t aos_frame
-extern AOS_FramePrimaryHeader_t aos_frame_pri_hdr; 
-extern AOS_FrameSecurityHeader_t aos_frame_sec_hdr; // Used to reduce bit math duplication
+extern CRYPTO_THREAD_LOCAL AOS_FramePrimaryHeader_t aos_frame_pri_hdr; 
+extern CRYPTO_THREAD_LOCAL AOS_FrameSecurityHeader_t aos_frame_sec_hdr; // Used to reduce bit math duplication
 
 // Global configuration structs
 extern CryptoConfig_t crypto_config;
@@ -284,9 +364,9 @@ extern SadbMariaDBConfig_t* sa_mariadb_config;
 extern CryptographyKmcCryptoServiceConfig_t* cryptography_kmc_crypto_config;
 extern CamConfig_t* cam_config;
 extern GvcidManagedParameters_t* gvcid_managed_parameters;
-extern GvcidManagedParameters_t* current_managed_parameters;
+extern CRYPTO_THREAD_LOCAL const GvcidManagedParameters_t* current_managed_parameters;
 extern GvcidManagedParameters_t gvcid_managed_parameters_array[250];
-extern GvcidManagedParameters_t current_managed_parameters_struct;
+extern CRYPTO_THREAD_LOCAL GvcidManagedParameters_t current_managed_parameters_struct;
 extern int gvcid_counter;
 extern KeyInterface key_if;
 extern McInterface mc_if;
@@ -294,19 +374,20 @@ extern SaInterface sa_if;
 extern CryptographyInterface cryptography_if;
 
 // extern crypto_key_t ak_ring[NUM_KEYS];
-extern CCSDS_t sdls_frame;
+extern CRYPTO_THREAD_LOCAL CCSDS_t sdls_frame;
 extern SadbMariaDBConfig_t* sa_mariadb_config;
 extern GvcidManagedParameters_t* gvcid_managed_parameters;
-extern GvcidManagedParameters_t* current_managed_parameters;
+extern CRYPTO_THREAD_LOCAL const GvcidManagedParameters_t* current_managed_parameters;
 // OCF
-extern uint8_t ocf;
-extern Telemetry_Frame_Ocf_Fsr_t report;
-extern Telemetry_Frame_Ocf_Clcw_t clcw;
+extern CRYPTO_THREAD_LOCAL uint8_t ocf;
+extern CRYPTO_THREAD_LOCAL Telemetry_Frame_Ocf_Fsr_t report;
+extern CRYPTO_THREAD_LOCAL Telemetry_Frame_Ocf_Clcw_t clcw;
 // Flags
 extern SDLS_MC_LOG_RPLY_t log_summary;
 extern SDLS_MC_DUMP_BLK_RPLY_t mc_log;
-extern uint8_t log_count;
-extern uint16_t tm_offset;
+extern uint16_t log_count;
+extern uint32_t log_overwritten;
+extern CRYPTO_THREAD_LOCAL uint16_t tm_offset;
 // ESA Testing - 0 = disabled, 1 = enabled
 extern uint8_t badSPI;
 extern uint8_t badIV;
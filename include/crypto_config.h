@@ -58,6 +58,7 @@
 
 // Managed Parameters Size
 #define GVCID_MAN_PARAM_SIZE 250
+#define GVCID_INDEX_SIZE 512 /* managed parameter lookup slots, power of two, ~2x GVCID_MAN_PARAM_SIZE */
 
 // Max Frame Size
 #define TC_MAX_FRAME_SIZE 1024
@@ -103,6 +104,22 @@
 #define KEY_DESTROYED 3
 #define KEY_CORRUPTED 4
 
+// Keyed Context Cache Defines
+#define KEY_CACHE_SIZE 16     /* keyed cipher/MAC contexts retained per cryptography interface */
+#define KEY_CACHE_MAX_KEY 64  /* longest key (bytes) eligible for caching, HMAC-SHA512 */
+#define KEY_CACHE_ALL 0xFFFF  /* key ID wildcard, drops every cached context */
+
+// FECF Engines, fastest supported is selected at init
+#define FECF_ENGINE_BITWISE 0
+#define FECF_ENGINE_TABLE 1
+#define FECF_ENGINE_SLICE8 2
+#define FECF_ENGINE_PCLMUL 3
+
+// ABM Engines, fastest supported is selected at init
+#define ABM_ENGINE_BYTEWISE 0
+#define ABM_ENGINE_RUNS 1
+#define ABM_ENGINE_AVX2 2
+
 // SA Service Types
 #define SA_PLAINTEXT 0
 #define SA_AUTHENTICATION 1
@@ -111,6 +128,8 @@
 
 // Generic Defines
 #define NUM_SA 64
+#define SA_INDEX_BUCKETS 128 /* operational SA index, power of two, ~2x NUM_SA */
+#define CRYPTO_CACHE_ALIGNED __attribute__((aligned(64))) /* hot SA records start on a cache line */
 #define SPI_LEN 2 /* bytes */
 #define KEY_SIZE 512 /* bytes */
 #define KEY_ID_SIZE 8
@@ -128,17 +147,34 @@
 #define ABM_SIZE 1786         /* bytes */
 #define ARSN_SIZE 20          /* total messages */
 #define ARSNW_SIZE 1          /* bytes */
+#define ARSNW_BITMAP_BITS 1024 /* sliding anti-replay bitmap per SA, power of 2, reorder depth is 64 less */
 #define SN_SIZE 16            /* bytes */
 #define PAD_SIZE 32           /* bytes */
 #define CHALLENGE_SIZE 16     /* bytes */
 #define CHALLENGE_MAC_SIZE 16 /* bytes */
 
+// SA File Journal (SA_FILE)
+#define SA_JOURNAL_SYNC_FRAMES 64        /* group commit, fsync the journal every N SA saves... */
+#define SA_JOURNAL_SYNC_MS 100           /* ...or once this many ms have passed since the last fsync */
+#define SA_JOURNAL_COMPACT_RECORDS 65536 /* fold the journal into a new snapshot after this many records */
+
+// MariaDB SA Cache
+#define SA_MARIADB_CACHE_BUCKETS 64 /* SPI hash buckets, and GVCID lookup slots, power of 2 */
+#define SA_MARIADB_CACHE_TTL_MS 1000 /* re-read a cached SA from the database once it is this old, 0 always */
+#define SA_MARIADB_FLUSH_MS 0        /* write-behind, flush buffered IV/ARSN updates this often, needs lease mode */
+
 // Monitoring and Control Defines
 #define EMV_SIZE 4  /* bytes */
+#define EMV_DEFAULT ((const uint8_t[EMV_SIZE]){0x4E, 0x41, 0x53, 0x41}) /* "NASA" */
 #define LOG_SIZE 50 /* packets */
 #define ST_OK 0x00
 #define ST_NOK 0xFF
 
+// MC Error Log (MC_INTERNAL)
+#define MC_LOG_RING_SIZE 1024 /* error records awaiting the flusher, power of 2 */
+#define MC_LOG_FLUSH_MS 100   /* the flusher writes queued records this often */
+#define MC_LOG_DEDUP_SLOTS 64 /* repeat suppression slots, error codes hashed by low bits, power of 2 */
+
 // Procedure Identification (PID)
 // Service Group - Key Management
 #define SG_KEY_MGMT 0x00 // 0b00
@@ -201,6 +237,18 @@
    #define TM_CADU_SIZE TM_FRAME_DATA_SIZE
 #endif
 
+// Thread Defines
+#define CRYPTO_THREAD_LOCAL _Thread_local // per-thread frame scratch state
+#define SA_LOCK_STRIPES 64               /* SA IV/ARSN mutexes, indexed by SPI */
+#define TM_POOL_MAX_WORKERS 16           /* TM ProcessSecurity worker threads */
+#define TM_POOL_RING_SIZE 256            /* frames in flight per worker, power of 2 */
+#define CRYPTO_ARENA_SIZE 4096           /* per-thread frame scratch bytes, holds an ABM_SIZE AAD */
+#define CRYPTO_ASYNC_MAX_FRAMES 64       /* TC/TM ApplySecurity_Async frames awaiting delivery */
+
+// Metrics Defines
+// Stage latency timing (SA lookup, key fetch, crypto and FECF) is off unless built with CRYPTO_METRICS_LATENCY
+#define CRYPTO_METRICS_LATENCY_BUCKETS 32 /* log2 ns histogram buckets per stage, the last collects anything slower */
+
 // Logic Behavior Defines
 #define CRYPTO_FALSE 0
 #define CRYPTO_TRUE 1
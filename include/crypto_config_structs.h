@@ -217,6 +217,7 @@ typedef struct
     CheckFecfBool crypto_check_fecf;
     uint8_t vcid_bitmask;
     uint8_t crypto_increment_nontransmitted_iv; // Whether or not CryptoLib increments the non-transmitted portion of the IV field
+    uint32_t sa_lease_frames; // 0: persist IV/ARSN on every frame, N: persist a lease N counters ahead, see Crypto_Config_SA_Lease
 } CryptoConfig_t;
 #define CRYPTO_CONFIG_SIZE (sizeof(CryptoConfig_t))
 
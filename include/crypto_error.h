@@ -127,6 +127,10 @@
 #define CRYPTO_LIB_ERR_KEY_VALIDATION (-55)
 #define CRYPTO_LIB_ERR_SPI_INDEX_OOB (-56)
 #define CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL (-57)
+#define CRYPTO_LIB_ERR_TM_POOL_FULL (-58)
+#define CRYPTO_LIB_ERR_TM_POOL_NOT_RUNNING (-59)
+#define CRYPTO_LIB_ERR_OUTPUT_BUFFER_TOO_SMALL (-60)
+#define CRYPTO_LIB_ERR_ASYNC_FULL (-61)
 
 extern char *crypto_enum_errlist_core[];
 extern char *crypto_enum_errlist_config[];
@@ -46,19 +46,40 @@ typedef struct
 
 /*
 ** Security Association
+** Split hot/cold: the fields a frame touches sit in a compact, cache-line aligned record, while the
+** bulky key references and ABM live in a SecurityAssociationCold_t reached through the pointers at
+** its end. The SADB owns both and binds them together, see Crypto_SA_Alloc for a standalone SA.
 */
 typedef struct
 {
-    // Status
-    uint16_t spi;  // Security Parameter Index
-    uint16_t ekid; // Encryption Key ID  (Used with numerically indexed keystores, EG inmemory keyring)
-    uint16_t akid; // Authentication Key ID
+    uint64_t bitmap[ARSNW_BITMAP_BITS / 64]; // Counters seen at or behind hwm, bit (counter % ARSNW_BITMAP_BITS)
+    uint8_t hwm[ARSN_SIZE > IV_SIZE ? ARSN_SIZE : IV_SIZE]; // Highest accepted counter the bitmap is anchored to
+    uint8_t hwm_len;                                         // 0 until first anchored
+} SecurityAssociationReplay_t;
+
+typedef struct
+{
+    uint8_t iv[IV_SIZE];     // Highest IV the durable store has reserved, see Crypto_SA_Lease_Renew
+    uint8_t arsn[ARSN_SIZE]; // Highest ARSN the durable store has reserved
+    uint8_t active;          // CRYPTO_TRUE while the stored counters are the lease rather than the live ones
+} SecurityAssociationLease_t;
+
+typedef struct
+{
     char ek_ref[REF_SIZE]; // Encryption Key Reference (Used with string-referenced keystores,EG-PKCS12 keystores, KMC crypto)
     char ak_ref[REF_SIZE]; // Authentication Key Reference (Used with string-referenced keystores,EG-PKCS12 keystores, KMC crypto)
+    uint8_t abm[ABM_SIZE]; // Authentication Bit Mask (Primary Hdr. through Security Hdr.)
+    SecurityAssociationReplay_t replay; // Sliding anti-replay window state
+    SecurityAssociationLease_t lease;   // Counter lease held in the SA file, in-memory SADB only
+} SecurityAssociationCold_t;
+
+typedef struct
+{
+    // Status
+    uint16_t spi;  // Security Parameter Index
     uint8_t sa_state : 2;
     crypto_gvcid_t gvcid_blk;
     // crypto_gvcid_t gvcid_tm_blk[NUM_GVCID];
-    uint8_t lpid;
 
     // Configuration
     uint8_t est : 1;        // Encryption Service Type
@@ -69,18 +90,27 @@ typedef struct
     uint8_t stmacf_len : 8; // Sec. Trailer MAC Field Length
     uint8_t ecs;            // Encryption Cipher Suite (algorithm / mode ID)
     uint8_t ecs_len : 8;    // Encryption Cipher Suite Length
-    uint8_t iv[IV_SIZE];    // Initialization Vector
-    uint8_t iv_len;         // Length of entire IV
-    uint8_t acs_len : 8;    // Authentication Cipher Suite Length
     uint8_t acs;            // Authentication Cipher Suite (algorithm / mode ID)
-    uint16_t abm_len : 16;  // Authentication Bit Mask Length
-    uint8_t abm[ABM_SIZE];  // Authentication Bit Mask (Primary Hdr. through Security Hdr.)
+    uint8_t acs_len : 8;    // Authentication Cipher Suite Length
+    uint8_t iv_len;         // Length of entire IV
     uint8_t arsn_len : 8;   // Anti-Replay Seq Num Length
-    uint8_t arsn[ARSN_SIZE];// Anti-Replay Seq Num
     uint8_t arsnw_len : 8;  // Anti-Replay Seq Num Window Length
     uint16_t arsnw;         // Anti-Replay Seq Num Window
+    uint8_t arsnw_bitmap;   // CRYPTO_TRUE: window also accepts unseen counters behind the last one, see Crypto_Replay_Check
+    uint16_t abm_len : 16;  // Authentication Bit Mask Length
+    uint16_t ekid;          // Encryption Key ID  (Used with numerically indexed keystores, EG inmemory keyring)
+    uint16_t akid;          // Authentication Key ID
+    uint8_t lpid;
+    uint8_t iv[IV_SIZE];    // Initialization Vector
+    uint8_t arsn[ARSN_SIZE];// Anti-Replay Seq Num
+
+    // Cold storage, see SecurityAssociationCold_t
+    char* ek_ref;
+    char* ak_ref;
+    uint8_t* abm;
+    SecurityAssociationReplay_t* replay;
 
-} SecurityAssociation_t;
+} CRYPTO_CACHE_ALIGNED SecurityAssociation_t;
 #define SA_SIZE (sizeof(SecurityAssociation_t))
 
 /*
@@ -432,6 +462,19 @@ typedef struct
 #define TM_MIN_SIZE                                                                                                    \
     (TM_FRAME_PRIMARYHEADER_SIZE + TM_FRAME_SECHEADER_SIZE + TM_FRAME_SECTRAILER_SIZE + TM_FRAME_CLCW_SIZE)
 
+/*
+** TM ProcessSecurity Worker Pool
+*/
+typedef struct
+{
+    uint8_t* p_ingest;          // Frame as submitted, owned by the caller
+    uint16_t len_ingest;
+    void* user_ctx;             // Passed back untouched
+    uint8_t* p_processed_frame; // Output of Crypto_TM_ProcessSecurity, free()d by the caller
+    uint16_t decrypted_length;
+    int32_t status;
+} TM_Pool_Frame_t;
+
 /*
 ** Advanced Orbiting Systems (AOS) Definitions
 */
@@ -489,4 +532,54 @@ typedef struct
 #define AOS_MIN_SIZE                                                                                                    \
     (AOS_FRAME_PRIMARYHEADER_SIZE + AOS_FRAME_SECHEADER_SIZE + AOS_FRAME_SECTRAILER_SIZE + AOS_FRAME_OCF_SIZE)
 
+/*
+** Asynchronous ApplySecurity
+*/
+// Hands a frame back from Crypto_Async_Poll, status is what the blocking ApplySecurity would have returned
+typedef void (*Crypto_Async_Callback_t)(void* ctx, int32_t status, uint8_t* p_frame, uint16_t frame_len);
+
+/*
+** Metrics
+*/
+// Per-frame counters, indexes into Crypto_Metrics_t rows. Frames are counted once, under the outcome they
+// left the public entry point with; each byte counter directly follows its frame counter.
+typedef enum
+{
+    CRYPTO_COUNTER_FRAMES_APPLIED,   // ApplySecurity succeeded
+    CRYPTO_COUNTER_BYTES_APPLIED,
+    CRYPTO_COUNTER_FRAMES_PROCESSED, // ProcessSecurity succeeded
+    CRYPTO_COUNTER_BYTES_PROCESSED,
+    CRYPTO_COUNTER_MAC_FAILURES,
+    CRYPTO_COUNTER_REPLAY_REJECTS,   // IV or ARSN outside the anti-replay window
+    CRYPTO_COUNTER_FECF_ERRORS,
+    CRYPTO_COUNTER_SA_MISSES,        // No operational SA or managed parameters for the SPI or GVCID
+    CRYPTO_COUNTER_OTHER_ERRORS,
+    CRYPTO_COUNTER_COUNT
+} Crypto_Counter_t;
+
+// Timed stages, see CRYPTO_STAGE_START
+typedef enum
+{
+    CRYPTO_STAGE_SA_LOOKUP,
+    CRYPTO_STAGE_KEY_FETCH,
+    CRYPTO_STAGE_CRYPTO,
+    CRYPTO_STAGE_FECF,
+    CRYPTO_STAGE_COUNT
+} Crypto_Stage_t;
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t buckets[CRYPTO_METRICS_LATENCY_BUCKETS]; // [i] counts samples in [2^i, 2^(i+1)) ns, [0] from 0, last unbounded
+} Crypto_Latency_t;
+
+typedef struct
+{
+    uint64_t total[CRYPTO_COUNTER_COUNT];
+    uint64_t sa[NUM_SA][CRYPTO_COUNTER_COUNT];               // By SPI, SPIs from NUM_SA up only count in total
+    uint64_t vc[GVCID_MAN_PARAM_SIZE][CRYPTO_COUNTER_COUNT]; // By GVCID, row i is gvcid_managed_parameters_array[i]
+    Crypto_Latency_t stage[CRYPTO_STAGE_COUNT];              // Empty unless built with CRYPTO_METRICS_LATENCY
+} Crypto_Metrics_t;
+
 #endif //CRYPTO_STRUCTS_H
\ No newline at end of file
@@ -0,0 +1,48 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+#ifndef CRYPTO_TRACE_H
+#define CRYPTO_TRACE_H
+
+/*
+** Static Tracepoints (CMAKE option CRYPTO_TRACE)
+** USDT probes under provider "cryptolib", for perf, bpftrace or systemtap, e.g.
+**   bpftrace -e 'usdt:./libcrypto.so:cryptolib:tm_process_return { @[arg1] = count(); }'
+**
+**   <family>_entry(p_frame, frame_len)
+**   <family>_return(spi, tfvn, scid, vcid, frame_len, status)
+**       family is tc_apply, tc_process, tm_apply, tm_process, aos_apply or aos_process. Fired on the way in
+**       and out of the public entry points, and per frame by the batch calls. spi is -1 if no SA was
+**       found, scid 0xFFFF if the primary header could not be read.
+**   stage_entry(stage, spi)
+**   stage_return(stage, spi, ns)
+**       Crypto_Stage_t: SA lookup, key fetch, cryptography_if call, FECF. spi is the SA the thread holds,
+**       -1 during SA lookup. ns is 0 unless built with CRYPTO_METRICS_LATENCY.
+**   anti_replay_entry(spi) / anti_replay_return(spi, status)
+**   sa_save_entry(spi) / sa_save_return(spi, status)
+**
+** Without CRYPTO_TRACE a probe expands to nothing and its arguments are not evaluated.
+*/
+#ifdef CRYPTO_TRACE
+#include <sys/sdt.h>
+#define CRYPTO_PROBE(name, ...) STAP_PROBEV(cryptolib, name, __VA_ARGS__)
+#else
+#define CRYPTO_PROBE(name, ...)
+#endif
+
+#endif //CRYPTO_TRACE_H
@@ -26,6 +26,9 @@
 
 #include "crypto_structs.h"
 
+// Completion of an asynchronous call, status is what the blocking call would have returned
+typedef void (*cryptography_async_done_t)(void* op_ctx, int32_t status);
+
 typedef struct
 {
     // Cryptography Interface Initialization & Management Functions
@@ -80,7 +83,23 @@ typedef struct
                                          uint8_t aad_bool, uint8_t* ecs, uint8_t* acs, char* cam_cookies);
     int32_t (*cryptography_get_acs_algo)(int8_t algo_enum);
     int32_t (*cryptography_get_ecs_algo)(int8_t algo_enum);
-    
+    // Optional - drop keyed contexts retained for key_id (KEY_CACHE_ALL for every key), may be NULL
+    int32_t (*cryptography_invalidate_key)(uint16_t key_id);
+    // Optional - asynchronous AEAD encrypt, may be NULL. Takes the blocking call's arguments, copies every input
+    // before returning, then writes the outputs and calls done(op_ctx, status) from cryptography_async_poll.
+    // done is only called when the submission itself returned success.
+    int32_t (*cryptography_aead_encrypt_async)(uint8_t* data_out, size_t len_data_out,
+                                         uint8_t* data_in, size_t len_data_in,
+                                         uint8_t* key, uint32_t len_key,
+                                         SecurityAssociation_t* sa_ptr,
+                                         uint8_t* iv, uint32_t iv_len,
+                                         uint8_t* mac, uint32_t mac_size,
+                                         uint8_t* aad, uint32_t aad_len,
+                                         uint8_t encrypt_bool, uint8_t authenticate_bool,
+                                         uint8_t aad_bool, uint8_t* ecs, uint8_t* acs, char* cam_cookies,
+                                         cryptography_async_done_t done, void* op_ctx);
+    // Optional - completes asynchronous calls, waiting up to timeout_ms for the first, returns the number completed
+    int32_t (*cryptography_async_poll)(int32_t timeout_ms);
 
 } CryptographyInterfaceStruct, *CryptographyInterface;
 
@@ -33,24 +33,25 @@ CFS_MODULE_DECLARE_LIB(crypto);
 ** Global Variables
 */
 // crypto_key_t ak_ring[NUM_KEYS];
-CCSDS_t sdls_frame;
+CRYPTO_THREAD_LOCAL CCSDS_t sdls_frame;
 // TM_t tm_frame;
-uint8_t tm_frame[1786];                    // Testing
-TM_FramePrimaryHeader_t tm_frame_pri_hdr;  // Used to reduce bit math duplication
-TM_FrameSecurityHeader_t tm_frame_sec_hdr; // Used to reduce bit math duplication
+CRYPTO_THREAD_LOCAL uint8_t tm_frame[1786];                    // Testing
+CRYPTO_THREAD_LOCAL TM_FramePrimaryHeader_t tm_frame_pri_hdr;  // Used to reduce bit math duplication
+CRYPTO_THREAD_LOCAL TM_FrameSecurityHeader_t tm_frame_sec_hdr; // Used to reduce bit math duplication
 // AOS_t aos_frame
-uint8_t aos_frame[1786];                    // Testing
-AOS_FramePrimaryHeader_t aos_frame_pri_hdr;  // Used to reduce bit math duplication
-AOS_FrameSecurityHeader_t aos_frame_sec_hdr; // Used to reduce bit math duplication
+CRYPTO_THREAD_LOCAL uint8_t aos_frame[1786];                    // Testing
+CRYPTO_THREAD_LOCAL AOS_FramePrimaryHeader_t aos_frame_pri_hdr;  // Used to reduce bit math duplication
+CRYPTO_THREAD_LOCAL AOS_FrameSecurityHeader_t aos_frame_sec_hdr; // Used to reduce bit math duplication
 // OCF
-uint8_t ocf = 0;
-Telemetry_Frame_Ocf_Fsr_t report;
-Telemetry_Frame_Ocf_Clcw_t clcw;
+CRYPTO_THREAD_LOCAL uint8_t ocf = 0;
+CRYPTO_THREAD_LOCAL Telemetry_Frame_Ocf_Fsr_t report;
+CRYPTO_THREAD_LOCAL Telemetry_Frame_Ocf_Clcw_t clcw;
 // Flags
 SDLS_MC_LOG_RPLY_t log_summary;
 SDLS_MC_DUMP_BLK_RPLY_t mc_log;
-uint8_t log_count = 0;
-uint16_t tm_offset = 0;
+uint16_t log_count = 0;
+uint32_t log_overwritten = 0;
+CRYPTO_THREAD_LOCAL uint16_t tm_offset = 0;
 // ESA Testing - 0 = disabled, 1 = enabled
 uint8_t badSPI = 0;
 uint8_t badIV = 0;
@@ -90,6 +91,117 @@ void clean_akref(SecurityAssociation_t* sa)
     }
 }
 
+/**
+ * @brief Function: Crypto_SA_Alloc
+ * Allocates a zeroed SA together with its cold storage in a single block, so one free releases both.
+ * For SAs built outside the SADB, such as the rows of a MariaDB query.
+ * @return SecurityAssociation_t*: NULL on allocation failure
+ **/
+SecurityAssociation_t* Crypto_SA_Alloc(void)
+{
+    SecurityAssociation_t* sa;
+    SecurityAssociationCold_t* sa_cold;
+    size_t size = sizeof(SecurityAssociation_t) + sizeof(SecurityAssociationCold_t);
+
+    // aligned_alloc requires a multiple of the alignment
+    size = (size + _Alignof(SecurityAssociation_t) - 1) & ~(_Alignof(SecurityAssociation_t) - 1);
+    sa = aligned_alloc(_Alignof(SecurityAssociation_t), size);
+    if (sa == NULL)
+    {
+        return NULL;
+    }
+    memset(sa, 0, size);
+    sa_cold = (SecurityAssociationCold_t*)(sa + 1);
+    sa->ek_ref = sa_cold->ek_ref;
+    sa->ak_ref = sa_cold->ak_ref;
+    sa->abm = sa_cold->abm;
+    sa->replay = &sa_cold->replay;
+    return sa;
+}
+
+/**
+ * @brief Function: crypto_counter_lease_covers
+ * Whether a lease is still ahead of a counter, by no more than the lease length
+ **/
+static uint8_t crypto_counter_lease_covers(const uint8_t* lease, const uint8_t* counter, int length)
+{
+    uint64_t remaining;
+
+    if (length == 0)
+    {
+        return CRYPTO_TRUE;
+    }
+    return (Crypto_Counter_Diff(lease, counter, length, &remaining) == CRYPTO_TRUE && remaining > 0 &&
+            remaining <= crypto_config.sa_lease_frames)
+               ? CRYPTO_TRUE
+               : CRYPTO_FALSE;
+}
+
+/**
+ * @brief Function: crypto_counter_add
+ * Adds n to a big-endian counter, wrapping like Crypto_increment
+ **/
+static void crypto_counter_add(uint8_t* counter, int length, uint64_t n)
+{
+    uint64_t sum;
+    int i;
+
+    for (i = length - 1; i >= 0 && n > 0; i--)
+    {
+        sum = counter[i] + (n & 0xFF);
+        counter[i] = (uint8_t)sum;
+        n = (n >> 8) + (sum >> 8);
+    }
+}
+
+/**
+ * @brief Function: Crypto_SA_Lease_Renew
+ * For SA backends persisting counters in lease mode (Crypto_Config_SA_Lease). Called on every save: if
+ * the lease still covers the SA's IV and ARSN there is nothing to persist, otherwise the lease is moved
+ * to the current counters plus the lease length and the caller persists it in place of the counters.
+ * @param sa_ptr: SecurityAssociation_t*
+ * @param lease: SecurityAssociationLease_t*, the backend's lease for this SA
+ * @return uint8: CRYPTO_TRUE if the lease was renewed and must be persisted
+ **/
+uint8_t Crypto_SA_Lease_Renew(SecurityAssociation_t* sa_ptr, SecurityAssociationLease_t* lease)
+{
+    int iv_len = (sa_ptr->iv_len > IV_SIZE) ? IV_SIZE : sa_ptr->iv_len;
+    int arsn_len = (sa_ptr->arsn_len > ARSN_SIZE) ? ARSN_SIZE : sa_ptr->arsn_len;
+
+    if (lease->active == CRYPTO_TRUE && crypto_counter_lease_covers(lease->iv, sa_ptr->iv, iv_len) &&
+        crypto_counter_lease_covers(lease->arsn, sa_ptr->arsn, arsn_len))
+    {
+        return CRYPTO_FALSE;
+    }
+
+    memset(lease, 0, sizeof(SecurityAssociationLease_t));
+    memcpy(lease->iv, sa_ptr->iv, iv_len);
+    crypto_counter_add(lease->iv, iv_len, crypto_config.sa_lease_frames);
+    memcpy(lease->arsn, sa_ptr->arsn, arsn_len);
+    crypto_counter_add(lease->arsn, arsn_len, crypto_config.sa_lease_frames);
+    lease->active = CRYPTO_TRUE;
+#ifdef SA_DEBUG
+    printf("SA %d counter lease renewed for %d frames\n", sa_ptr->spi, crypto_config.sa_lease_frames);
+#endif
+    return CRYPTO_TRUE;
+}
+
+/**
+ * @brief Function: Crypto_SA_Save
+ * Persists a frame's SA updates through sa_if->sa_save_sa, between the sa_save trace probes
+ * @param sa_ptr: SecurityAssociation_t*
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_SA_Save(SecurityAssociation_t* sa_ptr)
+{
+    int32_t status;
+
+    CRYPTO_PROBE(sa_save_entry, (sa_ptr != NULL) ? (int32_t)sa_ptr->spi : -1);
+    status = sa_if->sa_save_sa(sa_ptr);
+    CRYPTO_PROBE(sa_save_return, (sa_ptr != NULL) ? (int32_t)sa_ptr->spi : -1, status);
+    return status;
+}
+
 /**
  * @brief Function: Crypto_Is_AEAD_Algorithm
  * Looks up cipher suite ID and determines if it's an AEAD algorithm. Returns 1 if true, 0 if false;
@@ -147,9 +259,78 @@ int32_t Crypto_increment(uint8_t* num, int length)
     return CRYPTO_LIB_SUCCESS;
 }
 
+/**
+ * @brief Function: crypto_load_be
+ * Reads an n byte (n <= 8) big-endian number
+ * @param num: const uint8_t*
+ * @param n: int
+ * @return uint64: value
+ **/
+static uint64_t crypto_load_be(const uint8_t* num, int n)
+{
+    uint64_t value = 0;
+    int i;
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (n == 8)
+    {
+        memcpy(&value, num, 8);
+        return __builtin_bswap64(value);
+    }
+#endif
+    for (i = 0; i < n; i++)
+    {
+        value = (value << 8) | num[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Function: Crypto_Counter_Diff
+ * Computes a - b modulo 2^(8 * length) for big-endian counters, 64 bits at a time
+ * @param a: const uint8_t*
+ * @param b: const uint8_t*
+ * @param length: int
+ * @param diff: uint64_t*, low 64 bits of the difference
+ * @return uint8: CRYPTO_TRUE if the difference fits in diff
+ **/
+uint8_t Crypto_Counter_Diff(const uint8_t* a, const uint8_t* b, int length, uint64_t* diff)
+{
+    uint64_t va;
+    uint64_t vb;
+    uint64_t word;
+    uint64_t mask;
+    uint64_t borrow = 0;
+    uint64_t high = 0;
+    int end;
+    int n;
+
+    *diff = 0;
+    for (end = length; end > 0; end -= n)
+    {
+        n = (end >= 8) ? 8 : end;
+        mask = (n == 8) ? UINT64_MAX : ((1ULL << (8 * n)) - 1);
+        va = crypto_load_be(&a[end - n], n);
+        vb = crypto_load_be(&b[end - n], n);
+        word = (va - vb - borrow) & mask;
+        borrow = (va < vb || (va - vb) < borrow) ? 1 : 0;
+        if (end == length)
+        {
+            *diff = word;
+        }
+        else
+        {
+            high |= word;
+        }
+    }
+    return (high == 0) ? CRYPTO_TRUE : CRYPTO_FALSE;
+}
+
 /**
  * @brief Function: Crypto_window
- * Determines if a value is within the expected positive window of values
+ * Determines if a value is within the expected positive window of values, ie. actual is one of
+ * expected + 1 .. expected + window, wrapping at the counter length like Crypto_increment.
+ * Takes one big-endian subtraction, so the cost does not depend on the window.
  * @param actual: uint8*
  * @param expected: uint8*
  * @param length: int
@@ -159,10 +340,9 @@ int32_t Crypto_increment(uint8_t* num, int length)
 int32_t Crypto_window(uint8_t* actual, uint8_t* expected, int length, int window)
 {
     int status = CRYPTO_LIB_ERROR;
-    int result = 0;
-    uint8_t temp[length];
+    uint64_t diff;
+    uint8_t fits;
     int i;
-    int j;
 
     // Check Null Pointers
     if (actual == NULL)
@@ -187,6 +367,7 @@ int32_t Crypto_window(uint8_t* actual, uint8_t* expected, int length, int window
         if (actual[i] != 0 || expected[i] != 0)
         {
             zero_case = CRYPTO_FALSE;
+            break;
         }
     }
     if (zero_case == CRYPTO_TRUE)
@@ -195,31 +376,16 @@ int32_t Crypto_window(uint8_t* actual, uint8_t* expected, int length, int window
         return status;
     }
 
-    memcpy(temp, expected, length);
-    for (i = 0; i < window; i++)
-    {
-        // Recall - the stored IV or ARSN is the last valid one received, check against next expected
-        Crypto_increment(&temp[0], length);
-
+    fits = Crypto_Counter_Diff(actual, expected, length, &diff);
 #ifdef DEBUG
-        printf("Checking Frame Against Incremented Window:\n");
-        Crypto_hexprint(temp, length);
+    printf("Crypto_Window: actual - expected = %s%llu, window %d\n", fits ? "" : "> ", (unsigned long long)diff, window);
 #endif
-
-        result = 0;
-        /* go from right (least significant) to left (most signifcant) */
-        for (j = length - 1; j >= 0; --j)
-        {
-            if (actual[j] == temp[j])
-            {
-                result++;
-            }
-        }
-        if (result == length)
-        {
-            status = CRYPTO_LIB_SUCCESS;
-            break;
-        }
+    // Recall - the stored IV or ARSN is the last valid one received, so a repeat (diff 0) is rejected,
+    // unless the window spans the whole counter space of a short counter
+    if (window > 0 && fits == CRYPTO_TRUE &&
+        ((diff >= 1 && diff <= (uint64_t)window) || (length < 4 && ((uint64_t)window >> (8 * length)) != 0)))
+    {
+        status = CRYPTO_LIB_SUCCESS;
     }
     return status;
 }
@@ -324,17 +490,7 @@ int32_t Crypto_FECF(int fecf, uint8_t* ingest, int len_ingest,TC_t* tc_frame)
             else
             {   // TODO: Error Correction
                 printf(KRED "Error: FECF incorrect!\n" RESET);
-                if (log_summary.rs > 0)
-                {
-                    Crypto_increment((uint8_t*)&log_summary.num_se, 4);
-                    log_summary.rs--;
-                    mc_log.blk[log_count].emt = FECF_ERR_EID;
-                    mc_log.blk[log_count].emv[0] = 0x4E;
-                    mc_log.blk[log_count].emv[1] = 0x41;
-                    mc_log.blk[log_count].emv[2] = 0x53;
-                    mc_log.blk[log_count].emv[3] = 0x41;
-                    mc_log.blk[log_count++].em_len = 4;
-                }
+                Crypto_Event_Log(FECF_ERR_EID, EMV_DEFAULT);
                 #ifdef FECF_DEBUG
                     printf("\t Calculated = 0x%04x \n\t Received   = 0x%04x \n", calc_fecf,
 tc_frame->tc_sec_trailer.fecf); #endif result = CRYPTO_LIB_ERROR;
@@ -345,57 +501,6 @@ tc_frame->tc_sec_trailer.fecf); #endif result = CRYPTO_LIB_ERROR;
 }
 */
 
-/**
- * @brief Function Crypto_Calc_FECF
- * Calculate the Frame Error Control Field (FECF), also known as a cyclic redundancy check (CRC)
- * @param ingest: uint8_t*
- * @param len_ingest: int
- * @return uint16: FECF
- **/
-uint16_t Crypto_Calc_FECF(const uint8_t* ingest, int len_ingest)
-{
-    uint16_t fecf = 0xFFFF;
-    uint16_t poly = 0x1021; // TODO: This polynomial is (CRC-CCITT) for ESA testing, may not match standard protocol
-    uint8_t bit;
-    uint8_t c15;
-    int i;
-    int j;
-
-    for (i = 0; i < len_ingest; i++)
-    { // Byte Logic
-        for (j = 0; j < 8; j++)
-        { // Bit Logic
-            bit = ((ingest[i] >> (7 - j) & 1) == 1);
-            c15 = ((fecf >> 15 & 1) == 1);
-            fecf <<= 1;
-            if (c15 ^ bit)
-            {
-                fecf ^= poly;
-            }
-        }
-    }
-    // Check if Testing
-    //if (badFECF == 1)
-    //{
-    //    fecf++;
-    //}
-
-#ifdef FECF_DEBUG
-    int x;
-    printf(KCYN "Crypto_Calc_FECF: 0x%02x%02x%02x%02x%02x, len_ingest = %d\n" RESET, ingest[0], ingest[1], ingest[2],
-           ingest[3], ingest[4], len_ingest);
-    printf(KCYN "0x" RESET);
-    for (x = 0; x < len_ingest; x++)
-    {
-        printf(KCYN "%02x" RESET, (uint8_t) * (ingest + x));
-    }
-    printf(KCYN "\n" RESET);
-    printf(KCYN "In Crypto_Calc_FECF! fecf = 0x%04x\n" RESET, fecf);
-#endif
-
-    return fecf;
-}
-
 /**
  * @brief Function: Crypto_Calc_CRC16
  * Calculates CRC16
@@ -690,22 +795,37 @@ int32_t Crypto_Get_Managed_Parameters_For_Gvcid(uint8_t tfvn, uint16_t scid, uin
                                                 GvcidManagedParameters_t* managed_parameters_out)
 {
     int32_t status = MANAGED_PARAMETERS_FOR_GVCID_NOT_FOUND;
-    for(int i = 0; i < gvcid_counter; i++)
+    const GvcidManagedParameters_t* found = NULL;
+
+    if (managed_parameters_in == gvcid_managed_parameters_array)
+    {
+        status = Crypto_Get_Managed_Parameters_Ptr(tfvn, scid, vcid, &found);
+    }
+    else
     {
-        if (managed_parameters_in[i].tfvn == tfvn && managed_parameters_in[i].scid == scid &&
-            managed_parameters_in[i].vcid == vcid)
+        for(int i = 0; i < gvcid_counter; i++)
         {
-            *managed_parameters_out = managed_parameters_in[i];
-            status = CRYPTO_LIB_SUCCESS;
-            break;
+            if (managed_parameters_in[i].tfvn == tfvn && managed_parameters_in[i].scid == scid &&
+                managed_parameters_in[i].vcid == vcid)
+            {
+                found = &managed_parameters_in[i];
+                status = CRYPTO_LIB_SUCCESS;
+                break;
+            }
         }
     }
 
-    if(status != CRYPTO_LIB_SUCCESS)
+    if(status == CRYPTO_LIB_SUCCESS)
+    {
+        *managed_parameters_out = *found;
+    }
+#ifdef DEBUG
+    else
     {
         printf(KRED "Error: Managed Parameters for GVCID(TFVN: %d, SCID: %d, VCID: %d) not found. \n" RESET, tfvn, scid,
                vcid);
     }
+#endif
 
     return status;
 }
@@ -822,7 +942,9 @@ int32_t Crypto_Process_Extended_Procedure_Pdu(TC_t* tc_sdls_processed_frame, uin
 #endif
 
             // Determine type of PDU
+            Crypto_Mgmt_Lock();
             status = Crypto_PDU(ingest, tc_sdls_processed_frame);
+            Crypto_Mgmt_Unlock();
         }
     }
     else if (tc_sdls_processed_frame->tc_header.vcid == TC_SDLS_EP_VCID) // TC SDLS PDU with no packet layer
@@ -849,7 +971,9 @@ int32_t Crypto_Process_Extended_Procedure_Pdu(TC_t* tc_sdls_processed_frame, uin
 #endif
 
         // Determine type of PDU
+        Crypto_Mgmt_Lock();
         status = Crypto_PDU(ingest, tc_sdls_processed_frame);
+        Crypto_Mgmt_Unlock();
     }
     else
     {
@@ -888,20 +1012,33 @@ int32_t Crypto_Check_Anti_Replay_Verify_Pointers(SecurityAssociation_t* sa_ptr,
     return status;
 }
 
+/**
+ * @brief Function: crypto_anti_replay_tracks_arsn
+ * Which counter an SA's sliding anti-replay bitmap follows: the ARSN if transmitted, else the IV
+ * @param sa_ptr: SecurityAssociation_t*
+ * @return uint8: CRYPTO_TRUE if the ARSN
+ **/
+static uint8_t crypto_anti_replay_tracks_arsn(SecurityAssociation_t* sa_ptr)
+{
+    return (sa_ptr->arsn_len > 0 && sa_ptr->shsnf_len > 0) ? CRYPTO_TRUE : CRYPTO_FALSE;
+}
+
 /**
  * @brief Function: Crypto_Check_Anti_Replay_ARSNW
  * Sanity Check, validates ARSN within window
  * @param sa_ptr: SecurityAssociation_t*
  * @param arsn: uint8_t*
  * @param arsn_valid: uint8_t*
+ * @param arsn_ahead: uint8_t*, CRYPTO_TRUE if ahead of the stored ARSN rather than reordered behind it
  **/
-int32_t Crypto_Check_Anti_Replay_ARSNW(SecurityAssociation_t* sa_ptr, uint8_t* arsn, int8_t* arsn_valid)
+int32_t Crypto_Check_Anti_Replay_ARSNW(SecurityAssociation_t* sa_ptr, uint8_t* arsn, int8_t* arsn_valid,
+                                       int8_t* arsn_ahead)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
     if (sa_ptr->shsnf_len > 0)
     {
         // Check Sequence Number is in ARSNW
-        status = Crypto_window(arsn, sa_ptr->arsn, sa_ptr->arsn_len, sa_ptr->arsnw);
+        status = Crypto_Replay_Check(sa_ptr, arsn, sa_ptr->arsn, sa_ptr->arsn_len, CRYPTO_TRUE, arsn_ahead);
 #ifdef DEBUG
         printf("Received ARSN is\n\t");
         for (int i = 0; i < sa_ptr->arsn_len; i++)
@@ -914,7 +1051,7 @@ int32_t Crypto_Check_Anti_Replay_ARSNW(SecurityAssociation_t* sa_ptr, uint8_t* a
             printf("%02x", *(sa_ptr->arsn + i));
         }
         printf("\nARSNW is: %d\n", sa_ptr->arsnw);
-        printf("Status from Crypto_Window is: %d\n", status);
+        printf("Status from Crypto_Replay_Check is: %d\n", status);
 #endif
         if (status != CRYPTO_LIB_SUCCESS)
         {
@@ -936,21 +1073,24 @@ int32_t Crypto_Check_Anti_Replay_ARSNW(SecurityAssociation_t* sa_ptr, uint8_t* a
  * @param sa_ptr: SecurityAssociation_t*
  * @param iv: uint8_t*
  * @param iv_valid: uint8_t*
+ * @param iv_ahead: uint8_t*, CRYPTO_TRUE if ahead of the stored IV rather than reordered behind it
  **/
-int32_t Crypto_Check_Anti_Replay_GCM(SecurityAssociation_t* sa_ptr, uint8_t* iv, int8_t* iv_valid)
+int32_t Crypto_Check_Anti_Replay_GCM(SecurityAssociation_t* sa_ptr, uint8_t* iv, int8_t* iv_valid, int8_t* iv_ahead)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
+    uint8_t tracked = crypto_anti_replay_tracks_arsn(sa_ptr) ? CRYPTO_FALSE : CRYPTO_TRUE;
     if ((sa_ptr->iv_len > 0) && (sa_ptr->ecs == CRYPTO_CIPHER_AES256_GCM))
     {
         // Check IV is in ARSNW
         if(crypto_config.crypto_increment_nontransmitted_iv == SA_INCREMENT_NONTRANSMITTED_IV_TRUE)
         {
-            status = Crypto_window(iv, sa_ptr->iv, sa_ptr->iv_len, sa_ptr->arsnw);
+            status = Crypto_Replay_Check(sa_ptr, iv, sa_ptr->iv, sa_ptr->iv_len, tracked, iv_ahead);
         }
         else // SA_INCREMENT_NONTRANSMITTED_IV_FALSE
         {
             // Whole IV gets checked in MAC validation previously, this only verifies transmitted portion is what we expect.
-            status = Crypto_window(iv, sa_ptr->iv + (sa_ptr->iv_len - sa_ptr->shivf_len), sa_ptr->shivf_len, sa_ptr->arsnw);
+            status = Crypto_Replay_Check(sa_ptr, iv, sa_ptr->iv + (sa_ptr->iv_len - sa_ptr->shivf_len), sa_ptr->shivf_len,
+                                         tracked, iv_ahead);
         }
 #ifdef DEBUG
         printf("Received IV is\n\t");
@@ -964,7 +1104,7 @@ int32_t Crypto_Check_Anti_Replay_GCM(SecurityAssociation_t* sa_ptr, uint8_t* iv,
             printf("%02x", *(sa_ptr->iv + i));
         }
         printf("\nARSNW is: %d\n", sa_ptr->arsnw);
-        printf("Crypto_Window return status is: %d\n", status);
+        printf("Crypto_Replay_Check return status is: %d\n", status);
 #endif
         if (status != CRYPTO_LIB_SUCCESS)
         {
@@ -982,7 +1122,8 @@ int32_t Crypto_Check_Anti_Replay_GCM(SecurityAssociation_t* sa_ptr, uint8_t* iv,
 
 /**
  * @brief Function: Crypto_Check_Anti_Replay
- * Verifies data within window.
+ * Verifies data within window. Stored counters only ever move forward; with the SA's arsnw_bitmap set,
+ * a reordered counter behind them is accepted once and recorded in the bitmap.
  * @param sa_ptr: SecurityAssociation_t*
  * @param arsn: uint8_t*
  * @param iv: uint8_t*
@@ -992,6 +1133,10 @@ int32_t Crypto_Check_Anti_Replay(SecurityAssociation_t* sa_ptr, uint8_t* arsn, u
     int32_t status = CRYPTO_LIB_SUCCESS;
     int8_t iv_valid = -1;
     int8_t arsn_valid = -1;
+    int8_t iv_ahead = CRYPTO_FALSE;
+    int8_t arsn_ahead = CRYPTO_FALSE;
+
+    CRYPTO_PROBE(anti_replay_entry, (sa_ptr != NULL) ? (int32_t)sa_ptr->spi : -1);
 
     // Check for NULL pointers
     status = Crypto_Check_Anti_Replay_Verify_Pointers(sa_ptr, arsn, iv);
@@ -999,13 +1144,34 @@ int32_t Crypto_Check_Anti_Replay(SecurityAssociation_t* sa_ptr, uint8_t* arsn, u
     // If sequence number field is greater than zero, check for replay
     if(status == CRYPTO_LIB_SUCCESS)
     {
-        status = Crypto_Check_Anti_Replay_ARSNW(sa_ptr, arsn, &arsn_valid);
+        status = Crypto_Check_Anti_Replay_ARSNW(sa_ptr, arsn, &arsn_valid, &arsn_ahead);
     }
 
     // If IV is greater than zero and using GCM, check for replay
     if(status == CRYPTO_LIB_SUCCESS)
     {
-        status = Crypto_Check_Anti_Replay_GCM(sa_ptr, iv, &iv_valid);
+        status = Crypto_Check_Anti_Replay_GCM(sa_ptr, iv, &iv_valid, &iv_ahead);
+    }
+
+    // Record the counter the sliding window follows before the stored one moves
+    if (status == CRYPTO_LIB_SUCCESS && sa_ptr->arsnw_bitmap == CRYPTO_TRUE)
+    {
+        if (crypto_anti_replay_tracks_arsn(sa_ptr) && arsn_valid == CRYPTO_TRUE)
+        {
+            Crypto_Replay_Update(sa_ptr, arsn, sa_ptr->arsn, sa_ptr->arsn_len, arsn_ahead);
+        }
+        else if (!crypto_anti_replay_tracks_arsn(sa_ptr) && iv_valid == CRYPTO_TRUE)
+        {
+            if (crypto_config.crypto_increment_nontransmitted_iv == SA_INCREMENT_NONTRANSMITTED_IV_TRUE)
+            {
+                Crypto_Replay_Update(sa_ptr, iv, sa_ptr->iv, sa_ptr->iv_len, iv_ahead);
+            }
+            else
+            {
+                Crypto_Replay_Update(sa_ptr, iv, sa_ptr->iv + (sa_ptr->iv_len - sa_ptr->shivf_len), sa_ptr->shivf_len,
+                                     iv_ahead);
+            }
+        }
     }
 
     // For GCM specifically, if have a valid IV...
@@ -1014,18 +1180,25 @@ int32_t Crypto_Check_Anti_Replay(SecurityAssociation_t* sa_ptr, uint8_t* arsn, u
         // Using ARSN? Need to be valid to increment both
         if (sa_ptr->arsn_len > 0 && arsn_valid == CRYPTO_TRUE)
         {
-            memcpy(sa_ptr->iv, iv, sa_ptr->iv_len);
-            memcpy(sa_ptr->arsn, arsn, sa_ptr->arsn_len);
+            if (iv_ahead == CRYPTO_TRUE)
+            {
+                memcpy(sa_ptr->iv, iv, sa_ptr->iv_len);
+            }
+            if (arsn_ahead == CRYPTO_TRUE)
+            {
+                memcpy(sa_ptr->arsn, arsn, sa_ptr->arsn_len);
+            }
         }
         // Not using ARSN? IV Valid and good to go
-        if (sa_ptr->arsn_len == 0)
+        if (sa_ptr->arsn_len == 0 && iv_ahead == CRYPTO_TRUE)
         {
             memcpy(sa_ptr->iv, iv, sa_ptr->iv_len);
         }
     }
 
     // If not GCM, and ARSN is valid - can incrmeent it
-    if ((sa_ptr->ecs != CRYPTO_CIPHER_AES256_GCM && sa_ptr->ecs != CRYPTO_CIPHER_AES256_GCM_SIV) && arsn_valid == CRYPTO_TRUE)
+    if ((sa_ptr->ecs != CRYPTO_CIPHER_AES256_GCM && sa_ptr->ecs != CRYPTO_CIPHER_AES256_GCM_SIV) && arsn_valid == CRYPTO_TRUE &&
+        arsn_ahead == CRYPTO_TRUE)
     {
         memcpy(sa_ptr->arsn, arsn, sa_ptr->arsn_len);
     }
@@ -1036,6 +1209,7 @@ int32_t Crypto_Check_Anti_Replay(SecurityAssociation_t* sa_ptr, uint8_t* arsn, u
         mc_if->mc_log(status);
     }
 
+    CRYPTO_PROBE(anti_replay_return, (sa_ptr != NULL) ? (int32_t)sa_ptr->spi : -1, status);
     return status;
 }
 
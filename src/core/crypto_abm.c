@@ -0,0 +1,250 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ABM_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+/*
+** Static Globals
+** An ABM is in practice runs of 0xFF (authenticate the byte) and 0x00 (skip it), with the odd mixed
+** byte around bit-packed header fields.  The engines below walk the mask a block at a time and turn it
+** into runs on the fly: an all-ones run is a memcpy of the frame, an all-zeros run a memset, and only
+** mixed blocks are actually ANDed.  The mask is read on every frame rather than compiled once per SA,
+** since SAs may be edited in place through the pointer handed out by the SADB.
+*/
+typedef void (*abm_engine_t)(const uint8_t* buffer, uint16_t len_aad, const uint8_t* abm, uint8_t* aad);
+
+static uint8_t abm_initialized = CRYPTO_FALSE;
+static uint8_t abm_engine_id = ABM_ENGINE_BYTEWISE;
+static abm_engine_t abm_engine = NULL;
+#ifdef ABM_HAVE_AVX2
+static uint8_t abm_avx2_supported = CRYPTO_FALSE;
+#endif
+
+/*
+** ABM Engines
+*/
+/**
+ * @brief Function: Crypto_Apply_ABM_Bytewise
+ * Reference implementation, one AND per byte.  All other engines must match it.
+ * @param buffer: const uint8_t*
+ * @param len_aad: uint16_t
+ * @param abm: const uint8_t*
+ * @param aad: uint8_t*
+ **/
+void Crypto_Apply_ABM_Bytewise(const uint8_t* buffer, uint16_t len_aad, const uint8_t* abm, uint8_t* aad)
+{
+    int i;
+
+    for (i = 0; i < len_aad; i++)
+    {
+        aad[i] = buffer[i] & abm[i];
+    }
+}
+
+/**
+ * @brief Function: crypto_abm_runs
+ * Portable engine, classifies the mask 8 bytes at a time
+ **/
+static void crypto_abm_runs(const uint8_t* buffer, uint16_t len_aad, const uint8_t* abm, uint8_t* aad)
+{
+    uint32_t i = 0;
+    uint32_t run;
+    uint64_t mask;
+    uint64_t data;
+
+    while (i + 8 <= len_aad)
+    {
+        memcpy(&mask, &abm[i], 8);
+        if (mask == UINT64_MAX || mask == 0)
+        {
+            // Extend the run over every following block with the same mask
+            run = i + 8;
+            while (run + 8 <= len_aad && memcmp(&abm[run], &mask, 8) == 0)
+            {
+                run += 8;
+            }
+            if (mask == 0)
+            {
+                memset(&aad[i], 0, run - i);
+            }
+            else
+            {
+                memcpy(&aad[i], &buffer[i], run - i);
+            }
+            i = run;
+        }
+        else
+        {
+            memcpy(&data, &buffer[i], 8);
+            data &= mask;
+            memcpy(&aad[i], &data, 8);
+            i += 8;
+        }
+    }
+    Crypto_Apply_ABM_Bytewise(&buffer[i], (uint16_t)(len_aad - i), &abm[i], &aad[i]);
+}
+
+#ifdef ABM_HAVE_AVX2
+/**
+ * @brief Function: crypto_abm_avx2
+ * AVX2 engine, classifies the mask 32 bytes at a time and masks mixed blocks in one AND
+ **/
+__attribute__((target("avx2"))) static void crypto_abm_avx2(const uint8_t* buffer, uint16_t len_aad,
+                                                             const uint8_t* abm, uint8_t* aad)
+{
+    const __m256i ones = _mm256_set1_epi8((char)0xFF);
+    uint32_t i = 0;
+    uint32_t run;
+    __m256i mask;
+
+    while (i + 32 <= len_aad)
+    {
+        mask = _mm256_loadu_si256((const __m256i*)&abm[i]);
+        if (_mm256_testc_si256(mask, ones))
+        {
+            run = i + 32;
+            while (run + 32 <= len_aad && _mm256_testc_si256(_mm256_loadu_si256((const __m256i*)&abm[run]), ones))
+            {
+                run += 32;
+            }
+            memcpy(&aad[i], &buffer[i], run - i);
+            i = run;
+        }
+        else if (_mm256_testz_si256(mask, mask))
+        {
+            run = i + 32;
+            while (run + 32 <= len_aad)
+            {
+                mask = _mm256_loadu_si256((const __m256i*)&abm[run]);
+                if (!_mm256_testz_si256(mask, mask))
+                {
+                    break;
+                }
+                run += 32;
+            }
+            memset(&aad[i], 0, run - i);
+            i = run;
+        }
+        else
+        {
+            _mm256_storeu_si256((__m256i*)&aad[i],
+                                _mm256_and_si256(mask, _mm256_loadu_si256((const __m256i*)&buffer[i])));
+            i += 32;
+        }
+    }
+    crypto_abm_runs(&buffer[i], (uint16_t)(len_aad - i), &abm[i], &aad[i]);
+}
+#endif
+
+/**
+ * @brief Function: Crypto_Apply_ABM_Init
+ * Picks the fastest ABM engine supported by the running CPU
+ **/
+void Crypto_Apply_ABM_Init(void)
+{
+    if (abm_initialized == CRYPTO_TRUE)
+    {
+        return;
+    }
+
+    abm_engine_id = ABM_ENGINE_RUNS;
+    abm_engine = crypto_abm_runs;
+
+#ifdef ABM_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        abm_avx2_supported = CRYPTO_TRUE;
+        abm_engine_id = ABM_ENGINE_AVX2;
+        abm_engine = crypto_abm_avx2;
+    }
+#endif
+
+    abm_initialized = CRYPTO_TRUE;
+#ifdef MAC_DEBUG
+    printf(KCYN "Crypto_Apply_ABM_Init: engine %d selected\n" RESET, abm_engine_id);
+#endif
+}
+
+/**
+ * @brief Function: Crypto_Apply_ABM_Set_Engine
+ * Overrides the engine picked at init, e.g. to benchmark or cross-check the engines.
+ * @param engine: uint8_t, ABM_ENGINE_*
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_Apply_ABM_Set_Engine(uint8_t engine)
+{
+    Crypto_Apply_ABM_Init();
+    switch (engine)
+    {
+    case ABM_ENGINE_BYTEWISE:
+        abm_engine = Crypto_Apply_ABM_Bytewise;
+        break;
+    case ABM_ENGINE_RUNS:
+        abm_engine = crypto_abm_runs;
+        break;
+#ifdef ABM_HAVE_AVX2
+    case ABM_ENGINE_AVX2:
+        if (abm_avx2_supported != CRYPTO_TRUE)
+        {
+            return CRYPTO_LIB_ERROR;
+        }
+        abm_engine = crypto_abm_avx2;
+        break;
+#endif
+    default:
+        return CRYPTO_LIB_ERROR;
+    }
+    abm_engine_id = engine;
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: Crypto_Apply_ABM_Get_Engine
+ * @return uint8: ABM_ENGINE_* currently in use
+ **/
+uint8_t Crypto_Apply_ABM_Get_Engine(void)
+{
+    Crypto_Apply_ABM_Init();
+    return abm_engine_id;
+}
+
+/**
+ * @brief Function: Crypto_Apply_ABM
+ * Builds the AAD as buffer bitwise ANDed with the authentication bit mask. buffer and aad must not overlap.
+ * @param buffer: const uint8_t*
+ * @param len_aad: uint16_t
+ * @param abm: const uint8_t*
+ * @param aad: uint8_t*
+ **/
+void Crypto_Apply_ABM(const uint8_t* buffer, uint16_t len_aad, const uint8_t* abm, uint8_t* aad)
+{
+    if (abm_initialized != CRYPTO_TRUE)
+    {
+        Crypto_Apply_ABM_Init();
+    }
+    abm_engine(buffer, len_aad, abm, aad);
+}
@@ -23,6 +23,13 @@
 
 #include <string.h> // memcpy/memset
 
+/*
+** Static Functions
+*/
+static int32_t crypto_aos_apply_security(uint8_t* pTfBuffer);
+static int32_t crypto_aos_process_security(uint8_t* p_ingest, uint16_t len_ingest, uint8_t* p_out, uint16_t* p_pdu_offset,
+                                           uint16_t* p_pdu_len, uint8_t** pp_processed_frame, uint16_t* p_decrypted_length);
+
 /**
  * @brief Function: Crypto_AOS_ApplySecurity
  * @param ingest: uint8_t*
@@ -42,6 +49,21 @@
  * Security Header
    **/
 int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
+{
+    int32_t status;
+
+    CRYPTO_PROBE(aos_apply_entry, pTfBuffer, 0);
+    status = crypto_aos_apply_security(pTfBuffer);
+    Crypto_Metrics_Frame(TYPE_AOS, CRYPTO_TRUE, pTfBuffer, 0, status);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: crypto_aos_apply_security
+ * Body of Crypto_AOS_ApplySecurity, runs with the frame's SA lock held once the SA is known
+ **/
+static int32_t crypto_aos_apply_security(uint8_t* pTfBuffer)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
     int mac_loc = 0;
@@ -93,7 +115,9 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
     printf("\n");
 #endif
 
+    CRYPTO_STAGE_START(CRYPTO_STAGE_SA_LOOKUP);
     status = sa_if->sa_get_operational_sa_from_gvcid(tfvn, scid, vcid, 0, &sa_ptr);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_SA_LOOKUP);
 
     // No operational/valid SA found
     if (status != CRYPTO_LIB_SUCCESS)
@@ -104,8 +128,14 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
         mc_if->mc_log(status);
         return status;
     }
+    status = Crypto_SA_Lock_GVCID(sa_ptr, tfvn, scid, vcid, 0);
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        mc_if->mc_log(status);
+        return status;
+    }
 
-    status = Crypto_Get_Managed_Parameters_For_Gvcid(tfvn, scid, vcid, gvcid_managed_parameters_array, &current_managed_parameters_struct);
+    status = Crypto_Get_Managed_Parameters_Ptr(tfvn, scid, vcid, &current_managed_parameters);
 
     // No managed parameters found
     if (status != CRYPTO_LIB_SUCCESS)
@@ -119,7 +149,7 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
 
 #ifdef AOS_DEBUG
     printf(KYEL "AOS BEFORE Apply Sec:\n\t" RESET);
-    for (int16_t i =0; i < current_managed_parameters_struct.max_frame_size; i++)
+    for (int16_t i =0; i < current_managed_parameters->max_frame_size; i++)
     {
         printf("%02X", pTfBuffer[i]);
     }
@@ -186,15 +216,15 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
     idx = 6;
 
     // Detect if optional 2 byte FHEC is present
-    if(current_managed_parameters_struct.aos_has_fhec == AOS_HAS_FHEC)
+    if(current_managed_parameters->aos_has_fhec == AOS_HAS_FHEC)
     {
         idx += 2;
     }
 
     // Detect if optional variable length Insert Zone is present
-    if(current_managed_parameters_struct.aos_has_iz == AOS_HAS_IZ)
+    if(current_managed_parameters->aos_has_iz == AOS_HAS_IZ)
     {
-        idx += current_managed_parameters_struct.aos_iz_len;
+        idx += current_managed_parameters->aos_iz_len;
     }
 
     // Idx is now at SPI location
@@ -270,8 +300,8 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
      **/
     for (i = sa_ptr->arsn_len - sa_ptr->shsnf_len; i < sa_ptr->arsn_len; i++)
     {
-        // Copy in ARSN from SA
-        pTfBuffer[idx] = *(sa_ptr->arsn + i);
+        // Copy in ARSN from SA, zero filling an SN field wider than the ARSN
+        pTfBuffer[idx] = (i >= 0) ? *(sa_ptr->arsn + i) : 0;
         idx++;
     }
 
@@ -328,13 +358,13 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
      **/
     data_loc = idx;
     // Calculate size of data to be encrypted
-    pdu_len = current_managed_parameters_struct.max_frame_size - idx - sa_ptr->stmacf_len;
+    pdu_len = current_managed_parameters->max_frame_size - idx - sa_ptr->stmacf_len;
     // Check other managed parameter flags, subtract their lengths from data field if present
-    if(current_managed_parameters_struct.has_ocf == AOS_HAS_OCF)
+    if(current_managed_parameters->has_ocf == AOS_HAS_OCF)
     {
         pdu_len -= 4;
     }
-    if(current_managed_parameters_struct.has_fecf == AOS_HAS_FECF)
+    if(current_managed_parameters->has_fecf == AOS_HAS_FECF)
     {
         pdu_len -= 2;
     }
@@ -343,21 +373,23 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
     printf(KYEL "Data location starts at: %d\n" RESET, idx);
     printf(KYEL "Data size is: %d\n" RESET, pdu_len);
     printf(KYEL "Index at end of SPI is: %d\n", idx);
-    if(current_managed_parameters_struct.has_ocf == AOS_HAS_OCF)
+    if(current_managed_parameters->has_ocf == AOS_HAS_OCF)
     {
         // If OCF exists, comes immediately after MAC
         printf(KYEL "OCF Location is: %d" RESET, idx + pdu_len + sa_ptr->stmacf_len);
     }
-    if(current_managed_parameters_struct.has_fecf == AOS_HAS_FECF)
+    if(current_managed_parameters->has_fecf == AOS_HAS_FECF)
     {
         // If FECF exists, comes just before end of the frame
-        printf(KYEL "FECF Location is: %d\n" RESET, current_managed_parameters_struct.max_frame_size - 2);
+        printf(KYEL "FECF Location is: %d\n" RESET, current_managed_parameters->max_frame_size - 2);
     }
 #endif
 
     // Get Key
     crypto_key_t* ekp = NULL;
+    CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
     ekp = key_if->get_key(sa_ptr->ekid);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
     if (ekp == NULL)
     {
         status = CRYPTO_LIB_ERR_KEY_ID_ERROR;
@@ -366,7 +398,9 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
     }
 
     crypto_key_t* akp = NULL;
+    CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
     akp = key_if->get_key(sa_ptr->akid);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
     if (akp == NULL)
     {
         status = CRYPTO_LIB_ERR_KEY_ID_ERROR;
@@ -415,6 +449,7 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
     {
         if(sa_service_type == SA_ENCRYPTION)
         {
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_encrypt(//Stub out data in/out as this is done in place and want to save cycles
                                                         (uint8_t*)(&pTfBuffer[data_loc]), // ciphertext output
                                                         (size_t) pdu_len, // length of data
@@ -428,9 +463,11 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
                                                         &sa_ptr->ecs, // encryption cipher
                                                         pkcs_padding,  // authentication cipher
                                                         NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         } 
         if(sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
         {
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_aead_encrypt((uint8_t*)(&pTfBuffer[data_loc]), // ciphertext output
                                                                 (size_t) pdu_len,  // length of data
                                                                 (uint8_t*)(&pTfBuffer[data_loc]), // plaintext input
@@ -450,6 +487,7 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
                                                                 &sa_ptr->ecs, // encryption cipher
                                                                 &sa_ptr->acs,  // authentication cipher
                                                                 NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         }
     }
 
@@ -458,6 +496,7 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
             // TODO - implement non-AEAD algorithm logic
             if(sa_service_type == SA_AUTHENTICATION)
             {
+                CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
                 status = cryptography_if->cryptography_authenticate(//Stub out data in/out as this is done in place and want to save cycles
                                                                     (uint8_t*)(&pTfBuffer[0]), // ciphertext output
                                                                     (size_t) 0, // length of data
@@ -475,11 +514,13 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
                                                                     sa_ptr->ecs, // encryption cipher
                                                                     sa_ptr->acs,  // authentication cipher
                                                                     NULL);
+                CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
             }
             else if(sa_service_type == SA_ENCRYPTION || sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
             {
                 if (sa_service_type == SA_ENCRYPTION)
                     {
+                        CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
                         status = cryptography_if->cryptography_encrypt(//Stub out data in/out as this is done in place and want to save cycles
                                                                     (uint8_t*)(&pTfBuffer[data_loc]), // ciphertext output
                                                                     (size_t) pdu_len, // length of data
@@ -493,6 +534,7 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
                                                                     &sa_ptr->ecs, // encryption cipher
                                                                     pkcs_padding,  // authentication cipher
                                                                     NULL);
+                        CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
                 }
             }
             else if(sa_service_type == SA_PLAINTEXT)
@@ -590,35 +632,35 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
      **/
 
     // Only calculate & insert FECF if CryptoLib is configured to do so & gvcid includes FECF.
-    if (current_managed_parameters_struct.has_fecf == AOS_HAS_FECF)
+    if (current_managed_parameters->has_fecf == AOS_HAS_FECF)
     {
 #ifdef FECF_DEBUG
-        printf(KCYN "Calcing FECF over %d bytes\n" RESET, current_managed_parameters_struct.max_frame_size - 2);
+        printf(KCYN "Calcing FECF over %d bytes\n" RESET, current_managed_parameters->max_frame_size - 2);
 #endif
         if (crypto_config.crypto_create_fecf == CRYPTO_AOS_CREATE_FECF_TRUE)
         {
-            new_fecf = Crypto_Calc_FECF((uint8_t*)pTfBuffer, current_managed_parameters_struct.max_frame_size - 2);
-            pTfBuffer[current_managed_parameters_struct.max_frame_size - 2] = (uint8_t)((new_fecf & 0xFF00) >> 8);
-            pTfBuffer[current_managed_parameters_struct.max_frame_size - 1] = (uint8_t)(new_fecf & 0x00FF);
+            new_fecf = Crypto_Calc_FECF((uint8_t*)pTfBuffer, current_managed_parameters->max_frame_size - 2);
+            pTfBuffer[current_managed_parameters->max_frame_size - 2] = (uint8_t)((new_fecf & 0xFF00) >> 8);
+            pTfBuffer[current_managed_parameters->max_frame_size - 1] = (uint8_t)(new_fecf & 0x00FF);
         }
         else // CRYPTO_TC_CREATE_FECF_FALSE
         {
-            pTfBuffer[current_managed_parameters_struct.max_frame_size - 2] = (uint8_t)0x00;
-            pTfBuffer[current_managed_parameters_struct.max_frame_size - 1] = (uint8_t)0x00;
+            pTfBuffer[current_managed_parameters->max_frame_size - 2] = (uint8_t)0x00;
+            pTfBuffer[current_managed_parameters->max_frame_size - 1] = (uint8_t)0x00;
         }
         idx += 2;
     }
 
 #ifdef AOS_DEBUG
     printf(KYEL "Printing new AOS frame:\n\t");
-    for(int i = 0; i < current_managed_parameters_struct.max_frame_size; i++)
+    for(int i = 0; i < current_managed_parameters->max_frame_size; i++)
     {
         printf("%02X", pTfBuffer[i]);
     }
     printf("\n");
 #endif
 
-    status = sa_if->sa_save_sa(sa_ptr);
+    status = Crypto_SA_Save(sa_ptr);
 
 #ifdef DEBUG
     printf(KYEL "----- Crypto_AOS_ApplySecurity END -----\n" RESET);
@@ -878,6 +920,68 @@ int32_t Crypto_AOS_ApplySecurity(uint8_t* pTfBuffer)
  * @return int32: Success/Failure
    **/
 int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_t** pp_processed_frame, uint16_t* p_decrypted_length)
+{
+    int32_t status;
+
+    CRYPTO_PROBE(aos_process_entry, p_ingest, len_ingest);
+    status = crypto_aos_process_security(p_ingest, len_ingest, NULL, NULL, NULL, pp_processed_frame, p_decrypted_length);
+    Crypto_Metrics_Frame(TYPE_AOS, CRYPTO_FALSE, p_ingest, len_ingest, status);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: Crypto_AOS_ProcessSecurity_Into
+ * Crypto_AOS_ProcessSecurity without the per-frame allocation. The processed frame is written to p_out,
+ * which may be p_ingest itself to process in place (p_ingest is then overwritten even on failure).
+ * Output layout matches Crypto_AOS_ProcessSecurity: headers copied, security fields and trailer zeroed.
+ * @param p_ingest: uint8_t*
+ * @param len_ingest: uint16_t
+ * @param p_out: uint8_t*, at least len_ingest bytes
+ * @param len_out: uint16_t
+ * @param p_pdu_offset: uint16_t*, optional, offset of the processed data field in p_out
+ * @param p_pdu_len: uint16_t*, optional, length of the processed data field
+ * @param p_decrypted_length: uint16_t*
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_AOS_ProcessSecurity_Into(uint8_t* p_ingest, uint16_t len_ingest, uint8_t* p_out, uint16_t len_out,
+                                        uint16_t* p_pdu_offset, uint16_t* p_pdu_len, uint16_t* p_decrypted_length)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    uint8_t* p_processed_frame = NULL;
+
+    if (p_ingest == NULL || p_out == NULL || p_decrypted_length == NULL)
+    {
+        status = CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+    else if (len_out < len_ingest)
+    {
+        status = CRYPTO_LIB_ERR_OUTPUT_BUFFER_TOO_SMALL;
+    }
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        if (mc_if != NULL)
+        {
+            mc_if->mc_log(status);
+        }
+        return status;
+    }
+
+    CRYPTO_PROBE(aos_process_entry, p_ingest, len_ingest);
+    status = crypto_aos_process_security(p_ingest, len_ingest, p_out, p_pdu_offset, p_pdu_len, &p_processed_frame,
+                                         p_decrypted_length);
+    Crypto_Metrics_Frame(TYPE_AOS, CRYPTO_FALSE, p_ingest, len_ingest, status);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: crypto_aos_process_security
+ * Body of Crypto_AOS_ProcessSecurity, runs with the frame's SA lock held once the SA is known.
+ * Allocates the output frame unless p_out is given.
+ **/
+static int32_t crypto_aos_process_security(uint8_t* p_ingest, uint16_t len_ingest, uint8_t* p_out, uint16_t* p_pdu_offset,
+                                           uint16_t* p_pdu_len, uint8_t** pp_processed_frame, uint16_t* p_decrypted_length)
 {
     // Local Variables
     int32_t status = CRYPTO_LIB_SUCCESS;
@@ -889,8 +993,11 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
     uint8_t iv_loc;
     int mac_loc = 0;
     uint16_t pdu_len = 1;
+    uint16_t pdu_offset = 0;
+    uint16_t iz_len = 0;
     uint8_t* p_new_dec_frame = NULL;
     SecurityAssociation_t* sa_ptr = NULL;
+    uint8_t sa_state = SA_NONE;
     uint8_t sa_service_type = -1;
     uint8_t spi = -1;
 
@@ -938,9 +1045,9 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
 #endif
 
     // Lookup-retrieve managed parameters for frame via gvcid:
-    status = Crypto_Get_Managed_Parameters_For_Gvcid(
+    status = Crypto_Get_Managed_Parameters_Ptr(
         aos_frame_pri_hdr.tfvn, aos_frame_pri_hdr.scid, aos_frame_pri_hdr.vcid, 
-        gvcid_managed_parameters_array, &current_managed_parameters_struct);
+        &current_managed_parameters);
 
     if (status != CRYPTO_LIB_SUCCESS)
     {
@@ -953,15 +1060,15 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
 
     // Increment to end of Primary Header start, depends on FHECF presence
     byte_idx = 6;
-    if (current_managed_parameters_struct.aos_has_fhec == AOS_HAS_FHEC)
+    if (current_managed_parameters->aos_has_fhec == AOS_HAS_FHEC)
     {
         byte_idx = 8;
     }
 
     // Determine if Insert Zone exists, increment past it if so
-    if (current_managed_parameters_struct.aos_has_iz)
+    if (current_managed_parameters->aos_has_iz)
     {
-        byte_idx += current_managed_parameters_struct.aos_iz_len;
+        byte_idx += current_managed_parameters->aos_iz_len;
     }
 
     /**
@@ -973,13 +1080,23 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
     // Move index to past the SPI
     byte_idx += 2;
 
+    CRYPTO_STAGE_START(CRYPTO_STAGE_SA_LOOKUP);
     status = sa_if->sa_get_from_spi(spi, &sa_ptr);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_SA_LOOKUP);
     // If no valid SPI, return
     if (status != CRYPTO_LIB_SUCCESS)
     {
         mc_if->mc_log(status);
         return status;
     }
+    // Checked again under the lock, SA management may have changed the SA since the lookup
+    sa_state = sa_ptr->sa_state;
+    status = Crypto_SA_Lock_State(sa_ptr, sa_state);
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        mc_if->mc_log(status);
+        return status;
+    }
 
 #ifdef SA_DEBUG
         printf(KYEL "DEBUG - Printing SA Entry for current frame.\n" RESET);
@@ -1056,10 +1173,10 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
 #endif
 
     // Parse & Check FECF, if present, and update fecf length
-    if (current_managed_parameters_struct.has_fecf == AOS_HAS_FECF)
+    if (current_managed_parameters->has_fecf == AOS_HAS_FECF)
     {
-        uint16_t received_fecf = (((p_ingest[current_managed_parameters_struct.max_frame_size - 2] << 8) & 0xFF00) |
-                                                        (p_ingest[current_managed_parameters_struct.max_frame_size - 1] & 0x00FF));
+        uint16_t received_fecf = (((p_ingest[current_managed_parameters->max_frame_size - 2] << 8) & 0xFF00) |
+                                                        (p_ingest[current_managed_parameters->max_frame_size - 1] & 0x00FF));
 
         if (crypto_config.crypto_check_fecf == AOS_CHECK_FECF_TRUE)
         {
@@ -1089,38 +1206,52 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
         }
     }
     // Needs to be AOS_HAS_FECF (checked above, or AOS_NO_FECF)
-    else if (current_managed_parameters_struct.has_fecf != AOS_NO_FECF)
+    else if (current_managed_parameters->has_fecf != AOS_NO_FECF)
     {
 #ifdef AOS_DEBUG
         printf(KRED "AOS_Process Error...tfvn: %d scid: 0x%04X vcid: 0x%02X fecf_enum: %d\n" RESET, 
-            current_managed_parameters_struct.tfvn, current_managed_parameters_struct.scid, 
-            current_managed_parameters_struct.vcid, current_managed_parameters_struct.has_fecf);
+            current_managed_parameters->tfvn, current_managed_parameters->scid, 
+            current_managed_parameters->vcid, current_managed_parameters->has_fecf);
 #endif
         status = CRYPTO_LIB_ERR_TC_ENUM_USED_FOR_AOS_CONFIG;
         mc_if->mc_log(status);
         return status;
     }
 
-    // Accio buffer
-    p_new_dec_frame = (uint8_t*)calloc(1, (len_ingest) * sizeof(uint8_t));
-    if (!p_new_dec_frame)
+    if (p_out != NULL)
     {
-        printf(KRED "Error: Calloc for decrypted output buffer failed! \n" RESET);
-        status = CRYPTO_LIB_ERROR;
-        mc_if->mc_log(status);
-        return status;
+        p_new_dec_frame = p_out;
+    }
+    else
+    {
+        // Accio buffer
+        p_new_dec_frame = (uint8_t*)calloc(1, (len_ingest) * sizeof(uint8_t));
+        if (!p_new_dec_frame)
+        {
+            printf(KRED "Error: Calloc for decrypted output buffer failed! \n" RESET);
+            status = CRYPTO_LIB_ERROR;
+            mc_if->mc_log(status);
+            return status;
+        }
     }
 
     // Copy over AOS Primary Header (6 bytes)
-    memcpy(p_new_dec_frame, &p_ingest[0], 6);
+    if (p_new_dec_frame != p_ingest)
+    {
+        memcpy(p_new_dec_frame, &p_ingest[0], 6);
+    }
 
     // Copy over insert zone data, if it exists
-    if (current_managed_parameters_struct.aos_has_iz == AOS_HAS_IZ)
+    if (current_managed_parameters->aos_has_iz == AOS_HAS_IZ)
     {
-        memcpy(p_new_dec_frame+6, &p_ingest[6], current_managed_parameters_struct.aos_iz_len);
+        iz_len = current_managed_parameters->aos_iz_len;
+        if (p_new_dec_frame != p_ingest)
+        {
+            memcpy(p_new_dec_frame+6, &p_ingest[6], current_managed_parameters->aos_iz_len);
+        }
 #ifdef AOS_DEBUG
         printf("Copied over the following:\n\t");
-        for (int i=0; i < current_managed_parameters_struct.aos_iz_len;i++)
+        for (int i=0; i < current_managed_parameters->aos_iz_len;i++)
         {
             printf("%02X",p_ingest[6+i]);
         }
@@ -1153,12 +1284,12 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
 
     // Calculate size of the protocol data unit
     // NOTE: This size itself is not the length for authentication 
-    pdu_len = current_managed_parameters_struct.max_frame_size - (byte_idx) - sa_ptr->stmacf_len;
-    if(current_managed_parameters_struct.has_ocf == AOS_HAS_OCF)
+    pdu_len = current_managed_parameters->max_frame_size - (byte_idx) - sa_ptr->stmacf_len;
+    if(current_managed_parameters->has_ocf == AOS_HAS_OCF)
     {
         pdu_len -= 4;
     }
-    if(current_managed_parameters_struct.has_fecf == AOS_HAS_FECF)
+    if(current_managed_parameters->has_fecf == AOS_HAS_FECF)
     {
         pdu_len -= 2;
     }
@@ -1168,25 +1299,28 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
     {
         mac_loc = byte_idx + pdu_len;
     }
+    pdu_offset = byte_idx;
 
 #ifdef AOS_DEBUG
     printf(KYEL "Index / data location starts at: %d\n" RESET, byte_idx);
     printf(KYEL "Data size is: %d\n" RESET, pdu_len);
-    if(current_managed_parameters_struct.has_ocf == AOS_HAS_OCF)
+    if(current_managed_parameters->has_ocf == AOS_HAS_OCF)
     {
         // If OCF exists, comes immediately after MAC
         printf(KYEL "OCF Location is: %d" RESET, byte_idx + pdu_len + sa_ptr->stmacf_len);
     }
-    if(current_managed_parameters_struct.has_fecf == AOS_HAS_FECF)
+    if(current_managed_parameters->has_fecf == AOS_HAS_FECF)
     {
         // If FECF exists, comes just before end of the frame
-        printf(KYEL "FECF Location is: %d\n" RESET, current_managed_parameters_struct.max_frame_size - 2);
+        printf(KYEL "FECF Location is: %d\n" RESET, current_managed_parameters->max_frame_size - 2);
     }
 #endif
 
     // Get Key
     crypto_key_t* ekp = NULL;
+    CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
     ekp = key_if->get_key(sa_ptr->ekid);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
     if (ekp == NULL)
     {
         status = CRYPTO_LIB_ERR_KEY_ID_ERROR;
@@ -1195,7 +1329,9 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
     }
 
     crypto_key_t* akp = NULL;
+    CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
     akp = key_if->get_key(sa_ptr->akid);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
     if (akp == NULL)
     {
         status = CRYPTO_LIB_ERR_KEY_ID_ERROR;
@@ -1254,6 +1390,7 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
 
         if(sa_service_type == SA_ENCRYPTION)
         {
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_decrypt(p_new_dec_frame+byte_idx, // plaintext output
                                                         pdu_len,   // length of data
                                                         p_ingest+byte_idx, // ciphertext input
@@ -1266,9 +1403,11 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
                                                         &sa_ptr->ecs, // encryption cipher
                                                         &sa_ptr->acs,  // authentication cipher
                                                         NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         }
         if(sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
         {
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_aead_decrypt(p_new_dec_frame+byte_idx, // plaintext output
                                                                 pdu_len, // length of data
                                                                 p_ingest+byte_idx, // ciphertext input
@@ -1288,6 +1427,7 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
                                                                 &sa_ptr->ecs, // encryption cipher
                                                                 &sa_ptr->acs,  // authentication cipher
                                                                 NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         }
 
     }
@@ -1297,6 +1437,7 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
         // TODO - implement non-AEAD algorithm logic
         if(sa_service_type == SA_AUTHENTICATION || sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
         {
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_validate_authentication(p_new_dec_frame+byte_idx, // plaintext output
                                                 pdu_len, // length of data
                                                 p_ingest+byte_idx, // ciphertext input
@@ -1313,6 +1454,7 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
                                                 CRYPTO_CIPHER_NONE, // encryption cipher
                                                 sa_ptr->acs, // authentication cipher
                                                 NULL); // cam cookies
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
 
         }
         if(sa_service_type == SA_ENCRYPTION || sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
@@ -1326,6 +1468,7 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
                 return status;
             }
 
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_decrypt(p_new_dec_frame+byte_idx, // plaintext output
                                                         pdu_len,   // length of data
                                                         p_ingest+byte_idx, // ciphertext input
@@ -1338,6 +1481,7 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
                                                         &sa_ptr->ecs, // encryption cipher
                                                         &sa_ptr->acs,  // authentication cipher
                                                         NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
 
         // //Handle Padding Removal
         // if(sa_ptr->shplf_len != 0)
@@ -1356,18 +1500,39 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
    // If plaintext, copy byte by byte
     else if(sa_service_type == SA_PLAINTEXT)
     {
-        memcpy(p_new_dec_frame+byte_idx, &(p_ingest[byte_idx]), pdu_len);
+        if (p_new_dec_frame != p_ingest)
+        {
+            memcpy(p_new_dec_frame+byte_idx, &(p_ingest[byte_idx]), pdu_len);
+        }
         byte_idx += pdu_len;
     }
 
+    if (p_out != NULL)
+    {
+        // A caller buffer is not pre-zeroed; clear what calloc would have left empty
+        memset(p_out + 6 + iz_len, 0, pdu_offset - (6 + iz_len));
+        if (len_ingest > pdu_offset + pdu_len)
+        {
+            memset(p_out + pdu_offset + pdu_len, 0, len_ingest - (pdu_offset + pdu_len));
+        }
+        if (p_pdu_offset != NULL)
+        {
+            *p_pdu_offset = pdu_offset;
+        }
+        if (p_pdu_len != NULL)
+        {
+            *p_pdu_len = pdu_len;
+        }
+    }
+
 #ifdef AOS_DEBUG
     printf(KYEL "\nPrinting received frame:\n\t" RESET);
-    for( int i=0; i<current_managed_parameters_struct.max_frame_size; i++)
+    for( int i=0; i<current_managed_parameters->max_frame_size; i++)
     {
         printf(KYEL "%02X", p_ingest[i]);
     }
     printf(KYEL "\nPrinting PROCESSED frame:\n\t" RESET);
-        for( int i=0; i<current_managed_parameters_struct.max_frame_size; i++)
+        for( int i=0; i<current_managed_parameters->max_frame_size; i++)
     {
         printf(KYEL "%02X", p_new_dec_frame[i]);
     }
@@ -1376,7 +1541,7 @@ int32_t Crypto_AOS_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8
 
     *pp_processed_frame = p_new_dec_frame;
     // TODO maybe not just return this without doing the math ourselves
-    *p_decrypted_length = current_managed_parameters_struct.max_frame_size;
+    *p_decrypted_length = current_managed_parameters->max_frame_size;
 
 #ifdef DEBUG
         printf(KYEL "----- Crypto_AOS_ProcessSecurity END -----\n" RESET);
@@ -1593,7 +1758,7 @@ void Crypto_AOS_updateOCF(void)
 
 /**
  * @brief Function: Crypto_Prepare_AOS_AAD
- * Bitwise ANDs buffer with abm, placing results in aad buffer
+ * Bitwise ANDs buffer with abm, placing results in aad buffer, see Crypto_Apply_ABM
  * @param buffer: uint8_t*
  * @param len_aad: uint16_t
  * @param abm_buffer: uint8_t*
@@ -1603,12 +1768,11 @@ void Crypto_AOS_updateOCF(void)
 uint32_t Crypto_Prepare_AOS_AAD(const uint8_t* buffer, uint16_t len_aad, const uint8_t* abm_buffer, uint8_t* aad)
 {
     uint32_t status = CRYPTO_LIB_SUCCESS;
+#ifdef MAC_DEBUG
     int i;
+#endif
 
-    for (i = 0; i < len_aad; i++)
-    {
-        aad[i] = buffer[i] & abm_buffer[i];
-    }
+    Crypto_Apply_ABM(buffer, len_aad, abm_buffer, aad);
 
 #ifdef MAC_DEBUG
     printf(KYEL "AAD before ABM Bitmask:\n\t");
@@ -0,0 +1,64 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+/*
+** Static Globals
+** Per-frame scratch (AAD, counter copies) is carved from a fixed, per-thread arena rather than the heap.
+** The arena is rewound at the start of every frame, so nothing taken from it may outlive the frame.
+*/
+static CRYPTO_THREAD_LOCAL uint8_t crypto_arena[CRYPTO_ARENA_SIZE] __attribute__((aligned(8)));
+static CRYPTO_THREAD_LOCAL uint32_t crypto_arena_used = 0;
+
+/**
+ * @brief Function: Crypto_Arena_Reset
+ * Releases everything taken from the calling thread's arena
+ **/
+void Crypto_Arena_Reset(void)
+{
+    crypto_arena_used = 0;
+}
+
+/**
+ * @brief Function: Crypto_Arena_Alloc
+ * Takes len zeroed bytes from the calling thread's arena, valid until the next Crypto_Arena_Reset
+ * @param len: uint32_t
+ * @return uint8_t*: Scratch buffer, NULL if the arena is exhausted
+ **/
+uint8_t* Crypto_Arena_Alloc(uint32_t len)
+{
+    uint8_t* ptr;
+    uint32_t aligned_len = (len + 7) & ~7u;
+
+    if (aligned_len > CRYPTO_ARENA_SIZE - crypto_arena_used)
+    {
+#ifdef DEBUG
+        printf(KRED "Error: Crypto arena exhausted, %d of %d bytes used, %d requested\n" RESET, crypto_arena_used,
+               CRYPTO_ARENA_SIZE, len);
+#endif
+        return NULL;
+    }
+    ptr = &crypto_arena[crypto_arena_used];
+    crypto_arena_used += aligned_len;
+    memset(ptr, 0, len);
+    return ptr;
+}
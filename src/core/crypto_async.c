@@ -0,0 +1,372 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+/*
+** Asynchronous ApplySecurity
+** The async entry points run the normal ApplySecurity path, so the security header is built and the SA
+** counters advance at submission, but the AEAD call is handed to the cryptography interface's asynchronous
+** variant when it has one.  A remote backend can then keep many frames in flight instead of paying a round
+** trip per frame.  Whatever depends on the ciphertext (the FECF) is finished once the frame's calls have
+** completed, and the frame is handed back through its callback from Crypto_Async_Poll.
+**
+** Frames of one GVCID, and so of one SA, are handed back in submission order; other channels may overtake.
+** Backends without an asynchronous variant complete the call during submission.
+** Submission and polling must happen on a single thread.
+*/
+typedef struct
+{
+    uint8_t in_use;
+    uint32_t seq;      // Submission order
+    uint32_t channel;  // Frame type and GVCID
+    uint16_t pending;  // Asynchronous calls not yet completed
+    int32_t status;
+    uint8_t* p_frame;
+    uint16_t frame_len;
+    uint8_t fecf_deferred;
+    uint16_t fecf_loc;
+    Crypto_Async_Callback_t callback;
+    void* ctx;
+} crypto_async_frame_t;
+
+/*
+** Static Globals
+*/
+static crypto_async_frame_t crypto_async_frames[CRYPTO_ASYNC_MAX_FRAMES];
+static uint16_t crypto_async_order[CRYPTO_ASYNC_MAX_FRAMES]; // Queued frames, oldest first
+static uint32_t crypto_async_queued = 0;
+static uint32_t crypto_async_seq = 0;
+// Frame being submitted by the calling thread, read by the crypto call sites
+static CRYPTO_THREAD_LOCAL crypto_async_frame_t* crypto_async_current = NULL;
+
+/*
+** Static Functions
+*/
+static crypto_async_frame_t* crypto_async_frame_get(uint32_t channel, uint8_t* p_frame,
+                                                    Crypto_Async_Callback_t callback, void* ctx);
+static void crypto_async_op_done(void* op_ctx, int32_t status);
+static uint8_t crypto_async_blocked(uint32_t position);
+
+/**
+ * @brief Function: crypto_async_frame_get
+ * Queues a frame slot behind every frame already submitted
+ * @return crypto_async_frame_t*: NULL when CRYPTO_ASYNC_MAX_FRAMES frames are queued
+ **/
+static crypto_async_frame_t* crypto_async_frame_get(uint32_t channel, uint8_t* p_frame,
+                                                    Crypto_Async_Callback_t callback, void* ctx)
+{
+    crypto_async_frame_t* frame = NULL;
+    uint16_t i;
+
+    if (crypto_async_queued == CRYPTO_ASYNC_MAX_FRAMES)
+    {
+        return NULL;
+    }
+    for (i = 0; i < CRYPTO_ASYNC_MAX_FRAMES; i++)
+    {
+        if (crypto_async_frames[i].in_use == CRYPTO_FALSE)
+        {
+            frame = &crypto_async_frames[i];
+            break;
+        }
+    }
+
+    memset(frame, 0, sizeof(crypto_async_frame_t));
+    frame->in_use = CRYPTO_TRUE;
+    frame->seq = crypto_async_seq++;
+    frame->channel = channel;
+    frame->status = CRYPTO_LIB_SUCCESS;
+    frame->p_frame = p_frame;
+    frame->callback = callback;
+    frame->ctx = ctx;
+    crypto_async_order[crypto_async_queued++] = i;
+    return frame;
+}
+
+/**
+ * @brief Function: crypto_async_op_done
+ * cryptography_async_done_t for every call made on behalf of a frame
+ * @param op_ctx: void*, crypto_async_frame_t*
+ * @param status: int32_t
+ **/
+static void crypto_async_op_done(void* op_ctx, int32_t status)
+{
+    crypto_async_frame_t* frame = (crypto_async_frame_t*)op_ctx;
+
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        if (frame->status == CRYPTO_LIB_SUCCESS)
+        {
+            frame->status = status;
+        }
+        mc_if->mc_log(status);
+    }
+    frame->pending--;
+}
+
+/**
+ * @brief Function: crypto_async_blocked
+ * A frame waits for every older frame of its channel
+ * @param position: uint32_t, index into crypto_async_order
+ * @return uint8_t: CRYPTO_TRUE if an older frame of the same channel is still queued
+ **/
+static uint8_t crypto_async_blocked(uint32_t position)
+{
+    uint32_t channel = crypto_async_frames[crypto_async_order[position]].channel;
+    uint32_t i;
+
+    for (i = 0; i < position; i++)
+    {
+        if (crypto_async_frames[crypto_async_order[i]].channel == channel)
+        {
+            return CRYPTO_TRUE;
+        }
+    }
+    return CRYPTO_FALSE;
+}
+
+/**
+ * @brief Function: Crypto_Async_AEAD_Encrypt
+ * cryptography_aead_encrypt for the apply paths, asynchronous when called on behalf of an async frame
+ * and the backend supports it.  Arguments as cryptography_aead_encrypt.
+ * @return int32: Success/Failure of the call, or of its submission
+ **/
+int32_t Crypto_Async_AEAD_Encrypt(uint8_t* data_out, size_t len_data_out, uint8_t* data_in, size_t len_data_in,
+                                  uint8_t* key, uint32_t len_key, SecurityAssociation_t* sa_ptr, uint8_t* iv,
+                                  uint32_t iv_len, uint8_t* mac, uint32_t mac_size, uint8_t* aad, uint32_t aad_len,
+                                  uint8_t encrypt_bool, uint8_t authenticate_bool, uint8_t aad_bool, uint8_t* ecs,
+                                  uint8_t* acs, char* cam_cookies)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+
+    if (crypto_async_current == NULL || cryptography_if->cryptography_aead_encrypt_async == NULL)
+    {
+        return cryptography_if->cryptography_aead_encrypt(data_out, len_data_out, data_in, len_data_in, key, len_key,
+                                                          sa_ptr, iv, iv_len, mac, mac_size, aad, aad_len,
+                                                          encrypt_bool, authenticate_bool, aad_bool, ecs, acs,
+                                                          cam_cookies);
+    }
+
+    crypto_async_current->pending++;
+    status = cryptography_if->cryptography_aead_encrypt_async(
+        data_out, len_data_out, data_in, len_data_in, key, len_key, sa_ptr, iv, iv_len, mac, mac_size, aad, aad_len,
+        encrypt_bool, authenticate_bool, aad_bool, ecs, acs, cam_cookies, crypto_async_op_done, crypto_async_current);
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        // Never submitted, done will not be called
+        crypto_async_current->pending--;
+    }
+    return status;
+}
+
+/**
+ * @brief Function: Crypto_Async_Defer_FECF
+ * Called by the apply paths in place of computing the FECF.  While the frame's ciphertext is still in flight,
+ * the FECF over p_frame[0, fecf_loc) is computed and stored at fecf_loc once it lands.
+ * @param fecf_loc: uint16_t
+ * @return uint8_t: CRYPTO_TRUE if deferred, CRYPTO_FALSE if the caller must compute it now
+ **/
+uint8_t Crypto_Async_Defer_FECF(uint16_t fecf_loc)
+{
+    if (crypto_async_current == NULL || crypto_async_current->pending == 0)
+    {
+        return CRYPTO_FALSE;
+    }
+    crypto_async_current->fecf_deferred = CRYPTO_TRUE;
+    crypto_async_current->fecf_loc = fecf_loc;
+    return CRYPTO_TRUE;
+}
+
+/**
+ * @brief Function: Crypto_TC_ApplySecurity_Async
+ * Crypto_TC_ApplySecurity_Into, handed back through callback from Crypto_Async_Poll.
+ * p_in_frame may be reused on return, p_out must stay valid until the callback.
+ * @param p_in_frame: const uint8_t*
+ * @param in_frame_length: uint16_t
+ * @param p_out: uint8_t*
+ * @param len_out: uint16_t
+ * @param callback: Crypto_Async_Callback_t
+ * @param ctx: void*, passed to callback
+ * @return int32: Success if queued, every queued frame gets exactly one callback
+ **/
+int32_t Crypto_TC_ApplySecurity_Async(const uint8_t* p_in_frame, const uint16_t in_frame_length, uint8_t* p_out,
+                                      uint16_t len_out, Crypto_Async_Callback_t callback, void* ctx)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    crypto_async_frame_t* frame;
+    uint32_t channel;
+
+    if (p_in_frame == NULL || p_out == NULL || callback == NULL)
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+    if (in_frame_length < TC_FRAME_HEADER_SIZE)
+    {
+        return CRYPTO_LIB_ERR_INPUT_FRAME_TOO_SHORT_FOR_TC_STANDARD;
+    }
+
+    // TFVN, SCID and VCID straight from the primary header
+    channel = ((uint32_t)TYPE_TC << 24) | ((uint32_t)(p_in_frame[0] & 0xC3) << 16) |
+              ((uint32_t)p_in_frame[1] << 8) | (p_in_frame[2] & 0xFC);
+    frame = crypto_async_frame_get(channel, p_out, callback, ctx);
+    if (frame == NULL)
+    {
+        return CRYPTO_LIB_ERR_ASYNC_FULL;
+    }
+
+    crypto_async_current = frame;
+    status = Crypto_TC_ApplySecurity_Into(p_in_frame, in_frame_length, p_out, len_out, &frame->frame_len);
+    crypto_async_current = NULL;
+    if (frame->status == CRYPTO_LIB_SUCCESS)
+    {
+        frame->status = status;
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: Crypto_TM_ApplySecurity_Async
+ * Crypto_TM_ApplySecurity, handed back through callback from Crypto_Async_Poll.
+ * pTfBuffer is protected in place and must stay valid until the callback.
+ * @param pTfBuffer: uint8_t*
+ * @param callback: Crypto_Async_Callback_t
+ * @param ctx: void*, passed to callback
+ * @return int32: Success if queued, every queued frame gets exactly one callback
+ **/
+int32_t Crypto_TM_ApplySecurity_Async(uint8_t* pTfBuffer, Crypto_Async_Callback_t callback, void* ctx)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    crypto_async_frame_t* frame;
+    uint32_t channel;
+
+    if (pTfBuffer == NULL || callback == NULL)
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+
+    channel = ((uint32_t)TYPE_TM << 24) | ((uint32_t)pTfBuffer[0] << 8) | (pTfBuffer[1] & 0xFE);
+    frame = crypto_async_frame_get(channel, pTfBuffer, callback, ctx);
+    if (frame == NULL)
+    {
+        return CRYPTO_LIB_ERR_ASYNC_FULL;
+    }
+
+    crypto_async_current = frame;
+    status = Crypto_TM_ApplySecurity(pTfBuffer);
+    crypto_async_current = NULL;
+    if (status == CRYPTO_LIB_SUCCESS)
+    {
+        frame->frame_len = current_managed_parameters->max_frame_size;
+    }
+    if (frame->status == CRYPTO_LIB_SUCCESS)
+    {
+        frame->status = status;
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: Crypto_Async_Poll
+ * Completes in-flight calls, waiting up to timeout_ms when no frame is ready, and hands back every
+ * frame whose calls have completed and that is not behind an older frame of its channel.
+ * Callbacks may submit new frames; those are handed back by a later poll.
+ * @param timeout_ms: int32_t
+ * @param delivered: uint32_t*, number of callbacks made
+ * @return int32: Success/Failure of the backend poll
+ **/
+int32_t Crypto_Async_Poll(int32_t timeout_ms, uint32_t* delivered)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    crypto_async_frame_t* frame;
+    crypto_async_frame_t done;
+    uint32_t seq_limit = crypto_async_seq;
+    uint32_t i;
+    uint16_t fecf;
+
+    if (delivered == NULL)
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+    *delivered = 0;
+    if (crypto_async_queued == 0)
+    {
+        return status;
+    }
+
+    if (cryptography_if != NULL && cryptography_if->cryptography_async_poll != NULL)
+    {
+        // Don't wait on the backend if the oldest frame is already complete
+        frame = &crypto_async_frames[crypto_async_order[0]];
+        status = cryptography_if->cryptography_async_poll(frame->pending == 0 ? 0 : timeout_ms);
+        if (status > 0)
+        {
+            status = CRYPTO_LIB_SUCCESS;
+        }
+    }
+
+    i = 0;
+    while (i < crypto_async_queued)
+    {
+        frame = &crypto_async_frames[crypto_async_order[i]];
+        if (frame->pending != 0 || (int32_t)(frame->seq - seq_limit) >= 0 || crypto_async_blocked(i) == CRYPTO_TRUE)
+        {
+            i++;
+            continue;
+        }
+
+        if (frame->status == CRYPTO_LIB_SUCCESS && frame->fecf_deferred == CRYPTO_TRUE)
+        {
+            fecf = Crypto_Calc_FECF(frame->p_frame, frame->fecf_loc);
+            frame->p_frame[frame->fecf_loc] = (uint8_t)((fecf & 0xFF00) >> 8);
+            frame->p_frame[frame->fecf_loc + 1] = (uint8_t)(fecf & 0x00FF);
+        }
+
+        // Release the slot before the callback, which may submit
+        done = *frame;
+        frame->in_use = CRYPTO_FALSE;
+        crypto_async_queued--;
+        memmove(&crypto_async_order[i], &crypto_async_order[i + 1], (crypto_async_queued - i) * sizeof(uint16_t));
+        (*delivered)++;
+        done.callback(done.ctx, done.status, done.p_frame, done.status == CRYPTO_LIB_SUCCESS ? done.frame_len : 0);
+    }
+    return status;
+}
+
+/**
+ * @brief Function: Crypto_Async_Pending
+ * @return uint32_t: Frames submitted and not yet handed back
+ **/
+uint32_t Crypto_Async_Pending(void)
+{
+    return crypto_async_queued;
+}
+
+/**
+ * @brief Function: Crypto_Async_Reset
+ * Drops every queued frame without calling its callback, used at shutdown once the backend has been told to stop
+ **/
+void Crypto_Async_Reset(void)
+{
+    memset(crypto_async_frames, 0, sizeof(crypto_async_frames));
+    crypto_async_queued = 0;
+    crypto_async_current = NULL;
+}
@@ -40,13 +40,18 @@ CamConfig_t* cam_config = NULL;
 GvcidManagedParameters_t gvcid_managed_parameters_array[GVCID_MAN_PARAM_SIZE];  
 int gvcid_counter = 0;
 GvcidManagedParameters_t gvcid_null_struct = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-GvcidManagedParameters_t current_managed_parameters_struct = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+CRYPTO_THREAD_LOCAL GvcidManagedParameters_t current_managed_parameters_struct = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
 GvcidManagedParameters_t* gvcid_managed_parameters = NULL;
-GvcidManagedParameters_t* current_managed_parameters = NULL;
+CRYPTO_THREAD_LOCAL const GvcidManagedParameters_t* current_managed_parameters = &gvcid_null_struct;
+
+// Managed parameter index, (tfvn, scid, vcid) -> gvcid_managed_parameters_array entry + 1, 0 = empty
+// Open addressing with linear probing; the first entry added for a GVCID wins, as with the linear scan.
+static uint16_t gvcid_index[GVCID_INDEX_SIZE];
 
 // Free all configuration structs
 int32_t crypto_free_config_structs(void);
+static void crypto_managed_parameters_index_insert(int entry);
 
 /*
 ** Initialization Functions
@@ -331,6 +336,12 @@ int32_t Crypto_Init(void)
 
         // Init table for CRC calculations
         Crypto_Calc_CRC_Init_Table();
+        Crypto_Calc_FECF_Init();
+        Crypto_Apply_ABM_Init();
+        Crypto_Arena_Reset();
+
+        // Index managed parameters for per-frame lookup
+        Crypto_Managed_Parameters_Index_Build();
 
         // cFS Standard Initialized Message
 #ifdef DEBUG
@@ -358,7 +369,7 @@ int32_t Crypto_Shutdown(void)
 
     crypto_free_config_structs();
 
-    current_managed_parameters = NULL;
+    current_managed_parameters = &gvcid_null_struct;
     current_managed_parameters_struct = gvcid_null_struct;
     for(int i = 0; i < gvcid_counter; i++)
     {
@@ -366,6 +377,7 @@ int32_t Crypto_Shutdown(void)
     }
     
     gvcid_counter = 0;
+    memset(gvcid_index, 0, sizeof(gvcid_index));
 
     // if (gvcid_managed_parameters != NULL)
     // {
@@ -394,6 +406,8 @@ int32_t Crypto_Shutdown(void)
         cryptography_if->cryptography_shutdown();
         cryptography_if = NULL;
     }
+    // Calls still in flight died with the cryptography interface
+    Crypto_Async_Reset();
 
     return status;
 }
@@ -504,6 +518,21 @@ int32_t Crypto_Config_Kmc_Crypto_Service(char* protocol, char* kmc_crypto_hostna
     return status;
 }
 
+/**
+ * @brief Function: Crypto_Config_SA_Lease
+ * Enables IV/ARSN leases: instead of every new counter, SA backends persist a bound lease_frames ahead
+ * of it and only write again once the counter reaches it. After a crash the SA resumes from the bound,
+ * so no IV is reused (and an ARSN may skip ahead) at the cost of up to lease_frames unused counters.
+ * @param lease_frames: uint32_t, 0 to persist every frame
+ * @return int32_t: Success/Failure
+**/
+int32_t Crypto_Config_SA_Lease(uint32_t lease_frames)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    crypto_config.sa_lease_frames = lease_frames;
+    return status;
+}
+
 /**
  * @brief Function: Crypto_Config_Cam
  * @param cam_enabled: uint8_t
@@ -539,12 +568,96 @@ int32_t Crypto_Config_Add_Gvcid_Managed_Parameters(GvcidManagedParameters_t gvci
     else
     {
         gvcid_managed_parameters_array[gvcid_counter] = gvcid_managed_parameters_struct;
+        crypto_managed_parameters_index_insert(gvcid_counter);
         gvcid_counter++;    
     }
     
     return status; 
 }
 
+/**
+ * @brief Function: crypto_managed_parameters_hash
+ * @return uint16: home slot in gvcid_index
+ **/
+static uint16_t crypto_managed_parameters_hash(uint8_t tfvn, uint16_t scid, uint8_t vcid)
+{
+    uint32_t key = ((uint32_t)tfvn << 24) | ((uint32_t)scid << 8) | vcid;
+    key *= 0x9E3779B1U;
+    return (uint16_t)((key >> 16) & (GVCID_INDEX_SIZE - 1));
+}
+
+/**
+ * @brief Function: crypto_managed_parameters_index_insert
+ * Indexes gvcid_managed_parameters_array[entry] unless its GVCID is already present.
+ * @param entry: int
+ **/
+static void crypto_managed_parameters_index_insert(int entry)
+{
+    const GvcidManagedParameters_t* mp = &gvcid_managed_parameters_array[entry];
+    uint16_t slot = crypto_managed_parameters_hash(mp->tfvn, mp->scid, mp->vcid);
+    int probes;
+
+    for (probes = 0; probes < GVCID_INDEX_SIZE; probes++)
+    {
+        if (gvcid_index[slot] == 0)
+        {
+            gvcid_index[slot] = (uint16_t)(entry + 1);
+            return;
+        }
+        if (gvcid_managed_parameters_array[gvcid_index[slot] - 1].tfvn == mp->tfvn &&
+            gvcid_managed_parameters_array[gvcid_index[slot] - 1].scid == mp->scid &&
+            gvcid_managed_parameters_array[gvcid_index[slot] - 1].vcid == mp->vcid)
+        {
+            return;
+        }
+        slot = (slot + 1) & (GVCID_INDEX_SIZE - 1);
+    }
+}
+
+/**
+ * @brief Function: Crypto_Managed_Parameters_Index_Build
+ * (Re)builds the GVCID lookup over all configured managed parameters.
+ **/
+void Crypto_Managed_Parameters_Index_Build(void)
+{
+    int i;
+
+    memset(gvcid_index, 0, sizeof(gvcid_index));
+    for (i = 0; i < gvcid_counter && i < GVCID_MAN_PARAM_SIZE; i++)
+    {
+        crypto_managed_parameters_index_insert(i);
+    }
+}
+
+/**
+ * @brief Function: Crypto_Get_Managed_Parameters_Ptr
+ * Per-frame managed parameter lookup, no copy and no output on a miss.
+ * @param tfvn: uint8
+ * @param scid: uint16
+ * @param vcid: uint8
+ * @param managed_parameters_out: const GvcidManagedParameters_t**, left untouched on a miss
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_Get_Managed_Parameters_Ptr(uint8_t tfvn, uint16_t scid, uint8_t vcid,
+                                          const GvcidManagedParameters_t** managed_parameters_out)
+{
+    uint16_t slot = crypto_managed_parameters_hash(tfvn, scid, vcid);
+    const GvcidManagedParameters_t* mp;
+    int probes;
+
+    for (probes = 0; probes < GVCID_INDEX_SIZE && gvcid_index[slot] != 0; probes++)
+    {
+        mp = &gvcid_managed_parameters_array[gvcid_index[slot] - 1];
+        if (mp->tfvn == tfvn && mp->scid == scid && mp->vcid == vcid)
+        {
+            *managed_parameters_out = mp;
+            return CRYPTO_LIB_SUCCESS;
+        }
+        slot = (slot + 1) & (GVCID_INDEX_SIZE - 1);
+    }
+    return MANAGED_PARAMETERS_FOR_GVCID_NOT_FOUND;
+}
+
 /**
  * @brief Function: Crypto_Config_Add_Gvcid_Managed_Parameter
  * @param tfvn: uint8
@@ -713,24 +826,10 @@ void Crypto_Local_Config(void)
     // Initial TM configuration
     // tm_frame.tm_sec_header.spi = 1;
 
-    // Initialize Log
-    log_summary.num_se = 2;
-    log_summary.rs = LOG_SIZE;
-    // Add a two messages to the log
-    log_summary.rs--;
-    mc_log.blk[log_count].emt = STARTUP;
-    mc_log.blk[log_count].emv[0] = 0x4E;
-    mc_log.blk[log_count].emv[1] = 0x41;
-    mc_log.blk[log_count].emv[2] = 0x53;
-    mc_log.blk[log_count].emv[3] = 0x41;
-    mc_log.blk[log_count++].em_len = 4;
-    log_summary.rs--;
-    mc_log.blk[log_count].emt = STARTUP;
-    mc_log.blk[log_count].emv[0] = 0x4E;
-    mc_log.blk[log_count].emv[1] = 0x41;
-    mc_log.blk[log_count].emv[2] = 0x53;
-    mc_log.blk[log_count].emv[3] = 0x41;
-    mc_log.blk[log_count++].em_len = 4;
+    // Initialize Log, with two startup messages
+    Crypto_Event_Log_Reset();
+    Crypto_Event_Log(STARTUP, EMV_DEFAULT);
+    Crypto_Event_Log(STARTUP, EMV_DEFAULT);
 
 }
 
@@ -78,6 +78,11 @@ char *crypto_enum_errlist_core[] =
         (char*) "CRYPTO_LIB_ERR_EXCEEDS_MANAGED_PARAMETER_MAX_LIMIT",
         (char*) "CRYPTO_LIB_ERR_KEY_VALIDATION",
         (char*) "CRYPTO_LIB_ERR_SPI_INDEX_OOB", 
+        (char*) "CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL",
+        (char*) "CRYPTO_LIB_ERR_TM_POOL_FULL",
+        (char*) "CRYPTO_LIB_ERR_TM_POOL_NOT_RUNNING",
+        (char*) "CRYPTO_LIB_ERR_OUTPUT_BUFFER_TOO_SMALL",
+        (char*) "CRYPTO_LIB_ERR_ASYNC_FULL",
 };
 
 char *crypto_enum_errlist_config[] =
@@ -201,7 +206,7 @@ char* Crypto_Get_Error_Code_Enum_String(int32_t crypto_error_code)
     }
     else if(crypto_error_code <= 0) // Cryptolib Core Error Codes
     {
-        return_string = Crypto_Get_Crypto_Error_Code_String(crypto_error_code, -51, crypto_enum_errlist_core[(crypto_error_code * (-1))]);
+        return_string = Crypto_Get_Crypto_Error_Code_String(crypto_error_code, -61, crypto_enum_errlist_core[(crypto_error_code * (-1))]);
     }
     return return_string;
 }
\ No newline at end of file
@@ -0,0 +1,355 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FECF_HAVE_PCLMUL
+#include <immintrin.h>
+#endif
+
+/*
+** Static Globals
+*/
+// FECF is CRC-16/CCITT-FALSE: polynomial 0x1021, MSB first, initial value 0xFFFF, no final XOR
+#define FECF_POLY 0x1021
+#define FECF_INIT 0xFFFF
+
+typedef uint16_t (*fecf_engine_t)(const uint8_t* ingest, int len_ingest);
+
+static uint16_t fecf_table[8][256];
+static uint8_t fecf_initialized = CRYPTO_FALSE;
+static uint8_t fecf_engine_id = FECF_ENGINE_BITWISE;
+static fecf_engine_t fecf_engine = NULL;
+#ifdef FECF_HAVE_PCLMUL
+static uint8_t fecf_pclmul_supported = CRYPTO_FALSE;
+static uint16_t fecf_fold_128;   // x^128 mod P
+static uint16_t fecf_fold_192;   // x^192 mod P
+static uint16_t fecf_fold_512;   // x^512 mod P
+static uint16_t fecf_fold_576;   // x^576 mod P
+#endif
+
+/*
+** FECF Engines
+*/
+/**
+ * @brief Function: Crypto_Calc_FECF_Bitwise
+ * Reference implementation, one polynomial step per bit.  All other engines must match it.
+ * @param ingest: const uint8_t*
+ * @param len_ingest: int
+ * @return uint16: FECF
+ **/
+uint16_t Crypto_Calc_FECF_Bitwise(const uint8_t* ingest, int len_ingest)
+{
+    uint16_t fecf = FECF_INIT;
+    uint16_t poly = FECF_POLY;
+    uint8_t bit;
+    uint8_t c15;
+    int i;
+    int j;
+
+    for (i = 0; i < len_ingest; i++)
+    { // Byte Logic
+        for (j = 0; j < 8; j++)
+        { // Bit Logic
+            bit = ((ingest[i] >> (7 - j) & 1) == 1);
+            c15 = ((fecf >> 15 & 1) == 1);
+            fecf <<= 1;
+            if (c15 ^ bit)
+            {
+                fecf ^= poly;
+            }
+        }
+    }
+    return fecf;
+}
+
+/**
+ * @brief Function: crypto_fecf_table_update
+ * Byte-at-a-time table update, continues from fecf.
+ **/
+static uint16_t crypto_fecf_table_update(uint16_t fecf, const uint8_t* ingest, int len_ingest)
+{
+    int i;
+    for (i = 0; i < len_ingest; i++)
+    {
+        fecf = (uint16_t)((fecf << 8) ^ fecf_table[0][(uint8_t)((fecf >> 8) ^ ingest[i])]);
+    }
+    return fecf;
+}
+
+static uint16_t crypto_fecf_table(const uint8_t* ingest, int len_ingest)
+{
+    return crypto_fecf_table_update(FECF_INIT, ingest, len_ingest);
+}
+
+/**
+ * @brief Function: crypto_fecf_slice8
+ * Slicing-by-8: table k holds the contribution of a byte followed by k zero bytes,
+ * so eight input bytes fold into the FECF with eight independent lookups.
+ **/
+static uint16_t crypto_fecf_slice8(const uint8_t* ingest, int len_ingest)
+{
+    uint16_t fecf = FECF_INIT;
+    const uint8_t* p = ingest;
+
+    while (len_ingest >= 8)
+    {
+        fecf = fecf_table[7][(uint8_t)(p[0] ^ (fecf >> 8))] ^ fecf_table[6][(uint8_t)(p[1] ^ fecf)] ^
+               fecf_table[5][p[2]] ^ fecf_table[4][p[3]] ^ fecf_table[3][p[4]] ^ fecf_table[2][p[5]] ^
+               fecf_table[1][p[6]] ^ fecf_table[0][p[7]];
+        p += 8;
+        len_ingest -= 8;
+    }
+    return crypto_fecf_table_update(fecf, p, len_ingest);
+}
+
+#ifdef FECF_HAVE_PCLMUL
+/**
+ * @brief Function: crypto_fecf_pclmul
+ * Carry-less multiply folding.  Each 128-bit block is reduced by multiplying its halves with
+ * x^192 mod P and x^128 mod P; since P has degree 16 the products stay inside 128 bits and remain
+ * congruent to the data folded so far.  Four lanes run 64 bytes apart to hide multiply latency.
+ * The final 16-byte remainder and any tail bytes go through the table engine with a zero seed,
+ * the initial value having been XORed into the first two data bytes.
+ **/
+__attribute__((target("pclmul,ssse3"))) static __m128i crypto_fecf_pclmul_fold(__m128i acc, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(acc, k, 0x11), _mm_clmulepi64_si128(acc, k, 0x00));
+}
+
+__attribute__((target("pclmul,ssse3"))) static uint16_t crypto_fecf_pclmul(const uint8_t* ingest, int len_ingest)
+{
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k128 = _mm_set_epi64x(fecf_fold_192, fecf_fold_128);
+    const __m128i k512 = _mm_set_epi64x(fecf_fold_576, fecf_fold_512);
+    const __m128i seed = _mm_set_epi64x((long long)((uint64_t)FECF_INIT << 48), 0);
+    const uint8_t* p = ingest;
+    uint8_t rem[16];
+    __m128i acc;
+
+    if (len_ingest < 16)
+    {
+        return crypto_fecf_table(ingest, len_ingest);
+    }
+
+    if (len_ingest >= 64)
+    {
+        __m128i a0 = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 0)), bswap), seed);
+        __m128i a1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 16)), bswap);
+        __m128i a2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 32)), bswap);
+        __m128i a3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 48)), bswap);
+        p += 64;
+        len_ingest -= 64;
+        while (len_ingest >= 64)
+        {
+            a0 = _mm_xor_si128(crypto_fecf_pclmul_fold(a0, k512),
+                               _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 0)), bswap));
+            a1 = _mm_xor_si128(crypto_fecf_pclmul_fold(a1, k512),
+                               _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 16)), bswap));
+            a2 = _mm_xor_si128(crypto_fecf_pclmul_fold(a2, k512),
+                               _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 32)), bswap));
+            a3 = _mm_xor_si128(crypto_fecf_pclmul_fold(a3, k512),
+                               _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 48)), bswap));
+            p += 64;
+            len_ingest -= 64;
+        }
+        acc = _mm_xor_si128(crypto_fecf_pclmul_fold(a0, k128), a1);
+        acc = _mm_xor_si128(crypto_fecf_pclmul_fold(acc, k128), a2);
+        acc = _mm_xor_si128(crypto_fecf_pclmul_fold(acc, k128), a3);
+    }
+    else
+    {
+        acc = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p), bswap), seed);
+        p += 16;
+        len_ingest -= 16;
+    }
+
+    while (len_ingest >= 16)
+    {
+        acc = _mm_xor_si128(crypto_fecf_pclmul_fold(acc, k128),
+                            _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p), bswap));
+        p += 16;
+        len_ingest -= 16;
+    }
+
+    _mm_storeu_si128((__m128i*)rem, _mm_shuffle_epi8(acc, bswap));
+    return crypto_fecf_table_update(crypto_fecf_table_update(0, rem, 16), p, len_ingest);
+}
+
+/**
+ * @brief Function: crypto_fecf_xpow_mod
+ * Returns x^n mod P, used for the PCLMUL folding constants.
+ **/
+static uint16_t crypto_fecf_xpow_mod(int n)
+{
+    uint32_t r = 1;
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        r <<= 1;
+        if (r & 0x10000)
+        {
+            r ^= 0x10000 | FECF_POLY;
+        }
+    }
+    return (uint16_t)r;
+}
+#endif
+
+/**
+ * @brief Function: Crypto_Calc_FECF_Init
+ * Builds the FECF lookup tables and selects the fastest engine this CPU supports.
+ * Called from Crypto_Init, and on first use if Crypto_Calc_FECF runs before it.
+ **/
+void Crypto_Calc_FECF_Init(void)
+{
+    uint16_t crc;
+    int i;
+    int j;
+    int k;
+
+    if (fecf_initialized == CRYPTO_TRUE)
+    {
+        return;
+    }
+
+    for (i = 0; i < 256; i++)
+    {
+        crc = (uint16_t)(i << 8);
+        for (j = 0; j < 8; j++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ FECF_POLY) : (uint16_t)(crc << 1);
+        }
+        fecf_table[0][i] = crc;
+    }
+    for (k = 1; k < 8; k++)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            crc = fecf_table[k - 1][i];
+            fecf_table[k][i] = (uint16_t)((crc << 8) ^ fecf_table[0][crc >> 8]);
+        }
+    }
+
+    fecf_engine_id = FECF_ENGINE_SLICE8;
+    fecf_engine = crypto_fecf_slice8;
+
+#ifdef FECF_HAVE_PCLMUL
+    fecf_fold_128 = crypto_fecf_xpow_mod(128);
+    fecf_fold_192 = crypto_fecf_xpow_mod(192);
+    fecf_fold_512 = crypto_fecf_xpow_mod(512);
+    fecf_fold_576 = crypto_fecf_xpow_mod(576);
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3"))
+    {
+        fecf_pclmul_supported = CRYPTO_TRUE;
+        fecf_engine_id = FECF_ENGINE_PCLMUL;
+        fecf_engine = crypto_fecf_pclmul;
+    }
+#endif
+
+    fecf_initialized = CRYPTO_TRUE;
+#ifdef FECF_DEBUG
+    printf(KCYN "Crypto_Calc_FECF_Init: engine %d selected\n" RESET, fecf_engine_id);
+#endif
+}
+
+/**
+ * @brief Function: Crypto_Calc_FECF_Set_Engine
+ * Overrides the engine picked at init, e.g. to benchmark or cross-check the engines.
+ * @param engine: uint8_t, FECF_ENGINE_*
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_Calc_FECF_Set_Engine(uint8_t engine)
+{
+    Crypto_Calc_FECF_Init();
+    switch (engine)
+    {
+    case FECF_ENGINE_BITWISE:
+        fecf_engine = Crypto_Calc_FECF_Bitwise;
+        break;
+    case FECF_ENGINE_TABLE:
+        fecf_engine = crypto_fecf_table;
+        break;
+    case FECF_ENGINE_SLICE8:
+        fecf_engine = crypto_fecf_slice8;
+        break;
+#ifdef FECF_HAVE_PCLMUL
+    case FECF_ENGINE_PCLMUL:
+        if (fecf_pclmul_supported != CRYPTO_TRUE)
+        {
+            return CRYPTO_LIB_ERROR;
+        }
+        fecf_engine = crypto_fecf_pclmul;
+        break;
+#endif
+    default:
+        return CRYPTO_LIB_ERROR;
+    }
+    fecf_engine_id = engine;
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: Crypto_Calc_FECF_Get_Engine
+ * @return uint8: FECF_ENGINE_* currently in use
+ **/
+uint8_t Crypto_Calc_FECF_Get_Engine(void)
+{
+    Crypto_Calc_FECF_Init();
+    return fecf_engine_id;
+}
+
+/**
+ * @brief Function Crypto_Calc_FECF
+ * Calculate the Frame Error Control Field (FECF), also known as a cyclic redundancy check (CRC)
+ * @param ingest: uint8_t*
+ * @param len_ingest: int
+ * @return uint16: FECF
+ **/
+uint16_t Crypto_Calc_FECF(const uint8_t* ingest, int len_ingest)
+{
+    uint16_t fecf;
+
+    if (fecf_initialized != CRYPTO_TRUE)
+    {
+        Crypto_Calc_FECF_Init();
+    }
+    CRYPTO_STAGE_START(CRYPTO_STAGE_FECF);
+    fecf = (len_ingest > 0) ? fecf_engine(ingest, len_ingest) : FECF_INIT;
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_FECF);
+
+#ifdef FECF_DEBUG
+    int x;
+    printf(KCYN "Crypto_Calc_FECF: 0x%02x%02x%02x%02x%02x, len_ingest = %d\n" RESET, ingest[0], ingest[1], ingest[2],
+           ingest[3], ingest[4], len_ingest);
+    printf(KCYN "0x" RESET);
+    for (x = 0; x < len_ingest; x++)
+    {
+        printf(KCYN "%02x" RESET, (uint8_t) * (ingest + x));
+    }
+    printf(KCYN "\n" RESET);
+    printf(KCYN "In Crypto_Calc_FECF! fecf = 0x%04x\n" RESET, fecf);
+#endif
+
+    return fecf;
+}
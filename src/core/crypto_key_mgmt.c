@@ -24,6 +24,20 @@
 /*
 ** Key Management Services
 */
+/**
+ * @brief Function: Crypto_Key_Invalidate_Cache
+ * Drops any keyed contexts the cryptography interface retained for key_id.
+ * Must follow every change to key material or key state.
+ * @param key_id: uint16_t
+ **/
+void Crypto_Key_Invalidate_Cache(uint16_t key_id)
+{
+    if ((cryptography_if != NULL) && (cryptography_if->cryptography_invalidate_key != NULL))
+    {
+        cryptography_if->cryptography_invalidate_key(key_id);
+    }
+}
+
 /**
  * @brief Function: Crypto_Key_OTAR
  * The OTAR Rekeying procedure shall have the following Service Parameters:
@@ -54,17 +68,7 @@ int32_t Crypto_Key_OTAR(void)
     if (packet.mkid >= 128)
     {
         report.af = 1;
-        if (log_summary.rs > 0)
-        {
-            Crypto_increment((uint8_t* )&log_summary.num_se, 4);
-            log_summary.rs--;
-            mc_log.blk[log_count].emt = MKID_INVALID_EID;
-            mc_log.blk[log_count].emv[0] = 0x4E;
-            mc_log.blk[log_count].emv[1] = 0x41;
-            mc_log.blk[log_count].emv[2] = 0x53;
-            mc_log.blk[log_count].emv[3] = 0x41;
-            mc_log.blk[log_count++].em_len = 4;
-        }
+        Crypto_Event_Log(MKID_INVALID_EID, EMV_DEFAULT);
         printf(KRED "Error: MKID is not valid! \n" RESET);
         status = CRYPTO_LIB_ERROR;
         return status;
@@ -118,17 +122,7 @@ int32_t Crypto_Key_OTAR(void)
         if (packet.EKB[x].ekid < 128)
         {
             report.af = 1;
-            if (log_summary.rs > 0)
-            {
-                Crypto_increment((uint8_t* )&log_summary.num_se, 4);
-                log_summary.rs--;
-                mc_log.blk[log_count].emt = OTAR_MK_ERR_EID;
-                mc_log.blk[log_count].emv[0] = 0x4E; // N
-                mc_log.blk[log_count].emv[1] = 0x41; // A
-                mc_log.blk[log_count].emv[2] = 0x53; // S
-                mc_log.blk[log_count].emv[3] = 0x41; // A
-                mc_log.blk[log_count++].em_len = 4;
-            }
+            Crypto_Event_Log(OTAR_MK_ERR_EID, EMV_DEFAULT);
             printf(KRED "Error: Cannot OTAR master key! \n" RESET);
             status = CRYPTO_LIB_ERROR;
             return status;
@@ -156,6 +150,7 @@ int32_t Crypto_Key_OTAR(void)
 
             // Set state to PREACTIVE
             ekp->key_state = KEY_PREACTIVE;
+            Crypto_Key_Invalidate_Cache(packet.EKB[x].ekid);
         }
     }
 
@@ -244,17 +239,7 @@ int32_t Crypto_Key_update(uint8_t state)
         if (packet.kblk[x].kid < 128)
         {
             report.af = 1;
-            if (log_summary.rs > 0)
-            {
-                Crypto_increment((uint8_t* )&log_summary.num_se, 4);
-                log_summary.rs--;
-                mc_log.blk[log_count].emt = MKID_STATE_ERR_EID;
-                mc_log.blk[log_count].emv[0] = 0x4E;
-                mc_log.blk[log_count].emv[1] = 0x41;
-                mc_log.blk[log_count].emv[2] = 0x53;
-                mc_log.blk[log_count].emv[3] = 0x41;
-                mc_log.blk[log_count++].em_len = 4;
-            }
+            Crypto_Event_Log(MKID_STATE_ERR_EID, EMV_DEFAULT);
             printf(KRED "Error: MKID state cannot be changed! \n" RESET);
             // TODO: Exit
         }
@@ -268,23 +253,14 @@ int32_t Crypto_Key_update(uint8_t state)
         if (ekp->key_state == (state - 1))
         {
             ekp->key_state = state;
+            Crypto_Key_Invalidate_Cache(packet.kblk[x].kid);
 #ifdef PDU_DEBUG
             // printf("Key ID %d state changed to ", packet.kblk[x].kid);
 #endif
         }
         else
         {
-            if (log_summary.rs > 0)
-            {
-                Crypto_increment((uint8_t* )&log_summary.num_se, 4);
-                log_summary.rs--;
-                mc_log.blk[log_count].emt = KEY_TRANSITION_ERR_EID;
-                mc_log.blk[log_count].emv[0] = 0x4E;
-                mc_log.blk[log_count].emv[1] = 0x41;
-                mc_log.blk[log_count].emv[2] = 0x53;
-                mc_log.blk[log_count].emv[3] = 0x41;
-                mc_log.blk[log_count++].em_len = 4;
-            }
+            Crypto_Event_Log(KEY_TRANSITION_ERR_EID, EMV_DEFAULT);
             printf(KRED "Error: Key %d cannot transition to desired state! \n" RESET, packet.kblk[x].kid);
         }
     }
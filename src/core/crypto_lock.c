@@ -0,0 +1,211 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/*
+** Includes
+*/
+#include "crypto.h"
+#include <pthread.h>
+
+/*
+** Static Globals
+** Frame scratch state (headers, managed parameters, SDLS frame) is thread local, see crypto.c.
+** What remains shared is guarded here:
+**  - SA IV/ARSN state, by a mutex striped on SPI. A frame holds its SA's stripe from lookup until
+**    the public entry point returns, so IV use and increment (or anti-replay check and update) are
+**    atomic per SA while different SAs proceed in parallel.
+**  - SA/key/log management driven by SDLS-EP PDUs, by a single management mutex. Management also takes
+**    every SA stripe, so frames in flight never see an SA or key change half way. The order is
+**    management mutex, then stripes in ascending order; a thread gives up its own stripe first.
+**    While a thread holds management, its SA locks are already taken and Crypto_SA_Lock is a no-op.
+*/
+static pthread_once_t crypto_lock_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t crypto_sa_locks[SA_LOCK_STRIPES];
+static pthread_mutex_t crypto_mgmt_lock;
+static CRYPTO_THREAD_LOCAL int32_t crypto_sa_held_stripe = -1;
+static CRYPTO_THREAD_LOCAL int32_t crypto_sa_held_spi = -1;
+static CRYPTO_THREAD_LOCAL int32_t crypto_mgmt_resume_spi = -1; // SA lock given up by Crypto_Mgmt_Lock
+static CRYPTO_THREAD_LOCAL uint8_t crypto_mgmt_held = CRYPTO_FALSE;
+static CRYPTO_THREAD_LOCAL uint32_t crypto_mgmt_epoch = 0; // Crypto_Mgmt_Lock calls by this thread
+
+static void crypto_lock_init(void)
+{
+    int i;
+    for (i = 0; i < SA_LOCK_STRIPES; i++)
+    {
+        pthread_mutex_init(&crypto_sa_locks[i], NULL);
+    }
+    pthread_mutex_init(&crypto_mgmt_lock, NULL);
+}
+
+/**
+ * @brief Function: Crypto_SA_Lock
+ * Takes the lock for sa_ptr on behalf of the calling thread, dropping any other SA lock it holds.
+ * Idempotent for the SA already held, and a no-op under Crypto_Mgmt_Lock.
+ * @param sa_ptr: SecurityAssociation_t*
+ **/
+void Crypto_SA_Lock(SecurityAssociation_t* sa_ptr)
+{
+    int32_t stripe;
+
+    if (sa_ptr == NULL || crypto_mgmt_held == CRYPTO_TRUE)
+    {
+        return;
+    }
+    pthread_once(&crypto_lock_once, crypto_lock_init);
+
+    stripe = sa_ptr->spi % SA_LOCK_STRIPES;
+    if (stripe == crypto_sa_held_stripe)
+    {
+        crypto_sa_held_spi = sa_ptr->spi;
+        return;
+    }
+    Crypto_SA_Unlock();
+    pthread_mutex_lock(&crypto_sa_locks[stripe]);
+    crypto_sa_held_stripe = stripe;
+    crypto_sa_held_spi = sa_ptr->spi;
+}
+
+/**
+ * @brief Function: Crypto_SA_Lock_State
+ * Crypto_SA_Lock for an SA looked up by SPI. SA management may have started, stopped or expired the SA
+ * between the lookup and the lock, so its state is checked again under the lock.
+ * @param sa_ptr: SecurityAssociation_t*
+ * @param sa_state: uint8, the state the caller's lookup found
+ * @return int32: Success, or CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL
+ **/
+int32_t Crypto_SA_Lock_State(SecurityAssociation_t* sa_ptr, uint8_t sa_state)
+{
+    Crypto_SA_Lock(sa_ptr);
+    if (sa_ptr == NULL || sa_ptr->sa_state != sa_state)
+    {
+        return CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL;
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: Crypto_SA_Lock_GVCID
+ * Crypto_SA_Lock for an SA looked up by GVCID. SA management may have stopped, expired or moved the SA
+ * between the lookup and the lock, so it is checked again under the lock to still be the operational SA
+ * of the channel. MapID only counts when SAs are unique per MapID, as in the lookup.
+ * @param sa_ptr: SecurityAssociation_t*
+ * @param tfvn: uint8
+ * @param scid: uint16
+ * @param vcid: uint16
+ * @param mapid: uint8
+ * @return int32: Success, or CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL
+ **/
+int32_t Crypto_SA_Lock_GVCID(SecurityAssociation_t* sa_ptr, uint8_t tfvn, uint16_t scid, uint16_t vcid,
+                             uint8_t mapid)
+{
+    int32_t status = Crypto_SA_Lock_State(sa_ptr, SA_OPERATIONAL);
+
+    if (status == CRYPTO_LIB_SUCCESS &&
+        (sa_ptr->gvcid_blk.tfvn != tfvn || sa_ptr->gvcid_blk.scid != scid || sa_ptr->gvcid_blk.vcid != vcid ||
+         (crypto_config.unique_sa_per_mapid != TC_UNIQUE_SA_PER_MAP_ID_FALSE && sa_ptr->gvcid_blk.mapid != mapid)))
+    {
+        status = CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL;
+    }
+    return status;
+}
+
+/**
+ * @brief Function: Crypto_SA_Unlock
+ * Releases the SA lock held by the calling thread, if any.
+ **/
+void Crypto_SA_Unlock(void)
+{
+    if (crypto_sa_held_stripe >= 0)
+    {
+        pthread_mutex_unlock(&crypto_sa_locks[crypto_sa_held_stripe]);
+        crypto_sa_held_stripe = -1;
+    }
+    crypto_sa_held_spi = -1;
+}
+
+/**
+ * @brief Function: Crypto_SA_Held_SPI
+ * SPI of the SA the calling thread last locked, while it still holds the lock
+ * @return int32: SPI, or -1 if no SA lock is held
+ **/
+int32_t Crypto_SA_Held_SPI(void)
+{
+    return crypto_sa_held_spi;
+}
+
+/**
+ * @brief Function: Crypto_Mgmt_Epoch
+ * Counts the calling thread's Crypto_Mgmt_Lock calls. An SA lock held across an unchanged epoch
+ * was never given up to SA management.
+ * @return uint32: Epoch
+ **/
+uint32_t Crypto_Mgmt_Epoch(void)
+{
+    return crypto_mgmt_epoch;
+}
+
+/**
+ * @brief Function: Crypto_Mgmt_Lock
+ * Serializes SDLS-EP processing, which changes SA, key and log state outside of any one frame's SA.
+ * Excludes every frame in flight by taking all SA stripes. The caller's own SA lock, if any, is
+ * released first and handed back by Crypto_Mgmt_Unlock.
+ **/
+void Crypto_Mgmt_Lock(void)
+{
+    int i;
+
+    pthread_once(&crypto_lock_once, crypto_lock_init);
+    crypto_mgmt_epoch++;
+    crypto_mgmt_resume_spi = crypto_sa_held_spi;
+    Crypto_SA_Unlock();
+    pthread_mutex_lock(&crypto_mgmt_lock);
+    for (i = 0; i < SA_LOCK_STRIPES; i++)
+    {
+        pthread_mutex_lock(&crypto_sa_locks[i]);
+    }
+    crypto_mgmt_held = CRYPTO_TRUE;
+}
+
+/**
+ * @brief Function: Crypto_Mgmt_Unlock
+ * Releases the SA stripes and the management mutex, the caller keeps the SA lock it held before
+ * Crypto_Mgmt_Lock.
+ **/
+void Crypto_Mgmt_Unlock(void)
+{
+    int32_t resume_stripe = -1;
+    int i;
+
+    if (crypto_mgmt_resume_spi >= 0)
+    {
+        resume_stripe = crypto_mgmt_resume_spi % SA_LOCK_STRIPES;
+    }
+    for (i = SA_LOCK_STRIPES - 1; i >= 0; i--)
+    {
+        if (i != resume_stripe)
+        {
+            pthread_mutex_unlock(&crypto_sa_locks[i]);
+        }
+    }
+    crypto_sa_held_stripe = resume_stripe;
+    crypto_sa_held_spi = crypto_mgmt_resume_spi;
+    crypto_mgmt_resume_spi = -1;
+    crypto_mgmt_held = CRYPTO_FALSE;
+    pthread_mutex_unlock(&crypto_mgmt_lock);
+}
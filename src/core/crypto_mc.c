@@ -20,6 +20,68 @@
 ** Includes
 */
 #include "crypto.h"
+#include <pthread.h>
+
+/*
+** SDLS Event Log
+** mc_log.blk is a ring of LOG_SIZE events: log_first is the oldest and log_count are held. Once the log is
+** full a new event replaces the oldest, which is counted in log_overwritten. log_summary.num_se counts every
+** event since the last erase (saturating) and log_summary.rs the free blocks. crypto_event_lock keeps ring
+** and counters consistent, so a dump or status taken while events are appended is a snapshot. Management
+** procedures hold the Crypto_Mgmt_Lock as well, it is always taken first.
+*/
+static pthread_mutex_t crypto_event_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint16_t log_first = 0;
+
+/**
+ * @brief Function: Crypto_Event_Log
+ * Appends a security event to the log, replacing the oldest once it is full
+ * @param emt: uint8_t, Event Message Tag
+ * @param emv: const uint8_t*, EMV_SIZE byte Event Message Value
+ **/
+void Crypto_Event_Log(uint8_t emt, const uint8_t* emv)
+{
+    SDLS_MC_DUMP_RPLY_t* blk;
+
+    pthread_mutex_lock(&crypto_event_lock);
+    if (log_count < LOG_SIZE)
+    {
+        blk = &mc_log.blk[(log_first + log_count) % LOG_SIZE];
+        log_count++;
+    }
+    else
+    {
+        blk = &mc_log.blk[log_first];
+        log_first = (log_first + 1) % LOG_SIZE;
+        log_overwritten++;
+    }
+    blk->emt = emt;
+    blk->em_len = EMV_SIZE;
+    memcpy(blk->emv, emv, EMV_SIZE);
+
+    if (log_summary.num_se < 0xFFFF)
+    {
+        log_summary.num_se++;
+    }
+    log_summary.rs = LOG_SIZE - log_count;
+    pthread_mutex_unlock(&crypto_event_lock);
+}
+
+/**
+ * @brief Function: Crypto_Event_Log_Reset
+ * Empties the log and zeroes its counters
+ **/
+void Crypto_Event_Log_Reset(void)
+{
+    pthread_mutex_lock(&crypto_event_lock);
+    memset(&mc_log, 0, sizeof(mc_log));
+    log_first = 0;
+    log_count = 0;
+    log_overwritten = 0;
+    log_summary.num_se = 0;
+    log_summary.rs = LOG_SIZE;
+    pthread_mutex_unlock(&crypto_event_lock);
+}
 
 /*
 ** Security Association Monitoring and Control
@@ -51,14 +113,13 @@ int32_t Crypto_MC_status(uint8_t* ingest)
     if(ingest == NULL) return CRYPTO_LIB_ERROR;
     int count = 0;
 
-    // TODO: Update log_summary.rs;
-
     // Prepare for Reply
     sdls_frame.pdu.pdu_len = 2; // 4
     sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
     count = Crypto_Prep_Reply(ingest, 128);
 
     // PDU
+    pthread_mutex_lock(&crypto_event_lock);
     // ingest[count++] = (log_summary.num_se & 0xFF00) >> 8;
     ingest[count++] = (log_summary.num_se & 0x00FF);
     // ingest[count++] = (log_summary.rs & 0xFF00) >> 8;
@@ -68,6 +129,7 @@ int32_t Crypto_MC_status(uint8_t* ingest)
     printf("log_summary.num_se = 0x%02x \n", log_summary.num_se);
     printf("log_summary.rs = 0x%02x \n", log_summary.rs);
 #endif
+    pthread_mutex_unlock(&crypto_event_lock);
 
     return count;
 }
@@ -83,29 +145,36 @@ int32_t Crypto_MC_dump(uint8_t* ingest)
     int count = 0;
     int x;
     int y;
+    SDLS_MC_DUMP_RPLY_t* blk;
+
+    // Events appended meanwhile wait, the reply is one consistent snapshot
+    pthread_mutex_lock(&crypto_event_lock);
 
     // Prepare for Reply
     sdls_frame.pdu.pdu_len = (log_count * 6); // SDLS_MC_DUMP_RPLY_SIZE
     sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
     count = Crypto_Prep_Reply(ingest, 128);
 
-    // PDU
+    // PDU, oldest event first
     for (x = 0; x < log_count; x++)
     {
-        ingest[count++] = mc_log.blk[x].emt;
-        // ingest[count++] = (mc_log.blk[x].em_len & 0xFF00) >> 8;
-        ingest[count++] = (mc_log.blk[x].em_len & 0x00FF);
+        blk = &mc_log.blk[(log_first + x) % LOG_SIZE];
+        ingest[count++] = blk->emt;
+        // ingest[count++] = (blk->em_len & 0xFF00) >> 8;
+        ingest[count++] = (blk->em_len & 0x00FF);
         for (y = 0; y < EMV_SIZE; y++)
         {
-            ingest[count++] = mc_log.blk[x].emv[y];
+            ingest[count++] = blk->emv[y];
         }
     }
 
 #ifdef PDU_DEBUG
     printf("log_count = %d \n", log_count);
+    printf("log_overwritten = %u \n", log_overwritten);
     printf("log_summary.num_se = 0x%02x \n", log_summary.num_se);
     printf("log_summary.rs = 0x%02x \n", log_summary.rs);
 #endif
+    pthread_mutex_unlock(&crypto_event_lock);
 
     return count;
 }
@@ -119,24 +188,9 @@ int32_t Crypto_MC_erase(uint8_t* ingest)
 {
     if(ingest == NULL) return CRYPTO_LIB_ERROR;
     int count = 0;
-    int x;
-    int y;
 
-    // Zero Logs
-    for (x = 0; x < LOG_SIZE; x++)
-    {
-        mc_log.blk[x].emt = 0;
-        mc_log.blk[x].em_len = 0;
-        for (y = 0; y < EMV_SIZE; y++)
-        {
-            mc_log.blk[x].emv[y] = 0;
-        }
-    }
-
-    // Compute Summary
-    log_count = 0;
-    log_summary.num_se = 0;
-    log_summary.rs = LOG_SIZE;
+    // Zero Logs and Summary
+    Crypto_Event_Log_Reset();
 
     // Prepare for Reply
     sdls_frame.pdu.pdu_len = 2; // 4
@@ -0,0 +1,422 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/*
+** Includes
+*/
+#include "crypto.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+/*
+** Metrics
+** Every thread that handles frames owns one block of counters, allocated on its first frame and
+** linked into a global list. Only the owner writes a block, so an update is a relaxed load and store
+** with no read-modify-write or shared cache line. Crypto_Get_Metrics walks the list and sums the
+** blocks. A block outlives its thread: on exit it is released, and the next new thread adopts it
+** with its counts intact, so totals never go backwards and the list is bounded by peak thread count.
+*/
+typedef struct
+{
+    atomic_uint_least64_t count;
+    atomic_uint_least64_t total_ns;
+    atomic_uint_least64_t buckets[CRYPTO_METRICS_LATENCY_BUCKETS];
+} crypto_metrics_latency_t;
+
+typedef struct crypto_metrics_block
+{
+    struct crypto_metrics_block* next;
+    uint8_t owned;                                   // Guarded by crypto_metrics_lock
+    atomic_uint_least64_t total[CRYPTO_COUNTER_COUNT];
+    atomic_uint_least64_t sa[NUM_SA][CRYPTO_COUNTER_COUNT];
+    atomic_uint_least64_t vc[GVCID_MAN_PARAM_SIZE][CRYPTO_COUNTER_COUNT];
+    crypto_metrics_latency_t stage[CRYPTO_STAGE_COUNT];
+} crypto_metrics_block_t;
+
+/*
+** Static Globals
+*/
+static pthread_mutex_t crypto_metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t crypto_metrics_once = PTHREAD_ONCE_INIT;
+static pthread_key_t crypto_metrics_key;
+static crypto_metrics_block_t* crypto_metrics_blocks = NULL;
+static CRYPTO_THREAD_LOCAL crypto_metrics_block_t* crypto_metrics_self = NULL;
+#ifdef CRYPTO_METRICS_LATENCY
+static CRYPTO_THREAD_LOCAL uint64_t crypto_metrics_stage_start[CRYPTO_STAGE_COUNT];
+#endif
+
+/*
+** Static Functions
+*/
+static void crypto_metrics_init(void);
+static void crypto_metrics_release(void* arg);
+static crypto_metrics_block_t* crypto_metrics_block(void);
+#ifdef CRYPTO_METRICS_LATENCY
+static uint64_t crypto_metrics_now(void);
+#endif
+static void crypto_metrics_add(atomic_uint_least64_t* counter, uint64_t n);
+static uint8_t crypto_metrics_classify(int32_t status, uint8_t applied);
+#ifdef CRYPTO_TRACE
+static void crypto_metrics_trace_return(uint8_t type, uint8_t applied, int32_t spi, uint8_t tfvn, uint16_t scid,
+                                        uint8_t vcid, uint32_t frame_len, int32_t status);
+#endif
+
+/**
+ * @brief Function: crypto_metrics_init
+ * Registers the thread exit hook that releases a thread's block
+ **/
+static void crypto_metrics_init(void)
+{
+    pthread_key_create(&crypto_metrics_key, crypto_metrics_release);
+}
+
+/**
+ * @brief Function: crypto_metrics_release
+ * Thread exit hook, hands the exiting thread's block to the next thread that needs one
+ * @param arg: crypto_metrics_block_t*
+ **/
+static void crypto_metrics_release(void* arg)
+{
+    crypto_metrics_block_t* block = (crypto_metrics_block_t*)arg;
+
+    pthread_mutex_lock(&crypto_metrics_lock);
+    block->owned = CRYPTO_FALSE;
+    pthread_mutex_unlock(&crypto_metrics_lock);
+}
+
+/**
+ * @brief Function: crypto_metrics_block
+ * The calling thread's block, adopting a released one or allocating on first use
+ * @return crypto_metrics_block_t*: NULL if no block could be allocated, the sample is dropped
+ **/
+static crypto_metrics_block_t* crypto_metrics_block(void)
+{
+    crypto_metrics_block_t* block = crypto_metrics_self;
+
+    if (block != NULL)
+    {
+        return block;
+    }
+    pthread_once(&crypto_metrics_once, crypto_metrics_init);
+
+    pthread_mutex_lock(&crypto_metrics_lock);
+    for (block = crypto_metrics_blocks; block != NULL; block = block->next)
+    {
+        if (block->owned == CRYPTO_FALSE)
+        {
+            break;
+        }
+    }
+    if (block == NULL)
+    {
+        block = (crypto_metrics_block_t*)calloc(1, sizeof(crypto_metrics_block_t));
+        if (block != NULL)
+        {
+            block->next = crypto_metrics_blocks;
+            crypto_metrics_blocks = block;
+        }
+    }
+    if (block != NULL)
+    {
+        block->owned = CRYPTO_TRUE;
+        pthread_setspecific(crypto_metrics_key, block);
+    }
+    pthread_mutex_unlock(&crypto_metrics_lock);
+
+    crypto_metrics_self = block;
+    return block;
+}
+
+#ifdef CRYPTO_METRICS_LATENCY
+/**
+ * @brief Function: crypto_metrics_now
+ * @return uint64: monotonic time in ns
+ **/
+static uint64_t crypto_metrics_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+/**
+ * @brief Function: crypto_metrics_add
+ * Adds to a counter of the calling thread's block, which no other thread writes
+ * @param counter: atomic_uint_least64_t*
+ * @param n: uint64_t
+ **/
+static void crypto_metrics_add(atomic_uint_least64_t* counter, uint64_t n)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+/**
+ * @brief Function: crypto_metrics_classify
+ * Maps a frame's status to the counter it lands in
+ * @param status: int32_t
+ * @param applied: uint8_t, CRYPTO_TRUE for ApplySecurity
+ * @return uint8: Crypto_Counter_t
+ **/
+static uint8_t crypto_metrics_classify(int32_t status, uint8_t applied)
+{
+    switch (status)
+    {
+    case CRYPTO_LIB_SUCCESS:
+        return (applied == CRYPTO_TRUE) ? CRYPTO_COUNTER_FRAMES_APPLIED : CRYPTO_COUNTER_FRAMES_PROCESSED;
+    case CRYPTO_LIB_ERR_MAC_VALIDATION_ERROR:
+    case CRYPTO_LIB_ERR_AUTHENTICATION_ERROR:
+        return CRYPTO_COUNTER_MAC_FAILURES;
+    case CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW:
+    case CRYPTO_LIB_ERR_IV_OUTSIDE_WINDOW:
+        return CRYPTO_COUNTER_REPLAY_REJECTS;
+    case CRYPTO_LIB_ERR_INVALID_FECF:
+        return CRYPTO_COUNTER_FECF_ERRORS;
+    case CRYPTO_LIB_ERR_NO_OPERATIONAL_SA:
+    case CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL:
+    case CRYPTO_LIB_ERR_SPI_INDEX_OOB:
+    case CRYPTO_LIB_ERR_INVALID_TFVN:
+    case CRYPTO_LIB_ERR_INVALID_SCID:
+    case CRYPTO_LIB_ERR_INVALID_VCID:
+    case MANAGED_PARAMETERS_FOR_GVCID_NOT_FOUND:
+        return CRYPTO_COUNTER_SA_MISSES;
+    default:
+        return CRYPTO_COUNTER_OTHER_ERRORS;
+    }
+}
+
+#ifdef CRYPTO_TRACE
+/**
+ * @brief Function: crypto_metrics_trace_return
+ * Fires the <family>_return probe matching the entry point, see crypto_trace.h
+ **/
+static void crypto_metrics_trace_return(uint8_t type, uint8_t applied, int32_t spi, uint8_t tfvn, uint16_t scid,
+                                        uint8_t vcid, uint32_t frame_len, int32_t status)
+{
+    if (type == TYPE_TC && applied == CRYPTO_TRUE)
+    {
+        CRYPTO_PROBE(tc_apply_return, spi, tfvn, scid, vcid, frame_len, status);
+    }
+    else if (type == TYPE_TC)
+    {
+        CRYPTO_PROBE(tc_process_return, spi, tfvn, scid, vcid, frame_len, status);
+    }
+    else if (type == TYPE_TM && applied == CRYPTO_TRUE)
+    {
+        CRYPTO_PROBE(tm_apply_return, spi, tfvn, scid, vcid, frame_len, status);
+    }
+    else if (type == TYPE_TM)
+    {
+        CRYPTO_PROBE(tm_process_return, spi, tfvn, scid, vcid, frame_len, status);
+    }
+    else if (applied == CRYPTO_TRUE)
+    {
+        CRYPTO_PROBE(aos_apply_return, spi, tfvn, scid, vcid, frame_len, status);
+    }
+    else
+    {
+        CRYPTO_PROBE(aos_process_return, spi, tfvn, scid, vcid, frame_len, status);
+    }
+}
+#endif
+
+/**
+ * @brief Function: Crypto_Metrics_Frame
+ * Accounts one frame leaving a public Apply/ProcessSecurity entry point, and fires its return probe.
+ * Called with the frame's SA lock still held, which identifies the SA; the virtual channel comes from
+ * the frame's primary header.
+ * @param type: uint8_t, TYPE_TC, TYPE_TM or TYPE_AOS
+ * @param applied: uint8_t, CRYPTO_TRUE for ApplySecurity, CRYPTO_FALSE for ProcessSecurity
+ * @param p_frame: const uint8_t*, frame as passed in, may be NULL
+ * @param frame_len: uint32_t, 0 for TM/AOS ApplySecurity, whose frames are the managed parameter max_frame_size
+ * @param status: int32_t, what the entry point returns
+ **/
+void Crypto_Metrics_Frame(uint8_t type, uint8_t applied, const uint8_t* p_frame, uint32_t frame_len, int32_t status)
+{
+    crypto_metrics_block_t* block = crypto_metrics_block();
+    const GvcidManagedParameters_t* mp = NULL;
+    int32_t vc = -1;
+    int32_t spi = Crypto_SA_Held_SPI();
+    uint8_t tfvn = 0;
+    uint16_t scid = 0xFFFF;
+    uint8_t vcid = 0;
+    uint8_t counter;
+
+    // Header fields sit in the first 3 octets; a 0 length is only meaningful for TM/AOS ApplySecurity
+    if (p_frame != NULL && ((frame_len >= 3) || (frame_len == 0 && applied == CRYPTO_TRUE && type != TYPE_TC)))
+    {
+        tfvn = ((uint8_t)p_frame[0] & 0xC0) >> 6;
+        if (type == TYPE_TC)
+        {
+            scid = (((uint16_t)p_frame[0] & 0x03) << 8) | (uint16_t)p_frame[1];
+            vcid = ((uint8_t)p_frame[2] & 0xFC) >> 2;
+        }
+        else if (type == TYPE_TM)
+        {
+            scid = (((uint16_t)p_frame[0] & 0x3F) << 4) | (((uint16_t)p_frame[1] & 0xF0) >> 4);
+            vcid = ((uint8_t)p_frame[1] & 0x0E) >> 1;
+        }
+        else
+        {
+            scid = (((uint16_t)p_frame[0] & 0x3F) << 2) | (((uint16_t)p_frame[1] & 0xC0) >> 6);
+            vcid = (uint8_t)p_frame[1] & 0x3F;
+        }
+        if (Crypto_Get_Managed_Parameters_Ptr(tfvn, scid, vcid, &mp) == CRYPTO_LIB_SUCCESS)
+        {
+            vc = (int32_t)(mp - gvcid_managed_parameters_array);
+            if (frame_len == 0)
+            {
+                frame_len = mp->max_frame_size;
+            }
+        }
+    }
+
+#ifdef CRYPTO_TRACE
+    crypto_metrics_trace_return(type, applied, spi, tfvn, scid, vcid, frame_len, status);
+#endif
+    if (block == NULL)
+    {
+        return;
+    }
+
+    counter = crypto_metrics_classify(status, applied);
+    crypto_metrics_add(&block->total[counter], 1);
+    if (spi >= 0 && spi < NUM_SA)
+    {
+        crypto_metrics_add(&block->sa[spi][counter], 1);
+    }
+    if (vc >= 0 && vc < GVCID_MAN_PARAM_SIZE)
+    {
+        crypto_metrics_add(&block->vc[vc][counter], 1);
+    }
+
+    if (status == CRYPTO_LIB_SUCCESS)
+    {
+        // Byte counters directly follow their frame counters
+        counter++;
+        crypto_metrics_add(&block->total[counter], frame_len);
+        if (spi >= 0 && spi < NUM_SA)
+        {
+            crypto_metrics_add(&block->sa[spi][counter], frame_len);
+        }
+        if (vc >= 0 && vc < GVCID_MAN_PARAM_SIZE)
+        {
+            crypto_metrics_add(&block->vc[vc][counter], frame_len);
+        }
+    }
+}
+
+#if defined(CRYPTO_METRICS_LATENCY) || defined(CRYPTO_TRACE)
+/**
+ * @brief Function: Crypto_Metrics_Stage_Start
+ * Marks the start of a stage on the calling thread and fires the stage_entry probe, see CRYPTO_STAGE_START
+ * @param stage: uint8_t, Crypto_Stage_t
+ **/
+void Crypto_Metrics_Stage_Start(uint8_t stage)
+{
+    CRYPTO_PROBE(stage_entry, stage, Crypto_SA_Held_SPI());
+#ifdef CRYPTO_METRICS_LATENCY
+    crypto_metrics_stage_start[stage] = crypto_metrics_now();
+#endif
+}
+
+/**
+ * @brief Function: Crypto_Metrics_Stage_Stop
+ * Records the time since the matching Crypto_Metrics_Stage_Start in the stage's log2 ns histogram,
+ * and fires the stage_return probe
+ * @param stage: uint8_t, Crypto_Stage_t
+ **/
+void Crypto_Metrics_Stage_Stop(uint8_t stage)
+{
+    uint64_t ns = 0;
+#ifdef CRYPTO_METRICS_LATENCY
+    crypto_metrics_block_t* block = crypto_metrics_block();
+    uint32_t bucket = 0;
+
+    ns = crypto_metrics_now() - crypto_metrics_stage_start[stage];
+    if (block != NULL)
+    {
+        if (ns > 1)
+        {
+            bucket = 63 - (uint32_t)__builtin_clzll(ns);
+            if (bucket >= CRYPTO_METRICS_LATENCY_BUCKETS)
+            {
+                bucket = CRYPTO_METRICS_LATENCY_BUCKETS - 1;
+            }
+        }
+        crypto_metrics_add(&block->stage[stage].count, 1);
+        crypto_metrics_add(&block->stage[stage].total_ns, ns);
+        crypto_metrics_add(&block->stage[stage].buckets[bucket], 1);
+    }
+#endif
+    CRYPTO_PROBE(stage_return, stage, Crypto_SA_Held_SPI(), ns);
+}
+#endif
+
+/**
+ * @brief Function: Crypto_Get_Metrics
+ * Sums every thread's counters into metrics. Each counter is read atomically, but a frame in flight on
+ * another thread may show up in some of its counters and not yet in others.
+ * @param metrics: Crypto_Metrics_t*
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_Get_Metrics(Crypto_Metrics_t* metrics)
+{
+    crypto_metrics_block_t* block;
+    int i;
+    int j;
+    int k;
+
+    if (metrics == NULL)
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+    memset(metrics, 0, sizeof(Crypto_Metrics_t));
+
+    pthread_mutex_lock(&crypto_metrics_lock);
+    for (block = crypto_metrics_blocks; block != NULL; block = block->next)
+    {
+        for (j = 0; j < CRYPTO_COUNTER_COUNT; j++)
+        {
+            metrics->total[j] += atomic_load_explicit(&block->total[j], memory_order_relaxed);
+            for (i = 0; i < NUM_SA; i++)
+            {
+                metrics->sa[i][j] += atomic_load_explicit(&block->sa[i][j], memory_order_relaxed);
+            }
+            for (i = 0; i < GVCID_MAN_PARAM_SIZE; i++)
+            {
+                metrics->vc[i][j] += atomic_load_explicit(&block->vc[i][j], memory_order_relaxed);
+            }
+        }
+        for (i = 0; i < CRYPTO_STAGE_COUNT; i++)
+        {
+            metrics->stage[i].count += atomic_load_explicit(&block->stage[i].count, memory_order_relaxed);
+            metrics->stage[i].total_ns += atomic_load_explicit(&block->stage[i].total_ns, memory_order_relaxed);
+            for (k = 0; k < CRYPTO_METRICS_LATENCY_BUCKETS; k++)
+            {
+                metrics->stage[i].buckets[k] +=
+                    atomic_load_explicit(&block->stage[i].buckets[k], memory_order_relaxed);
+            }
+        }
+    }
+    pthread_mutex_unlock(&crypto_metrics_lock);
+
+    return CRYPTO_LIB_SUCCESS;
+}
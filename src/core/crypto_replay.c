@@ -0,0 +1,218 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+/*
+** Sliding Anti-Replay Window
+** With arsnw_bitmap set, an SA accepts a counter up to arsnw behind the last accepted one (the high-water
+** mark, HWM) as long as it has not been seen, in the style of the IPsec/DTLS replay windows (RFC 6479).
+** The bitmap is a ring of 64-bit words indexed by the low bits of the counter.  Moving the HWM forward
+** clears only the words it passes over, so both the check and the update are a handful of word operations
+** whatever the window.  The word holding the HWM is shared with counters ahead of it, which is why the
+** usable depth is one word less than the bitmap.
+**
+** The bitmap is anchored to the SA's stored counter.  Whenever the two disagree (first use, SA rekeyed or
+** reloaded from an external SADB) it is reset to "everything at or behind the stored counter was seen",
+** which can only reject more frames, never accept a replay.
+*/
+#define REPLAY_WORDS (ARSNW_BITMAP_BITS / 64)
+
+/*
+** Static Functions
+*/
+static uint32_t crypto_replay_words(int length);
+static uint64_t crypto_replay_seq(const uint8_t* counter, int length);
+static void crypto_replay_anchor(SecurityAssociationReplay_t* replay, const uint8_t* expected, int length);
+
+/**
+ * @brief Function: crypto_replay_words
+ * Number of bitmap words in use, a short counter may not have ARSNW_BITMAP_BITS values
+ * @param length: int
+ * @return uint32: Words in the ring, a power of 2
+ **/
+static uint32_t crypto_replay_words(int length)
+{
+    if (length < 8 && ((1ULL << (8 * length)) >> 6) < REPLAY_WORDS)
+    {
+        return (uint32_t)((1ULL << (8 * length)) >> 6);
+    }
+    return REPLAY_WORDS;
+}
+
+/**
+ * @brief Function: crypto_replay_seq
+ * Low 64 bits of a big-endian counter
+ * @param counter: const uint8_t*
+ * @param length: int
+ * @return uint64: Counter value modulo 2^64
+ **/
+static uint64_t crypto_replay_seq(const uint8_t* counter, int length)
+{
+    uint64_t seq = 0;
+    int i;
+
+    for (i = (length > 8) ? length - 8 : 0; i < length; i++)
+    {
+        seq = (seq << 8) | counter[i];
+    }
+    return seq;
+}
+
+/**
+ * @brief Function: crypto_replay_anchor
+ * Resets the bitmap if its HWM is not the SA's stored counter
+ * @param replay: SecurityAssociationReplay_t*
+ * @param expected: const uint8_t*, stored counter
+ * @param length: int
+ **/
+static void crypto_replay_anchor(SecurityAssociationReplay_t* replay, const uint8_t* expected, int length)
+{
+    uint64_t seq;
+    uint32_t bit;
+
+    if (replay->hwm_len == length && memcmp(replay->hwm, expected, length) == 0)
+    {
+        return;
+    }
+    seq = crypto_replay_seq(expected, length);
+    bit = (uint32_t)(seq & 63);
+    memset(replay->bitmap, 0xFF, sizeof(replay->bitmap));
+    // Counters above the HWM in its own word have not been seen
+    replay->bitmap[(seq >> 6) & (crypto_replay_words(length) - 1)] = (bit == 63) ? UINT64_MAX : ((2ULL << bit) - 1);
+    memcpy(replay->hwm, expected, length);
+    replay->hwm_len = (uint8_t)length;
+#ifdef DEBUG
+    printf("Crypto_Replay: bitmap anchored to counter ending %016llx\n", (unsigned long long)seq);
+#endif
+}
+
+/**
+ * @brief Function: Crypto_Replay_Check
+ * Anti-replay check of a received counter against the SA's stored one. Counters ahead are checked by
+ * Crypto_window. With arsnw_bitmap set, counters up to arsnw behind are also accepted: when tracked, only
+ * if not already seen, otherwise (the second counter of an SA that has both an ARSN and an IV) on distance
+ * alone, as replay protection is already provided by the tracked one.
+ * Does not modify the SA, see Crypto_Replay_Update.
+ * @param sa_ptr: SecurityAssociation_t*
+ * @param actual: uint8_t*, received counter
+ * @param expected: uint8_t*, stored counter
+ * @param length: int
+ * @param tracked: uint8_t, CRYPTO_TRUE if this is the counter the SA's bitmap follows
+ * @param ahead: int8_t*, set CRYPTO_TRUE if actual is ahead of expected
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_Replay_Check(SecurityAssociation_t* sa_ptr, uint8_t* actual, uint8_t* expected, int length, uint8_t tracked,
+                            int8_t* ahead)
+{
+    SecurityAssociationReplay_t* replay = sa_ptr->replay;
+    uint64_t behind;
+    uint64_t depth;
+    uint64_t seq;
+    uint32_t words;
+
+    *ahead = CRYPTO_FALSE;
+    if (Crypto_window(actual, expected, length, sa_ptr->arsnw) == CRYPTO_LIB_SUCCESS)
+    {
+        *ahead = CRYPTO_TRUE;
+        return CRYPTO_LIB_SUCCESS;
+    }
+    if (sa_ptr->arsnw_bitmap != CRYPTO_TRUE || replay == NULL || length <= 0 ||
+        length > (int)sizeof(replay->hwm))
+    {
+        return CRYPTO_LIB_ERROR;
+    }
+
+    words = crypto_replay_words(length);
+    depth = (uint64_t)words * 64 - 64;
+    if (sa_ptr->arsnw < depth)
+    {
+        depth = sa_ptr->arsnw;
+    }
+    if (Crypto_Counter_Diff(expected, actual, length, &behind) != CRYPTO_TRUE || behind == 0 || behind > depth)
+    {
+        return CRYPTO_LIB_ERROR;
+    }
+    if (tracked != CRYPTO_TRUE)
+    {
+        return CRYPTO_LIB_SUCCESS;
+    }
+
+    crypto_replay_anchor(replay, expected, length);
+    seq = crypto_replay_seq(actual, length);
+    if (replay->bitmap[(seq >> 6) & (words - 1)] & (1ULL << (seq & 63)))
+    {
+#ifdef DEBUG
+        printf("Crypto_Replay: counter ending %016llx already seen\n", (unsigned long long)seq);
+#endif
+        return CRYPTO_LIB_ERROR;
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: Crypto_Replay_Update
+ * Records a counter accepted by Crypto_Replay_Check in the SA's bitmap, sliding the window forward when
+ * it is ahead. The caller stores the counter in the SA itself. No-op unless arsnw_bitmap is set.
+ * @param sa_ptr: SecurityAssociation_t*
+ * @param actual: uint8_t*, received counter
+ * @param expected: uint8_t*, stored counter, before the caller updates it
+ * @param length: int
+ * @param ahead: int8_t, as returned by Crypto_Replay_Check
+ **/
+void Crypto_Replay_Update(SecurityAssociation_t* sa_ptr, uint8_t* actual, uint8_t* expected, int length, int8_t ahead)
+{
+    SecurityAssociationReplay_t* replay = sa_ptr->replay;
+    uint64_t seq;
+    uint64_t diff;
+    uint64_t hwm_seq;
+    uint64_t steps;
+    uint64_t k;
+    uint32_t words;
+
+    if (sa_ptr->arsnw_bitmap != CRYPTO_TRUE || replay == NULL || length <= 0 || length > (int)sizeof(replay->hwm))
+    {
+        return;
+    }
+
+    crypto_replay_anchor(replay, expected, length);
+    words = crypto_replay_words(length);
+    seq = crypto_replay_seq(actual, length);
+    if (ahead == CRYPTO_TRUE)
+    {
+        // Clear the words the HWM moves over, they held counters a full ring behind
+        hwm_seq = crypto_replay_seq(replay->hwm, length);
+        if (Crypto_Counter_Diff(actual, replay->hwm, length, &diff) != CRYPTO_TRUE || diff >= (uint64_t)words * 64)
+        {
+            memset(replay->bitmap, 0, sizeof(replay->bitmap));
+        }
+        else
+        {
+            steps = ((hwm_seq & 63) + diff) >> 6;
+            for (k = 1; k <= steps; k++)
+            {
+                replay->bitmap[((hwm_seq >> 6) + k) & (words - 1)] = 0;
+            }
+        }
+        memcpy(replay->hwm, actual, length);
+    }
+    replay->bitmap[(seq >> 6) & (words - 1)] |= 1ULL << (seq & 63);
+}
@@ -24,8 +24,23 @@
 #include <string.h> // memcpy
 
 /* Helper functions */
+static int32_t crypto_tc_apply_security_cam(const uint8_t* p_in_frame, const uint16_t in_frame_length, uint8_t** pp_in_frame, uint16_t* p_enc_frame_len, char* cam_cookies);
+static int32_t crypto_tc_process_security_cam(uint8_t* ingest, int* len_ingest, TC_t* tc_sdls_processed_frame, char* cam_cookies);
 static int32_t crypto_tc_validate_sa(SecurityAssociation_t* sa);
 static int32_t crypto_handle_incrementing_nontransmitted_counter(uint8_t* dest, uint8_t* src, int src_full_len, int transmitted_len, int window);
+static int32_t crypto_tc_batch_defer_save(SecurityAssociation_t* sa_ptr);
+
+/* Batch processing state, SA saves from anti-replay checks are deferred until the batch completes.
+ * A run of frames on the same SPI shares one SA lookup and lock, see Crypto_TC_Sanity_Validations. */
+static CRYPTO_THREAD_LOCAL uint8_t tc_batch_active = CRYPTO_FALSE;
+static CRYPTO_THREAD_LOCAL SecurityAssociation_t* tc_batch_sa = NULL;
+static CRYPTO_THREAD_LOCAL uint32_t tc_batch_sa_epoch = 0;
+static CRYPTO_THREAD_LOCAL SecurityAssociation_t* tc_batch_dirty_sa[NUM_SA];
+static CRYPTO_THREAD_LOCAL uint16_t tc_batch_dirty_count = 0;
+
+/* Caller output buffer for Crypto_TC_ApplySecurity_Into, used by Crypto_TC_Accio_Buffer in place of malloc */
+static CRYPTO_THREAD_LOCAL uint8_t* tc_apply_out_buf = NULL;
+static CRYPTO_THREAD_LOCAL uint16_t tc_apply_out_len = 0;
 
 /**
  * @brief Function: Crypto_TC_Get_SA_Service_Type
@@ -202,10 +217,10 @@ int32_t Crypto_TC_Handle_Enc_Padding(uint8_t sa_service_type, uint32_t* pkcs_pad
 int32_t Crypto_TC_Frame_Validation(uint16_t* p_enc_frame_len)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
-    if (*p_enc_frame_len > current_managed_parameters_struct.max_frame_size)
+    if (*p_enc_frame_len > current_managed_parameters->max_frame_size)
     {
 #ifdef DEBUG
-        printf("Managed length is: %d\n", current_managed_parameters_struct.max_frame_size);
+        printf("Managed length is: %d\n", current_managed_parameters->max_frame_size);
         printf("New enc frame length will be: %d\n", *p_enc_frame_len);
 #endif
         printf(KRED "Error: New frame would violate maximum tc frame managed parameter! \n" RESET);
@@ -225,9 +240,9 @@ int32_t Crypto_TC_Frame_Validation(uint16_t* p_enc_frame_len)
 }
 
 /**
- * TODO: Should this be pre-allocated in the library?
  * @brief Function: Crypto_TC_Accio_Buffer
  * Buffer creation for KMC
+ * Hands out the caller buffer under Crypto_TC_ApplySecurity_Into, otherwise mallocs one
  * @param p_new_enc_frame: uint8_t**
  * @param p_enc_frame_len: uint16_t*
  * @return int32: Creates Buffer, Returns Success/Failure
@@ -235,8 +250,20 @@ int32_t Crypto_TC_Frame_Validation(uint16_t* p_enc_frame_len)
 int32_t Crypto_TC_Accio_Buffer(uint8_t** p_new_enc_frame, uint16_t* p_enc_frame_len)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
+    if (tc_apply_out_buf != NULL)
+    {
+        if (*p_enc_frame_len > tc_apply_out_len)
+        {
+            status = CRYPTO_LIB_ERR_OUTPUT_BUFFER_TOO_SMALL;
+            mc_if->mc_log(status);
+            return status;
+        }
+        *p_new_enc_frame = tc_apply_out_buf;
+        memset(*p_new_enc_frame, 0, *p_enc_frame_len);
+        return status;
+    }
     *p_new_enc_frame = (uint8_t*)malloc((*p_enc_frame_len) * sizeof(uint8_t));
-    if (!p_new_enc_frame)
+    if (*p_new_enc_frame == NULL)
     {
         printf(KRED "Error: Malloc for encrypted output buffer failed! \n" RESET);
         status = CRYPTO_LIB_ERROR;
@@ -371,6 +398,12 @@ int32_t Crypto_TC_Do_Encrypt_PLAINTEXT(uint8_t sa_service_type, SecurityAssociat
                 return status;
             }
             *aad = Crypto_Prepare_TC_AAD(p_new_enc_frame, aad_len, sa_ptr->abm);
+            if (*aad == NULL)
+            {
+                status = CRYPTO_LIB_ERROR;
+                mc_if->mc_log(status);
+                return status;
+            }
         }
 
 #ifdef TC_DEBUG
@@ -379,7 +412,9 @@ int32_t Crypto_TC_Do_Encrypt_PLAINTEXT(uint8_t sa_service_type, SecurityAssociat
 #endif
 
         /* Get Key */
+        CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
         ekp = key_if->get_key(sa_ptr->ekid);
+        CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
         if (ekp == NULL)
         {
             status = CRYPTO_LIB_ERR_KEY_ID_ERROR;
@@ -391,13 +426,13 @@ int32_t Crypto_TC_Do_Encrypt_PLAINTEXT(uint8_t sa_service_type, SecurityAssociat
             // Check that key length to be used ets the algorithm requirement
             if ((int32_t)ekp->key_len != Crypto_Get_ECS_Algo_Keylen(sa_ptr->ecs))
             {
-                Crypto_TC_Safe_Free_Ptr(*aad);
                 status = CRYPTO_LIB_ERR_KEY_LENGTH_ERROR;
                 mc_if->mc_log(status);
                 return status;
             }
 
-            status = cryptography_if->cryptography_aead_encrypt(&p_new_enc_frame[index],                                          // ciphertext output
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
+            status = Crypto_Async_AEAD_Encrypt(&p_new_enc_frame[index],                                          // ciphertext output
                                                                 (size_t)tf_payload_len,                                           // length of data
                                                                 (uint8_t*)(p_in_frame + TC_FRAME_HEADER_SIZE + segment_hdr_len), // plaintext input
                                                                 (size_t)tf_payload_len,                                           // in data length
@@ -416,6 +451,7 @@ int32_t Crypto_TC_Do_Encrypt_PLAINTEXT(uint8_t sa_service_type, SecurityAssociat
                                                                 &sa_ptr->ecs, // encryption cipher
                                                                 &sa_ptr->acs, // authentication cipher
                                                                 cam_cookies);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         }
         else // non aead algorithm
         {
@@ -425,10 +461,10 @@ int32_t Crypto_TC_Do_Encrypt_PLAINTEXT(uint8_t sa_service_type, SecurityAssociat
                 // Check that key length to be used ets the algorithm requirement
                 if ((int32_t)ekp->key_len != Crypto_Get_ECS_Algo_Keylen(sa_ptr->ecs))
                 {
-                    Crypto_TC_Safe_Free_Ptr(*aad);
                     return CRYPTO_LIB_ERR_KEY_LENGTH_ERROR;
                 }
 
+                CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
                 status = cryptography_if->cryptography_encrypt(&p_new_enc_frame[index], // ciphertext output
                                                                 (size_t)tf_payload_len,
                                                                 &p_new_enc_frame[index], // length of data
@@ -443,13 +479,16 @@ int32_t Crypto_TC_Do_Encrypt_PLAINTEXT(uint8_t sa_service_type, SecurityAssociat
                                                                 &sa_ptr->ecs,                            // encryption cipher
                                                                 pkcs_padding,
                                                                 cam_cookies);
+                CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
             }
 
             if (sa_service_type == SA_AUTHENTICATION)
             {
                 /* Get Key */
                 crypto_key_t* akp = NULL;
+                CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
                 akp = key_if->get_key(sa_ptr->akid);
+                CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
                 if (akp == NULL)
                 {
                     return CRYPTO_LIB_ERR_KEY_ID_ERROR;
@@ -458,10 +497,10 @@ int32_t Crypto_TC_Do_Encrypt_PLAINTEXT(uint8_t sa_service_type, SecurityAssociat
                 // Check that key length to be used ets the algorithm requirement
                 if ((int32_t)akp->key_len != Crypto_Get_ACS_Algo_Keylen(sa_ptr->acs))
                 {
-                    Crypto_TC_Safe_Free_Ptr(*aad);
                     return CRYPTO_LIB_ERR_KEY_LENGTH_ERROR;
                 }
 
+                CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
                 status = cryptography_if->cryptography_authenticate(&p_new_enc_frame[index],                                          // ciphertext output
                                                                     (size_t)tf_payload_len,                                           // length of data
                                                                     (uint8_t*)(p_in_frame + TC_FRAME_HEADER_SIZE + segment_hdr_len), // plaintext input
@@ -478,13 +517,13 @@ int32_t Crypto_TC_Do_Encrypt_PLAINTEXT(uint8_t sa_service_type, SecurityAssociat
                                                                     sa_ptr->ecs,        // encryption cipher
                                                                     sa_ptr->acs,        // authentication cipher
                                                                     cam_cookies);
+                CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
             }
             
         }        
         *index_p = index;
         if (status != CRYPTO_LIB_SUCCESS)
         {
-            Crypto_TC_Safe_Free_Ptr(*aad);
             mc_if->mc_log(status);
             return status; // Cryptography IF call failed, return.
         }
@@ -585,7 +624,6 @@ int32_t Crypto_TC_Do_Encrypt(uint8_t sa_service_type, SecurityAssociation_t* sa_
     status = Crypto_TC_Do_Encrypt_PLAINTEXT(sa_service_type, sa_ptr, mac_loc, tf_payload_len, segment_hdr_len, p_new_enc_frame, ekp, aad, ecs_is_aead_algorithm, index_p, p_in_frame, cam_cookies, pkcs_padding);
     if (status != CRYPTO_LIB_SUCCESS)
     {
-        Crypto_TC_Safe_Free_Ptr(*aad);
         mc_if->mc_log(status);
         return status; 
     }
@@ -596,16 +634,20 @@ int32_t Crypto_TC_Do_Encrypt(uint8_t sa_service_type, SecurityAssociation_t* sa_
     */
 
     // Only calculate & insert FECF if CryptoLib is configured to do so & gvcid includes FECF.
-    if (current_managed_parameters_struct.has_fecf == TC_HAS_FECF)
+    if (current_managed_parameters->has_fecf == TC_HAS_FECF)
     {
 #ifdef FECF_DEBUG
         printf(KCYN "Calcing FECF over %d bytes\n" RESET, new_enc_frame_header_field_length - 1);
 #endif
         if (crypto_config.crypto_create_fecf == CRYPTO_TC_CREATE_FECF_TRUE)
         {
-            *new_fecf = Crypto_Calc_FECF(p_new_enc_frame, new_enc_frame_header_field_length - 1);
-            *(p_new_enc_frame + new_enc_frame_header_field_length - 1) = (uint8_t)((*new_fecf & 0xFF00) >> 8);
-            *(p_new_enc_frame + new_enc_frame_header_field_length) = (uint8_t)(*new_fecf & 0x00FF);
+            // While the ciphertext is still in flight, Crypto_Async_Poll inserts the FECF
+            if (Crypto_Async_Defer_FECF(new_enc_frame_header_field_length - 1) == CRYPTO_FALSE)
+            {
+                *new_fecf = Crypto_Calc_FECF(p_new_enc_frame, new_enc_frame_header_field_length - 1);
+                *(p_new_enc_frame + new_enc_frame_header_field_length - 1) = (uint8_t)((*new_fecf & 0xFF00) >> 8);
+                *(p_new_enc_frame + new_enc_frame_header_field_length) = (uint8_t)(*new_fecf & 0x00FF);
+            }
         }
         else // CRYPTO_TC_CREATE_FECF_FALSE
         {
@@ -709,8 +751,8 @@ int32_t Crytpo_TC_Validate_TC_Temp_Header(const uint16_t in_frame_length, TC_Fra
     }
 
     // Lookup-retrieve managed parameters for frame via gvcid:
-    status = Crypto_Get_Managed_Parameters_For_Gvcid(temp_tc_header.tfvn, temp_tc_header.scid, temp_tc_header.vcid,
-                                                     gvcid_managed_parameters_array, &current_managed_parameters_struct);
+    status = Crypto_Get_Managed_Parameters_Ptr(temp_tc_header.tfvn, temp_tc_header.scid, temp_tc_header.vcid,
+                                               &current_managed_parameters);
 
     if (status != CRYPTO_LIB_SUCCESS)
     {
@@ -718,7 +760,7 @@ int32_t Crytpo_TC_Validate_TC_Temp_Header(const uint16_t in_frame_length, TC_Fra
         return status;
     } // Unable to get necessary Managed Parameters for TC TF -- return with error.
 
-    if (current_managed_parameters_struct.has_segmentation_hdr == TC_HAS_SEGMENT_HDRS)
+    if (current_managed_parameters->has_segmentation_hdr == TC_HAS_SEGMENT_HDRS)
     {
         *segmentation_hdr = p_in_frame[5];
         *map_id = *segmentation_hdr & 0x3F;
@@ -730,14 +772,22 @@ int32_t Crytpo_TC_Validate_TC_Temp_Header(const uint16_t in_frame_length, TC_Fra
         mc_if->mc_log(status);
         return status;
     }
+    CRYPTO_STAGE_START(CRYPTO_STAGE_SA_LOOKUP);
     status = sa_if->sa_get_operational_sa_from_gvcid(temp_tc_header.tfvn, temp_tc_header.scid,
                                                         temp_tc_header.vcid, *map_id, sa_ptr);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_SA_LOOKUP);
     // If unable to get operational SA, can return
     if (status != CRYPTO_LIB_SUCCESS)
     {
         mc_if->mc_log(status);
         return status;
     }
+    status = Crypto_SA_Lock_GVCID(*sa_ptr, temp_tc_header.tfvn, temp_tc_header.scid, temp_tc_header.vcid, *map_id);
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        mc_if->mc_log(status);
+        return status;
+    }
 
     // Try to assure SA is sane
     status = crypto_tc_validate_sa(*sa_ptr);
@@ -892,6 +942,98 @@ int32_t Crypto_TC_ApplySecurity(const uint8_t* p_in_frame, const uint16_t in_fra
  **/
 int32_t Crypto_TC_ApplySecurity_Cam(const uint8_t* p_in_frame, const uint16_t in_frame_length, uint8_t** pp_in_frame,
                                     uint16_t* p_enc_frame_len, char* cam_cookies)
+{
+    int32_t status;
+
+    CRYPTO_PROBE(tc_apply_entry, p_in_frame, in_frame_length);
+    status = crypto_tc_apply_security_cam(p_in_frame, in_frame_length, pp_in_frame, p_enc_frame_len, cam_cookies);
+    Crypto_Metrics_Frame(TYPE_TC, CRYPTO_TRUE, p_in_frame, in_frame_length, status);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: Crypto_TC_ApplySecurity_Into
+ * Crypto_TC_ApplySecurity without heap allocation, the protected frame is written to p_out.
+ * Size p_out with Crypto_TC_Get_Max_Output_Len.
+ * @param p_in_frame: uint8*
+ * @param in_frame_length: uint16
+ * @param p_out: uint8_t*
+ * @param len_out: uint16_t
+ * @param p_enc_frame_len: uint16*
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_TC_ApplySecurity_Into(const uint8_t* p_in_frame, const uint16_t in_frame_length, uint8_t* p_out,
+                                     uint16_t len_out, uint16_t* p_enc_frame_len)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    uint8_t* p_enc_frame = NULL;
+
+    if (p_out == NULL || p_enc_frame_len == NULL)
+    {
+        status = CRYPTO_LIB_ERR_NULL_BUFFER;
+        if (mc_if != NULL)
+        {
+            mc_if->mc_log(status);
+        }
+        return status;
+    }
+
+    CRYPTO_PROBE(tc_apply_entry, p_in_frame, in_frame_length);
+    tc_apply_out_buf = p_out;
+    tc_apply_out_len = len_out;
+    status = crypto_tc_apply_security_cam(p_in_frame, in_frame_length, &p_enc_frame, p_enc_frame_len, NULL);
+    tc_apply_out_buf = NULL;
+    tc_apply_out_len = 0;
+    Crypto_Metrics_Frame(TYPE_TC, CRYPTO_TRUE, p_in_frame, in_frame_length, status);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: Crypto_TC_Get_Max_Output_Len
+ * Largest frame Crypto_TC_ApplySecurity can produce on an SA: the managed parameter maximum for its
+ * GVCID, capped at the TC specification limit
+ * @param spi: uint16_t
+ * @param p_max_len: uint16_t*
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_TC_Get_Max_Output_Len(uint16_t spi, uint16_t* p_max_len)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    SecurityAssociation_t* sa_ptr = NULL;
+    const GvcidManagedParameters_t* managed_parameters = NULL;
+
+    if (p_max_len == NULL)
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+    if (sa_if == NULL)
+    {
+        return CRYPTO_LIB_ERR_NO_INIT;
+    }
+    status = sa_if->sa_get_from_spi(spi, &sa_ptr);
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        return status;
+    }
+
+    *p_max_len = TC_MAX_FRAME_SIZE;
+    if (Crypto_Get_Managed_Parameters_Ptr(sa_ptr->gvcid_blk.tfvn, sa_ptr->gvcid_blk.scid, sa_ptr->gvcid_blk.vcid,
+                                          &managed_parameters) == CRYPTO_LIB_SUCCESS &&
+        managed_parameters->max_frame_size < *p_max_len)
+    {
+        *p_max_len = managed_parameters->max_frame_size;
+    }
+    return status;
+}
+
+/**
+ * @brief Function: crypto_tc_apply_security_cam
+ * Body of Crypto_TC_ApplySecurity_Cam, runs with the frame's SA lock held once the SA is known
+ **/
+static int32_t crypto_tc_apply_security_cam(const uint8_t* p_in_frame, const uint16_t in_frame_length, uint8_t** pp_in_frame,
+                                            uint16_t* p_enc_frame_len, char* cam_cookies)
 {
     // Local Variables
     int32_t status = CRYPTO_LIB_SUCCESS;
@@ -915,6 +1057,7 @@ int32_t Crypto_TC_ApplySecurity_Cam(const uint8_t* p_in_frame, const uint16_t in
 #ifdef DEBUG
     printf(KYEL "\n----- Crypto_TC_ApplySecurity START -----\n" RESET);
 #endif
+    Crypto_Arena_Reset();
     status = Crypto_TC_Sanity_Setup(p_in_frame, in_frame_length);
     if (status != CRYPTO_LIB_SUCCESS)
     {
@@ -1043,7 +1186,7 @@ int32_t Crypto_TC_ApplySecurity_Cam(const uint8_t* p_in_frame, const uint16_t in
     */
     uint16_t index = TC_FRAME_HEADER_SIZE; // Frame header is 5 bytes
 
-    if (current_managed_parameters_struct.has_segmentation_hdr == TC_HAS_SEGMENT_HDRS)
+    if (current_managed_parameters->has_segmentation_hdr == TC_HAS_SEGMENT_HDRS)
     {
         index++; // Add 1 byte to index because segmentation header used for this gvcid.
     }
@@ -1072,8 +1215,8 @@ int32_t Crypto_TC_ApplySecurity_Cam(const uint8_t* p_in_frame, const uint16_t in
     */
     for (i = sa_ptr->arsn_len - sa_ptr->shsnf_len; i < sa_ptr->arsn_len; i++)
     {
-        // Copy in ARSN from SA
-        *(p_new_enc_frame + index) = *(sa_ptr->arsn + i);
+        // Copy in ARSN from SA, zero filling an SN field wider than the ARSN
+        *(p_new_enc_frame + index) = (i >= 0) ? *(sa_ptr->arsn + i) : 0;
         index++;
     }
 
@@ -1134,12 +1277,11 @@ int32_t Crypto_TC_ApplySecurity_Cam(const uint8_t* p_in_frame, const uint16_t in
 
     *pp_in_frame = p_new_enc_frame;
 
-    status = sa_if->sa_save_sa(sa_ptr);
+    status = Crypto_SA_Save(sa_ptr);
 
 #ifdef DEBUG
     printf(KYEL "----- Crypto_TC_ApplySecurity END -----\n" RESET);
 #endif
-    Crypto_TC_Safe_Free_Ptr(aad);
     mc_if->mc_log(status);
     return status;
 }
@@ -1169,7 +1311,7 @@ int32_t Crypto_TC_ProcessSecurity(uint8_t* ingest, int* len_ingest, TC_t* tc_sdl
 int32_t Crypto_TC_Parse_Check_FECF(uint8_t* ingest, int* len_ingest, TC_t* tc_sdls_processed_frame)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
-    if (current_managed_parameters_struct.has_fecf == TC_HAS_FECF)
+    if (current_managed_parameters->has_fecf == TC_HAS_FECF)
     {
         tc_sdls_processed_frame->tc_sec_trailer.fecf = (((ingest[tc_sdls_processed_frame->tc_header.fl - 1] << 8) & 0xFF00) |
                                                         (ingest[tc_sdls_processed_frame->tc_header.fl] & 0x00FF));
@@ -1295,7 +1437,7 @@ int32_t Crypto_TC_Check_ECS_Keylen(crypto_key_t* ekp, SecurityAssociation_t* sa_
  **/
 void Crypto_TC_Safe_Free_Ptr(uint8_t* ptr)
 {   
-    if (!ptr) free(ptr);
+    if (ptr) free(ptr);
 }
 
 /** 
@@ -1325,10 +1467,10 @@ int32_t Crypto_TC_Do_Decrypt(uint8_t sa_service_type, uint8_t ecs_is_aead_algori
 
         status = Crypto_TC_Check_ECS_Keylen(ekp, sa_ptr);
         if(status!= CRYPTO_LIB_SUCCESS){
-            Crypto_TC_Safe_Free_Ptr(aad);
             return status;
         }
 
+        CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
         status = cryptography_if->cryptography_aead_decrypt(
             tc_sdls_processed_frame->tc_pdu,               // plaintext output
             (size_t)(tc_sdls_processed_frame->tc_pdu_len), // length of data
@@ -1350,6 +1492,7 @@ int32_t Crypto_TC_Do_Decrypt(uint8_t sa_service_type, uint8_t ecs_is_aead_algori
             &sa_ptr->acs,                                  // authentication cipher
             cam_cookies                                    // 
         );
+        CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
     }
     else if (sa_service_type != SA_PLAINTEXT && ecs_is_aead_algorithm == CRYPTO_FALSE) // Non aead algorithm
     {
@@ -1360,10 +1503,10 @@ int32_t Crypto_TC_Do_Decrypt(uint8_t sa_service_type, uint8_t ecs_is_aead_algori
             status = Crypto_TC_Check_ACS_Keylen(akp, sa_ptr);
             if(status!= CRYPTO_LIB_SUCCESS)
             {
-                Crypto_TC_Safe_Free_Ptr(aad);
                 return status;
             }
 
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_validate_authentication(
                 tc_sdls_processed_frame->tc_pdu,               // plaintext output
                 (size_t)(tc_sdls_processed_frame->tc_pdu_len), // length of data
@@ -1382,18 +1525,19 @@ int32_t Crypto_TC_Do_Decrypt(uint8_t sa_service_type, uint8_t ecs_is_aead_algori
                 sa_ptr->acs,                                   // authentication cipher
                 cam_cookies                                    // 
             );
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         }
         if (sa_service_type == SA_ENCRYPTION || sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
         {
             // Check that key length to be used emets the algorithm requirement
             if ((int32_t)ekp->key_len != Crypto_Get_ECS_Algo_Keylen(sa_ptr->ecs))
             {
-                Crypto_TC_Safe_Free_Ptr(aad);
                 status = CRYPTO_LIB_ERR_KEY_LENGTH_ERROR; 
                 mc_if->mc_log(status);
                 return status;
             }
 
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_decrypt(
                 tc_sdls_processed_frame->tc_pdu,               // plaintext output
                 (size_t)(tc_sdls_processed_frame->tc_pdu_len), // length of data
@@ -1408,6 +1552,7 @@ int32_t Crypto_TC_Do_Decrypt(uint8_t sa_service_type, uint8_t ecs_is_aead_algori
                 &sa_ptr->acs,                                  // authentication cipher
                 cam_cookies                                    // 
             );
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
 
             // Handle Padding Removal
             if (sa_ptr->shplf_len != 0)
@@ -1503,6 +1648,12 @@ int32_t Crypto_TC_Prep_AAD(TC_t* tc_sdls_processed_frame, uint8_t fecf_len,  uin
             return status;
         }
         *aad = Crypto_Prepare_TC_AAD(ingest, aad_len_temp, sa_ptr->abm);
+        if (*aad == NULL)
+        {
+            status = CRYPTO_LIB_ERROR;
+            mc_if->mc_log(status);
+            return status;
+        }
         *aad_len = aad_len_temp;
         aad = aad;
     }
@@ -1521,8 +1672,10 @@ int32_t Crypto_TC_Prep_AAD(TC_t* tc_sdls_processed_frame, uint8_t fecf_len,  uin
 int32_t Crypto_TC_Get_Keys(crypto_key_t** ekp, crypto_key_t** akp, SecurityAssociation_t* sa_ptr)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
+    CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
     *ekp = key_if->get_key(sa_ptr->ekid);
     *akp = key_if->get_key(sa_ptr->akid);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
 
     if (ekp == NULL)
     {
@@ -1538,6 +1691,75 @@ int32_t Crypto_TC_Get_Keys(crypto_key_t** ekp, crypto_key_t** akp, SecurityAssoc
     return status;
 }
 
+/**
+ * @brief Function: Crypto_TC_ProcessSecurity_Batch
+ * Processes count ingested TC frames in order, as consecutive Crypto_TC_ProcessSecurity calls would.
+ * A run of consecutive frames on the same SPI looks up, locks and validates its SA once, and keeps the
+ * lock, so the anti-replay window is loaded once per run and every frame of the run is checked against
+ * it in memory. The resulting SA state is committed once per SA at the end of the batch instead of
+ * once per frame.
+ * @param ingest: uint8_t**
+ * @param len_ingest: int*, one length per frame
+ * @param tc_sdls_processed_frames: TC_t*, one processed frame per ingest frame
+ * @param count: uint32_t
+ * @param results: int32_t*, per-frame Success/Failure
+ * @return int32: Success, or the first failure encountered
+**/
+int32_t Crypto_TC_ProcessSecurity_Batch(uint8_t** ingest, int* len_ingest, TC_t* tc_sdls_processed_frames, uint32_t count, int32_t* results)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    int32_t frame_status = CRYPTO_LIB_SUCCESS;
+    uint32_t i = 0;
+
+    if ((ingest == NULL) || (len_ingest == NULL) || (tc_sdls_processed_frames == NULL) || (results == NULL))
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+
+    tc_batch_active = CRYPTO_TRUE;
+    tc_batch_dirty_count = 0;
+    tc_batch_sa = NULL;
+
+    for (i = 0; i < count; i++)
+    {
+        if (ingest[i] == NULL)
+        {
+            frame_status = CRYPTO_LIB_ERR_NULL_BUFFER;
+        }
+        else
+        {
+            frame_status = Crypto_TC_ProcessSecurity_Cam(ingest[i], &len_ingest[i], &tc_sdls_processed_frames[i], NULL);
+        }
+        results[i] = frame_status;
+        if ((frame_status != CRYPTO_LIB_SUCCESS) && (status == CRYPTO_LIB_SUCCESS))
+        {
+            status = frame_status;
+        }
+    }
+
+    tc_batch_active = CRYPTO_FALSE;
+    tc_batch_sa = NULL;
+
+    // Commit SA state once per SA touched
+    for (i = 0; i < tc_batch_dirty_count; i++)
+    {
+        Crypto_SA_Lock(tc_batch_dirty_sa[i]);
+        frame_status = Crypto_SA_Save(tc_batch_dirty_sa[i]);
+        if (frame_status != CRYPTO_LIB_SUCCESS)
+        {
+            mc_if->mc_log(frame_status);
+            if (status == CRYPTO_LIB_SUCCESS)
+            {
+                status = frame_status;
+            }
+        }
+    }
+    Crypto_SA_Unlock();
+    tc_batch_dirty_count = 0;
+
+    return status;
+}
+
 /** 
  * @brief Function: Crypto_TC_Check_IV_ARSN
  * Checks and validates Anti Replay
@@ -1560,24 +1782,20 @@ int32_t Crypto_TC_Check_IV_ARSN(SecurityAssociation_t* sa_ptr,TC_t* tc_sdls_proc
         if(status == CRYPTO_LIB_SUCCESS) // else
         {
             // Only save the SA (IV/ARSN) if checking the anti-replay counter; Otherwise we don't update.
-            status = sa_if->sa_save_sa(sa_ptr);
+            if (tc_batch_active == CRYPTO_TRUE)
+            {
+                status = crypto_tc_batch_defer_save(sa_ptr);
+            }
+            else
+            {
+                status = Crypto_SA_Save(sa_ptr);
+            }
             if (status != CRYPTO_LIB_SUCCESS)
             {
                 mc_if->mc_log(status);
             }
         } 
     }
-    else
-    {
-        if (crypto_config.sa_type == SA_TYPE_MARIADB)
-        {
-            if (sa_ptr->ek_ref[0] != '\0')
-                clean_ekref(sa_ptr);
-            if (sa_ptr->ak_ref[0] != '\0')
-                clean_akref(sa_ptr);
-            free(sa_ptr);
-        }
-    }
     return status;
 }
 
@@ -1592,17 +1810,35 @@ uint32_t Crypto_TC_Sanity_Validations(TC_t* tc_sdls_processed_frame, SecurityAss
 {
     uint32_t status = CRYPTO_LIB_SUCCESS;
 
+    // In a batch, a frame on the SA of the previous frame reuses it, as long as the lock was never given up
+    if (tc_batch_active == CRYPTO_TRUE && tc_batch_sa != NULL &&
+        tc_batch_sa->spi == tc_sdls_processed_frame->tc_sec_header.spi &&
+        Crypto_SA_Held_SPI() == tc_batch_sa->spi && Crypto_Mgmt_Epoch() == tc_batch_sa_epoch)
+    {
+        *sa_ptr = tc_batch_sa;
+        return status;
+    }
+    tc_batch_sa = NULL;
+
+    CRYPTO_STAGE_START(CRYPTO_STAGE_SA_LOOKUP);
     status = sa_if->sa_get_from_spi(tc_sdls_processed_frame->tc_sec_header.spi, sa_ptr);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_SA_LOOKUP);
     // If no valid SPI, return
     if(status == CRYPTO_LIB_SUCCESS)
     {
-        // Try to assure SA is sane
+        Crypto_SA_Lock(*sa_ptr);
+        // Try to assure SA is sane, under the lock as SA management may have stopped it since the lookup
         status = crypto_tc_validate_sa(*sa_ptr);
     }
     if(status != CRYPTO_LIB_SUCCESS)
     {
         mc_if->mc_log(status);
     }
+    else if (tc_batch_active == CRYPTO_TRUE)
+    {
+        tc_batch_sa = *sa_ptr;
+        tc_batch_sa_epoch = Crypto_Mgmt_Epoch();
+    }
 
     return status;
 }
@@ -1632,12 +1868,12 @@ void Crypto_TC_Get_Ciper_Mode_TCP(uint8_t sa_service_type, uint32_t* encryption_
  **/
 void Crypto_TC_Calc_Lengths(uint8_t* fecf_len, uint8_t* segment_hdr_len)
 {
-    if (current_managed_parameters_struct.has_fecf == TC_NO_FECF)
+    if (current_managed_parameters->has_fecf == TC_NO_FECF)
     {
         *fecf_len = 0;
     }
 
-    if (current_managed_parameters_struct.has_segmentation_hdr == TC_NO_SEGMENT_HDRS)
+    if (current_managed_parameters->has_segmentation_hdr == TC_NO_SEGMENT_HDRS)
     {
         *segment_hdr_len = 0;
     }
@@ -1653,7 +1889,7 @@ void Crypto_TC_Calc_Lengths(uint8_t* fecf_len, uint8_t* segment_hdr_len)
 void Crypto_TC_Set_Segment_Header(TC_t* tc_sdls_processed_frame, uint8_t* ingest, int* byte_idx)
 {
     int byte_idx_tmp = *byte_idx;
-    if (current_managed_parameters_struct.has_segmentation_hdr == TC_HAS_SEGMENT_HDRS)
+    if (current_managed_parameters->has_segmentation_hdr == TC_HAS_SEGMENT_HDRS)
     {
         tc_sdls_processed_frame->tc_sec_header.sh = (uint8_t)ingest[*byte_idx];
         byte_idx_tmp++;
@@ -1670,6 +1906,26 @@ void Crypto_TC_Set_Segment_Header(TC_t* tc_sdls_processed_frame, uint8_t* ingest
  * @return int32: Success/Failure
 **/
 int32_t Crypto_TC_ProcessSecurity_Cam(uint8_t* ingest, int* len_ingest, TC_t* tc_sdls_processed_frame, char* cam_cookies)
+{
+    int frame_len = (len_ingest != NULL) ? *len_ingest : 0;
+    int32_t status;
+
+    CRYPTO_PROBE(tc_process_entry, ingest, frame_len);
+    status = crypto_tc_process_security_cam(ingest, len_ingest, tc_sdls_processed_frame, cam_cookies);
+    Crypto_Metrics_Frame(TYPE_TC, CRYPTO_FALSE, ingest, (frame_len > 0) ? (uint32_t)frame_len : 0, status);
+    // A batch keeps the SA locked for the next frame, Crypto_TC_ProcessSecurity_Batch releases it
+    if (tc_batch_active != CRYPTO_TRUE)
+    {
+        Crypto_SA_Unlock();
+    }
+    return status;
+}
+
+/**
+ * @brief Function: crypto_tc_process_security_cam
+ * Body of Crypto_TC_ProcessSecurity_Cam, runs with the frame's SA lock held once the SA is known
+ **/
+static int32_t crypto_tc_process_security_cam(uint8_t* ingest, int* len_ingest, TC_t* tc_sdls_processed_frame, char* cam_cookies)
 // Loads the ingest frame into the global tc_frame while performing decryption
 {
     // Local Variables
@@ -1686,6 +1942,7 @@ int32_t Crypto_TC_ProcessSecurity_Cam(uint8_t* ingest, int* len_ingest, TC_t* tc
 
     int byte_idx = 0;
 
+    Crypto_Arena_Reset();
     status = Crypto_TC_Process_Sanity_Check(len_ingest);
     if (status != CRYPTO_LIB_SUCCESS)
     {
@@ -1717,9 +1974,9 @@ int32_t Crypto_TC_ProcessSecurity_Cam(uint8_t* ingest, int* len_ingest, TC_t* tc
     }
 
     // Lookup-retrieve managed parameters for frame via gvcid:
-    status = Crypto_Get_Managed_Parameters_For_Gvcid(
+    status = Crypto_Get_Managed_Parameters_Ptr(
         tc_sdls_processed_frame->tc_header.tfvn, tc_sdls_processed_frame->tc_header.scid,
-        tc_sdls_processed_frame->tc_header.vcid, gvcid_managed_parameters_array, &current_managed_parameters_struct);
+        tc_sdls_processed_frame->tc_header.vcid, &current_managed_parameters);
 
     if (status != CRYPTO_LIB_SUCCESS)
     {
@@ -1869,7 +2126,6 @@ int32_t Crypto_TC_ProcessSecurity_Cam(uint8_t* ingest, int* len_ingest, TC_t* tc
     status = Crypto_TC_Do_Decrypt(sa_service_type, ecs_is_aead_algorithm, ekp, sa_ptr, aad, tc_sdls_processed_frame, ingest, tc_enc_payload_start_index, aad_len, cam_cookies, akp, segment_hdr_len);
     if (status != CRYPTO_LIB_SUCCESS)
     {
-        Crypto_TC_Safe_Free_Ptr(aad);
         mc_if->mc_log(status);
         return status; // Cryptography IF call failed, return.
     }
@@ -1878,7 +2134,6 @@ int32_t Crypto_TC_ProcessSecurity_Cam(uint8_t* ingest, int* len_ingest, TC_t* tc
     status = Crypto_TC_Check_IV_ARSN(sa_ptr, tc_sdls_processed_frame);
     if (status != CRYPTO_LIB_SUCCESS)
     {
-        Crypto_TC_Safe_Free_Ptr(aad);
         mc_if->mc_log(status);
         return status; // Cryptography IF call failed, return.
     }
@@ -1888,8 +2143,6 @@ int32_t Crypto_TC_ProcessSecurity_Cam(uint8_t* ingest, int* len_ingest, TC_t* tc
     {
         status = Crypto_Process_Extended_Procedure_Pdu(tc_sdls_processed_frame, ingest);
     }
-    
-    Crypto_TC_Safe_Free_Ptr(aad);
 
     mc_if->mc_log(status);
     return status;
@@ -1906,8 +2159,8 @@ int32_t Crypto_TC_ProcessSecurity_Cam(uint8_t* ingest, int* len_ingest, TC_t* tc
 int32_t Crypto_Get_tcPayloadLength(TC_t* tc_frame, SecurityAssociation_t* sa_ptr)
 {
     int tf_hdr = 5;
-    int seg_hdr = 0;if(current_managed_parameters_struct.has_segmentation_hdr==TC_HAS_SEGMENT_HDRS){seg_hdr=1;}
-    int fecf = 0;if(current_managed_parameters_struct.has_fecf==TC_HAS_FECF){fecf=FECF_SIZE;}
+    int seg_hdr = 0;if(current_managed_parameters->has_segmentation_hdr==TC_HAS_SEGMENT_HDRS){seg_hdr=1;}
+    int fecf = 0;if(current_managed_parameters->has_fecf==TC_HAS_FECF){fecf=FECF_SIZE;}
     int spi = 2;
     int iv_size = sa_ptr->shivf_len;
     int mac_size = sa_ptr->stmacf_len;
@@ -1930,22 +2183,27 @@ fecf))); #endif
 
 /**
  * @brief Function: Crypto_Prepare_TC_AAD
- * Callocs and returns pointer to buffer where AAD is created & bitwise-anded with bitmask!
- * Note: Function caller is responsible for freeing the returned buffer!
+ * Returns pointer to buffer where AAD is created & bitwise-anded with bitmask!
+ * Note: The buffer comes from the frame arena and is only valid until the next frame on this thread; do not free it.
  * @param buffer: uint8_t*
  * @param len_aad: uint16_t
  * @param abm_buffer: uint8_t*
+ * @return uint8_t*: AAD, NULL if the arena is exhausted
 **/
 uint8_t* Crypto_Prepare_TC_AAD(uint8_t* buffer, uint16_t len_aad, uint8_t* abm_buffer)
 {
-    uint8_t* aad = (uint8_t*)calloc(1, len_aad * sizeof(uint8_t));
+    uint8_t* aad = Crypto_Arena_Alloc(len_aad);
+#ifdef MAC_DEBUG
     int i;
+#endif
 
-    for (i = 0; i < len_aad; i++)
+    if (aad == NULL)
     {
-        aad[i] = buffer[i] & abm_buffer[i];
+        return NULL;
     }
 
+    Crypto_Apply_ABM(buffer, len_aad, abm_buffer, aad);
+
 #ifdef MAC_DEBUG
     printf(KYEL "AAD before ABM Bitmask:\n\t");
     for (i = 0; i < len_aad; i++)
@@ -2019,7 +2277,11 @@ static int32_t crypto_handle_incrementing_nontransmitted_counter(uint8_t* dest,
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
     // Copy IV to temp
-    uint8_t* temp_counter = malloc(src_full_len);
+    uint8_t* temp_counter = Crypto_Arena_Alloc(src_full_len);
+    if (temp_counter == NULL)
+    {
+        return CRYPTO_LIB_ERROR;
+    }
     memcpy(temp_counter, src, src_full_len);
 
     // Increment temp_counter Until Transmitted Portion Matches Frame.
@@ -2060,6 +2322,30 @@ static int32_t crypto_handle_incrementing_nontransmitted_counter(uint8_t* dest,
     {
         status = CRYPTO_LIB_ERR_FRAME_COUNTER_DOESNT_MATCH_SA;
     }
-    if (!temp_counter) free(temp_counter);
     return status;
 }
+
+/**
+ * @brief Function: crypto_tc_batch_defer_save
+ * Records an SA for saving at the end of the current batch.
+ * @param sa_ptr: SecurityAssociation_t*
+ * @return int32: Success/Failure
+ **/
+static int32_t crypto_tc_batch_defer_save(SecurityAssociation_t* sa_ptr)
+{
+    uint16_t i;
+
+    for (i = 0; i < tc_batch_dirty_count; i++)
+    {
+        if (tc_batch_dirty_sa[i] == sa_ptr)
+        {
+            return CRYPTO_LIB_SUCCESS;
+        }
+    }
+    if (tc_batch_dirty_count < NUM_SA)
+    {
+        tc_batch_dirty_sa[tc_batch_dirty_count++] = sa_ptr;
+        return CRYPTO_LIB_SUCCESS;
+    }
+    return Crypto_SA_Save(sa_ptr);
+}
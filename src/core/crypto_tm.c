@@ -23,6 +23,14 @@
 
 #include <string.h> // memcpy/memset
 
+/*
+** Static Functions
+*/
+static int32_t crypto_tm_apply_security(uint8_t* pTfBuffer);
+static int32_t crypto_tm_apply_security_batch(uint8_t** frames, uint32_t count, int32_t* results);
+static int32_t crypto_tm_process_security(uint8_t* p_ingest, uint16_t len_ingest, uint8_t* p_out, uint16_t* p_pdu_offset,
+                                          uint16_t* p_pdu_len, uint8_t** pp_processed_frame, uint16_t* p_decrypted_length);
+
 /**
  * @brief Function: Crypto_TM_Sanity_Check
  * Verify that needed buffers and settings are not null
@@ -214,11 +222,11 @@ void Crypto_TM_PKCS_Padding(uint32_t* pkcs_padding, SecurityAssociation_t* sa_pt
 **/
 void Crypto_TM_Handle_Managed_Parameter_Flags(uint16_t* pdu_len)
 {
-    if(current_managed_parameters_struct.has_ocf == TM_HAS_OCF)
+    if(current_managed_parameters->has_ocf == TM_HAS_OCF)
     {
         *pdu_len -= 4;
     }
-    if(current_managed_parameters_struct.has_fecf == TM_HAS_FECF)
+    if(current_managed_parameters->has_fecf == TM_HAS_FECF)
     {
         *pdu_len -= 2;
     }
@@ -236,14 +244,18 @@ int32_t Crypto_TM_Get_Keys(crypto_key_t** ekp, crypto_key_t** akp, SecurityAssoc
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
     printf("getting key for ekid %d\n", sa_ptr->ekid);
+    CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
     *ekp = key_if->get_key(sa_ptr->ekid);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
     if (ekp == NULL)
     {
         status = CRYPTO_LIB_ERR_KEY_ID_ERROR;
         mc_if->mc_log(status);
     }
     
+    CRYPTO_STAGE_START(CRYPTO_STAGE_KEY_FETCH);
     *akp = key_if->get_key(sa_ptr->akid);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_KEY_FETCH);
     printf("getting key for akid %d\n", sa_ptr->akid);
     if (akp == NULL && status == CRYPTO_LIB_SUCCESS)
     {
@@ -336,6 +348,7 @@ int32_t Crypto_TM_Do_Encrypt_NONPLAINTEXT_AEAD_Logic(uint8_t sa_service_type, ui
     {
         if(sa_service_type == SA_ENCRYPTION)
         {
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_encrypt(//Stub out data in/out as this is done in place and want to save cycles
                                                         (uint8_t*)(&pTfBuffer[data_loc]), // ciphertext output
                                                         (size_t) pdu_len, // length of data
@@ -349,10 +362,12 @@ int32_t Crypto_TM_Do_Encrypt_NONPLAINTEXT_AEAD_Logic(uint8_t sa_service_type, ui
                                                         &sa_ptr->ecs, // encryption cipher
                                                         pkcs_padding,  // authentication cipher
                                                         NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         } 
         if(sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
         {
-            status = cryptography_if->cryptography_aead_encrypt((uint8_t*)(&pTfBuffer[data_loc]), // ciphertext output
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
+            status = Crypto_Async_AEAD_Encrypt((uint8_t*)(&pTfBuffer[data_loc]), // ciphertext output
                                                                 (size_t) pdu_len,  // length of data
                                                                 (uint8_t*)(&pTfBuffer[data_loc]), // plaintext input
                                                                 (size_t) pdu_len, // in data length
@@ -371,6 +386,7 @@ int32_t Crypto_TM_Do_Encrypt_NONPLAINTEXT_AEAD_Logic(uint8_t sa_service_type, ui
                                                                 &sa_ptr->ecs, // encryption cipher
                                                                 &sa_ptr->acs,  // authentication cipher
                                                                 NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         }
     }
 
@@ -379,6 +395,7 @@ int32_t Crypto_TM_Do_Encrypt_NONPLAINTEXT_AEAD_Logic(uint8_t sa_service_type, ui
         // TODO - implement non-AEAD algorithm logic
         if(sa_service_type == SA_AUTHENTICATION)
         {
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_authenticate(//Stub out data in/out as this is done in place and want to save cycles
                                                                 (uint8_t*)(&pTfBuffer[0]), // ciphertext output
                                                                 (size_t) 0, // length of data
@@ -396,11 +413,13 @@ int32_t Crypto_TM_Do_Encrypt_NONPLAINTEXT_AEAD_Logic(uint8_t sa_service_type, ui
                                                                 sa_ptr->ecs, // encryption cipher
                                                                 sa_ptr->acs,  // authentication cipher
                                                                 NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         }
         else if(sa_service_type == SA_ENCRYPTION || sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
         {
             if (sa_service_type == SA_ENCRYPTION)
                 {
+                    CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
                     status = cryptography_if->cryptography_encrypt(//Stub out data in/out as this is done in place and want to save cycles
                                                                 (uint8_t*)(&pTfBuffer[data_loc]), // ciphertext output
                                                                 (size_t) pdu_len, // length of data
@@ -414,6 +433,7 @@ int32_t Crypto_TM_Do_Encrypt_NONPLAINTEXT_AEAD_Logic(uint8_t sa_service_type, ui
                                                                 &sa_ptr->ecs, // encryption cipher
                                                                 pkcs_padding,  // authentication cipher
                                                                 NULL);
+                    CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
             }
         }
         else if(sa_service_type == SA_PLAINTEXT)
@@ -562,28 +582,32 @@ int32_t Crypto_TM_Do_Encrypt(uint8_t sa_service_type, SecurityAssociation_t* sa_
          **/
 
         // Only calculate & insert FECF if CryptoLib is configured to do so & gvcid includes FECF.
-        if (current_managed_parameters_struct.has_fecf == TM_HAS_FECF)
+        if (current_managed_parameters->has_fecf == TM_HAS_FECF)
         {
 #ifdef FECF_DEBUG
-            printf(KCYN "Calcing FECF over %d bytes\n" RESET, current_managed_parameters_struct.max_frame_size - 2);
+            printf(KCYN "Calcing FECF over %d bytes\n" RESET, current_managed_parameters->max_frame_size - 2);
 #endif
             if (crypto_config.crypto_create_fecf == CRYPTO_TM_CREATE_FECF_TRUE)
             {
-                *new_fecf = Crypto_Calc_FECF((uint8_t*)pTfBuffer, current_managed_parameters_struct.max_frame_size - 2);
-                pTfBuffer[current_managed_parameters_struct.max_frame_size - 2] = (uint8_t)((*new_fecf & 0xFF00) >> 8);
-                pTfBuffer[current_managed_parameters_struct.max_frame_size - 1] = (uint8_t)(*new_fecf & 0x00FF);
+                // While the ciphertext is still in flight, Crypto_Async_Poll inserts the FECF
+                if (Crypto_Async_Defer_FECF(current_managed_parameters->max_frame_size - 2) == CRYPTO_FALSE)
+                {
+                    *new_fecf = Crypto_Calc_FECF((uint8_t*)pTfBuffer, current_managed_parameters->max_frame_size - 2);
+                    pTfBuffer[current_managed_parameters->max_frame_size - 2] = (uint8_t)((*new_fecf & 0xFF00) >> 8);
+                    pTfBuffer[current_managed_parameters->max_frame_size - 1] = (uint8_t)(*new_fecf & 0x00FF);
+                }
             }
             else // CRYPTO_TC_CREATE_FECF_FALSE
             {
-                pTfBuffer[current_managed_parameters_struct.max_frame_size - 2] = (uint8_t)0x00;
-                pTfBuffer[current_managed_parameters_struct.max_frame_size - 1] = (uint8_t)0x00;
+                pTfBuffer[current_managed_parameters->max_frame_size - 2] = (uint8_t)0x00;
+                pTfBuffer[current_managed_parameters->max_frame_size - 1] = (uint8_t)0x00;
             }
             idx += 2;
         }
 
 #ifdef TM_DEBUG
         printf(KYEL "Printing new TM frame:\n\t");
-        for(int i = 0; i < current_managed_parameters_struct.max_frame_size; i++)
+        for(int i = 0; i < current_managed_parameters->max_frame_size; i++)
         {
             printf("%02X", pTfBuffer[i]);
         }
@@ -592,12 +616,6 @@ int32_t Crypto_TM_Do_Encrypt(uint8_t sa_service_type, SecurityAssociation_t* sa_
     }
     if (status == CRYPTO_LIB_SUCCESS)
     {
-        status = sa_if->sa_save_sa(sa_ptr);
-
-#ifdef DEBUG
-        printf(KYEL "----- Crypto_TM_ApplySecurity END -----\n" RESET);
-#endif
-
         *idx_p = idx;
     }
     return status;
@@ -623,42 +641,34 @@ void Crypto_TM_ApplySecurity_Debug_Print(uint16_t idx, uint16_t pdu_len, Securit
     printf(KYEL "Data location starts at: %d\n" RESET, idx);
     printf(KYEL "Data size is: %d\n" RESET, pdu_len);
     printf(KYEL "Index at end of SPI is: %d\n", idx);
-    if(current_managed_parameters_struct.has_ocf == TM_HAS_OCF)
+    if(current_managed_parameters->has_ocf == TM_HAS_OCF)
     {
         // If OCF exists, comes immediately after MAC
         printf(KYEL "OCF Location is: %d\n" RESET, idx + pdu_len + sa_ptr->stmacf_len);
     }
-    if(current_managed_parameters_struct.has_fecf == TM_HAS_FECF)
+    if(current_managed_parameters->has_fecf == TM_HAS_FECF)
     {
         // If FECF exists, comes just before end of the frame
-        printf(KYEL "FECF Location is: %d\n" RESET, current_managed_parameters_struct.max_frame_size - 2);
+        printf(KYEL "FECF Location is: %d\n" RESET, current_managed_parameters->max_frame_size - 2);
     }
 #endif
 }
 
 /**
- * @brief Function: Crypto_TM_ApplySecurity
- * @param ingest: uint8_t*
- * @param len_ingest: int*
- * @return int32: Success/Failure
- * 
- * The TM ApplySecurity Payload shall consist of the portion of the TM Transfer Frame (see
- * reference [1]) from the first octet of the Transfer Frame Primary Header to the last octet of
- * the Transfer Frame Data Field. 
- * NOTES
- * 1 The TM Transfer Frame is the fixed-length protocol data unit of the TM Space Data
- * Link Protocol. The length of any Transfer Frame transferred on a physical channel is
- * constant, and is established by management.
- * 2 The portion of the TM Transfer Frame contained in the TM ApplySecurity Payload
- * parameter includes the Security Header field. When the ApplySecurity Function is
- * called, the Security Header field is empty; i.e., the caller has not set any values in the
- * Security Header
-   **/
-int32_t Crypto_TM_ApplySecurity(uint8_t* pTfBuffer)
+ * @brief Function: Crypto_TM_ApplySecurity_Frame
+ * Applies security to a single TM frame once its SA, keys, and managed parameters are resolved.
+ * Does not persist the SA, callers save it once they are done with the SA.
+ * @param pTfBuffer: uint8_t*
+ * @param sa_ptr: SecurityAssociation_t*
+ * @param ekp: crypto_key_t*
+ * @param akp: crypto_key_t*
+ * @param aad: uint8_t*
+ * @return int32_t: Success/Failure
+**/
+int32_t Crypto_TM_ApplySecurity_Frame(uint8_t* pTfBuffer, SecurityAssociation_t* sa_ptr, crypto_key_t* ekp, crypto_key_t* akp, uint8_t* aad)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
     int mac_loc = 0;
-    uint8_t aad[1786];
     uint16_t aad_len = 0;
     int i = 0;
     uint16_t data_loc;
@@ -668,73 +678,6 @@ int32_t Crypto_TM_ApplySecurity(uint8_t* pTfBuffer)
     uint32_t pkcs_padding = 0;
     uint16_t new_fecf = 0x0000;
     uint8_t ecs_is_aead_algorithm;
-    SecurityAssociation_t* sa_ptr = NULL;
-    uint8_t tfvn = 0;
-    uint16_t scid = 0; 
-    uint16_t vcid = 0;
-
-    status = Crypto_TM_Sanity_Check(pTfBuffer);
-    if(status != CRYPTO_LIB_SUCCESS)
-    {
-        return status;
-    }
-
-    tfvn = ((uint8_t)pTfBuffer[0] & 0xC0) >> 6;
-    scid = (((uint16_t)pTfBuffer[0] & 0x3F) << 4) | (((uint16_t)pTfBuffer[1] & 0xF0) >> 4);
-    vcid =  ((uint8_t) pTfBuffer[1] & 0x0E) >> 1;
-
-#ifdef TM_DEBUG
-    printf(KYEL "\n----- Crypto_TM_ApplySecurity START -----\n" RESET);
-    printf("The following GVCID parameters will be used:\n");
-    printf("\tTVFN: 0x%04X\t", tfvn);
-    printf("\tSCID: 0x%04X", scid);
-    printf("\tVCID: 0x%04X",vcid);
-    printf("\tMAP: %d\n", 0);
-    printf("\tPriHdr as follows:\n\t\t");
-    for (int i =0; i<6; i++)
-    {
-        printf("%02X", (uint8_t)pTfBuffer[i]);
-    }
-    printf("\n");
-#endif
-
-    status = sa_if->sa_get_operational_sa_from_gvcid(tfvn, scid, vcid, 0, &sa_ptr);
-
-    // No operational/valid SA found
-    if (status != CRYPTO_LIB_SUCCESS)
-    {
-#ifdef TM_DEBUG
-        printf(KRED "Error: Could not retrieve an SA!\n" RESET);
-#endif
-        mc_if->mc_log(status);
-        return status;
-    }
-
-    status = Crypto_Get_Managed_Parameters_For_Gvcid(tfvn, scid, vcid, gvcid_managed_parameters_array, &current_managed_parameters_struct);
-
-    // No managed parameters found
-    if (status != CRYPTO_LIB_SUCCESS)
-    {
-#ifdef TM_DEBUG
-        printf(KRED "Error: No managed parameters found!\n" RESET);
-#endif
-        mc_if->mc_log(status);
-        return status;
-    }
-
- #ifdef TM_DEBUG
-    printf(KYEL "TM BEFORE Apply Sec:\n\t" RESET);
-    for (int16_t i =0; i < current_managed_parameters_struct.max_frame_size; i++)
-    {
-        printf("%02X", pTfBuffer[i]);
-    }
-    printf("\n");
-#endif
-
-#ifdef SA_DEBUG
-    printf(KYEL "DEBUG - Printing SA Entry for current frame.\n" RESET);
-    Crypto_saPrint(sa_ptr);
-#endif
 
     // Determine SA Service Type
     status = Crypto_TM_Determine_SA_Service_Type(&sa_service_type, sa_ptr);
@@ -802,8 +745,8 @@ int32_t Crypto_TM_ApplySecurity(uint8_t* pTfBuffer)
      **/
     for (i = sa_ptr->arsn_len - sa_ptr->shsnf_len; i < sa_ptr->arsn_len; i++)
     {
-        // Copy in ARSN from SA
-        pTfBuffer[idx] = *(sa_ptr->arsn + i);
+        // Copy in ARSN from SA, zero filling an SN field wider than the ARSN
+        pTfBuffer[idx] = (i >= 0) ? *(sa_ptr->arsn + i) : 0;
         idx++;
     }
 
@@ -842,11 +785,129 @@ int32_t Crypto_TM_ApplySecurity(uint8_t* pTfBuffer)
      **/
     data_loc = idx;
     // Calculate size of data to be encrypted
-    pdu_len = current_managed_parameters_struct.max_frame_size - idx - sa_ptr->stmacf_len;
+    pdu_len = current_managed_parameters->max_frame_size - idx - sa_ptr->stmacf_len;
     // Check other managed parameter flags, subtract their lengths from data field if present
     Crypto_TM_Handle_Managed_Parameter_Flags(&pdu_len);
     Crypto_TM_ApplySecurity_Debug_Print(idx, pdu_len, sa_ptr);
 
+    status = Crypto_TM_Do_Encrypt(sa_service_type, sa_ptr, &aad_len, &mac_loc, &idx, pdu_len, pTfBuffer, aad, ecs_is_aead_algorithm, data_loc, ekp, akp, pkcs_padding, &new_fecf);
+    return status;
+
+}
+
+/**
+ * @brief Function: Crypto_TM_ApplySecurity
+ * @param ingest: uint8_t*
+ * @param len_ingest: int*
+ * @return int32: Success/Failure
+ * 
+ * The TM ApplySecurity Payload shall consist of the portion of the TM Transfer Frame (see
+ * reference [1]) from the first octet of the Transfer Frame Primary Header to the last octet of
+ * the Transfer Frame Data Field. 
+ * NOTES
+ * 1 The TM Transfer Frame is the fixed-length protocol data unit of the TM Space Data
+ * Link Protocol. The length of any Transfer Frame transferred on a physical channel is
+ * constant, and is established by management.
+ * 2 The portion of the TM Transfer Frame contained in the TM ApplySecurity Payload
+ * parameter includes the Security Header field. When the ApplySecurity Function is
+ * called, the Security Header field is empty; i.e., the caller has not set any values in the
+ * Security Header
+   **/
+int32_t Crypto_TM_ApplySecurity(uint8_t* pTfBuffer)
+{
+    int32_t status;
+
+    CRYPTO_PROBE(tm_apply_entry, pTfBuffer, 0);
+    status = crypto_tm_apply_security(pTfBuffer);
+    Crypto_Metrics_Frame(TYPE_TM, CRYPTO_TRUE, pTfBuffer, 0, status);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: crypto_tm_apply_security
+ * Body of Crypto_TM_ApplySecurity, runs with the frame's SA lock held once the SA is known
+ **/
+static int32_t crypto_tm_apply_security(uint8_t* pTfBuffer)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    uint8_t aad[1786];
+    SecurityAssociation_t* sa_ptr = NULL;
+    uint8_t tfvn = 0;
+    uint16_t scid = 0; 
+    uint16_t vcid = 0;
+
+    status = Crypto_TM_Sanity_Check(pTfBuffer);
+    if(status != CRYPTO_LIB_SUCCESS)
+    {
+        return status;
+    }
+
+    tfvn = ((uint8_t)pTfBuffer[0] & 0xC0) >> 6;
+    scid = (((uint16_t)pTfBuffer[0] & 0x3F) << 4) | (((uint16_t)pTfBuffer[1] & 0xF0) >> 4);
+    vcid =  ((uint8_t) pTfBuffer[1] & 0x0E) >> 1;
+
+#ifdef TM_DEBUG
+    printf(KYEL "\n----- Crypto_TM_ApplySecurity START -----\n" RESET);
+    printf("The following GVCID parameters will be used:\n");
+    printf("\tTVFN: 0x%04X\t", tfvn);
+    printf("\tSCID: 0x%04X", scid);
+    printf("\tVCID: 0x%04X",vcid);
+    printf("\tMAP: %d\n", 0);
+    printf("\tPriHdr as follows:\n\t\t");
+    for (int i =0; i<6; i++)
+    {
+        printf("%02X", (uint8_t)pTfBuffer[i]);
+    }
+    printf("\n");
+#endif
+
+    CRYPTO_STAGE_START(CRYPTO_STAGE_SA_LOOKUP);
+    status = sa_if->sa_get_operational_sa_from_gvcid(tfvn, scid, vcid, 0, &sa_ptr);
+    CRYPTO_STAGE_STOP(CRYPTO_STAGE_SA_LOOKUP);
+
+    // No operational/valid SA found
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+#ifdef TM_DEBUG
+        printf(KRED "Error: Could not retrieve an SA!\n" RESET);
+#endif
+        mc_if->mc_log(status);
+        return status;
+    }
+    status = Crypto_SA_Lock_GVCID(sa_ptr, tfvn, scid, vcid, 0);
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        mc_if->mc_log(status);
+        return status;
+    }
+
+    status = Crypto_Get_Managed_Parameters_Ptr(tfvn, scid, vcid, &current_managed_parameters);
+
+    // No managed parameters found
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+#ifdef TM_DEBUG
+        printf(KRED "Error: No managed parameters found!\n" RESET);
+#endif
+        mc_if->mc_log(status);
+        return status;
+    }
+
+ #ifdef TM_DEBUG
+    printf(KYEL "TM BEFORE Apply Sec:\n\t" RESET);
+    for (int16_t i =0; i < current_managed_parameters->max_frame_size; i++)
+    {
+        printf("%02X", pTfBuffer[i]);
+    }
+    printf("\n");
+#endif
+
+#ifdef SA_DEBUG
+    printf(KYEL "DEBUG - Printing SA Entry for current frame.\n" RESET);
+    Crypto_saPrint(sa_ptr);
+#endif
+
     // Get Key
     crypto_key_t* ekp = NULL;
     crypto_key_t* akp = NULL;
@@ -856,16 +917,162 @@ int32_t Crypto_TM_ApplySecurity(uint8_t* pTfBuffer)
         return status;
     }
 
-    status = Crypto_TM_Do_Encrypt(sa_service_type, sa_ptr, &aad_len, &mac_loc, &idx, pdu_len, pTfBuffer, aad, ecs_is_aead_algorithm, data_loc, ekp, akp, pkcs_padding, &new_fecf);
+    status = Crypto_TM_ApplySecurity_Frame(pTfBuffer, sa_ptr, ekp, akp, aad);
     if(status != CRYPTO_LIB_SUCCESS)
     {
         return status;
     }
 
+    status = Crypto_SA_Save(sa_ptr);
+
+#ifdef DEBUG
+    printf(KYEL "----- Crypto_TM_ApplySecurity END -----\n" RESET);
+#endif
+
     mc_if->mc_log(status);
     return status;
 }
 
+/**
+ * @brief Function: Crypto_TM_ApplySecurity_Batch
+ * Applies security to count TM frames in place. Consecutive frames on the same GVCID form a run:
+ * the SA, keys, and managed parameters are resolved once for the run and the SA is saved once
+ * when the run ends, rather than once per frame.
+ * @param frames: uint8_t**
+ * @param count: uint32_t
+ * @param results: int32_t*, per-frame Success/Failure
+ * @return int32: Success, or the first failure encountered
+**/
+int32_t Crypto_TM_ApplySecurity_Batch(uint8_t** frames, uint32_t count, int32_t* results)
+{
+    int32_t status = crypto_tm_apply_security_batch(frames, count, results);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: crypto_tm_apply_security_batch
+ * Body of Crypto_TM_ApplySecurity_Batch, runs with the frame's SA lock held once the SA is known
+ **/
+static int32_t crypto_tm_apply_security_batch(uint8_t** frames, uint32_t count, int32_t* results)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    int32_t frame_status = CRYPTO_LIB_SUCCESS;
+    int32_t save_status = CRYPTO_LIB_SUCCESS;
+    uint8_t aad[1786];
+    SecurityAssociation_t* sa_ptr = NULL;
+    crypto_key_t* ekp = NULL;
+    crypto_key_t* akp = NULL;
+    uint8_t run_valid = CRYPTO_FALSE;
+    uint8_t run_dirty = CRYPTO_FALSE;
+    uint32_t run_last = 0;
+    uint8_t tfvn = 0;
+    uint16_t scid = 0;
+    uint16_t vcid = 0;
+    uint32_t i = 0;
+
+    if ((frames == NULL) || (results == NULL))
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        CRYPTO_PROBE(tm_apply_entry, frames[i], 0);
+        frame_status = Crypto_TM_Sanity_Check(frames[i]);
+        if (frame_status == CRYPTO_LIB_SUCCESS)
+        {
+            // A new GVCID closes the current run
+            if ((run_valid == CRYPTO_TRUE) &&
+                ((tfvn != (((uint8_t)frames[i][0] & 0xC0) >> 6)) ||
+                 (scid != ((((uint16_t)frames[i][0] & 0x3F) << 4) | (((uint16_t)frames[i][1] & 0xF0) >> 4))) ||
+                 (vcid != (((uint8_t)frames[i][1] & 0x0E) >> 1))))
+            {
+                run_valid = CRYPTO_FALSE;
+                if (run_dirty == CRYPTO_TRUE)
+                {
+                    run_dirty = CRYPTO_FALSE;
+                    // A failed save belongs to the run being closed, not to the frame that closed it
+                    save_status = Crypto_SA_Save(sa_ptr);
+                    if (save_status != CRYPTO_LIB_SUCCESS)
+                    {
+                        results[run_last] = save_status;
+                        if (status == CRYPTO_LIB_SUCCESS)
+                        {
+                            status = save_status;
+                        }
+                    }
+                }
+            }
+        }
+
+        if ((frame_status == CRYPTO_LIB_SUCCESS) && (run_valid == CRYPTO_FALSE))
+        {
+            tfvn = ((uint8_t)frames[i][0] & 0xC0) >> 6;
+            scid = (((uint16_t)frames[i][0] & 0x3F) << 4) | (((uint16_t)frames[i][1] & 0xF0) >> 4);
+            vcid = ((uint8_t)frames[i][1] & 0x0E) >> 1;
+
+            CRYPTO_STAGE_START(CRYPTO_STAGE_SA_LOOKUP);
+            frame_status = sa_if->sa_get_operational_sa_from_gvcid(tfvn, scid, vcid, 0, &sa_ptr);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_SA_LOOKUP);
+            if (frame_status == CRYPTO_LIB_SUCCESS)
+            {
+                frame_status = Crypto_SA_Lock_GVCID(sa_ptr, tfvn, scid, vcid, 0);
+            }
+            if (frame_status == CRYPTO_LIB_SUCCESS)
+            {
+                frame_status = Crypto_Get_Managed_Parameters_Ptr(tfvn, scid, vcid, &current_managed_parameters);
+            }
+            if (frame_status == CRYPTO_LIB_SUCCESS)
+            {
+                frame_status = Crypto_TM_Get_Keys(&ekp, &akp, sa_ptr);
+            }
+            if (frame_status == CRYPTO_LIB_SUCCESS)
+            {
+                run_valid = CRYPTO_TRUE;
+            }
+        }
+
+        if (frame_status == CRYPTO_LIB_SUCCESS)
+        {
+            frame_status = Crypto_TM_ApplySecurity_Frame(frames[i], sa_ptr, ekp, akp, aad);
+            if (frame_status == CRYPTO_LIB_SUCCESS)
+            {
+                run_dirty = CRYPTO_TRUE;
+                run_last = i;
+            }
+        }
+
+        results[i] = frame_status;
+        Crypto_Metrics_Frame(TYPE_TM, CRYPTO_TRUE, frames[i], 0, frame_status);
+        if (frame_status != CRYPTO_LIB_SUCCESS)
+        {
+            if (mc_if != NULL)
+            {
+                mc_if->mc_log(frame_status);
+            }
+            if (status == CRYPTO_LIB_SUCCESS)
+            {
+                status = frame_status;
+            }
+        }
+    }
+
+    if (run_dirty == CRYPTO_TRUE)
+    {
+        save_status = Crypto_SA_Save(sa_ptr);
+        if (save_status != CRYPTO_LIB_SUCCESS)
+        {
+            results[run_last] = save_status;
+            if (status == CRYPTO_LIB_SUCCESS)
+            {
+                status = save_status;
+            }
+        }
+    }
+    return status;
+}
+
 /** Preserving for now
     // Check for idle frame trigger
     if (((uint8_t)ingest[0] == 0x08) && ((uint8_t)ingest[1] == 0x90))
@@ -1162,9 +1369,9 @@ int32_t Crypto_TM_Process_Setup(uint16_t len_ingest, uint16_t* byte_idx, uint8_t
     // Lookup-retrieve managed parameters for frame via gvcid:
     if (status == CRYPTO_LIB_SUCCESS)
     {
-        status = Crypto_Get_Managed_Parameters_For_Gvcid(
+        status = Crypto_Get_Managed_Parameters_Ptr(
         tm_frame_pri_hdr.tfvn, tm_frame_pri_hdr.scid, tm_frame_pri_hdr.vcid, 
-        gvcid_managed_parameters_array, &current_managed_parameters_struct);
+        &current_managed_parameters);
     }
     
     if (status != CRYPTO_LIB_SUCCESS)
@@ -1265,10 +1472,10 @@ int32_t Crypto_TM_FECF_Setup(uint8_t* p_ingest, uint16_t len_ingest)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
 
-    if (current_managed_parameters_struct.has_fecf == TM_HAS_FECF)
+    if (current_managed_parameters->has_fecf == TM_HAS_FECF)
     {
-        uint16_t received_fecf = (((p_ingest[current_managed_parameters_struct.max_frame_size - 2] << 8) & 0xFF00) |
-                                                        (p_ingest[current_managed_parameters_struct.max_frame_size - 1] & 0x00FF));
+        uint16_t received_fecf = (((p_ingest[current_managed_parameters->max_frame_size - 2] << 8) & 0xFF00) |
+                                                        (p_ingest[current_managed_parameters->max_frame_size - 1] & 0x00FF));
 
         if (crypto_config.crypto_check_fecf == TM_CHECK_FECF_TRUE)
         {
@@ -1297,12 +1504,12 @@ int32_t Crypto_TM_FECF_Setup(uint8_t* p_ingest, uint16_t len_ingest)
         }
     }
     // Needs to be TM_HAS_FECF (checked above_ or TM_NO_FECF)
-    else if (current_managed_parameters_struct.has_fecf != TM_NO_FECF)
+    else if (current_managed_parameters->has_fecf != TM_NO_FECF)
     {
 #ifdef TM_DEBUG
         printf(KRED "TM_Process Error...tfvn: %d scid: 0x%04X vcid: 0x%02X fecf_enum: %d\n" RESET, 
-            current_managed_parameters_struct.tfvn, current_managed_parameters_struct.scid, 
-            current_managed_parameters_struct.vcid, current_managed_parameters_struct.has_fecf);
+            current_managed_parameters->tfvn, current_managed_parameters->scid, 
+            current_managed_parameters->vcid, current_managed_parameters->has_fecf);
 #endif
         status = CRYPTO_LIB_ERR_TC_ENUM_USED_FOR_TM_CONFIG;
         mc_if->mc_log(status);
@@ -1387,6 +1594,7 @@ int32_t Crypto_TM_Do_Decrypt_AEAD(uint8_t sa_service_type, uint8_t* p_ingest, ui
     int32_t status = CRYPTO_LIB_SUCCESS;
     if(sa_service_type == SA_ENCRYPTION)
     {
+        CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
         status = cryptography_if->cryptography_decrypt(p_new_dec_frame+byte_idx, // plaintext output
                                                     pdu_len,   // length of data
                                                     p_ingest+byte_idx, // ciphertext input
@@ -1399,9 +1607,11 @@ int32_t Crypto_TM_Do_Decrypt_AEAD(uint8_t sa_service_type, uint8_t* p_ingest, ui
                                                     &sa_ptr->ecs, // encryption cipher
                                                     &sa_ptr->acs,  // authentication cipher
                                                     NULL);
+        CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
     }
     if(sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
     {
+        CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
         status = cryptography_if->cryptography_aead_decrypt(p_new_dec_frame+byte_idx, // plaintext output
                                                             pdu_len, // length of data
                                                             p_ingest+byte_idx, // ciphertext input
@@ -1421,6 +1631,7 @@ int32_t Crypto_TM_Do_Decrypt_AEAD(uint8_t sa_service_type, uint8_t* p_ingest, ui
                                                             &sa_ptr->ecs, // encryption cipher
                                                             &sa_ptr->acs,  // authentication cipher
                                                             NULL);
+        CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
     }
     return status;
 }
@@ -1447,6 +1658,7 @@ int32_t Crypto_TM_Do_Decrypt_NONAEAD(uint8_t sa_service_type, uint16_t pdu_len,
     int32_t status = CRYPTO_LIB_SUCCESS;
     if(sa_service_type == SA_AUTHENTICATION || sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
     {
+        CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
         status = cryptography_if->cryptography_validate_authentication(p_new_dec_frame+byte_idx, // plaintext output
                                             pdu_len, // length of data
                                             p_ingest+byte_idx, // ciphertext input
@@ -1463,6 +1675,7 @@ int32_t Crypto_TM_Do_Decrypt_NONAEAD(uint8_t sa_service_type, uint16_t pdu_len,
                                             CRYPTO_CIPHER_NONE, // encryption cipher
                                             sa_ptr->acs, // authentication cipher
                                             NULL); // cam cookies
+        CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
 
     }
     if(sa_service_type == SA_ENCRYPTION || sa_service_type == SA_AUTHENTICATED_ENCRYPTION)
@@ -1478,6 +1691,7 @@ int32_t Crypto_TM_Do_Decrypt_NONAEAD(uint8_t sa_service_type, uint16_t pdu_len,
 
         if(status == CRYPTO_LIB_SUCCESS)
         {
+            CRYPTO_STAGE_START(CRYPTO_STAGE_CRYPTO);
             status = cryptography_if->cryptography_decrypt(p_new_dec_frame+byte_idx, // plaintext output
                                                     pdu_len,   // length of data
                                                     p_ingest+byte_idx, // ciphertext input
@@ -1490,6 +1704,7 @@ int32_t Crypto_TM_Do_Decrypt_NONAEAD(uint8_t sa_service_type, uint16_t pdu_len,
                                                     &sa_ptr->ecs, // encryption cipher
                                                     &sa_ptr->acs,  // authentication cipher
                                                     NULL);
+            CRYPTO_STAGE_STOP(CRYPTO_STAGE_CRYPTO);
         }
         
 
@@ -1519,12 +1734,12 @@ int32_t Crypto_TM_Do_Decrypt_NONAEAD(uint8_t sa_service_type, uint16_t pdu_len,
 */
 void Crypto_TM_Calc_PDU_MAC(uint16_t* pdu_len, uint16_t byte_idx, SecurityAssociation_t* sa_ptr, int* mac_loc)
 {
-    *pdu_len = current_managed_parameters_struct.max_frame_size - (byte_idx) - sa_ptr->stmacf_len;
-    if(current_managed_parameters_struct.has_ocf == TM_HAS_OCF)
+    *pdu_len = current_managed_parameters->max_frame_size - (byte_idx) - sa_ptr->stmacf_len;
+    if(current_managed_parameters->has_ocf == TM_HAS_OCF)
     {
         *pdu_len -= 4;
     }
-    if(current_managed_parameters_struct.has_fecf == TM_HAS_FECF)
+    if(current_managed_parameters->has_fecf == TM_HAS_FECF)
     {
         *pdu_len -= 2;
     }
@@ -1573,18 +1788,21 @@ int32_t Crypto_TM_Do_Decrypt(uint8_t sa_service_type, SecurityAssociation_t* sa_
    // If plaintext, copy byte by byte
     else if(sa_service_type == SA_PLAINTEXT)
     {
-        memcpy(p_new_dec_frame+byte_idx, &(p_ingest[byte_idx]), pdu_len);
+        if (p_new_dec_frame != p_ingest)
+        {
+            memcpy(p_new_dec_frame+byte_idx, &(p_ingest[byte_idx]), pdu_len);
+        }
         byte_idx += pdu_len;
     }
 
 #ifdef TM_DEBUG
     printf(KYEL "Printing received frame:\n\t" RESET);
-    for( int i=0; i<current_managed_parameters_struct.max_frame_size; i++)
+    for( int i=0; i<current_managed_parameters->max_frame_size; i++)
     {
         printf(KYEL "%02X", p_ingest[i]);
     }
     printf(KYEL "\nPrinting PROCESSED frame:\n\t" RESET);
-        for( int i=0; i<current_managed_parameters_struct.max_frame_size; i++)
+        for( int i=0; i<current_managed_parameters->max_frame_size; i++)
     {
         printf(KYEL "%02X", p_new_dec_frame[i]);
     }
@@ -1593,7 +1811,7 @@ int32_t Crypto_TM_Do_Decrypt(uint8_t sa_service_type, SecurityAssociation_t* sa_
 
     *pp_processed_frame = p_new_dec_frame;
     // TODO maybe not just return this without doing the math ourselves
-    *p_decrypted_length = current_managed_parameters_struct.max_frame_size;
+    *p_decrypted_length = current_managed_parameters->max_frame_size;
 
 #ifdef DEBUG
         printf(KYEL "----- Crypto_TM_ProcessSecurity END -----\n" RESET);
@@ -1623,15 +1841,15 @@ void Crypto_TM_Process_Debug_Print(uint16_t byte_idx, uint16_t pdu_len, Security
     #ifdef TM_DEBUG
     printf(KYEL "Index / data location starts at: %d\n" RESET, byte_idx);
     printf(KYEL "Data size is: %d\n" RESET, pdu_len);
-    if(current_managed_parameters_struct.has_ocf == TM_HAS_OCF)
+    if(current_managed_parameters->has_ocf == TM_HAS_OCF)
     {
         // If OCF exists, comes immediately after MAC
         printf(KYEL "OCF Location is: %d\n" RESET, byte_idx + pdu_len + sa_ptr->stmacf_len);
     }
-    if(current_managed_parameters_struct.has_fecf == TM_HAS_FECF)
+    if(current_managed_parameters->has_fecf == TM_HAS_FECF)
     {
         // If FECF exists, comes just before end of the frame
-        printf(KYEL "FECF Location is: %d\n" RESET, current_managed_parameters_struct.max_frame_size - 2);
+        printf(KYEL "FECF Location is: %d\n" RESET, current_managed_parameters->max_frame_size - 2);
     }
     #endif
 }
@@ -1643,6 +1861,68 @@ void Crypto_TM_Process_Debug_Print(uint16_t byte_idx, uint16_t pdu_len, Security
  * @return int32: Success/Failure
    **/
 int32_t Crypto_TM_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_t** pp_processed_frame, uint16_t* p_decrypted_length)
+{
+    int32_t status;
+
+    CRYPTO_PROBE(tm_process_entry, p_ingest, len_ingest);
+    status = crypto_tm_process_security(p_ingest, len_ingest, NULL, NULL, NULL, pp_processed_frame, p_decrypted_length);
+    Crypto_Metrics_Frame(TYPE_TM, CRYPTO_FALSE, p_ingest, len_ingest, status);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: Crypto_TM_ProcessSecurity_Into
+ * Crypto_TM_ProcessSecurity without the per-frame allocation. The processed frame is written to p_out,
+ * which may be p_ingest itself to process in place (p_ingest is then overwritten even on failure).
+ * Output layout matches Crypto_TM_ProcessSecurity: headers copied, security fields and trailer zeroed.
+ * @param p_ingest: uint8_t*
+ * @param len_ingest: uint16_t
+ * @param p_out: uint8_t*, at least len_ingest bytes
+ * @param len_out: uint16_t
+ * @param p_pdu_offset: uint16_t*, optional, offset of the processed data field in p_out
+ * @param p_pdu_len: uint16_t*, optional, length of the processed data field
+ * @param p_decrypted_length: uint16_t*
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_TM_ProcessSecurity_Into(uint8_t* p_ingest, uint16_t len_ingest, uint8_t* p_out, uint16_t len_out,
+                                       uint16_t* p_pdu_offset, uint16_t* p_pdu_len, uint16_t* p_decrypted_length)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    uint8_t* p_processed_frame = NULL;
+
+    if (p_ingest == NULL || p_out == NULL || p_decrypted_length == NULL)
+    {
+        status = CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+    else if (len_out < len_ingest)
+    {
+        status = CRYPTO_LIB_ERR_OUTPUT_BUFFER_TOO_SMALL;
+    }
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        if (mc_if != NULL)
+        {
+            mc_if->mc_log(status);
+        }
+        return status;
+    }
+
+    CRYPTO_PROBE(tm_process_entry, p_ingest, len_ingest);
+    status = crypto_tm_process_security(p_ingest, len_ingest, p_out, p_pdu_offset, p_pdu_len, &p_processed_frame,
+                                        p_decrypted_length);
+    Crypto_Metrics_Frame(TYPE_TM, CRYPTO_FALSE, p_ingest, len_ingest, status);
+    Crypto_SA_Unlock();
+    return status;
+}
+
+/**
+ * @brief Function: crypto_tm_process_security
+ * Body of Crypto_TM_ProcessSecurity, runs with the frame's SA lock held once the SA is known.
+ * Allocates the output frame unless p_out is given.
+ **/
+static int32_t crypto_tm_process_security(uint8_t* p_ingest, uint16_t len_ingest, uint8_t* p_out, uint16_t* p_pdu_offset,
+                                          uint16_t* p_pdu_len, uint8_t** pp_processed_frame, uint16_t* p_decrypted_length)
 {
     // Local Variables
     int32_t status = CRYPTO_LIB_SUCCESS;
@@ -1656,6 +1936,7 @@ int32_t Crypto_TM_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_
     uint16_t pdu_len = 1;
     uint8_t* p_new_dec_frame = NULL;
     SecurityAssociation_t* sa_ptr = NULL;
+    uint8_t sa_state = SA_NONE;
     uint8_t sa_service_type = -1;
     uint8_t secondary_hdr_len = 0;
     uint8_t spi = -1;  
@@ -1679,11 +1960,21 @@ int32_t Crypto_TM_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_
         // Move index to past the SPI
         byte_idx += 2;
 
+        CRYPTO_STAGE_START(CRYPTO_STAGE_SA_LOOKUP);
         status = sa_if->sa_get_from_spi(spi, &sa_ptr);
+        CRYPTO_STAGE_STOP(CRYPTO_STAGE_SA_LOOKUP);
+        if (status == CRYPTO_LIB_SUCCESS)
+        {
+            sa_state = sa_ptr->sa_state;
+        }
     }
 
     // If no valid SPI, return
     if (status == CRYPTO_LIB_SUCCESS)
+    {
+        status = Crypto_SA_Lock_State(sa_ptr, sa_state);
+    }
+    if (status == CRYPTO_LIB_SUCCESS)
     {
 #ifdef SA_DEBUG
         printf(KYEL "DEBUG - Printing SA Entry for current frame.\n" RESET);
@@ -1721,7 +2012,11 @@ int32_t Crypto_TM_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_
         status = Crypto_TM_FECF_Setup(p_ingest, len_ingest);
     }
     
-    if (status == CRYPTO_LIB_SUCCESS) 
+    if (status == CRYPTO_LIB_SUCCESS && p_out != NULL)
+    {
+        p_new_dec_frame = p_out;
+    }
+    else if (status == CRYPTO_LIB_SUCCESS) 
     {
         // Accio buffer
         p_new_dec_frame = (uint8_t*)calloc(1, (len_ingest) * sizeof(uint8_t));
@@ -1736,7 +2031,10 @@ int32_t Crypto_TM_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_
     {
         // Copy over TM Primary Header (6 bytes),Secondary (if present)
         // If present, the TF Secondary Header will follow the TF PriHdr
-        memcpy(p_new_dec_frame, &p_ingest[0], 6 + secondary_hdr_len);
+        if (p_new_dec_frame != p_ingest)
+        {
+            memcpy(p_new_dec_frame, &p_ingest[0], 6 + secondary_hdr_len);
+        }
 
         // Byte_idx is still set to just past the SPI
         // If IV is present, note location
@@ -1791,6 +2089,24 @@ int32_t Crypto_TM_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_
         Crypto_TM_Parse_Mac_Prep_AAD(sa_service_type, p_ingest, mac_loc, sa_ptr, &aad_len, byte_idx, aad);
 
         status = Crypto_TM_Do_Decrypt(sa_service_type, sa_ptr, ecs_is_aead_algorithm, byte_idx, p_new_dec_frame, pdu_len, p_ingest, ekp, akp, iv_loc, mac_loc, aad_len, aad, pp_processed_frame, p_decrypted_length);
+
+        if (p_out != NULL)
+        {
+            // A caller buffer is not pre-zeroed; clear what calloc would have left empty
+            memset(p_out + 6 + secondary_hdr_len, 0, byte_idx - (6 + secondary_hdr_len));
+            if (len_ingest > byte_idx + pdu_len)
+            {
+                memset(p_out + byte_idx + pdu_len, 0, len_ingest - (byte_idx + pdu_len));
+            }
+            if (p_pdu_offset != NULL)
+            {
+                *p_pdu_offset = byte_idx;
+            }
+            if (p_pdu_len != NULL)
+            {
+                *p_pdu_len = pdu_len;
+            }
+        }
     } 
 
     return status;
@@ -1798,7 +2114,7 @@ int32_t Crypto_TM_ProcessSecurity(uint8_t* p_ingest, uint16_t len_ingest, uint8_
 
 void Crypto_TM_Print_FSR(uint8_t* p_ingest, uint16_t byte_idx, uint16_t pdu_len, SecurityAssociation_t* sa_ptr)
 {
-    if(current_managed_parameters_struct.has_ocf == TM_HAS_OCF)
+    if(current_managed_parameters->has_ocf == TM_HAS_OCF)
         {
             byte_idx += (pdu_len + sa_ptr->stmacf_len);
             Telemetry_Frame_Ocf_Fsr_t report;
@@ -2009,7 +2325,7 @@ void Crypto_TM_updateOCF(Telemetry_Frame_Ocf_Fsr_t* report, TM_t* tm_frame)
 
 /**
  * @brief Function: Crypto_Prepare_TM_AAD
- * Bitwise ANDs buffer with abm, placing results in aad buffer
+ * Bitwise ANDs buffer with abm, placing results in aad buffer, see Crypto_Apply_ABM
  * @param buffer: uint8_t*
  * @param len_aad: uint16_t
  * @param abm_buffer: uint8_t*
@@ -2019,12 +2335,11 @@ void Crypto_TM_updateOCF(Telemetry_Frame_Ocf_Fsr_t* report, TM_t* tm_frame)
 uint32_t Crypto_Prepare_TM_AAD(const uint8_t* buffer, uint16_t len_aad, const uint8_t* abm_buffer, uint8_t* aad)
 {
     uint32_t status = CRYPTO_LIB_SUCCESS;
+#ifdef MAC_DEBUG
     int i;
+#endif
 
-    for (i = 0; i < len_aad; i++)
-    {
-        aad[i] = buffer[i] & abm_buffer[i];
-    }
+    Crypto_Apply_ABM(buffer, len_aad, abm_buffer, aad);
 
 #ifdef MAC_DEBUG
     printf(KYEL "AAD before ABM Bitmask:\n\t");
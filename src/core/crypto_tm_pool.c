@@ -0,0 +1,280 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/*
+** Includes
+*/
+#include "crypto.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+
+/*
+** TM ProcessSecurity Worker Pool
+** Frames are dispatched to a worker by GVCID, so every frame of a virtual channel is processed by the
+** same thread in submission order and the SA's anti-replay window sees them in sequence, while
+** independent VCs decrypt in parallel.
+**
+** Each worker owns one ring of TM_POOL_RING_SIZE slots walked by three indices:
+**   head - advanced by the submitting thread
+**   done - advanced by the worker once a slot has been processed
+**   tail - advanced by the collecting thread
+** Every index has a single writer, so both stages (submit -> worker, worker -> collect) are lock-free
+** SPSC hand-offs. Submit refuses work once head - tail reaches the ring size, so a worker never waits
+** on the collector. Submit and Collect must each be called from a single thread (they may differ).
+*/
+typedef struct
+{
+    pthread_t thread;
+    sem_t work;                 // Posted once per submitted frame, and once to stop
+    atomic_uint head;
+    atomic_uint done;
+    atomic_uint tail;
+    atomic_int stop;
+    TM_Pool_Frame_t ring[TM_POOL_RING_SIZE];
+} crypto_tm_pool_worker_t;
+
+/*
+** Static Globals
+*/
+static crypto_tm_pool_worker_t tm_pool_workers[TM_POOL_MAX_WORKERS];
+static uint32_t tm_pool_num_workers = 0;
+static uint32_t tm_pool_collect_next = 0;
+static uint8_t tm_pool_running = CRYPTO_FALSE;
+
+/*
+** Static Functions
+*/
+static void* crypto_tm_pool_worker(void* arg);
+static uint32_t crypto_tm_pool_dispatch(const uint8_t* p_ingest);
+
+/**
+ * @brief Function: crypto_tm_pool_worker
+ * Worker thread body, processes its ring in order until stopped and drained
+ * @param arg: crypto_tm_pool_worker_t*
+ **/
+static void* crypto_tm_pool_worker(void* arg)
+{
+    crypto_tm_pool_worker_t* worker = (crypto_tm_pool_worker_t*)arg;
+    TM_Pool_Frame_t* frame;
+    uint32_t done;
+
+    for (;;)
+    {
+        sem_wait(&worker->work);
+        done = atomic_load_explicit(&worker->done, memory_order_relaxed);
+        if (done == atomic_load_explicit(&worker->head, memory_order_acquire))
+        {
+            if (atomic_load_explicit(&worker->stop, memory_order_acquire))
+            {
+                break;
+            }
+            continue;
+        }
+
+        frame = &worker->ring[done & (TM_POOL_RING_SIZE - 1)];
+        frame->p_processed_frame = NULL;
+        frame->decrypted_length = 0;
+        frame->status = Crypto_TM_ProcessSecurity(frame->p_ingest, frame->len_ingest, &frame->p_processed_frame,
+                                                  &frame->decrypted_length);
+        atomic_store_explicit(&worker->done, done + 1, memory_order_release);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function: crypto_tm_pool_dispatch
+ * Maps a frame to its worker from the GVCID in the TM primary header
+ * @param p_ingest: const uint8_t*
+ * @return uint32: Worker index
+ **/
+static uint32_t crypto_tm_pool_dispatch(const uint8_t* p_ingest)
+{
+    uint32_t tfvn = (p_ingest[0] & 0xC0) >> 6;
+    uint32_t scid = ((p_ingest[0] & 0x3F) << 4) | ((p_ingest[1] & 0xF0) >> 4);
+    uint32_t vcid = (p_ingest[1] & 0x0E) >> 1;
+    uint32_t key = (tfvn << 13) | (scid << 3) | vcid;
+
+    return ((key * 2654435761u) >> 16) % tm_pool_num_workers;
+}
+
+/**
+ * @brief Function: Crypto_TM_Pool_Start
+ * Starts num_workers TM ProcessSecurity worker threads. CryptoLib must already be initialized.
+ * @param num_workers: uint32_t
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_TM_Pool_Start(uint32_t num_workers)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    uint32_t i;
+
+    if (tm_pool_running == CRYPTO_TRUE || num_workers == 0 || num_workers > TM_POOL_MAX_WORKERS)
+    {
+        status = CRYPTO_LIB_ERROR;
+        mc_if->mc_log(status);
+        return status;
+    }
+
+    memset(tm_pool_workers, 0, sizeof(tm_pool_workers));
+    tm_pool_collect_next = 0;
+    for (i = 0; i < num_workers; i++)
+    {
+        sem_init(&tm_pool_workers[i].work, 0, 0);
+        atomic_init(&tm_pool_workers[i].head, 0);
+        atomic_init(&tm_pool_workers[i].done, 0);
+        atomic_init(&tm_pool_workers[i].tail, 0);
+        atomic_init(&tm_pool_workers[i].stop, 0);
+        if (pthread_create(&tm_pool_workers[i].thread, NULL, crypto_tm_pool_worker, &tm_pool_workers[i]) != 0)
+        {
+            sem_destroy(&tm_pool_workers[i].work);
+            tm_pool_num_workers = i;
+            tm_pool_running = CRYPTO_TRUE;
+            Crypto_TM_Pool_Stop();
+            status = CRYPTO_LIB_ERROR;
+            mc_if->mc_log(status);
+            return status;
+        }
+    }
+    tm_pool_num_workers = num_workers;
+    tm_pool_running = CRYPTO_TRUE;
+
+#ifdef DEBUG
+    printf(KYEL "TM ProcessSecurity pool started with %d workers\n" RESET, num_workers);
+#endif
+    return status;
+}
+
+/**
+ * @brief Function: Crypto_TM_Pool_Submit
+ * Queues a frame for Crypto_TM_ProcessSecurity. p_ingest must stay valid until the frame is collected.
+ * @param p_ingest: uint8_t*
+ * @param len_ingest: uint16_t
+ * @param user_ctx: void*, returned with the frame
+ * @return int32: Success/Failure, CRYPTO_LIB_ERR_TM_POOL_FULL when the frame's worker has no free slot
+ **/
+int32_t Crypto_TM_Pool_Submit(uint8_t* p_ingest, uint16_t len_ingest, void* user_ctx)
+{
+    crypto_tm_pool_worker_t* worker;
+    TM_Pool_Frame_t* frame;
+    uint32_t head;
+
+    if (tm_pool_running == CRYPTO_FALSE)
+    {
+        return CRYPTO_LIB_ERR_TM_POOL_NOT_RUNNING;
+    }
+    if (p_ingest == NULL)
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+    if (len_ingest < 6)
+    {
+        return CRYPTO_LIB_ERR_INPUT_FRAME_TOO_SHORT_FOR_TM_STANDARD;
+    }
+
+    worker = &tm_pool_workers[crypto_tm_pool_dispatch(p_ingest)];
+    head = atomic_load_explicit(&worker->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&worker->tail, memory_order_acquire) >= TM_POOL_RING_SIZE)
+    {
+        return CRYPTO_LIB_ERR_TM_POOL_FULL;
+    }
+
+    frame = &worker->ring[head & (TM_POOL_RING_SIZE - 1)];
+    frame->p_ingest = p_ingest;
+    frame->len_ingest = len_ingest;
+    frame->user_ctx = user_ctx;
+    atomic_store_explicit(&worker->head, head + 1, memory_order_release);
+    sem_post(&worker->work);
+
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: Crypto_TM_Pool_Collect
+ * Returns up to max_frames processed frames without blocking. Frames of one VC are returned in
+ * submission order; frames of different VCs may interleave. Per-frame results are in frames[i].status.
+ * Frames still queued after Crypto_TM_Pool_Stop remain collectable until the next Start.
+ * @param frames: TM_Pool_Frame_t*
+ * @param max_frames: uint32_t
+ * @param count: uint32_t*, number of frames returned
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_TM_Pool_Collect(TM_Pool_Frame_t* frames, uint32_t max_frames, uint32_t* count)
+{
+    crypto_tm_pool_worker_t* worker;
+    uint32_t tail;
+    uint32_t done;
+    uint32_t i;
+
+    if (frames == NULL || count == NULL)
+    {
+        return CRYPTO_LIB_ERR_NULL_BUFFER;
+    }
+    *count = 0;
+    if (tm_pool_num_workers == 0)
+    {
+        return CRYPTO_LIB_ERR_TM_POOL_NOT_RUNNING;
+    }
+
+    // Start from a rotating worker so one busy VC cannot starve the others
+    for (i = 0; i < tm_pool_num_workers && *count < max_frames; i++)
+    {
+        worker = &tm_pool_workers[(tm_pool_collect_next + i) % tm_pool_num_workers];
+        tail = atomic_load_explicit(&worker->tail, memory_order_relaxed);
+        done = atomic_load_explicit(&worker->done, memory_order_acquire);
+        while (tail != done && *count < max_frames)
+        {
+            frames[*count] = worker->ring[tail & (TM_POOL_RING_SIZE - 1)];
+            (*count)++;
+            tail++;
+        }
+        atomic_store_explicit(&worker->tail, tail, memory_order_release);
+    }
+    tm_pool_collect_next = (tm_pool_collect_next + 1) % tm_pool_num_workers;
+
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: Crypto_TM_Pool_Stop
+ * Processes every frame already submitted, then joins the worker threads
+ * @return int32: Success/Failure
+ **/
+int32_t Crypto_TM_Pool_Stop(void)
+{
+    uint32_t i;
+
+    if (tm_pool_running == CRYPTO_FALSE)
+    {
+        return CRYPTO_LIB_ERR_TM_POOL_NOT_RUNNING;
+    }
+
+    for (i = 0; i < tm_pool_num_workers; i++)
+    {
+        atomic_store_explicit(&tm_pool_workers[i].stop, 1, memory_order_release);
+        sem_post(&tm_pool_workers[i].work);
+    }
+    for (i = 0; i < tm_pool_num_workers; i++)
+    {
+        pthread_join(tm_pool_workers[i].thread, NULL);
+        sem_destroy(&tm_pool_workers[i].work);
+    }
+    tm_pool_running = CRYPTO_FALSE;
+
+    return CRYPTO_LIB_SUCCESS;
+}
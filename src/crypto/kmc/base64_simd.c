@@ -0,0 +1,461 @@
+/*
+ * Copyright 2021, by the California Institute of Technology.
+ * ALL RIGHTS RESERVED. United States Government Sponsorship acknowledged.
+ * Any commercial use must be negotiated with the Office of Technology
+ * Transfer at the California Institute of Technology.
+ *
+ * This software may be subject to U.S. export control laws. By accepting
+ * this software, the user agrees to comply with all applicable U.S.
+ * export laws and regulations. User has the responsibility to obtain
+ * export licenses, or other export authority as may be required before
+ * exporting such information to foreign countries or providing access to
+ * foreign persons.
+ */
+
+/*
+** Base64 decoding straight into the caller's buffer
+** Crypto Service responses carry AAD, ciphertext and tag as one base64 string.  base64SimdDecode decodes
+** just the byte range asked for, starting mid-quantum if need be, so the ciphertext lands in the frame and
+** the tag in the MAC field without an intermediate buffer.  Whole quanta are decoded 16 or 32 characters at
+** a time with SSSE3 or AVX2 when the CPU has them: each character's high nibble picks its class, the low
+** nibble checks it is in the alphabet, and a per-class offset maps it to its 6-bit value before the values
+** are packed into bytes.  Any block with an invalid character falls back to the scalar loop, which reports it.
+*/
+
+#include <string.h>
+
+#include "base64_simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BASE64_HAVE_SIMD
+#include <immintrin.h>
+#endif
+
+typedef int32_t (*base64_engine_t)(const char* input, size_t quanta, uint8_t alphabet, uint8_t* output);
+
+typedef struct
+{
+    uint8_t dec[128];  // Character to 6-bit value, 0xFF when outside the alphabet
+    int8_t lut_lo[16]; // Low nibble, classes for which the character is invalid
+    int8_t lut_hi[16]; // High nibble, class bit
+    int8_t lut_roll[16]; // High nibble, offset from character to value
+    char fix_char;     // The one character whose offset differs from its class...
+    int8_t fix_roll;   // ...and the correction to apply
+} base64_alphabet_t;
+
+/*
+** Static Globals
+*/
+static const base64_alphabet_t base64_alphabets[2] = {
+    // BASE64_ALPHABET_STANDARD
+    {
+        {
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+            0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+            0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+            0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+        },
+        {0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A},
+        {0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+        {0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0},
+        '/', -3
+    },
+    // BASE64_ALPHABET_URL
+    {
+        {
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+            0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+            0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+            0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+            0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+        },
+        {0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x3B, 0x3B, 0x3A, 0x3B, 0x33},
+        {0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x20, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+        {0, 0, 17, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0},
+        '_', 33
+    }
+};
+
+static uint8_t base64_initialized = 0;
+static uint8_t base64_engine_id = BASE64_ENGINE_SCALAR;
+static base64_engine_t base64_engine = NULL;
+#ifdef BASE64_HAVE_SIMD
+static uint8_t base64_ssse3_supported = 0;
+static uint8_t base64_avx2_supported = 0;
+#endif
+
+/*
+** Engines
+** Each decodes whole 4 character quanta, without padding, into 3 bytes each
+*/
+static int32_t base64_decode_scalar(const char* input, size_t quanta, uint8_t alphabet, uint8_t* output)
+{
+    const uint8_t* dec = base64_alphabets[alphabet].dec;
+    const uint8_t* p = (const uint8_t*)input;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+    uint8_t d;
+
+    while (quanta-- > 0)
+    {
+        if ((p[0] | p[1] | p[2] | p[3]) & 0x80)
+        {
+            return ERROR_INVALID_CHARACTER;
+        }
+        a = dec[p[0]];
+        b = dec[p[1]];
+        c = dec[p[2]];
+        d = dec[p[3]];
+        if ((a | b | c | d) & 0xC0)
+        {
+            return ERROR_INVALID_CHARACTER;
+        }
+        output[0] = (uint8_t)((a << 2) | (b >> 4));
+        output[1] = (uint8_t)((b << 4) | (c >> 2));
+        output[2] = (uint8_t)((c << 6) | d);
+        p += 4;
+        output += 3;
+    }
+    return NO_ERROR;
+}
+
+#ifdef BASE64_HAVE_SIMD
+/**
+ * SSSE3 engine, 16 characters to 12 bytes per step.  The 16 byte store runs 4 bytes past the decoded
+ * data, so the last few quanta are left to the scalar loop.
+ **/
+__attribute__((target("ssse3,sse4.1"))) static int32_t base64_decode_ssse3(const char* input, size_t quanta,
+                                                                          uint8_t alphabet, uint8_t* output)
+{
+    const base64_alphabet_t* a = &base64_alphabets[alphabet];
+    const __m128i lut_lo = _mm_loadu_si128((const __m128i*)a->lut_lo);
+    const __m128i lut_hi = _mm_loadu_si128((const __m128i*)a->lut_hi);
+    const __m128i lut_roll = _mm_loadu_si128((const __m128i*)a->lut_roll);
+    const __m128i fix_char = _mm_set1_epi8(a->fix_char);
+    const __m128i fix_roll = _mm_set1_epi8(a->fix_roll);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    __m128i str;
+    __m128i hi;
+    __m128i lo;
+    __m128i roll;
+
+    while (quanta >= 6)
+    {
+        str = _mm_loadu_si128((const __m128i*)input);
+        hi = _mm_and_si128(_mm_srli_epi32(str, 4), nibble);
+        lo = _mm_and_si128(str, nibble);
+        if (!_mm_testz_si128(_mm_shuffle_epi8(lut_lo, lo), _mm_shuffle_epi8(lut_hi, hi)))
+        {
+            break;
+        }
+        roll = _mm_add_epi8(_mm_shuffle_epi8(lut_roll, hi),
+                            _mm_and_si128(_mm_cmpeq_epi8(str, fix_char), fix_roll));
+        str = _mm_add_epi8(str, roll);
+        // aaaaaabb bbbbcccc ccdddddd from the four 6-bit values of each 32-bit lane
+        str = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+        str = _mm_madd_epi16(str, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128((__m128i*)output, _mm_shuffle_epi8(str, pack));
+        input += 16;
+        output += 12;
+        quanta -= 4;
+    }
+    return base64_decode_scalar(input, quanta, alphabet, output);
+}
+
+/**
+ * AVX2 engine, 32 characters to 24 bytes per step, the same steps as the SSSE3 engine in each 128-bit lane.
+ * The tail goes to the scalar loop, handing it to the (non-VEX) SSSE3 engine costs an AVX/SSE transition.
+ **/
+__attribute__((target("avx2"))) static int32_t base64_decode_avx2(const char* input, size_t quanta,
+                                                                 uint8_t alphabet, uint8_t* output)
+{
+    const base64_alphabet_t* a = &base64_alphabets[alphabet];
+    const __m256i lut_lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)a->lut_lo));
+    const __m256i lut_hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)a->lut_hi));
+    const __m256i lut_roll = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)a->lut_roll));
+    const __m256i fix_char = _mm256_set1_epi8(a->fix_char);
+    const __m256i fix_roll = _mm256_set1_epi8(a->fix_roll);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    __m256i str;
+    __m256i hi;
+    __m256i lo;
+    __m256i roll;
+
+    while (quanta >= 11)
+    {
+        str = _mm256_loadu_si256((const __m256i*)input);
+        hi = _mm256_and_si256(_mm256_srli_epi32(str, 4), nibble);
+        lo = _mm256_and_si256(str, nibble);
+        if (!_mm256_testz_si256(_mm256_shuffle_epi8(lut_lo, lo), _mm256_shuffle_epi8(lut_hi, hi)))
+        {
+            break;
+        }
+        roll = _mm256_add_epi8(_mm256_shuffle_epi8(lut_roll, hi),
+                               _mm256_and_si256(_mm256_cmpeq_epi8(str, fix_char), fix_roll));
+        str = _mm256_add_epi8(str, roll);
+        str = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+        str = _mm256_madd_epi16(str, _mm256_set1_epi32(0x00011000));
+        str = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(str, pack), lanes);
+        _mm256_storeu_si256((__m256i*)output, str);
+        input += 32;
+        output += 24;
+        quanta -= 8;
+    }
+    return base64_decode_scalar(input, quanta, alphabet, output);
+}
+#endif
+
+/**
+ * @brief Function: base64_init
+ * Picks the fastest engine supported by the running CPU
+ **/
+static void base64_init(void)
+{
+    if (base64_initialized)
+    {
+        return;
+    }
+
+    base64_engine_id = BASE64_ENGINE_SCALAR;
+    base64_engine = base64_decode_scalar;
+
+#ifdef BASE64_HAVE_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1"))
+    {
+        base64_ssse3_supported = 1;
+        base64_engine_id = BASE64_ENGINE_SSSE3;
+        base64_engine = base64_decode_ssse3;
+    }
+    if (base64_ssse3_supported && __builtin_cpu_supports("avx2"))
+    {
+        base64_avx2_supported = 1;
+        base64_engine_id = BASE64_ENGINE_AVX2;
+        base64_engine = base64_decode_avx2;
+    }
+#endif
+
+    base64_initialized = 1;
+}
+
+/**
+ * @brief Function: base64SimdSetEngine
+ * Overrides the engine picked on first use, e.g. to benchmark or cross-check the engines
+ * @param engine: uint8_t, BASE64_ENGINE_*
+ * @return int32: NO_ERROR, or ERROR_INVALID_PARAMETER if the CPU lacks it
+ **/
+int32_t base64SimdSetEngine(uint8_t engine)
+{
+    base64_init();
+    switch (engine)
+    {
+    case BASE64_ENGINE_SCALAR:
+        base64_engine = base64_decode_scalar;
+        break;
+#ifdef BASE64_HAVE_SIMD
+    case BASE64_ENGINE_SSSE3:
+        if (!base64_ssse3_supported)
+        {
+            return ERROR_INVALID_PARAMETER;
+        }
+        base64_engine = base64_decode_ssse3;
+        break;
+    case BASE64_ENGINE_AVX2:
+        if (!base64_avx2_supported)
+        {
+            return ERROR_INVALID_PARAMETER;
+        }
+        base64_engine = base64_decode_avx2;
+        break;
+#endif
+    default:
+        return ERROR_INVALID_PARAMETER;
+    }
+    base64_engine_id = engine;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Function: base64SimdGetEngine
+ * @return uint8: BASE64_ENGINE_* currently in use
+ **/
+uint8_t base64SimdGetEngine(void)
+{
+    base64_init();
+    return base64_engine_id;
+}
+
+/**
+ * @brief Function: base64SimdDecodedLen
+ * Length of the data encoded by a padded or unpadded base64 string, 0 if the length is impossible
+ * @param input: const char*
+ * @param inputLen: size_t
+ * @return size_t: Decoded length
+ **/
+size_t base64SimdDecodedLen(const char* input, size_t inputLen)
+{
+    if (inputLen > 0 && input[inputLen - 1] == '=')
+    {
+        inputLen--;
+        if (inputLen > 0 && input[inputLen - 1] == '=')
+        {
+            inputLen--;
+        }
+    }
+    if (inputLen % 4 == 1)
+    {
+        return 0;
+    }
+    return (inputLen / 4) * 3 + ((inputLen % 4) ? (inputLen % 4) - 1 : 0);
+}
+
+/**
+ * @brief Function: base64_decode_quantum
+ * Decodes the possibly short quantum at input, for the ends of a range
+ * @return int32: NO_ERROR or ERROR_INVALID_CHARACTER
+ **/
+static int32_t base64_decode_quantum(const char* input, size_t avail, uint8_t alphabet, uint8_t output[3])
+{
+    const uint8_t* dec = base64_alphabets[alphabet].dec;
+    uint32_t value = 0;
+    size_t i;
+    uint8_t c;
+
+    for (i = 0; i < 4; i++)
+    {
+        c = 0;
+        if (i < avail && input[i] == '=')
+        {
+            // Padding only ends the last quantum, after at least two characters
+            if (avail > 4 || i < 2 || (i == 2 && avail == 4 && input[3] != '='))
+            {
+                return ERROR_INVALID_CHARACTER;
+            }
+        }
+        else if (i < avail)
+        {
+            c = (uint8_t)input[i];
+            if (c & 0x80 || dec[c] & 0xC0)
+            {
+                return ERROR_INVALID_CHARACTER;
+            }
+            c = dec[c];
+        }
+        value = (value << 6) | c;
+    }
+    output[0] = (uint8_t)(value >> 16);
+    output[1] = (uint8_t)(value >> 8);
+    output[2] = (uint8_t)value;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Function: base64SimdDecode
+ * Decodes bytes [offset, offset + outputLen) of the data encoded by input, or up to its end if shorter
+ * @param input: const char*, base64 or base64url characters, padding optional, no line breaks
+ * @param inputLen: size_t
+ * @param alphabet: uint8_t, BASE64_ALPHABET_*
+ * @param offset: size_t, first decoded byte wanted
+ * @param output: void*
+ * @param outputLen: size_t, bytes wanted
+ * @param decodedLen: size_t*, bytes written
+ * @return int32: NO_ERROR, ERROR_INVALID_LENGTH or ERROR_INVALID_CHARACTER
+ **/
+int32_t base64SimdDecode(const char* input, size_t inputLen, uint8_t alphabet, size_t offset, void* output,
+                         size_t outputLen, size_t* decodedLen)
+{
+    int32_t error = NO_ERROR;
+    uint8_t* p = (uint8_t*)output;
+    uint8_t quantum[3];
+    size_t total;
+    size_t pos;
+    size_t skip;
+    size_t n;
+
+    if ((input == NULL && inputLen != 0) || (output == NULL && outputLen != 0) || decodedLen == NULL ||
+        alphabet > BASE64_ALPHABET_URL)
+    {
+        return ERROR_INVALID_PARAMETER;
+    }
+    *decodedLen = 0;
+    if (base64_initialized == 0)
+    {
+        base64_init();
+    }
+
+    total = base64SimdDecodedLen(input, inputLen);
+    if (total == 0 && inputLen != 0)
+    {
+        return ERROR_INVALID_LENGTH;
+    }
+    if (offset >= total)
+    {
+        return NO_ERROR;
+    }
+    if (outputLen > total - offset)
+    {
+        outputLen = total - offset;
+    }
+
+    // Leading partial quantum
+    pos = (offset / 3) * 4;
+    skip = offset % 3;
+    if (skip != 0)
+    {
+        error = base64_decode_quantum(&input[pos], inputLen - pos, alphabet, quantum);
+        if (error != NO_ERROR)
+        {
+            return error;
+        }
+        n = 3 - skip;
+        if (n > outputLen)
+        {
+            n = outputLen;
+        }
+        memcpy(p, &quantum[skip], n);
+        p += n;
+        outputLen -= n;
+        pos += 4;
+    }
+
+    // Whole quanta, every quantum that yields 3 wanted bytes has 4 characters and no padding
+    n = outputLen / 3;
+    if (n > 0)
+    {
+        error = base64_engine(&input[pos], n, alphabet, p);
+        if (error != NO_ERROR)
+        {
+            return error;
+        }
+        p += n * 3;
+        outputLen -= n * 3;
+        pos += n * 4;
+    }
+
+    // Trailing partial quantum
+    if (outputLen > 0)
+    {
+        error = base64_decode_quantum(&input[pos], inputLen - pos, alphabet, quantum);
+        if (error != NO_ERROR)
+        {
+            return error;
+        }
+        memcpy(p, quantum, outputLen);
+        p += outputLen;
+    }
+
+    *decodedLen = (size_t)(p - (uint8_t*)output);
+    return NO_ERROR;
+}
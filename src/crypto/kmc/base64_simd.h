@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021, by the California Institute of Technology.
+ * ALL RIGHTS RESERVED. United States Government Sponsorship acknowledged.
+ * Any commercial use must be negotiated with the Office of Technology
+ * Transfer at the California Institute of Technology.
+ *
+ * This software may be subject to U.S. export control laws. By accepting
+ * this software, the user agrees to comply with all applicable U.S.
+ * export laws and regulations. User has the responsibility to obtain
+ * export licenses, or other export authority as may be required before
+ * exporting such information to foreign countries or providing access to
+ * foreign persons.
+ */
+
+#ifndef BASE64_SIMD_H
+#define BASE64_SIMD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Alphabets
+#define BASE64_ALPHABET_STANDARD 0 // RFC 4648 section 4, '+' '/' and '=' padding
+#define BASE64_ALPHABET_URL 1      // RFC 4648 section 5, '-' '_' with or without padding
+
+// Engines, fastest supported is selected on first use
+#define BASE64_ENGINE_SCALAR 0
+#define BASE64_ENGINE_SSSE3 1
+#define BASE64_ENGINE_AVX2 2
+
+// Return codes, shared with base64.h and base64url.h
+#ifndef NO_ERROR
+#define ERROR_INVALID_PARAMETER 21
+#define ERROR_INVALID_LENGTH 22
+#define ERROR_INVALID_CHARACTER 23
+#define NO_ERROR 0
+#endif
+
+size_t base64SimdDecodedLen(const char* input, size_t inputLen);
+int32_t base64SimdDecode(const char* input, size_t inputLen, uint8_t alphabet, size_t offset, void* output,
+                         size_t outputLen, size_t* decodedLen);
+int32_t base64SimdSetEngine(uint8_t engine);
+uint8_t base64SimdGetEngine(void);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif //BASE64_SIMD_H
@@ -16,6 +16,7 @@
 #include "cryptography_interface.h"
 #include "crypto.h"
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -23,16 +24,22 @@
 
 // base64 & base64url encoding/decoding libraries
 #include "base64url.h"
-#include "base64.h"
+#include "base64_simd.h"
 // JSON marshalling libraries
 #include "jsmn.h"
 
 #define CAM_MAX_AUTH_RETRIES 4
+#define KMC_URI_SIZE 2048     // Longest Crypto Service request URI
+#define KMC_URI_TEMPLATES 64  // Cached per-SA URI templates, see kmc_uri
+#define KMC_ASYNC_MAX_OPS 32  // Asynchronous requests in flight to the Crypto Service
+#define KMC_RESPONSE_SIZE 4096 // Initial response buffer, grown by doubling
+#define KMC_JSON_TOKENS 64    // Crypto Service responses are flat objects of a few fields
 
 // libcurl call-back response handling Structures
 typedef struct {
     char* response;
     size_t size;
+    size_t capacity;
 } memory_write;
 #define MEMORY_WRITE_SIZE (sizeof(memory_write))
 typedef struct  {
@@ -41,6 +48,36 @@ typedef struct  {
 } memory_read;
 #define MEMORY_READ_SIZE (sizeof(memory_read))
 
+// An AEAD encrypt in flight on the curl multi handle, see cryptography_aead_encrypt_async
+typedef struct {
+    uint8_t in_use;
+    CURL* handle;          // Kept across requests, like the blocking handle
+    char uri[KMC_URI_SIZE];
+    uint8_t* payload;
+    memory_write chunk_write;
+    memory_read chunk_read;
+    uint8_t cam_retry;
+    // Outputs, owned by the caller until done is called
+    uint8_t* data_out;
+    size_t len_data_out;
+    uint8_t* iv_out;
+    uint32_t iv_len;
+    uint8_t* mac;
+    uint32_t mac_size;
+    uint32_t aad_len;
+    uint8_t encrypt_bool;
+    uint8_t authenticate_bool;
+    cryptography_async_done_t done;
+    void* op_ctx;
+} kmc_async_op_t;
+
+// A parsed Crypto Service response, values are spans of the response buffer and are not copied
+typedef struct {
+    const char* json;
+    int count;
+    jsmntok_t tokens[KMC_JSON_TOKENS];
+} kmc_json_t;
+
 // Cryptography Interface Initialization & Management Functions
 static int32_t cryptography_config(void);
 static int32_t cryptography_init(void);
@@ -93,21 +130,50 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
                                          uint8_t aad_bool, uint8_t* ecs, uint8_t* acs, char* cam_cookies);
 static int32_t cryptography_get_acs_algo(int8_t algo_enum);
 static int32_t cryptography_get_ecs_algo(int8_t algo_enum);
+static int32_t cryptography_aead_encrypt_async(uint8_t* data_out, size_t len_data_out,
+                                               uint8_t* data_in, size_t len_data_in,
+                                               uint8_t* key, uint32_t len_key,
+                                               SecurityAssociation_t* sa_ptr,
+                                               uint8_t* iv, uint32_t iv_len,
+                                               uint8_t* mac, uint32_t mac_size,
+                                               uint8_t* aad, uint32_t aad_len,
+                                               uint8_t encrypt_bool, uint8_t authenticate_bool,
+                                               uint8_t aad_bool, uint8_t* ecs, uint8_t* acs, char* cam_cookies,
+                                               cryptography_async_done_t done, void* op_ctx);
+static int32_t cryptography_async_poll(int32_t timeout_ms);
 
 //Local support functions
 static int32_t get_auth_algorithm_from_acs(uint8_t acs_enum, const char** algo_ptr);
 static int32_t get_cam_sso_token(void);
 static int32_t initialize_kerberos_keytab_file_login(void);
 static int32_t curl_perform_with_cam_retries(CURL* curl_handle,memory_write* chunk_write, memory_read* chunk_read);
+static int32_t kmc_aead_encrypt_request(SecurityAssociation_t* sa_ptr, uint8_t* data_in, size_t len_data_in,
+                                        uint8_t* iv, uint32_t iv_len, uint32_t mac_size, uint8_t* aad,
+                                        uint32_t aad_len, uint8_t encrypt_bool, uint8_t aad_bool,
+                                        const char** uri, uint8_t** payload, size_t* payload_len);
+static int32_t kmc_aead_encrypt_response(memory_write* response, uint8_t* data_out, size_t len_data_out, uint8_t* iv_out,
+                                         uint32_t iv_len, uint8_t* mac, uint32_t mac_size, uint32_t aad_len,
+                                         uint8_t encrypt_bool, uint8_t authenticate_bool);
 
 // libcurl call back and support function declarations
-static int32_t configure_curl_connect_opts(CURL* curl, char* cam_cookies);
+static int32_t configure_curl_connect_opts(CURL* curl);
+static int32_t configure_curl_request_opts(CURL* curl, char* cam_cookies);
+static const char* kmc_uri(uint16_t spi, uint8_t endpoint, const char* key_ref, const char* transformation,
+                           uint32_t key_len_bits, const char* tail_fmt, ...);
 static int32_t handle_cam_cookies(CURL* curl,char* cam_cookies);
-static int32_t curl_response_error_check(CURL* curl, char* response);
+static int32_t curl_response_error_check(CURL* curl, memory_write* response);
+static int32_t kmc_async_complete(kmc_async_op_t* op, CURLcode res);
 static size_t write_callback(void* data, size_t size, size_t nmemb, void* userp);
 static size_t read_callback(char* dest, size_t size, size_t nmemb, void* userp);
 static char* int_to_str(uint32_t int_src, uint32_t* converted_str_length);
 static int jsoneq(const char* json, jsmntok_t* tok, const char* s);
+static memory_write* kmc_response_reset(memory_write* response);
+static int32_t kmc_json_parse(memory_write* response, kmc_json_t* json, uint8_t http_code_required);
+static uint8_t kmc_json_field(kmc_json_t* json, const char* key, const char** value, size_t* value_len);
+static uint8_t kmc_metadata_field(const char* metadata, size_t metadata_len, const char* key, const char** value,
+                                  size_t* value_len);
+static int32_t kmc_base64_decode(const char* value, size_t value_len, uint8_t alphabet, size_t offset, uint8_t* out,
+                                 size_t out_len, size_t* decoded_len);
 
 
 /*
@@ -120,14 +186,46 @@ struct curl_slist *http_headers_list;
 // KMC Crypto Service Endpoints
 static char* kmc_root_uri;
 //static const char* status_endpoint = "/status";
-static const char* encrypt_endpoint = "encrypt?keyRef=%s&transformation=%s&iv=%s";
-static const char* encrypt_endpoint_null_iv = "encrypt?keyRef=%s&transformation=%s";
-static const char* encrypt_offset_endpoint = "encrypt?keyRef=%s&transformation=%s&iv=%s&encryptOffset=%s&macLength=%s";
-static const char* encrypt_offset_endpoint_null_iv = "encrypt?keyRef=%s&transformation=%s&encryptOffset=%s&macLength=%s";
-static const char* decrypt_endpoint = "decrypt?metadata=keyLength:%s,keyRef:%s,cipherTransformation:%s,initialVector:%s,cryptoAlgorithm:%s,metadataType:EncryptionMetadata";
-static const char* decrypt_offset_endpoint = "decrypt?metadata=keyLength:%s,keyRef:%s,cipherTransformation:%s,initialVector:%s,cryptoAlgorithm:%s,macLength:%s,metadataType:EncryptionMetadata,encryptOffset:%s";
-static const char* icv_create_endpoint = "icv-create?keyRef=%s";
-static const char* icv_verify_endpoint = "icv-verify?metadata=integrityCheckValue:%s,keyRef:%s,cryptoAlgorithm:%s,macLength:%s,metadataType:IntegrityCheckMetadata";
+// Each endpoint is split into the part fixed for an SA, cached as a template, and the per-frame tail
+enum
+{
+    KMC_URI_ENCRYPT,
+    KMC_URI_DECRYPT,
+    KMC_URI_ICV_CREATE,
+    KMC_URI_ICV_VERIFY,
+    KMC_URI_ENDPOINTS
+};
+static const char* encrypt_template = "%sencrypt?keyRef=%s&transformation=%s";
+static const char* encrypt_tail = "&iv=%s";
+static const char* encrypt_offset_tail = "&iv=%s&encryptOffset=%u&macLength=%u";
+static const char* encrypt_offset_tail_null_iv = "&encryptOffset=%u&macLength=%u";
+static const char* decrypt_template = "%sdecrypt?metadata=keyLength:%u,keyRef:%s,cipherTransformation:%s,initialVector:";
+static const char* decrypt_tail = "%s,cryptoAlgorithm:%s,metadataType:EncryptionMetadata";
+static const char* decrypt_offset_tail = "%s,cryptoAlgorithm:%s,macLength:%u,metadataType:EncryptionMetadata,encryptOffset:%u";
+static const char* icv_create_template = "%sicv-create?keyRef=%s";
+static const char* icv_verify_template = "%sicv-verify?metadata=";
+static const char* icv_verify_tail = "integrityCheckValue:%s,keyRef:%s,cryptoAlgorithm:%s,macLength:%u,metadataType:IntegrityCheckMetadata";
+
+typedef struct
+{
+    uint8_t valid;
+    uint16_t spi;
+    uint8_t endpoint;
+    const char* transformation;
+    uint32_t key_len_bits;
+    char key_ref[REF_SIZE];
+    size_t len;
+    char uri[KMC_URI_SIZE];
+} kmc_uri_template_t;
+static kmc_uri_template_t kmc_uri_templates[KMC_URI_TEMPLATES];
+static char kmc_uri_buffer[KMC_URI_SIZE]; // URI of the request in progress, like the curl handle there is one
+
+// Asynchronous requests
+static CURLM* kmc_multi;
+static kmc_async_op_t kmc_async_ops[KMC_ASYNC_MAX_OPS];
+// Blocking request/response buffers, reused like the curl handle so responses are not reallocated per frame
+static memory_write kmc_response;
+static memory_read kmc_request;
 
 // CAM Security Endpoints
 static const char* cam_kerberos_uri = "%s/cam-api/ssoToken?loginMethod=kerberos";
@@ -156,6 +254,8 @@ CryptographyInterface get_cryptography_interface_kmc_crypto_service(void)
     cryptography_if_struct.cryptography_aead_decrypt = cryptography_aead_decrypt;
     cryptography_if_struct.cryptography_get_acs_algo = cryptography_get_acs_algo;
     cryptography_if_struct.cryptography_get_ecs_algo = cryptography_get_ecs_algo;
+    cryptography_if_struct.cryptography_aead_encrypt_async = cryptography_aead_encrypt_async;
+    cryptography_if_struct.cryptography_async_poll = cryptography_async_poll;
     return &cryptography_if_struct;
 }
 
@@ -205,11 +305,16 @@ static int32_t cryptography_config(void)
         printf("\tSSL Client Key: %s\n",cryptography_kmc_crypto_config->mtls_client_key_path);
         printf("\tSSL CA Bundle: %s\n",cryptography_kmc_crypto_config->mtls_ca_bundle);
 #endif
-        //status = configure_curl_connect_opts(curl, NULL);
-        //if(status != CRYPTO_LIB_SUCCESS)
-        //{
-        //    return status;
-        //}
+        // URI templates embed the root URI
+        memset(kmc_uri_templates, 0, sizeof(kmc_uri_templates));
+
+        // Everything but the URL, payload and CAM cookies is the same for every request, set it once.
+        // Not resetting the handle between requests keeps its connection (and TLS session) alive.
+        status = configure_curl_connect_opts(curl);
+        if(status != CRYPTO_LIB_SUCCESS)
+        {
+            return status;
+        }
         //curl_easy_setopt(curl, CURLOPT_URL, status_uri);
 
         //memory_write* chunk = calloc(1,MEMORY_WRITE_SIZE);
@@ -263,10 +368,33 @@ static int32_t cryptography_init(void)
         status = CRYPTOGRAPHY_KMC_CURL_INITIALIZATION_FAILURE;
     }
     kmc_root_uri = NULL;
+    memset(kmc_uri_templates, 0, sizeof(kmc_uri_templates));
+    kmc_multi = NULL; // Created by the first asynchronous request
+    memset(kmc_async_ops, 0, sizeof(kmc_async_ops));
     return status;
 }
 static int32_t cryptography_shutdown(void)
 {
+    // Requests still in flight are dropped without calling done
+    for(int i = 0; i < KMC_ASYNC_MAX_OPS; i++)
+    {
+        if(kmc_async_ops[i].handle != NULL)
+        {
+            if(kmc_async_ops[i].in_use == CRYPTO_TRUE)
+            {
+                curl_multi_remove_handle(kmc_multi, kmc_async_ops[i].handle);
+                free(kmc_async_ops[i].payload);
+            }
+            curl_easy_cleanup(kmc_async_ops[i].handle);
+        }
+        free(kmc_async_ops[i].chunk_write.response);
+    }
+    memset(kmc_async_ops, 0, sizeof(kmc_async_ops));
+    if(kmc_multi != NULL)
+    {
+        curl_multi_cleanup(kmc_multi);
+        kmc_multi = NULL;
+    }
    if(curl){
        curl_easy_cleanup(curl);
        curl_global_cleanup();
@@ -277,6 +405,8 @@ static int32_t cryptography_shutdown(void)
     if(kmc_root_uri != NULL){
         free(kmc_root_uri);
     }
+    free(kmc_response.response);
+    memset(&kmc_response, 0, MEMORY_WRITE_SIZE);
     return CRYPTO_LIB_SUCCESS;
 }
 
@@ -303,14 +433,17 @@ static int32_t cryptography_encrypt(uint8_t* data_out, size_t len_data_out,
     printf("PADLENGTH FIELD: 0x%02x\n", *(data_in - sa_ptr->shplf_len));
     #endif
 
-    curl_easy_reset(curl);
-    status = configure_curl_connect_opts(curl, cam_cookies);
+    status = configure_curl_request_opts(curl, cam_cookies);
     if(status != CRYPTO_LIB_SUCCESS)
     {
         return status;
     }
     // Base64 URL encode IV for KMC REST Encrypt
-    char* iv_base64 = (char*)calloc(1,B64ENCODE_OUT_SAFESIZE(iv_len)+1);
+    char iv_base64[B64ENCODE_OUT_SAFESIZE(IV_SIZE) + 1] = {0};
+    if(iv_len > IV_SIZE)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
     if(iv != NULL) base64urlEncode(iv,iv_len,iv_base64,NULL);
 
     uint8_t* encrypt_payload = data_in;
@@ -326,39 +459,28 @@ static int32_t cryptography_encrypt(uint8_t* data_out, size_t len_data_out,
         return status;
     }
 
-    char* encrypt_uri;
-    
-    int len_encrypt_endpoint = strlen(encrypt_endpoint)+strlen(sa_ptr->ek_ref)+strlen(iv_base64)+strlen(AES_CBC_TRANSFORMATION);
-    char* encrypt_endpoint_final = (char*) malloc(len_encrypt_endpoint);
+    const char* encrypt_uri;
     if(iv == NULL){
-        snprintf(encrypt_endpoint_final,len_encrypt_endpoint,encrypt_endpoint_null_iv,sa_ptr->ek_ref,AES_CBC_TRANSFORMATION); 
+        encrypt_uri = kmc_uri(sa_ptr->spi, KMC_URI_ENCRYPT, sa_ptr->ek_ref, AES_CBC_TRANSFORMATION, 0, NULL);
     }
     else{
-        snprintf(encrypt_endpoint_final,len_encrypt_endpoint,encrypt_endpoint,sa_ptr->ek_ref,AES_CBC_TRANSFORMATION, iv_base64);
+        encrypt_uri = kmc_uri(sa_ptr->spi, KMC_URI_ENCRYPT, sa_ptr->ek_ref, AES_CBC_TRANSFORMATION, 0, encrypt_tail, iv_base64);
+    }
+    if(encrypt_uri == NULL)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
     }
-
-    encrypt_uri = (char*) malloc(strlen(kmc_root_uri)+len_encrypt_endpoint);
-    encrypt_uri[0] = '\0';
-    strcat(encrypt_uri, kmc_root_uri);
-    strcat(encrypt_uri, encrypt_endpoint_final);
     
 #ifdef DEBUG
     printf("Encrypt URI: %s\n",encrypt_uri);
 #endif
     curl_easy_setopt(curl, CURLOPT_URL, encrypt_uri);
 
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, http_headers_list);
 
-    memory_write* chunk_write = (memory_write*) calloc(1,MEMORY_WRITE_SIZE);
-    memory_read* chunk_read = (memory_read*) calloc(1,MEMORY_READ_SIZE);;
-    /* Configure CURL for POST */
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    /* send all data to this function  */
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
-    /* we pass our 'chunk' struct to the callback function */
+    memory_write* chunk_write = kmc_response_reset(&kmc_response);
+    memory_read* chunk_read = &kmc_request;
+    /* we pass our 'chunk' structs to the callback functions */
     curl_easy_setopt(curl, CURLOPT_READDATA, chunk_read);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    /* we pass our 'chunk' struct to the callback function */
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, chunk_write);
 
     /* size of the POST data */
@@ -383,150 +505,49 @@ static int32_t cryptography_encrypt(uint8_t* data_out, size_t len_data_out,
 
     /* JSON Response Handling */
 
-    // Parse the JSON string response
-    jsmn_parser p;
-    jsmntok_t t[64]; /* We expect no more than 64 JSON tokens */
-    jsmn_init(&p);
-    int parse_result = jsmn_parse(&p, chunk_write->response, strlen(chunk_write->response), t, 64); // "chunk->response" is the char array holding the json content
-
-    // Find the 'base64ciphertext' token
-    if (parse_result < 0) {
-        status = CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR;
-        printf("Failed to parse JSON: %d\n", parse_result);
+    kmc_json_t json;
+    const char* value;
+    size_t value_len;
+    size_t decoded_len = 0;
+    status = kmc_json_parse(chunk_write, &json, CRYPTO_FALSE);
+    if(status != CRYPTO_LIB_SUCCESS)
+    {
         return status;
     }
 
-    int json_idx = 0;
-    uint8_t ciphertext_found = CRYPTO_FALSE;
-    char* ciphertext_base64 = NULL;
-    char* ciphertext_IV_base64 = NULL;
-    for (json_idx = 1; json_idx < parse_result; json_idx++)
+    // Service generated IV, it goes in the security header ahead of the data
+    if(iv == NULL && kmc_json_field(&json, "metadata", &value, &value_len) == CRYPTO_TRUE &&
+       kmc_metadata_field(value, value_len, "initialVector", &value, &value_len) == CRYPTO_TRUE)
     {
-        if (jsoneq(chunk_write->response, &t[json_idx], "metadata") == 0)
-        {
-            uint32_t len_ciphertext = t[json_idx + 1].end - t[json_idx + 1].start;
-            ciphertext_IV_base64 = malloc(len_ciphertext+1);
-            memcpy(ciphertext_IV_base64,chunk_write->response + t[json_idx + 1].start, len_ciphertext);
-            ciphertext_IV_base64[len_ciphertext] = '\0';
-            
-            
-            char* line;
-            char* token;
-            char temp_buff[256];
-            for (line = strtok (ciphertext_IV_base64, ","); line !=NULL; line = strtok(line + strlen(line) + 1, ","))
-            {
-                strncpy(temp_buff, line, sizeof(temp_buff));
-
-                for (token = strtok(temp_buff, ":"); token != NULL; token = strtok(token + strlen(token) + 1, ":"))
-                {
-                    if(strcmp(token, "initialVector") == 0){
-                        token = strtok(token + strlen(token) + 1, ":");
-                        char * ciphertext_token_base64 = malloc(strlen(token));
-                        size_t cipher_text_token_len = strlen(token);
-                        memcpy(ciphertext_token_base64,token, cipher_text_token_len);
-                        #ifdef DEBUG
-                        printf("IV LENGTH: %d\n", iv_len);
-                        printf("IV ENCODED Text: %s\nIV ENCODED TEXT LEN: %ld\n", ciphertext_token_base64, cipher_text_token_len);
-                        #endif
-                        char* iv_decoded = malloc((iv_len)*2 + 1);
-                        size_t iv_decoded_len = 0;
-                        base64urlDecode(ciphertext_token_base64,cipher_text_token_len,iv_decoded, &iv_decoded_len);
-                        #ifdef DEBUG
-                        printf("Decoded IV Text Length: %ld\n", iv_decoded_len);
-                        printf("Decoded IV Text: \n");
-                        for (uint32_t i=0; i < iv_decoded_len; i++)
-                        {
-                            printf("%02x ", (uint8_t)iv_decoded[i]);
-                        }
-                        printf("\n");
-                        #endif
-                        
-                        if(iv == NULL)
-                        {
-                            memcpy(data_out - sa_ptr->shsnf_len - sa_ptr->shivf_len - sa_ptr->shplf_len, iv_decoded, iv_decoded_len);
-                        }
-                        free(ciphertext_token_base64);
-                        break;
-                    }
-                }
-            }
-            
-
-              
-            json_idx++;
-            continue;
-        }
-
-        if (jsoneq(chunk_write->response, &t[json_idx], "base64ciphertext") == 0)
-        {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("Json base64ciphertext: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_ciphertext = t[json_idx + 1].end - t[json_idx + 1].start;
-            ciphertext_base64 = malloc(len_ciphertext+1);
-            memcpy(ciphertext_base64,chunk_write->response + t[json_idx + 1].start, len_ciphertext);
-            ciphertext_base64[len_ciphertext] = '\0';
 #ifdef DEBUG
-            printf("Parsed base64ciphertext: %s\n",ciphertext_base64);
+        printf("IV ENCODED Text: %.*s\n", (int)value_len, value);
 #endif
-            json_idx++;
-            ciphertext_found = CRYPTO_TRUE;
-            continue;
-        }
-
-        if (jsoneq(chunk_write->response, &t[json_idx], "httpCode") == 0)
+        status = kmc_base64_decode(value, value_len, BASE64_ALPHABET_URL, 0,
+                                   data_out - sa_ptr->shsnf_len - sa_ptr->shivf_len - sa_ptr->shplf_len, iv_len,
+                                   &decoded_len);
+        if(status != CRYPTO_LIB_SUCCESS)
         {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("httpCode: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_httpcode = t[json_idx + 1].end - t[json_idx + 1].start;
-            char* http_code_str = malloc(len_httpcode+1);
-            memcpy(http_code_str,chunk_write->response + t[json_idx + 1].start, len_httpcode);
-            http_code_str[len_httpcode] = '\0';
-            int http_code = atoi(http_code_str);
-#ifdef DEBUG
-            printf("Parsed http code: %d\n",http_code);
-#endif
-            if(http_code != 200)
-            {
-                status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
-                fprintf(stderr,"KMC Crypto Failure Response:\n%s\n",chunk_write->response);
-                return status;
-            }
-            free(http_code_str);
-            json_idx++;
-            continue;
+            return status;
         }
-
     }
-    if(ciphertext_found == CRYPTO_FALSE){
-        status = CRYPTOGRAHPY_KMC_CIPHER_TEXT_NOT_FOUND_IN_JSON_RESPONSE;
-        return status;
+
+    if(kmc_json_field(&json, "base64ciphertext", &value, &value_len) == CRYPTO_FALSE)
+    {
+        return CRYPTOGRAHPY_KMC_CIPHER_TEXT_NOT_FOUND_IN_JSON_RESPONSE;
     }
+#ifdef DEBUG
+    printf("Json base64ciphertext: %.*s\n", (int)value_len, value);
+#endif
 
     /* JSON Response Handling End */
 
-
-    uint8_t* ciphertext_decoded = malloc((len_data_out)*2 + 1);
-    size_t ciphertext_decoded_len = 0;
-    base64Decode(ciphertext_base64,strlen(ciphertext_base64),ciphertext_decoded, &ciphertext_decoded_len);
+    // Crypto Service returns cipher_text, decoded straight into the output stream
+    status = kmc_base64_decode(value, value_len, BASE64_ALPHABET_STANDARD, 0, data_out, len_data_out, &decoded_len);
 #ifdef DEBUG
-    printf("Decoded Cipher Text Length: %ld\n",ciphertext_decoded_len);
-    printf("Decoded Cipher Text: \n");
+    printf("Decoded Cipher Text Length: %ld\n",decoded_len);
     printf("Data Out Len: %ld\n", len_data_out);
-    for (uint32_t i=0; i < ciphertext_decoded_len; i++)
-    {
-        printf("%02x ", ciphertext_decoded[i]);
-    }
-    printf("\n");
+    Crypto_hexprint(data_out, decoded_len);
 #endif
-
-    // Crypto Service returns aad - cipher_text - tag
-    memcpy(data_out,ciphertext_decoded,ciphertext_decoded_len);
     return status;
 }
 
@@ -541,20 +562,21 @@ static int32_t cryptography_decrypt(uint8_t* data_out, size_t len_data_out,
     ecs = ecs;
     acs = acs;
 
-    // Get the key length in bits, in string format.
+    // Get the key length in bits
     // TODO -- Parse the key length from the keyInfo endpoint of the Crypto Service!
     uint32_t key_len_in_bits = len_key * 8; // 8 bits per byte.
-    uint32_t key_len_in_bits_str_len = 0;
-    char* key_len_in_bits_str = int_to_str(key_len_in_bits, &key_len_in_bits);
 
-    curl_easy_reset(curl);
-    status = configure_curl_connect_opts(curl, cam_cookies);
+    status = configure_curl_request_opts(curl, cam_cookies);
     if(status != CRYPTO_LIB_SUCCESS)
     {
         return status;
     }
     // Base64 URL encode IV for KMC REST Encrypt
-    char* iv_base64 = (char*)calloc(1,B64ENCODE_OUT_SAFESIZE(iv_len)+1);
+    char iv_base64[B64ENCODE_OUT_SAFESIZE(IV_SIZE) + 1] = {0};
+    if(iv_len > IV_SIZE)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
     base64urlEncode(iv,iv_len,iv_base64,NULL);
 
     uint8_t* decrypt_payload = data_in;
@@ -571,35 +593,23 @@ static int32_t cryptography_decrypt(uint8_t* data_out, size_t len_data_out,
         return status;
     }
 
-    char* decrypt_uri;
-    
-    int len_decrypt_endpoint = strlen(decrypt_endpoint)+ key_len_in_bits_str_len + strlen(sa_ptr->ek_ref)+strlen(iv_base64)+strlen(AES_CBC_TRANSFORMATION) + strlen(AES_CRYPTO_ALGORITHM);
-    char* decrypt_endpoint_final = (char*) malloc(len_decrypt_endpoint);
-
-    snprintf(decrypt_endpoint_final,len_decrypt_endpoint,decrypt_endpoint,key_len_in_bits_str,sa_ptr->ek_ref,AES_CBC_TRANSFORMATION, iv_base64, AES_CRYPTO_ALGORITHM);
-    free(key_len_in_bits_str);
-    decrypt_uri = (char*) malloc(strlen(kmc_root_uri)+len_decrypt_endpoint);
-    decrypt_uri[0] = '\0';
-    strcat(decrypt_uri, kmc_root_uri);
-    strcat(decrypt_uri, decrypt_endpoint_final);
+    const char* decrypt_uri = kmc_uri(sa_ptr->spi, KMC_URI_DECRYPT, sa_ptr->ek_ref, AES_CBC_TRANSFORMATION, key_len_in_bits,
+                                      decrypt_tail, iv_base64, AES_CRYPTO_ALGORITHM);
+    if(decrypt_uri == NULL)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
 
 #ifdef DEBUG
     printf("Decrypt URI: %s\n",decrypt_uri);
 #endif
     curl_easy_setopt(curl, CURLOPT_URL, decrypt_uri);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, http_headers_list);
 
-    memory_write* chunk_write = (memory_write*) calloc(1,MEMORY_WRITE_SIZE);
-    memory_read* chunk_read = (memory_read*) calloc(1,MEMORY_READ_SIZE);;
+    memory_write* chunk_write = kmc_response_reset(&kmc_response);
+    memory_read* chunk_read = &kmc_request;
 
-    /* Configure CURL for POST */
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    /* send all data to this function  */
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
-    /* we pass our 'chunk' struct to the callback function */
+    /* we pass our 'chunk' structs to the callback functions */
     curl_easy_setopt(curl, CURLOPT_READDATA, chunk_read);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    /* we pass our 'chunk' struct to the callback function */
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, chunk_write);
 
     /* size of the POST data */
@@ -625,92 +635,32 @@ static int32_t cryptography_decrypt(uint8_t* data_out, size_t len_data_out,
 
     /* JSON Response Handling */
 
-    // Parse the JSON string response
-    jsmn_parser p;
-    jsmntok_t t[64]; /* We expect no more than 64 JSON tokens */
-    jsmn_init(&p);
-    int parse_result = jsmn_parse(&p, chunk_write->response, strlen(chunk_write->response), t, 64); // "chunk->response" is the char array holding the json content
-
-    // Find the 'base64ciphertext' token
-    if (parse_result < 0) {
-        status = CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR;
-        printf("Failed to parse JSON: %d\n", parse_result);
+    kmc_json_t json;
+    const char* cleartext_base64;
+    size_t cleartext_base64_len;
+    size_t cleartext_decoded_len = 0;
+    status = kmc_json_parse(chunk_write, &json, CRYPTO_FALSE);
+    if(status != CRYPTO_LIB_SUCCESS)
+    {
         return status;
     }
-
-    int json_idx = 0;
-    uint8_t ciphertext_found = CRYPTO_FALSE;
-    char* cleartext_base64 = NULL;
-    for (json_idx = 1; json_idx < parse_result; json_idx++)
+    if(kmc_json_field(&json, "base64cleartext", &cleartext_base64, &cleartext_base64_len) == CRYPTO_FALSE)
     {
-        // check "httpCode" field for non-200 status codes!!!
-        if (jsoneq(chunk_write->response, &t[json_idx], "base64cleartext") == 0)
-        {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("Json base64cleartext: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_cleartext = t[json_idx + 1].end - t[json_idx + 1].start;
-            cleartext_base64 = malloc(len_cleartext+1);
-            memcpy(cleartext_base64,chunk_write->response + t[json_idx + 1].start, len_cleartext);
-            cleartext_base64[len_cleartext] = '\0';
-#ifdef DEBUG
-            printf("Parsed base64cleartext: %s\n",cleartext_base64);
-#endif
-            json_idx++;
-            ciphertext_found = CRYPTO_TRUE;
-            continue;
-        }
-        if (jsoneq(chunk_write->response, &t[json_idx], "httpCode") == 0)
-        {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("httpCode: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_httpcode = t[json_idx + 1].end - t[json_idx + 1].start;
-            char* http_code_str = malloc(len_httpcode+1);
-            memcpy(http_code_str,chunk_write->response + t[json_idx + 1].start, len_httpcode);
-            http_code_str[len_httpcode] = '\0';
-            int http_code = atoi(http_code_str);
+        return CRYPTOGRAHPY_KMC_CIPHER_TEXT_NOT_FOUND_IN_JSON_RESPONSE;
+    }
 #ifdef DEBUG
-            printf("Parsed http code: %d\n",http_code);
+    printf("Json base64cleartext: %.*s\n", (int)cleartext_base64_len, cleartext_base64);
 #endif
-            if(http_code != 200)
-            {
-                status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
-                fprintf(stderr,"KMC Crypto Failure Response:\n%s\n",chunk_write->response);
-                return status;
-            }
-            free(http_code_str);
-            json_idx++;
-            continue;
-        }
-    }
-    if(ciphertext_found == CRYPTO_FALSE){
-        status = CRYPTOGRAHPY_KMC_CIPHER_TEXT_NOT_FOUND_IN_JSON_RESPONSE;
-        return status;
-    }
 
     /* JSON Response Handling End */
 
-    uint8_t* cleartext_decoded = malloc((len_data_out)*2 + 1);
-    size_t cleartext_decoded_len = 0;
-    base64Decode(cleartext_base64,strlen(cleartext_base64),cleartext_decoded, &cleartext_decoded_len);
+    // Decode the decrypted data straight into the output stream
+    status = kmc_base64_decode(cleartext_base64, cleartext_base64_len, BASE64_ALPHABET_STANDARD, 0, data_out,
+                               len_data_out, &cleartext_decoded_len);
 #ifdef DEBUG
-    printf("Decoded Cipher Text Length: %ld\n",cleartext_decoded_len);
-    printf("Decoded Cipher Text: \n");
-    for (uint32_t i=0; i < cleartext_decoded_len; i++)
-    {
-        printf("%02x ", cleartext_decoded[i]);
-    }
-    printf("\n");
+    printf("Decoded Clear Text Length: %ld\n",cleartext_decoded_len);
+    Crypto_hexprint(data_out, cleartext_decoded_len);
 #endif
-    // Copy the decrypted data to the output stream
-    // Crypto Service returns aad - clear_text
-    memcpy(data_out,cleartext_decoded, len_data_out);
-    
     return status;
 }
 
@@ -733,8 +683,7 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
     iv_len = iv_len;
     ecs = ecs;
     
-    curl_easy_reset(curl);
-    status = configure_curl_connect_opts(curl, cam_cookies);
+    status = configure_curl_request_opts(curl, cam_cookies);
     if(status != CRYPTO_LIB_SUCCESS)
     {
         return status;
@@ -769,32 +718,22 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
     }
 
     // Prepare the Authentication Endpoint URI for KMC Crypto Service
-    int len_auth_endpoint = strlen(icv_create_endpoint)+strlen(sa_ptr->ak_ref);
-    char* auth_endpoint_final = (char*) malloc(len_auth_endpoint);
-    snprintf(auth_endpoint_final,len_auth_endpoint,icv_create_endpoint,sa_ptr->ak_ref);
-
-    char* auth_uri = (char*) malloc(strlen(kmc_root_uri)+len_auth_endpoint);
-    auth_uri[0] = '\0';
-    strcat(auth_uri, kmc_root_uri);
-    strcat(auth_uri, auth_endpoint_final);
+    const char* auth_uri = kmc_uri(sa_ptr->spi, KMC_URI_ICV_CREATE, sa_ptr->ak_ref, NULL, 0, NULL);
+    if(auth_uri == NULL)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
 
 #ifdef DEBUG
     printf("Authentication URI: %s\n",auth_uri);
 #endif
     curl_easy_setopt(curl, CURLOPT_URL, auth_uri);
 
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, http_headers_list);
 
-    memory_write* chunk_write = (memory_write*) calloc(1,MEMORY_WRITE_SIZE);
-    memory_read* chunk_read = (memory_read*) calloc(1,MEMORY_READ_SIZE);;
-    /* Configure CURL for POST */
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    /* send all data to this function  */
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
-    /* we pass our 'chunk' struct to the callback function */
+    memory_write* chunk_write = kmc_response_reset(&kmc_response);
+    memory_read* chunk_read = &kmc_request;
+    /* we pass our 'chunk' structs to the callback functions */
     curl_easy_setopt(curl, CURLOPT_READDATA, chunk_read);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    /* we pass our 'chunk' struct to the callback function */
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, chunk_write);
 
     /* size of the POST data */
@@ -820,127 +759,41 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
 
     /* JSON Response Handling */
 
-    // Parse the JSON string response
-    jsmn_parser p;
-    jsmntok_t t[64]; /* We expect no more than 64 JSON tokens */
-    jsmn_init(&p);
-    int parse_result = jsmn_parse(&p, chunk_write->response, strlen(chunk_write->response), t, 64); // "chunk->response" is the char array holding the json content
-
-    // Find the 'integrityCheckValue' token
-    if (parse_result < 0) {
-        status = CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR;
-        printf("Failed to parse JSON: %d\n", parse_result);
+    kmc_json_t json;
+    const char* metadata;
+    size_t metadata_len;
+    const char* icv_base64;
+    size_t icv_base64_len;
+    size_t icv_decoded_len = 0;
+    status = kmc_json_parse(chunk_write, &json, CRYPTO_FALSE);
+    if(status != CRYPTO_LIB_SUCCESS)
+    {
         return status;
     }
 
-    int json_idx = 0;
-    uint8_t icvtext_found = CRYPTO_FALSE;
-    char* icv_base64 = NULL;
-    for (json_idx = 1; json_idx < parse_result; json_idx++)
+    // Format: "integrityCheckValue:xQgnkVrrQj8FRALV3DxnVg==,keyRef:kmc/test/nist_cmac_90,cryptoAlgorithm:AESCMAC,metadataType:IntegrityCheckMetadata"
+    if(kmc_json_field(&json, "metadata", &metadata, &metadata_len) == CRYPTO_FALSE ||
+       kmc_metadata_field(metadata, metadata_len, "integrityCheckValue", &icv_base64, &icv_base64_len) == CRYPTO_FALSE)
     {
-        if (jsoneq(chunk_write->response, &t[json_idx], "metadata") == 0)
-        {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("Json metadata: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            // search through metadata string for base64 ICV end idx:
-            // Format: "integrityCheckValue:xQgnkVrrQj8FRALV3DxnVg==,keyRef:kmc/test/nist_cmac_90,cryptoAlgorithm:AESCMAC,metadataType:IntegrityCheckMetadata"
-            uint32_t len_metadata = t[json_idx + 1].end - t[json_idx + 1].start;
-            char* metadata = malloc(len_metadata+1);
-            char* metadata_end = &metadata[len_metadata];
-            memcpy(metadata,chunk_write->response + t[json_idx + 1].start, len_metadata);
-
-            char* key = "";
-            size_t colon_idx;
-            size_t comma_idx;
-            while(CRYPTO_TRUE)
-            {
-                colon_idx = strcspn(metadata,":");
-                comma_idx = strcspn(metadata,",");
-                key = malloc(colon_idx+1);
-                strncpy(key,metadata,colon_idx);
-                key[colon_idx]='\0';
-#ifdef DEBUG
-                printf("Found key in metadata: %s\n",key);
-#endif
-                if(strcmp(key,"integrityCheckValue")==0){
-                    break; // key found!
-                }
-                if(strcmp(key,"integrityCheckValue")!=0){
-                    metadata += comma_idx+1;
-                    if(metadata >= metadata_end)
-                    {
-                        status = CRYPTOGRAHPY_KMC_ICV_NOT_FOUND_IN_JSON_RESPONSE;
-                        return status;
-                    }
-                }
-            }
-
-            metadata += colon_idx+1;
-            comma_idx = strcspn(metadata,",");
-            icv_base64 = malloc(comma_idx+1);
-            strncpy(icv_base64,metadata,comma_idx);
-            icv_base64[comma_idx] = '\0';
+        return CRYPTOGRAHPY_KMC_ICV_NOT_FOUND_IN_JSON_RESPONSE;
+    }
 #ifdef DEBUG
-            printf("Parsed integrityCheckValue: %s\n",icv_base64);
+    printf("Parsed integrityCheckValue: %.*s\n", (int)icv_base64_len, icv_base64);
 #endif
-            json_idx++;
-            icvtext_found = CRYPTO_TRUE;
-            continue;
-        }
 
-        if (jsoneq(chunk_write->response, &t[json_idx], "httpCode") == 0)
-        {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("httpCode: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_httpcode = t[json_idx + 1].end - t[json_idx + 1].start;
-            char* http_code_str = malloc(len_httpcode+1);
-            memcpy(http_code_str,chunk_write->response + t[json_idx + 1].start, len_httpcode);
-            http_code_str[len_httpcode] = '\0';
-            int http_code = atoi(http_code_str);
-#ifdef DEBUG
-            printf("Parsed http code: %d\n",http_code);
-#endif
-            if(http_code != 200)
-            {
-                status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
-                fprintf(stderr,"KMC Crypto Failure Response:\n%s\n",chunk_write->response);
-                return status;
-            }
-            json_idx++;
-            free(http_code_str);
-            continue;
-        }
+    /* JSON Response Handling End */
 
-    }
-    if(icvtext_found == CRYPTO_FALSE){
+    // The ICV may be longer than the MAC field, which holds its leading bytes
+    status = kmc_base64_decode(icv_base64, icv_base64_len, BASE64_ALPHABET_URL, 0, mac, mac_size, &icv_decoded_len);
+    if(status == CRYPTO_LIB_SUCCESS && icv_decoded_len != mac_size)
+    {
         status = CRYPTOGRAHPY_KMC_ICV_NOT_FOUND_IN_JSON_RESPONSE;
-        return status;
     }
-
-    /* JSON Response Handling End */
-
-    // https://stackoverflow.com/questions/13378815/base64-length-calculation
-    uint8_t* icv_decoded = calloc(1,B64DECODE_OUT_SAFESIZE(strlen(icv_base64)) + 1);
-    size_t icv_decoded_len = 0;
-    base64urlDecode(icv_base64,strlen(icv_base64),icv_decoded, &icv_decoded_len);
 #ifdef DEBUG
     printf("Mac size: %d\n",mac_size);
     printf("Decoded ICV Length: %ld\n",icv_decoded_len);
-    printf("Decoded ICV Text: \n");
-    for (uint32_t i=0; i < icv_decoded_len; i++)
-    {
-        printf("%02x ", icv_decoded[i]);
-    }
-    printf("\n");
+    Crypto_hexprint(mac, icv_decoded_len);
 #endif
-
-    memcpy(mac,icv_decoded, mac_size);
     return status;
 }
 
@@ -977,8 +830,7 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
         return CRYPTO_LIB_ERR_NULL_BUFFER;
     }
 
-    curl_easy_reset(curl);
-    status = configure_curl_connect_opts(curl, cam_cookies);
+    status = configure_curl_request_opts(curl, cam_cookies);
     if(status != CRYPTO_LIB_SUCCESS)
     {
         return status;
@@ -987,7 +839,11 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
     size_t auth_payload_len = aad_len;
 
     // Base64 URL encode MAC for KMC REST Encrypt
-    char* mac_base64 = (char*)calloc(1,B64ENCODE_OUT_SAFESIZE(mac_size) + 1);
+    char mac_base64[B64ENCODE_OUT_SAFESIZE(MAC_SIZE) + 1] = {0};
+    if(mac_size > MAC_SIZE)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
     base64urlEncode(mac,mac_size,mac_base64,NULL);
 #ifdef DEBUG
     printf("MAC Base64 URL Encoded: %s\n",mac_base64);
@@ -1004,18 +860,13 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
     const char* auth_algorithm = NULL;
     get_auth_algorithm_from_acs(acs,&auth_algorithm);
 
-    uint32_t mac_size_str_len = 0;
-    char* mac_size_str = int_to_str(mac_size*8, &mac_size_str_len);
-
     // Prepare the Authentication Endpoint URI for KMC Crypto Service
-    int len_auth_endpoint = strlen(icv_verify_endpoint)+strlen(mac_base64)+strlen(sa_ptr->ak_ref)+strlen(auth_algorithm)+mac_size_str_len;
-    char* auth_endpoint_final = (char*) malloc(len_auth_endpoint);
-    snprintf(auth_endpoint_final,len_auth_endpoint,icv_verify_endpoint,mac_base64,sa_ptr->ak_ref,auth_algorithm,mac_size_str);
-    free(mac_size_str);
-    char* auth_uri = (char*) malloc(strlen(kmc_root_uri)+len_auth_endpoint);
-    auth_uri[0] = '\0';
-    strcat(auth_uri, kmc_root_uri);
-    strcat(auth_uri, auth_endpoint_final);
+    const char* auth_uri = kmc_uri(sa_ptr->spi, KMC_URI_ICV_VERIFY, sa_ptr->ak_ref, NULL, 0, icv_verify_tail, mac_base64,
+                                   sa_ptr->ak_ref, auth_algorithm, mac_size * 8);
+    if(auth_uri == NULL)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
 
 #ifdef DEBUG
     printf("Authentication Verification URI: %s\n",auth_uri);
@@ -1023,18 +874,11 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
 
     curl_easy_setopt(curl, CURLOPT_URL, auth_uri);
 
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, http_headers_list);
 
-    memory_write* chunk_write = (memory_write*) calloc(1,MEMORY_WRITE_SIZE);
-    memory_read* chunk_read = (memory_read*) calloc(1,MEMORY_READ_SIZE);;
-    /* Configure CURL for POST */
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    /* send all data to this function  */
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
-    /* we pass our 'chunk' struct to the callback function */
+    memory_write* chunk_write = kmc_response_reset(&kmc_response);
+    memory_read* chunk_read = &kmc_request;
+    /* we pass our 'chunk' structs to the callback functions */
     curl_easy_setopt(curl, CURLOPT_READDATA, chunk_read);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    /* we pass our 'chunk' struct to the callback function */
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, chunk_write);
 
     /* size of the POST data */
@@ -1060,77 +904,26 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
 
     /* JSON Response Handling */
 
-    // Parse the JSON string response
-    jsmn_parser p;
-    jsmntok_t t[64]; /* We expect no more than 64 JSON tokens */
-    jsmn_init(&p);
-    int parse_result = jsmn_parse(&p, chunk_write->response, strlen(chunk_write->response), t, 64); // "chunk->response" is the char array holding the json content
-
-    if (parse_result < 0) {
-        status = CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR;
-        printf("Failed to parse JSON: %d\n", parse_result);
+    kmc_json_t json;
+    const char* result;
+    size_t result_len;
+    status = kmc_json_parse(chunk_write, &json, CRYPTO_TRUE);
+    if(status != CRYPTO_LIB_SUCCESS)
+    {
         return status;
     }
-
-    int json_idx = 0;
-    uint8_t http_status_found = CRYPTO_FALSE;
-    for (json_idx = 1; json_idx < parse_result; json_idx++)
+    if(kmc_json_field(&json, "result", &result, &result_len) == CRYPTO_TRUE)
     {
-        if (jsoneq(chunk_write->response, &t[json_idx], "httpCode") == 0)
-        {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("httpCode: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_httpcode = t[json_idx + 1].end - t[json_idx + 1].start;
-            char* http_code_str = malloc(len_httpcode+1);
-            memcpy(http_code_str,chunk_write->response + t[json_idx + 1].start, len_httpcode);
-            http_code_str[len_httpcode] = '\0';
-            http_status_found = CRYPTO_TRUE;
-            int http_code = atoi(http_code_str);
 #ifdef DEBUG
-            printf("Parsed http code: %d\n",http_code);
+        printf("Parsed result string: %.*s\n", (int)result_len, result);
 #endif
-            if(http_code != 200)
-            {
-                status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
-                fprintf(stderr,"KMC Crypto Generic Failure Response:\n%s\n",chunk_write->response);
-                return status;
-            }
-            json_idx++;
-            free(http_code_str);
-            continue;
-        }
-
-        if (jsoneq(chunk_write->response, &t[json_idx], "result") == 0)
+        if(result_len != 4 || memcmp(result, "true", 4) != 0) // KMC crypto service returns true string if ICV check succeeds.
         {
-#ifdef DEBUG
-            printf("result: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_result = t[json_idx + 1].end - t[json_idx + 1].start;
-            char* result_str = malloc(len_result+1);
-            memcpy(result_str,chunk_write->response + t[json_idx + 1].start, len_result);
-            result_str[len_result] = '\0';
-
-#ifdef DEBUG
-            printf("Parsed result string: %s\n",result_str);
-#endif
-            if(strcmp(result_str,"true")!=0) // KMC crypto service returns true string if ICV check succeeds.
-            {
-                status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_MAC_VALIDATION_ERROR;
-                fprintf(stderr,"KMC Crypto MAC Validation Failure Response:\n%s\n",chunk_write->response);
-                return status;
-            }
-            continue;
+            status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_MAC_VALIDATION_ERROR;
+            fprintf(stderr,"KMC Crypto MAC Validation Failure Response:\n%s\n",chunk_write->response);
+            return status;
         }
     }
-    if(http_status_found == CRYPTO_FALSE){
-        status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
-        fprintf(stderr,"KMC Crypto Generic Failure Response:\n%s\n",chunk_write->response);
-        return status;
-    }
 
     /* JSON Response Handling End */
 
@@ -1153,362 +946,521 @@ static int32_t cryptography_aead_encrypt(uint8_t* data_out, size_t len_data_out,
     ecs = ecs;
     acs = acs;
 
-    curl_easy_reset(curl);
-    status = configure_curl_connect_opts(curl, cam_cookies);
+    status = configure_curl_request_opts(curl, cam_cookies);
     if(status != CRYPTO_LIB_SUCCESS)
     {
         return status;
     }
-    // Base64 URL encode IV for KMC REST Encrypt
-    char* iv_base64 = (char*)calloc(1,B64ENCODE_OUT_SAFESIZE(iv_len)+1);
-    if(iv != NULL)
+
+    const char* encrypt_uri = NULL;
+    uint8_t* encrypt_payload = NULL;
+    size_t encrypt_payload_len = 0;
+    status = kmc_aead_encrypt_request(sa_ptr, data_in, len_data_in, iv, iv_len, mac_size, aad, aad_len,
+                                      encrypt_bool, aad_bool, &encrypt_uri, &encrypt_payload, &encrypt_payload_len);
+    if(status != CRYPTO_LIB_SUCCESS)
     {
-        base64urlEncode(iv,iv_len,iv_base64,NULL);
+        return status;
     }
-    
-    #ifdef DEBUG
-    printf("IV_BASE64: %s\n", iv_base64);
-    #endif
-
-    uint8_t* encrypt_payload = data_in;
-    size_t encrypt_payload_len = len_data_in;
 
 #ifdef DEBUG
-    printf("IV Base64 URL Encoded: %s\n",iv_base64);
+    printf("Encrypt URI AEAD: %s\n",encrypt_uri);
 #endif
+    curl_easy_setopt(curl, CURLOPT_URL, encrypt_uri);
 
-    if(sa_ptr->ek_ref[0] == '\0')
-    {
-        status = CRYPTOGRAHPY_KMC_NULL_ENCRYPTION_KEY_REFERENCE_IN_SA;
-        free(iv_base64);
-        return status;
-    }
 
-    char* encrypt_uri;
-    if(aad_bool == CRYPTO_TRUE)
-    {
-        //Determine length of aad offset string and convert to string for use in URL
-        uint32_t aad_offset_str_len = 0;
+    memory_write* chunk_write = kmc_response_reset(&kmc_response);
+    memory_read* chunk_read = &kmc_request;
+    /* we pass our 'chunk' structs to the callback functions */
+    curl_easy_setopt(curl, CURLOPT_READDATA, chunk_read);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, chunk_write);
+
+    /* size of the POST data */
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long) encrypt_payload_len);
+    /* binary data */
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, encrypt_payload);
 
-        char* aad_offset_str = int_to_str(aad_len, &aad_offset_str_len);
 #ifdef DEBUG
-        printf("AAD Offset Str: %s\n",aad_offset_str);
+    printf("Data to Encrypt: \n");
+    for (uint32_t i=0; i < encrypt_payload_len; i++)
+    {
+        printf("%02x ", encrypt_payload[i]);
+    }
+    printf("\n");
 #endif
 
-        uint32_t mac_size_str_len = 0;
-        char* mac_size_str = int_to_str(mac_size*8, &mac_size_str_len);
-        
-        int len_encrypt_endpoint = strlen(encrypt_offset_endpoint)+strlen(sa_ptr->ek_ref)+strlen(iv_base64)+strlen(AES_GCM_TRANSFORMATION)+aad_offset_str_len + mac_size_str_len;
-        char* encrypt_endpoint_final = (char*) malloc(len_encrypt_endpoint);
-        if(iv != NULL)
-        {
-                                   
-            snprintf(encrypt_endpoint_final,len_encrypt_endpoint,encrypt_offset_endpoint,sa_ptr->ek_ref,AES_GCM_TRANSFORMATION, iv_base64,aad_offset_str,mac_size_str);
-        }
-        else
-        { 
-            //"encrypt?keyRef=%s&transformation=%s&encryptOffset=%s&macLength=%s";
-            snprintf(encrypt_endpoint_final,len_encrypt_endpoint,encrypt_offset_endpoint_null_iv,sa_ptr->ek_ref,AES_GCM_TRANSFORMATION,aad_offset_str,mac_size_str);
-        }
-        
-
-        free(aad_offset_str);
-        free(mac_size_str);
+    status = curl_perform_with_cam_retries(curl,chunk_write,chunk_read);
 #ifdef DEBUG
-        printf("KMC ROOT URI: %s\n",kmc_root_uri);
+    printf("Curl Perform Final Status Code: %d\n",status);
+    if(chunk_write->response != NULL)
+    {
+        printf("Chunk Write Response Length: %ld\n", strlen(chunk_write->response));
+        printf("Chunk Write Response: %s\n", chunk_write->response);
+    }
 #endif
-        encrypt_uri = (char*) malloc(strlen(kmc_root_uri)+len_encrypt_endpoint);
-        encrypt_uri[0] = '\0';
-        strcat(encrypt_uri, kmc_root_uri);
-        strcat(encrypt_uri, encrypt_endpoint_final);
+    if(status == CRYPTO_LIB_SUCCESS)
+    {
+        status = kmc_aead_encrypt_response(chunk_write, data_out, len_data_out,
+                                           (iv == NULL) ? data_out - sa_ptr->shsnf_len - sa_ptr->shivf_len -
+                                                              sa_ptr->shplf_len
+                                                        : NULL,
+                                           iv_len, mac, mac_size, aad_len, encrypt_bool, authenticate_bool);
+    }
 
-        // Prepare encrypt_payload with AAD at the front for KMC Crypto Service.
-        if(encrypt_bool == CRYPTO_FALSE) //Not encrypting data, only passing in AAD for TAG.
-        {
-            encrypt_payload_len = aad_len;
-        }
-        else // Encrypt & AAD
-        {
-            encrypt_payload_len = len_data_in + aad_len;
-        }
+    if (encrypt_payload != data_in) free(encrypt_payload);
 
 #ifdef DEBUG
-        printf("Encrypt Payload Length: %ld\n",encrypt_payload_len);
-#endif
-        encrypt_payload = (uint8_t*) malloc(encrypt_payload_len);
-        memcpy(&encrypt_payload[0],aad,aad_len);
-        if(encrypt_bool == CRYPTO_TRUE)
-        {
-            memcpy(&encrypt_payload[aad_len],data_in,len_data_in);
+    if(status == CRYPTO_LIB_SUCCESS)
+    {
+        printf("DATA OUT:\n");
+        for(size_t i = 0; i < len_data_out; i++){
+            printf("%02x ", data_out[i]);
         }
-        free(encrypt_endpoint_final); 
+        printf("\n");
     }
-    else //No AAD -- just prepare the endpoint URI
+#endif
+
+    return status;
+}
+
+/**
+ * @brief Function: kmc_aead_encrypt_request
+ * Builds the URI and payload of a Crypto Service AEAD encrypt.  The payload is data_in itself when there is no
+ * AAD, otherwise a malloc'ed copy of AAD followed by the data that the caller frees.
+ * @param uri: const char**, valid until the next kmc_uri call
+ * @param payload: uint8_t**
+ * @param payload_len: size_t*
+ * @return int32: Success/Failure
+ **/
+static int32_t kmc_aead_encrypt_request(SecurityAssociation_t* sa_ptr, uint8_t* data_in, size_t len_data_in,
+                                        uint8_t* iv, uint32_t iv_len, uint32_t mac_size, uint8_t* aad,
+                                        uint32_t aad_len, uint8_t encrypt_bool, uint8_t aad_bool,
+                                        const char** uri, uint8_t** payload, size_t* payload_len)
+{
+    // Base64 URL encode IV for KMC REST Encrypt
+    char iv_base64[B64ENCODE_OUT_SAFESIZE(IV_SIZE) + 1] = {0};
+    if(iv_len > IV_SIZE)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
+    if(iv != NULL)
     {
-        int len_encrypt_endpoint = strlen(encrypt_endpoint)+strlen(sa_ptr->ek_ref)+strlen(iv_base64)+strlen(AES_GCM_TRANSFORMATION);
-        char* encrypt_endpoint_final = (char*) malloc(len_encrypt_endpoint);
+        base64urlEncode(iv,iv_len,iv_base64,NULL);
+    }
+
+#ifdef DEBUG
+    printf("IV Base64 URL Encoded: %s\n",iv_base64);
+#endif
+
+    if(sa_ptr->ek_ref[0] == '\0')
+    {
+        return CRYPTOGRAHPY_KMC_NULL_ENCRYPTION_KEY_REFERENCE_IN_SA;
+    }
+
+    *payload = data_in;
+    *payload_len = len_data_in;
+    if(aad_bool == CRYPTO_TRUE)
+    {
+#ifdef DEBUG
+        printf("AAD Offset: %d\n",aad_len);
+        printf("KMC ROOT URI: %s\n",kmc_root_uri);
+#endif
         if(iv != NULL)
         {
-            snprintf(encrypt_endpoint_final,len_encrypt_endpoint,encrypt_endpoint,sa_ptr->ek_ref,AES_GCM_TRANSFORMATION, iv_base64);
+            *uri = kmc_uri(sa_ptr->spi, KMC_URI_ENCRYPT, sa_ptr->ek_ref, AES_GCM_TRANSFORMATION, 0,
+                           encrypt_offset_tail, iv_base64, aad_len, mac_size * 8);
         }
         else
+        { 
+            *uri = kmc_uri(sa_ptr->spi, KMC_URI_ENCRYPT, sa_ptr->ek_ref, AES_GCM_TRANSFORMATION, 0,
+                           encrypt_offset_tail_null_iv, aad_len, mac_size * 8);
+        }
+        if(*uri == NULL)
         {
-            snprintf(encrypt_endpoint_final,len_encrypt_endpoint,encrypt_endpoint_null_iv,sa_ptr->ek_ref,AES_GCM_TRANSFORMATION);
+            return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
         }
-        
 
-        encrypt_uri = (char*) malloc(strlen(kmc_root_uri)+len_encrypt_endpoint);
-        encrypt_uri[0] = '\0';
-        strcat(encrypt_uri, kmc_root_uri);
-        strcat(encrypt_uri, encrypt_endpoint_final);
-        free(encrypt_endpoint_final);
-    }
+        // Prepare encrypt_payload with AAD at the front for KMC Crypto Service.
+        if(encrypt_bool == CRYPTO_FALSE) //Not encrypting data, only passing in AAD for TAG.
+        {
+            *payload_len = aad_len;
+        }
+        else // Encrypt & AAD
+        {
+            *payload_len = len_data_in + aad_len;
+        }
 
 #ifdef DEBUG
-    printf("Encrypt URI AEAD: %s\n",encrypt_uri);
+        printf("Encrypt Payload Length: %ld\n",*payload_len);
 #endif
-    curl_easy_setopt(curl, CURLOPT_URL, encrypt_uri);
+        *payload = (uint8_t*) malloc(*payload_len);
+        if(*payload == NULL)
+        {
+            return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+        }
+        memcpy(*payload,aad,aad_len);
+        if(encrypt_bool == CRYPTO_TRUE)
+        {
+            memcpy(*payload + aad_len,data_in,len_data_in);
+        }
+    }
+    else //No AAD -- just prepare the endpoint URI
+    {
+        if(iv != NULL)
+        {
+            *uri = kmc_uri(sa_ptr->spi, KMC_URI_ENCRYPT, sa_ptr->ek_ref, AES_GCM_TRANSFORMATION, 0, encrypt_tail,
+                           iv_base64);
+        }
+        else
+        {
+            *uri = kmc_uri(sa_ptr->spi, KMC_URI_ENCRYPT, sa_ptr->ek_ref, AES_GCM_TRANSFORMATION, 0, NULL);
+        }
+        if(*uri == NULL)
+        {
+            return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+        }
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
 
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, http_headers_list);
+/**
+ * @brief Function: kmc_aead_encrypt_response
+ * Unpacks a Crypto Service AEAD encrypt response into the ciphertext and MAC outputs
+ * @param response: memory_write*, JSON body
+ * @param iv_out: uint8_t*, where a service generated IV is written, NULL when the IV was supplied
+ * @return int32: Success/Failure
+ **/
+static int32_t kmc_aead_encrypt_response(memory_write* response, uint8_t* data_out, size_t len_data_out, uint8_t* iv_out,
+                                         uint32_t iv_len, uint8_t* mac, uint32_t mac_size, uint32_t aad_len,
+                                         uint8_t encrypt_bool, uint8_t authenticate_bool)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    kmc_json_t json;
+    const char* value;
+    size_t value_len;
+    size_t decoded_len = 0;
 
-    memory_write* chunk_write = (memory_write*) calloc(1,MEMORY_WRITE_SIZE);
-    memory_read* chunk_read = (memory_read*) calloc(1,MEMORY_READ_SIZE);;
-    /* Configure CURL for POST */
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    /* send all data to this function  */
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
-    /* we pass our 'chunk' struct to the callback function */
-    curl_easy_setopt(curl, CURLOPT_READDATA, chunk_read);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    /* we pass our 'chunk' struct to the callback function */
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, chunk_write);
+    /* JSON Response Handling */
 
-    /* size of the POST data */
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long) encrypt_payload_len);
-    /* binary data */
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, encrypt_payload);
+    status = kmc_json_parse(response, &json, CRYPTO_FALSE);
+    if(status != CRYPTO_LIB_SUCCESS)
+    {
+        return status;
+    }
 
+    if(iv_out != NULL && kmc_json_field(&json, "metadata", &value, &value_len) == CRYPTO_TRUE &&
+       kmc_metadata_field(value, value_len, "initialVector", &value, &value_len) == CRYPTO_TRUE)
+    {
 #ifdef DEBUG
-    printf("Data to Encrypt: \n");
-    for (uint32_t i=0; i < encrypt_payload_len; i++)
+        printf("IV LENGTH: %d\n", iv_len);
+        printf("IV ENCODED Text: %.*s\n", (int)value_len, value);
+#endif
+        status = kmc_base64_decode(value, value_len, BASE64_ALPHABET_URL, 0, iv_out, iv_len, &decoded_len);
+        if(status != CRYPTO_LIB_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    if(kmc_json_field(&json, "base64ciphertext", &value, &value_len) == CRYPTO_FALSE)
     {
-        printf("%02x ", encrypt_payload[i]);
+        return CRYPTOGRAHPY_KMC_CIPHER_TEXT_NOT_FOUND_IN_JSON_RESPONSE;
     }
-    printf("\n");
+#ifdef DEBUG
+    printf("Json base64ciphertext: %.*s\n", (int)value_len, value);
 #endif
 
-    status = curl_perform_with_cam_retries(curl,chunk_write,chunk_read);
-#ifdef DEBUG
-    printf("Curl Perform Final Status Code: %d\n",status);
-    if(chunk_write->response != NULL)
+    /* JSON Response Handling End */
+
+    // Crypto Service returns aad - cipher_text - tag, each part wanted is decoded straight into place
+    if(encrypt_bool == CRYPTO_TRUE)
     {
-        printf("Chunk Write Response Length: %ld\n", strlen(chunk_write->response));
-        printf("Chunk Write Response: %s\n", chunk_write->response);
+        status = kmc_base64_decode(value, value_len, BASE64_ALPHABET_STANDARD, aad_len, data_out, len_data_out,
+                                   &decoded_len);
+        if(status == CRYPTO_LIB_SUCCESS && decoded_len != len_data_out)
+        {
+            status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_AEAD_ENCRYPT_ERROR;
+        }
     }
-#endif
-    if(status != CRYPTO_LIB_SUCCESS)
+
+    // If authenticate, decode the MAC into its field
+    if(status == CRYPTO_LIB_SUCCESS && authenticate_bool == CRYPTO_TRUE)
     {
-        if(iv_base64 != NULL) free(iv_base64);
-        if(encrypt_uri != NULL) free(encrypt_uri);
-        if(chunk_write != NULL) free(chunk_write);
-        if(chunk_read != NULL) free(chunk_read);
-        if(encrypt_payload != NULL) free(encrypt_payload);
-        return status;
+        size_t data_offset = len_data_out;
+        if(encrypt_bool == CRYPTO_FALSE) { data_offset = 0; }
+        status = kmc_base64_decode(value, value_len, BASE64_ALPHABET_STANDARD, aad_len + data_offset, mac, mac_size,
+                                   &decoded_len);
+        if(status == CRYPTO_LIB_SUCCESS && decoded_len != mac_size)
+        {
+            status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_AEAD_ENCRYPT_ERROR;
+        }
     }
+#ifdef DEBUG
+    printf("Mac size: %d\n",mac_size);
+#endif
 
-    /* JSON Response Handling */
+    return status;
+}
 
-    // Parse the JSON string response
-    jsmn_parser p;
-    jsmntok_t t[64]; /* We expect no more than 64 JSON tokens */
-    jsmn_init(&p);
-    int parse_result = jsmn_parse(&p, chunk_write->response, strlen(chunk_write->response), t, 64); // "chunk->response" is the char array holding the json content
-
-    // Find the 'base64ciphertext' token
-    if (parse_result < 0) {
-        status = CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR;
-        printf("Failed to parse JSON: %d\n", parse_result);
-        if(iv_base64 != NULL) free(iv_base64);
-        if(encrypt_uri != NULL) free(encrypt_uri);
-        if(chunk_write != NULL) free(chunk_write);
-        if(chunk_read != NULL) free(chunk_read);
-        if(encrypt_payload != NULL) free(encrypt_payload);
-        return status;
+/**
+ * @brief Function: cryptography_aead_encrypt_async
+ * Queues an AEAD encrypt on the curl multi handle.  Each in flight request has its own easy handle, so with
+ * HTTP/2 the requests are multiplexed over the one Crypto Service connection instead of waiting on each
+ * other's round trip.  When every slot is busy, requests already in flight are completed first.
+ * @return int32: Success/Failure of the submission, the result of the encrypt is passed to done
+ **/
+static int32_t cryptography_aead_encrypt_async(uint8_t* data_out, size_t len_data_out,
+                                               uint8_t* data_in, size_t len_data_in,
+                                               uint8_t* key, uint32_t len_key,
+                                               SecurityAssociation_t* sa_ptr,
+                                               uint8_t* iv, uint32_t iv_len,
+                                               uint8_t* mac, uint32_t mac_size,
+                                               uint8_t* aad, uint32_t aad_len,
+                                               uint8_t encrypt_bool, uint8_t authenticate_bool,
+                                               uint8_t aad_bool, uint8_t* ecs, uint8_t* acs, char* cam_cookies,
+                                               cryptography_async_done_t done, void* op_ctx)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    kmc_async_op_t* op = NULL;
+    const char* encrypt_uri = NULL;
+    uint8_t* encrypt_payload = NULL;
+    size_t encrypt_payload_len = 0;
+    int running = 0;
+    int i;
+    key = key; // Direct key input is not supported in KMC interface
+    len_key = len_key; // Direct key input is not supported in KMC interface
+    ecs = ecs;
+    acs = acs;
+
+    if(kmc_multi == NULL)
+    {
+        kmc_multi = curl_multi_init();
+        if(kmc_multi == NULL)
+        {
+            return CRYPTOGRAPHY_KMC_CURL_INITIALIZATION_FAILURE;
+        }
+#if LIBCURL_VERSION_NUM >= 0x072b00
+        curl_multi_setopt(kmc_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
     }
 
-    int json_idx = 0;
-    uint8_t ciphertext_found = CRYPTO_FALSE;
-    char* ciphertext_base64 = NULL;
-    char* ciphertext_IV_base64 = NULL;
-    for (json_idx = 1; json_idx < parse_result; json_idx++)
+    while(op == NULL)
     {
-        if (jsoneq(chunk_write->response, &t[json_idx], "metadata") == 0)
+        for(i = 0; i < KMC_ASYNC_MAX_OPS; i++)
         {
-            uint32_t len_ciphertext = t[json_idx + 1].end - t[json_idx + 1].start;
-            ciphertext_IV_base64 = malloc(len_ciphertext+1);
-            memcpy(ciphertext_IV_base64,chunk_write->response + t[json_idx + 1].start, len_ciphertext);
-            ciphertext_IV_base64[len_ciphertext] = '\0';
-            //printf("%s\n", ciphertext_IV_base64);
-            
-            char* line;
-            char* token;
-            char temp_buff[256];
-            for (line = strtok (ciphertext_IV_base64, ","); line !=NULL; line = strtok(line + strlen(line) + 1, ","))
+            if(kmc_async_ops[i].in_use == CRYPTO_FALSE)
             {
-                strncpy(temp_buff, line, sizeof(temp_buff));
-
-                for (token = strtok(temp_buff, ":"); token != NULL; token = strtok(token + strlen(token) + 1, ":"))
-                {
-                    if(strcmp(token, "initialVector") == 0){
-                        token = strtok(token + strlen(token) + 1, ":");
-                        char * ciphertext_token_base64 = malloc(strlen(token));
-                        size_t cipher_text_token_len = strlen(token);
-                        memcpy(ciphertext_token_base64,token, cipher_text_token_len);
-                        #ifdef DEBUG
-                        printf("IV LENGTH: %d\n", iv_len);
-                        printf("IV ENCODED Text: %s\nIV ENCODED TEXT LEN: %ld\n", ciphertext_token_base64, cipher_text_token_len);
-                        #endif
-                        char* iv_decoded = malloc((iv_len)*2 + 1);
-                        size_t iv_decoded_len = 0;
-                        base64urlDecode(ciphertext_token_base64,cipher_text_token_len,iv_decoded, &iv_decoded_len);
-
-                        #ifdef DEBUG
-                        printf("Decoded IV Text Length: %ld\n", iv_decoded_len);
-                        printf("Decoded IV Text: \n");
-                        for (uint32_t i=0; i < iv_decoded_len; i++)
-                        {
-                            printf("%02x ", (uint8_t)iv_decoded[i]);
-                        }
-                        printf("\n");
-                        #endif
-
-                        if(iv == NULL)
-                        {   
-                            memcpy(data_out - sa_ptr->shsnf_len - sa_ptr->shivf_len - sa_ptr->shplf_len, iv_decoded, iv_decoded_len);
-                        }
-                        free(ciphertext_token_base64);
-                        break;
-                    }
-                }
+                op = &kmc_async_ops[i];
+                break;
             }
-            
-
-              
-            json_idx++;
-            continue;
         }
-        if (jsoneq(chunk_write->response, &t[json_idx], "base64ciphertext") == 0)
+        if(op == NULL && cryptography_async_poll(100) < 0)
         {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("Json base64ciphertext: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_ciphertext = t[json_idx + 1].end - t[json_idx + 1].start;
-            ciphertext_base64 = malloc(len_ciphertext+1);
-            memcpy(ciphertext_base64,chunk_write->response + t[json_idx + 1].start, len_ciphertext);
-            ciphertext_base64[len_ciphertext] = '\0';
-#ifdef DEBUG
-            printf("Parsed base64ciphertext: %s\n",ciphertext_base64);
-#endif
-            json_idx++;
-            ciphertext_found = CRYPTO_TRUE;
-            continue;
+            return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_CONNECTION_ERROR;
         }
+    }
 
-        if (jsoneq(chunk_write->response, &t[json_idx], "httpCode") == 0)
+    if(op->handle == NULL)
+    {
+        op->handle = curl_easy_init();
+        if(op->handle == NULL)
         {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("httpCode: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_httpcode = t[json_idx + 1].end - t[json_idx + 1].start;
-            char* http_code_str = malloc(len_httpcode+1);
-            memcpy(http_code_str,chunk_write->response + t[json_idx + 1].start, len_httpcode);
-            http_code_str[len_httpcode] = '\0';
-            int http_code = atoi(http_code_str);
-#ifdef DEBUG
-            printf("Parsed http code: %d\n",http_code);
-#endif
-            if(http_code != 200)
-            {
-                status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
-                fprintf(stderr,"KMC Crypto Failure Response:\n%s\n",chunk_write->response);
-                if(iv_base64 != NULL) free(iv_base64);
-                if(encrypt_uri != NULL) free(encrypt_uri);
-                if(chunk_write != NULL) free(chunk_write);
-                if(chunk_read != NULL) free(chunk_read);
-                if(encrypt_payload != NULL) free(encrypt_payload);
-                if(http_code_str != NULL) free(http_code_str);
-                if(ciphertext_base64 != NULL) free(ciphertext_base64);
-                return status;
-            }
-            json_idx++;
-            if(http_code_str != NULL) free(http_code_str);
-            continue;
+            return CRYPTOGRAPHY_KMC_CURL_INITIALIZATION_FAILURE;
         }
-
+        status = configure_curl_connect_opts(op->handle);
+        if(status != CRYPTO_LIB_SUCCESS)
+        {
+            return status;
+        }
+#if LIBCURL_VERSION_NUM >= 0x072b00
+        // Wait to multiplex on the existing connection rather than opening a new one per request
+        curl_easy_setopt(op->handle, CURLOPT_PIPEWAIT, 1L);
+#endif
+        curl_easy_setopt(op->handle, CURLOPT_PRIVATE, (char*)op);
     }
-    if(ciphertext_found == CRYPTO_FALSE){
-        status = CRYPTOGRAHPY_KMC_CIPHER_TEXT_NOT_FOUND_IN_JSON_RESPONSE;
-        if(encrypt_uri != NULL) free(encrypt_uri);
-        if(iv_base64 != NULL) free(iv_base64);
-        if(ciphertext_base64 != NULL) free(ciphertext_base64);
-        if(chunk_write != NULL) free(chunk_write);
-        if(chunk_read != NULL) free(chunk_read);
-        if(encrypt_payload != NULL) free(encrypt_payload);
+    status = configure_curl_request_opts(op->handle, cam_cookies);
+    if(status != CRYPTO_LIB_SUCCESS)
+    {
         return status;
     }
 
-    /* JSON Response Handling End */
+    status = kmc_aead_encrypt_request(sa_ptr, data_in, len_data_in, iv, iv_len, mac_size, aad, aad_len,
+                                      encrypt_bool, aad_bool, &encrypt_uri, &encrypt_payload, &encrypt_payload_len);
+    if(status != CRYPTO_LIB_SUCCESS)
+    {
+        return status;
+    }
+    // The request outlives the caller's buffers
+    if(encrypt_payload == data_in)
+    {
+        encrypt_payload = (uint8_t*) malloc(encrypt_payload_len);
+        if(encrypt_payload == NULL)
+        {
+            return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+        }
+        memcpy(encrypt_payload, data_in, encrypt_payload_len);
+    }
+    strncpy(op->uri, encrypt_uri, KMC_URI_SIZE - 1);
+    op->uri[KMC_URI_SIZE - 1] = '\0';
+
+#ifdef DEBUG
+    printf("Encrypt URI AEAD (async): %s\n",op->uri);
+#endif
+    op->payload = encrypt_payload;
+    kmc_response_reset(&op->chunk_write);
+    memset(&op->chunk_read, 0, MEMORY_READ_SIZE);
+    op->cam_retry = 0;
+    op->data_out = data_out;
+    op->len_data_out = len_data_out;
+    op->iv_out = (iv == NULL) ? data_out - sa_ptr->shsnf_len - sa_ptr->shivf_len - sa_ptr->shplf_len : NULL;
+    op->iv_len = iv_len;
+    op->mac = mac;
+    op->mac_size = mac_size;
+    op->aad_len = aad_len;
+    op->encrypt_bool = encrypt_bool;
+    op->authenticate_bool = authenticate_bool;
+    op->done = done;
+    op->op_ctx = op_ctx;
+
+    curl_easy_setopt(op->handle, CURLOPT_URL, op->uri);
+    curl_easy_setopt(op->handle, CURLOPT_READDATA, &op->chunk_read);
+    curl_easy_setopt(op->handle, CURLOPT_WRITEDATA, &op->chunk_write);
+    curl_easy_setopt(op->handle, CURLOPT_POSTFIELDSIZE, (long) encrypt_payload_len);
+    curl_easy_setopt(op->handle, CURLOPT_POSTFIELDS, op->payload);
+
+    if(curl_multi_add_handle(kmc_multi, op->handle) != CURLM_OK)
+    {
+        free(op->payload);
+        op->payload = NULL;
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_CONNECTION_ERROR;
+    }
+    op->in_use = CRYPTO_TRUE;
+
+    // Get the request on the wire before returning to the caller
+    curl_multi_perform(kmc_multi, &running);
+    return CRYPTO_LIB_SUCCESS;
+}
 
-    uint8_t* ciphertext_decoded = malloc((len_data_out + mac_size + aad_len)*2 + 1);
-    size_t ciphertext_decoded_len = 0;
-    base64Decode(ciphertext_base64,strlen(ciphertext_base64),ciphertext_decoded, &ciphertext_decoded_len);
-#ifdef DEBUG
-    printf("Mac size: %d\n",mac_size);
-    printf("Decoded Cipher Text Length: %ld\n",ciphertext_decoded_len);
-    printf("Decoded Cipher Text: \n");
-    for (uint32_t i=0; i < ciphertext_decoded_len; i++)
+/**
+ * @brief Function: cryptography_async_poll
+ * Drives the curl multi handle and finishes every request that has completed
+ * @param timeout_ms: int32_t, how long to wait for network activity when nothing has completed
+ * @return int32: Number of calls completed, negative on a curl multi failure
+ **/
+static int32_t cryptography_async_poll(int32_t timeout_ms)
+{
+    int32_t completed = 0;
+    int running = 0;
+    int queued = 0;
+    CURLMsg* msg;
+    CURL* handle;
+    CURLcode res;
+    kmc_async_op_t* op;
+
+    if(kmc_multi == NULL)
     {
-        printf("%02x ", ciphertext_decoded[i]);
+        return 0;
     }
-    printf("\n");
-#endif
 
-    // Copy the encrypted data to the output stream
-    if(encrypt_bool == CRYPTO_TRUE)
+    if(curl_multi_perform(kmc_multi, &running) != CURLM_OK)
+    {
+        return -1;
+    }
+    msg = curl_multi_info_read(kmc_multi, &queued);
+    if(msg == NULL && running > 0 && timeout_ms > 0)
     {
-        // Crypto Service returns aad - cipher_text - tag
-        memcpy(data_out,ciphertext_decoded + aad_len,len_data_out);
+        curl_multi_wait(kmc_multi, NULL, 0, timeout_ms, NULL);
+        curl_multi_perform(kmc_multi, &running);
+        msg = curl_multi_info_read(kmc_multi, &queued);
     }
 
-    // If authenticate, Copy the MAC to the output stream
-    if(authenticate_bool == CRYPTO_TRUE)
+    while(msg != NULL)
     {
-        uint32_t data_offset = len_data_out;
-        if(encrypt_bool == CRYPTO_FALSE) { data_offset = 0; }
-        memcpy(mac,ciphertext_decoded + aad_len + data_offset, mac_size);
+        if(msg->msg == CURLMSG_DONE)
+        {
+            // msg is freed by curl_multi_remove_handle
+            handle = msg->easy_handle;
+            res = msg->data.result;
+            curl_easy_getinfo(handle, CURLINFO_PRIVATE, (char**)&op);
+            curl_multi_remove_handle(kmc_multi, handle);
+            completed += kmc_async_complete(op, res);
+        }
+        msg = curl_multi_info_read(kmc_multi, &queued);
     }
-    if (ciphertext_base64 != NULL) free(ciphertext_base64);
-    if (ciphertext_decoded != NULL) free(ciphertext_decoded);
-    if (iv_base64 != NULL) free(iv_base64);
-    if (encrypt_uri != NULL) free(encrypt_uri);
-    //if (encrypt_payload != NULL) free(encrypt_payload);
-    if (chunk_write->response != NULL) free(chunk_write->response);
-    if (chunk_write != NULL) free(chunk_write);
-    if (chunk_read != NULL) free(chunk_read);
+    return completed;
+}
 
-#ifdef DEBUG
-    printf("DATA OUT:\n");
-    for(size_t i = 0; i < len_data_out; i++){
-        printf("%02x ", data_out[i]);
+/**
+ * @brief Function: kmc_async_complete
+ * Finishes a request taken off the multi handle, the counterpart of curl_perform_with_cam_retries and the
+ * response handling of cryptography_aead_encrypt.  A request that needs CAM authentication is resubmitted.
+ * @param op: kmc_async_op_t*
+ * @param res: CURLcode
+ * @return int32: 1 when the call completed, 0 when it was resubmitted
+ **/
+static int32_t kmc_async_complete(kmc_async_op_t* op, CURLcode res)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+
+    if(res != CURLE_OK)
+    {
+        status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+        fprintf(stderr, "curl_multi_perform() failed: %s\n", curl_easy_strerror(res));
+    }
+    else
+    {
+        status = curl_response_error_check(op->handle, &op->chunk_write);
     }
-    printf("\n");
-#endif
 
-    return status;
+    if(status == CAM_AUTHENTICATION_REQUIRED)
+    {
+        kmc_response_reset(&op->chunk_write);
+        memset(&op->chunk_read, 0, MEMORY_READ_SIZE);
+        op->cam_retry++;
+        if(op->cam_retry == CAM_MAX_AUTH_RETRIES)
+        {
+            status = CAM_MAX_AUTH_RETRIES_REACHED;
+        }
+        else
+        {
+            status = get_cam_sso_token();
+            if(status == CRYPTO_LIB_SUCCESS)
+            {
+                //Re-handle CAM cookie file, when cookie file is regenerated above, the existing curl_handle doesn't recognize it
+                status = handle_cam_cookies(op->handle, NULL);
+            }
+            else if(status == CAM_KERBEROS_REQUEST_TIME_OUT)
+            {
+                //Non-fatal getSsoToken failure... Attempt CAM retry...
+                status = CRYPTO_LIB_SUCCESS;
+            }
+            if(status == CRYPTO_LIB_SUCCESS)
+            {
+                if(curl_multi_add_handle(kmc_multi, op->handle) == CURLM_OK)
+                {
+                    return 0;
+                }
+                status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_CONNECTION_ERROR;
+            }
+        }
+    }
+
+    if(status == CRYPTO_LIB_SUCCESS && op->chunk_write.size == 0)
+    {
+        status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_EMPTY_RESPONSE;
+    }
+    if(status == CRYPTO_LIB_SUCCESS)
+    {
+        status = kmc_aead_encrypt_response(&op->chunk_write, op->data_out, op->len_data_out, op->iv_out,
+                                           op->iv_len, op->mac, op->mac_size, op->aad_len, op->encrypt_bool,
+                                           op->authenticate_bool);
+    }
+
+    kmc_response_reset(&op->chunk_write);
+    free(op->payload);
+    op->payload = NULL;
+    op->in_use = CRYPTO_FALSE;
+    op->done(op->op_ctx, status);
+    return 1;
 }
 
 static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
@@ -1526,23 +1478,22 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
     ecs = ecs;
     acs = acs;
 
-    // Get the key length in bits, in string format.
+    // Get the key length in bits
     // TODO -- Parse the key length from the keyInfo endpoint of the Crypto Service!
     uint32_t key_len_in_bits = len_key * 8; // 8 bits per byte.
-    uint32_t key_len_in_bits_str_len = 0;
-    char* key_len_in_bits_str = int_to_str(key_len_in_bits, &key_len_in_bits);
-
-
 
-    curl_easy_reset(curl);
-    status = configure_curl_connect_opts(curl, cam_cookies);
+    status = configure_curl_request_opts(curl, cam_cookies);
     if(status != CRYPTO_LIB_SUCCESS)
     {
         return status;
     }
 
     // Base64 URL encode IV for KMC REST Encrypt
-    char* iv_base64 = (char*)calloc(1,B64ENCODE_OUT_SAFESIZE(iv_len)+1);
+    char iv_base64[B64ENCODE_OUT_SAFESIZE(IV_SIZE) + 1] = {0};
+    if(iv_len > IV_SIZE)
+    {
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
     base64urlEncode(iv,iv_len,iv_base64,NULL);
 
     uint8_t* decrypt_payload = data_in;
@@ -1559,32 +1510,18 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
         return status;
     }
 
-    char* decrypt_uri;
+    const char* decrypt_uri;
     if(aad_bool == CRYPTO_TRUE)
     {
-        //Determine length of aad offset string and convert to string for use in URL
-        uint32_t aad_offset_str_len = 0;
-        char* aad_offset_str = int_to_str(aad_len, &aad_offset_str_len);
 #ifdef DEBUG
-        printf("AAD Offset Str: %s\n",aad_offset_str);
+        printf("AAD Offset: %d\n",aad_len);
 #endif
-
-        uint32_t mac_size_str_len = 0;
-        char* mac_size_str = int_to_str(mac_size*8, &mac_size_str_len);
-
-        int len_decrypt_endpoint = strlen(decrypt_offset_endpoint)+ key_len_in_bits_str_len + strlen(sa_ptr->ek_ref)+strlen(iv_base64)+strlen(AES_GCM_TRANSFORMATION) + strlen(AES_CRYPTO_ALGORITHM) + mac_size_str_len + aad_offset_str_len;
-        char* decrypt_endpoint_final = (char*) malloc(len_decrypt_endpoint);
-
-        snprintf(decrypt_endpoint_final,len_decrypt_endpoint,decrypt_offset_endpoint,key_len_in_bits_str,sa_ptr->ek_ref,AES_GCM_TRANSFORMATION, iv_base64, AES_CRYPTO_ALGORITHM, mac_size_str, aad_offset_str);
-
-        free(key_len_in_bits_str);
-        free(aad_offset_str);
-        free(mac_size_str);
-
-        decrypt_uri = (char*) malloc(strlen(kmc_root_uri)+len_decrypt_endpoint);
-        decrypt_uri[0] = '\0';
-        strcat(decrypt_uri, kmc_root_uri);
-        strcat(decrypt_uri, decrypt_endpoint_final);
+        decrypt_uri = kmc_uri(sa_ptr->spi, KMC_URI_DECRYPT, sa_ptr->ek_ref, AES_GCM_TRANSFORMATION, key_len_in_bits,
+                              decrypt_offset_tail, iv_base64, AES_CRYPTO_ALGORITHM, mac_size * 8, aad_len);
+        if(decrypt_uri == NULL)
+        {
+            return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+        }
 
         // Prepare decrypt_payload with AAD at the front for KMC Crypto Service.
         if(decrypt_bool == CRYPTO_FALSE) //Not decrypting data, only passing in AAD for TAG validation.
@@ -1610,39 +1547,26 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
             if(decrypt_bool == CRYPTO_FALSE) { data_offset = 0; }
             memcpy(&decrypt_payload[aad_len + data_offset],mac,mac_size);
         }
-
-        free(decrypt_endpoint_final);
     }
     else //No AAD - just prepare the endpoint URI string
     {
-        int len_decrypt_endpoint = strlen(decrypt_endpoint)+ key_len_in_bits_str_len + strlen(sa_ptr->ek_ref)+strlen(iv_base64)+strlen(AES_GCM_TRANSFORMATION) + strlen(AES_CRYPTO_ALGORITHM);
-        char* decrypt_endpoint_final = (char*) malloc(len_decrypt_endpoint);
-
-        snprintf(decrypt_endpoint_final,len_decrypt_endpoint,decrypt_endpoint,key_len_in_bits_str,sa_ptr->ek_ref,AES_GCM_TRANSFORMATION, iv_base64, AES_CRYPTO_ALGORITHM);
-
-        decrypt_uri = (char*) malloc(strlen(kmc_root_uri)+len_decrypt_endpoint);
-        decrypt_uri[0] = '\0';
-        strcat(decrypt_uri, kmc_root_uri);
-        strcat(decrypt_uri, decrypt_endpoint_final);
-        free(decrypt_endpoint_final);
+        decrypt_uri = kmc_uri(sa_ptr->spi, KMC_URI_DECRYPT, sa_ptr->ek_ref, AES_GCM_TRANSFORMATION, key_len_in_bits,
+                              decrypt_tail, iv_base64, AES_CRYPTO_ALGORITHM);
+        if(decrypt_uri == NULL)
+        {
+            return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+        }
     }
 #ifdef DEBUG
     printf("Decrypt URI: %s\n",decrypt_uri);
 #endif
     curl_easy_setopt(curl, CURLOPT_URL, decrypt_uri);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, http_headers_list);
 
-    memory_write* chunk_write = (memory_write*) calloc(1,MEMORY_WRITE_SIZE);
-    memory_read* chunk_read = (memory_read*) calloc(1,MEMORY_READ_SIZE);;
+    memory_write* chunk_write = kmc_response_reset(&kmc_response);
+    memory_read* chunk_read = &kmc_request;
 
-    /* Configure CURL for POST */
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    /* send all data to this function  */
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
-    /* we pass our 'chunk' struct to the callback function */
+    /* we pass our 'chunk' structs to the callback functions */
     curl_easy_setopt(curl, CURLOPT_READDATA, chunk_read);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    /* we pass our 'chunk' struct to the callback function */
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, chunk_write);
 
     /* size of the POST data */
@@ -1663,126 +1587,42 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
     status = curl_perform_with_cam_retries(curl, chunk_write, chunk_read);
     if(status != CRYPTO_LIB_SUCCESS)
     {
-        //free(decrypt_payload);
-        free(decrypt_uri);
-        free(iv_base64);
+        if(decrypt_payload != data_in) free(decrypt_payload);
         return status;
     }
 
     /* JSON Response Handling */
 
-    // Parse the JSON string response
-    jsmn_parser p;
-    jsmntok_t t[64]; /* We expect no more than 64 JSON tokens */
-    jsmn_init(&p);
-    int parse_result = jsmn_parse(&p, chunk_write->response, strlen(chunk_write->response), t, 64); // "chunk->response" is the char array holding the json content
-
-    // Find the 'base64ciphertext' token
-    if (parse_result < 0) {
-        status = CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR;
-        printf("Failed to parse JSON: %d\n", parse_result);
-        free(decrypt_payload);
-        free(decrypt_uri);
-        free(iv_base64);
-        return status;
-    }
-
-    int json_idx = 0;
-    uint8_t ciphertext_found = CRYPTO_FALSE;
-    char* cleartext_base64 = NULL;
-    for (json_idx = 1; json_idx < parse_result; json_idx++)
+    kmc_json_t json;
+    const char* cleartext_base64;
+    size_t cleartext_base64_len;
+    size_t cleartext_decoded_len = 0;
+    status = kmc_json_parse(chunk_write, &json, CRYPTO_FALSE);
+    if(status == CRYPTO_LIB_SUCCESS &&
+       kmc_json_field(&json, "base64cleartext", &cleartext_base64, &cleartext_base64_len) == CRYPTO_FALSE)
     {
-        // check "httpCode" field for non-200 status codes!!!
-        if (jsoneq(chunk_write->response, &t[json_idx], "base64cleartext") == 0)
-        {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("Json base64cleartext: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_cleartext = t[json_idx + 1].end - t[json_idx + 1].start;
-            cleartext_base64 = malloc(len_cleartext+1);
-            memcpy(cleartext_base64,chunk_write->response + t[json_idx + 1].start, len_cleartext);
-            cleartext_base64[len_cleartext] = '\0';
-#ifdef DEBUG
-            printf("Parsed base64cleartext: %s\n",cleartext_base64);
-#endif
-            json_idx++;
-            ciphertext_found = CRYPTO_TRUE;
-            continue;
-        }
-        if (jsoneq(chunk_write->response, &t[json_idx], "httpCode") == 0)
-        {
-            /* We may use strndup() to fetch string value */
-#ifdef DEBUG
-            printf("httpCode: %.*s\n", t[json_idx + 1].end - t[json_idx + 1].start,
-                   chunk_write->response + t[json_idx + 1].start);
-#endif
-            uint32_t len_httpcode = t[json_idx + 1].end - t[json_idx + 1].start;
-            char* http_code_str = malloc(len_httpcode+1);
-            memcpy(http_code_str,chunk_write->response + t[json_idx + 1].start, len_httpcode);
-            http_code_str[len_httpcode] = '\0';
-            int http_code = atoi(http_code_str);
-#ifdef DEBUG
-            printf("Parsed http code: %d\n",http_code);
-#endif
-            if(http_code != 200)
-            {
-                status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
-                fprintf(stderr,"KMC Crypto Failure Response:\n%s\n",chunk_write->response);
-                free(chunk_read);
-                free(chunk_write);
-                free(http_code_str);
-                free(cleartext_base64);
-                free(decrypt_uri);
-                free(iv_base64);
-                return status;
-            }
-            free(http_code_str);
-            json_idx++;
-            continue;
-        }
-    }
-    if(ciphertext_found == CRYPTO_FALSE){
         status = CRYPTOGRAHPY_KMC_CIPHER_TEXT_NOT_FOUND_IN_JSON_RESPONSE;
-        free(chunk_read);
-        free(chunk_write); 
-        free(cleartext_base64); 
-        free(decrypt_payload);
-        free(decrypt_uri);
-        free(iv_base64);
-        return status;
     }
 
     /* JSON Response Handling End */
 
-    uint8_t* cleartext_decoded = malloc((len_data_out + mac_size + aad_len)*2 + 1);
-    size_t cleartext_decoded_len = 0;
-    base64Decode(cleartext_base64,strlen(cleartext_base64),cleartext_decoded, &cleartext_decoded_len);
-#ifdef DEBUG
-    printf("Decoded Cipher Text Length: %ld\n",cleartext_decoded_len);
-    printf("Decoded Cipher Text: \n");
-    for (uint32_t i=0; i < cleartext_decoded_len; i++)
+    // Crypto Service returns aad - clear_text, the clear text is decoded straight into the output stream
+    if(status == CRYPTO_LIB_SUCCESS && decrypt_bool == CRYPTO_TRUE)
     {
-        printf("%02x ", cleartext_decoded[i]);
-    }
-    printf("\n");
+#ifdef DEBUG
+        printf("Json base64cleartext: %.*s\n", (int)cleartext_base64_len, cleartext_base64);
 #endif
-
-    // Copy the decrypted data to the output stream
-    // Crypto Service returns aad - clear_text
-    if(decrypt_bool == CRYPTO_TRUE)
+        status = kmc_base64_decode(cleartext_base64, cleartext_base64_len, BASE64_ALPHABET_STANDARD, aad_len, data_out,
+                                   len_data_out, &cleartext_decoded_len);
+        if(status == CRYPTO_LIB_SUCCESS && cleartext_decoded_len != len_data_out)
+        {
+            status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_AEAD_DECRYPT_ERROR;
+        }
+    }
+    if(decrypt_payload != data_in)
     {
-        memcpy(data_out,cleartext_decoded + aad_len, len_data_out);
+        free(decrypt_payload);
     }
-    free(cleartext_decoded);
-    free(chunk_read);
-    free(chunk_write->response);
-    free(chunk_write);
-    free(cleartext_base64);
-    free(decrypt_payload);
-    free(decrypt_uri);
-    free(iv_base64);
     return status;
 }
 
@@ -1821,20 +1661,21 @@ static size_t write_callback(void* data, size_t size, size_t nmemb, void* userp)
     size_t realsize = size * nmemb;
     memory_write *mem = (memory_write *)userp;
 
-    char* ptr;
-    if(mem->response != NULL)
-    {
-        ptr = realloc(mem->response, mem->size + realsize + 1);
-    }
-    else
+    // Grow by doubling, buffers are reused across requests so this soon stops happening at all
+    if(mem->size + realsize + 1 > mem->capacity)
     {
-        ptr = malloc(realsize+1);
+        size_t capacity = (mem->capacity != 0) ? mem->capacity : KMC_RESPONSE_SIZE;
+        while(capacity < mem->size + realsize + 1)
+        {
+            capacity *= 2;
+        }
+        char* ptr = realloc(mem->response, capacity);
+        if(ptr == NULL)
+            return 0;  /* out of memory! */
+        mem->response = ptr;
+        mem->capacity = capacity;
     }
 
-    if(ptr == NULL)
-        return 0;  /* out of memory! */
-
-    mem->response = ptr;
     memcpy(&(mem->response[mem->size]), data, realsize);
     mem->size += realsize;
     mem->response[mem->size] = 0;
@@ -1861,16 +1702,16 @@ static size_t read_callback(char* dest, size_t size, size_t nmemb, void* userp)
     return 0; /* no more data left to deliver */
 }
 
-static int32_t configure_curl_connect_opts(CURL* curl_handle, char* cam_cookies)
+/**
+ * @brief Function: configure_curl_connect_opts
+ * Options shared by every Crypto Service request, set once on the long lived handle at config time
+ * @param curl_handle: CURL*
+ * @return int32: Success/Failure
+ **/
+static int32_t configure_curl_connect_opts(CURL* curl_handle)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
 
-    status = handle_cam_cookies(curl_handle, cam_cookies);
-    if(status != CRYPTO_LIB_SUCCESS)
-    {
-        return status;
-    }
-
     //curl_easy_setopt(curl_handle, CURLOPT_PROTOCOLS,CURLPROTO_HTTPS); // use default CURLPROTO_ALL
 #ifdef DEBUG
     printf("KMC Crypto Port: %d\n",cryptography_kmc_crypto_config->kmc_crypto_port);
@@ -1913,9 +1754,106 @@ static int32_t configure_curl_connect_opts(CURL* curl_handle, char* cam_cookies)
         curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYPEER, 0L);
     }
 
+    // Every request is a POST of a raw payload with the same headers
+    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, http_headers_list);
+    curl_easy_setopt(curl_handle, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl_handle, CURLOPT_READFUNCTION, read_callback);
+    curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, write_callback);
+
+    // Keep the connection, and with it the TLS session, up between frames
+    curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPALIVE, 1L);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    curl_easy_setopt(curl_handle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+#endif
+
     return status;
 }
 
+/**
+ * @brief Function: configure_curl_request_opts
+ * Per request options, the handle is not reset so anything set here must be set on every request
+ * @param curl_handle: CURL*
+ * @param cam_cookies: char*
+ * @return int32: Success/Failure
+ **/
+static int32_t configure_curl_request_opts(CURL* curl_handle, char* cam_cookies)
+{
+    // Drop cookies passed in by a previous call
+    curl_easy_setopt(curl_handle, CURLOPT_COOKIE, NULL);
+    return handle_cam_cookies(curl_handle, cam_cookies);
+}
+
+/**
+ * @brief Function: kmc_uri
+ * Builds a Crypto Service request URI into kmc_uri_buffer.  The part of the URI fixed for the SA (root URI,
+ * key reference, transformation, key length) is formatted once and cached per SPI and endpoint, only the
+ * per-frame tail (IV, MAC, offsets) is formatted on every call.  A changed key reference drops the template.
+ * @param spi: uint16_t
+ * @param endpoint: uint8_t, KMC_URI_*
+ * @param key_ref: const char*
+ * @param transformation: const char*, may be NULL
+ * @param key_len_bits: uint32_t, only used by the decrypt endpoint
+ * @param tail_fmt: const char*, NULL for no tail, followed by its arguments
+ * @return const char*: URI valid until the next call, NULL if it does not fit
+ **/
+static const char* kmc_uri(uint16_t spi, uint8_t endpoint, const char* key_ref, const char* transformation,
+                           uint32_t key_len_bits, const char* tail_fmt, ...)
+{
+    kmc_uri_template_t* template = &kmc_uri_templates[(spi * KMC_URI_ENDPOINTS + endpoint) % KMC_URI_TEMPLATES];
+    va_list args;
+    int len = 0;
+
+    if (template->valid != CRYPTO_TRUE || template->spi != spi || template->endpoint != endpoint ||
+        template->transformation != transformation || template->key_len_bits != key_len_bits ||
+        strncmp(template->key_ref, key_ref, REF_SIZE) != 0)
+    {
+        template->valid = CRYPTO_FALSE;
+        switch (endpoint)
+        {
+        case KMC_URI_ENCRYPT:
+            len = snprintf(template->uri, KMC_URI_SIZE, encrypt_template, kmc_root_uri, key_ref, transformation);
+            break;
+        case KMC_URI_DECRYPT:
+            len = snprintf(template->uri, KMC_URI_SIZE, decrypt_template, kmc_root_uri, key_len_bits, key_ref,
+                           transformation);
+            break;
+        case KMC_URI_ICV_CREATE:
+            len = snprintf(template->uri, KMC_URI_SIZE, icv_create_template, kmc_root_uri, key_ref);
+            break;
+        case KMC_URI_ICV_VERIFY:
+            len = snprintf(template->uri, KMC_URI_SIZE, icv_verify_template, kmc_root_uri);
+            break;
+        default:
+            return NULL;
+        }
+        if (len < 0 || len >= KMC_URI_SIZE)
+        {
+            return NULL;
+        }
+        template->spi = spi;
+        template->endpoint = endpoint;
+        template->transformation = transformation;
+        template->key_len_bits = key_len_bits;
+        strncpy(template->key_ref, key_ref, REF_SIZE - 1);
+        template->key_ref[REF_SIZE - 1] = '\0';
+        template->len = len;
+        template->valid = CRYPTO_TRUE;
+    }
+
+    memcpy(kmc_uri_buffer, template->uri, template->len + 1);
+    if (tail_fmt != NULL)
+    {
+        va_start(args, tail_fmt);
+        len = vsnprintf(&kmc_uri_buffer[template->len], KMC_URI_SIZE - template->len, tail_fmt, args);
+        va_end(args);
+        if (len < 0 || (size_t)len >= KMC_URI_SIZE - template->len)
+        {
+            return NULL;
+        }
+    }
+    return kmc_uri_buffer;
+}
+
 static int32_t handle_cam_cookies(CURL* curl_handle, char* cam_cookies)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
@@ -2059,6 +1997,7 @@ static int32_t get_cam_sso_token()
     curl_easy_cleanup(curl_cam);
     free(kerberos_endpoint_final);
     free(chunk_read);
+    free(chunk_write->response);
     free(chunk_write);
     return status;
 }
@@ -2083,7 +2022,143 @@ static int jsoneq(const char* json, jsmntok_t* tok, const char* s)
     return -1;
 }
 
-int32_t curl_response_error_check(CURL* curl_handle, char* response)
+/**
+ * @brief Function: kmc_response_reset
+ * Empties a response buffer for the next request, keeping its allocation
+ * @param response: memory_write*
+ * @return memory_write*: response
+ **/
+static memory_write* kmc_response_reset(memory_write* response)
+{
+    response->size = 0;
+    if(response->response != NULL)
+    {
+        response->response[0] = '\0';
+    }
+    return response;
+}
+
+/**
+ * @brief Function: kmc_json_parse
+ * Tokenizes a Crypto Service response and checks its httpCode
+ * @param response: memory_write*, JSON body
+ * @param json: kmc_json_t*, parsed tokens, referring into response
+ * @param http_code_required: uint8_t, CRYPTO_TRUE if a response without httpCode is a failure
+ * @return int32: Success/Failure
+ **/
+static int32_t kmc_json_parse(memory_write* response, kmc_json_t* json, uint8_t http_code_required)
+{
+    const char* http_code;
+    size_t http_code_len;
+    jsmn_parser p;
+
+    jsmn_init(&p);
+    json->json = response->response;
+    json->count = jsmn_parse(&p, response->response, response->size, json->tokens, KMC_JSON_TOKENS);
+    if(json->count < 0)
+    {
+        printf("Failed to parse JSON: %d\n", json->count);
+        return CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR;
+    }
+
+    if(kmc_json_field(json, "httpCode", &http_code, &http_code_len) == CRYPTO_FALSE)
+    {
+        return (http_code_required == CRYPTO_TRUE) ? CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR : CRYPTO_LIB_SUCCESS;
+    }
+#ifdef DEBUG
+    printf("httpCode: %.*s\n", (int)http_code_len, http_code);
+#endif
+    // Values are followed by at least a closing brace, so strtol stops inside the buffer
+    if(strtol(http_code, NULL, 10) != 200)
+    {
+        fprintf(stderr,"KMC Crypto Failure Response:\n%s\n",response->response);
+        return CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_GENERIC_FAILURE;
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: kmc_json_field
+ * Finds the value of a top level key
+ * @param json: kmc_json_t*
+ * @param key: const char*
+ * @param value: const char**, start of the value within the response
+ * @param value_len: size_t*
+ * @return uint8_t: CRYPTO_TRUE if found
+ **/
+static uint8_t kmc_json_field(kmc_json_t* json, const char* key, const char** value, size_t* value_len)
+{
+    for(int json_idx = 1; json_idx + 1 < json->count; json_idx++)
+    {
+        if(jsoneq(json->json, &json->tokens[json_idx], key) == 0)
+        {
+            jsmntok_t* tok = &json->tokens[json_idx + 1];
+            *value = json->json + tok->start;
+            *value_len = (size_t)(tok->end - tok->start);
+            return CRYPTO_TRUE;
+        }
+    }
+    return CRYPTO_FALSE;
+}
+
+/**
+ * @brief Function: kmc_metadata_field
+ * Finds a value in a Crypto Service metadata string, "key:value,key:value,..."
+ * @param metadata: const char*, not NUL terminated
+ * @param metadata_len: size_t
+ * @param key: const char*
+ * @param value: const char**, start of the value within metadata
+ * @param value_len: size_t*
+ * @return uint8_t: CRYPTO_TRUE if found
+ **/
+static uint8_t kmc_metadata_field(const char* metadata, size_t metadata_len, const char* key, const char** value,
+                                  size_t* value_len)
+{
+    size_t key_len = strlen(key);
+    const char* end = metadata + metadata_len;
+
+    while(metadata < end)
+    {
+        const char* comma = memchr(metadata, ',', end - metadata);
+        if(comma == NULL)
+        {
+            comma = end;
+        }
+        if((size_t)(comma - metadata) > key_len && metadata[key_len] == ':' && memcmp(metadata, key, key_len) == 0)
+        {
+            *value = metadata + key_len + 1;
+            *value_len = comma - *value;
+            return CRYPTO_TRUE;
+        }
+        metadata = comma + 1;
+    }
+    return CRYPTO_FALSE;
+}
+
+/**
+ * @brief Function: kmc_base64_decode
+ * Decodes bytes [offset, offset + out_len) of a base64 JSON value straight into their destination
+ * @param value: const char*, base64 text within the response
+ * @param value_len: size_t
+ * @param alphabet: uint8_t, BASE64_ALPHABET_STANDARD or BASE64_ALPHABET_URL
+ * @param offset: size_t, decoded bytes to skip
+ * @param out: uint8_t*
+ * @param out_len: size_t, most bytes to write
+ * @param decoded_len: size_t*, bytes written, short if the value ends first
+ * @return int32: Success/Failure
+ **/
+static int32_t kmc_base64_decode(const char* value, size_t value_len, uint8_t alphabet, size_t offset, uint8_t* out,
+                                 size_t out_len, size_t* decoded_len)
+{
+    if(base64SimdDecode(value, value_len, alphabet, offset, out, out_len, decoded_len) != NO_ERROR)
+    {
+        fprintf(stderr, "KMC Crypto Service returned invalid base64: %.*s\n", (int)value_len, value);
+        return CRYPTOGRAHPY_KMC_CRYPTO_JSON_PARSE_ERROR;
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
+
+int32_t curl_response_error_check(CURL* curl_handle, memory_write* response)
 {
     int32_t response_status = CRYPTO_LIB_SUCCESS;
 
@@ -2122,10 +2197,10 @@ int32_t curl_response_error_check(CURL* curl_handle, char* response)
     }
 
 #ifdef DEBUG
-    printf("\ncURL Response Body:\n\t %s\n", response);
+    printf("\ncURL Response Body:\n\t %.*s\n", (int)response->size, response->response);
 #endif
 
-    if(response == NULL) // No response, possibly because service is CAM secured.
+    if(response->size == 0) // No response, possibly because service is CAM secured.
     {
         response_status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_EMPTY_RESPONSE;
         fprintf(stderr, "curl_easy_perform() unexpected empty response: \n%s\n",
@@ -2157,7 +2232,7 @@ int32_t curl_perform_with_cam_retries(CURL* curl_handle,memory_write* chunk_writ
             break; // Go to Post retry loop cleanup and return status.
         }
 
-        status = curl_response_error_check(curl_handle, chunk_write->response);
+        status = curl_response_error_check(curl_handle, chunk_write);
 
         if(status == CRYPTO_LIB_SUCCESS) // Crypto Service REST call worked! Break out of retry loop.
         {
@@ -2165,8 +2240,8 @@ int32_t curl_perform_with_cam_retries(CURL* curl_handle,memory_write* chunk_writ
         }
         else
         {
-            // Zero out chunk_write/chunk_read for next cURL perform call
-            memset(chunk_write,0,MEMORY_WRITE_SIZE);
+            // Empty chunk_write/chunk_read for next cURL perform call
+            kmc_response_reset(chunk_write);
             memset(chunk_read,0,MEMORY_READ_SIZE);
         }
 
@@ -2199,7 +2274,7 @@ int32_t curl_perform_with_cam_retries(CURL* curl_handle,memory_write* chunk_writ
             status = CAM_MAX_AUTH_RETRIES_REACHED;
         }
     }
-    if(status == CRYPTO_LIB_SUCCESS && chunk_write->response==NULL) // no error case detected, but invalid NULL response!
+    if(status == CRYPTO_LIB_SUCCESS && chunk_write->size == 0) // no error case detected, but invalid NULL response!
     {
         status = CRYPTOGRAHPY_KMC_CRYPTO_SERVICE_EMPTY_RESPONSE;
     }
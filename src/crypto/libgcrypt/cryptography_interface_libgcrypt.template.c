@@ -13,6 +13,7 @@
  */
 
 #include <gcrypt.h>
+#include <pthread.h>
 
 
 #include "crypto.h"
@@ -73,6 +74,7 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
 static int32_t cryptography_get_acs_algo(int8_t algo_enum);
 static int32_t cryptography_get_ecs_algo(int8_t algo_enum);
 static int32_t cryptography_get_ecs_mode(int8_t algo_enum);
+static int32_t cryptography_invalidate_key(uint16_t key_id);
 
 /*
 ** Module Variables
@@ -80,6 +82,43 @@ static int32_t cryptography_get_ecs_mode(int8_t algo_enum);
 // Cryptography Interface
 static CryptographyInterfaceStruct cryptography_if_struct;
 
+/*
+** Keyed Context Cache
+** Opening a handle and expanding the key schedule costs more than processing a typical frame,
+** so keyed handles are retained per (key ID, cipher suite) and only reset / re-IV'd per call.
+** The key bytes are kept alongside to catch key material changed outside of OTAR / key update.
+*/
+typedef struct
+{
+    uint8_t in_use;
+    uint16_t key_id;
+    uint8_t suite; // ECS or ACS enum
+    int32_t algo;
+    int32_t mode;
+    uint32_t flags;
+    uint32_t len_key;
+    uint8_t key[KEY_CACHE_MAX_KEY];
+    gcry_cipher_hd_t hd;
+} cryptography_cipher_cache_t;
+
+typedef struct
+{
+    uint8_t in_use;
+    uint16_t key_id;
+    uint8_t suite;
+    int32_t algo;
+    uint32_t len_key;
+    uint8_t key[KEY_CACHE_MAX_KEY];
+    gcry_mac_hd_t hd;
+} cryptography_mac_cache_t;
+
+static cryptography_cipher_cache_t cipher_cache[KEY_CACHE_SIZE];
+static cryptography_mac_cache_t mac_cache[KEY_CACHE_SIZE];
+// A slot is owned by one caller from acquire to release; a caller finding it busy uses a one-shot handle
+static pthread_once_t cache_lock_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t cipher_cache_lock[KEY_CACHE_SIZE];
+static pthread_mutex_t mac_cache_lock[KEY_CACHE_SIZE];
+
 CryptographyInterface get_cryptography_interface_libgcrypt(void)
 {
     cryptography_if_struct.cryptography_config = cryptography_config;
@@ -93,9 +132,282 @@ CryptographyInterface get_cryptography_interface_libgcrypt(void)
     cryptography_if_struct.cryptography_aead_decrypt = cryptography_aead_decrypt;
     cryptography_if_struct.cryptography_get_acs_algo = cryptography_get_acs_algo;
     cryptography_if_struct.cryptography_get_ecs_algo = cryptography_get_ecs_algo;
+    cryptography_if_struct.cryptography_invalidate_key = cryptography_invalidate_key;
     return &cryptography_if_struct;
 }
 
+static void cryptography_cache_lock_init(void)
+{
+    int i;
+    for (i = 0; i < KEY_CACHE_SIZE; i++)
+    {
+        pthread_mutex_init(&cipher_cache_lock[i], NULL);
+        pthread_mutex_init(&mac_cache_lock[i], NULL);
+    }
+}
+
+static void cryptography_cipher_cache_evict(cryptography_cipher_cache_t* entry)
+{
+    if (entry->in_use)
+    {
+        gcry_cipher_close(entry->hd);
+    }
+    memset(entry, 0, sizeof(cryptography_cipher_cache_t));
+}
+
+static void cryptography_mac_cache_evict(cryptography_mac_cache_t* entry)
+{
+    if (entry->in_use)
+    {
+        gcry_mac_close(entry->hd);
+    }
+    memset(entry, 0, sizeof(cryptography_mac_cache_t));
+}
+
+/**
+ * @brief Function: cryptography_invalidate_key
+ * Drops every cached context keyed with key_id, or all contexts for KEY_CACHE_ALL
+ * @param key_id: uint16_t
+ * @return int32: Success/Failure
+ **/
+static int32_t cryptography_invalidate_key(uint16_t key_id)
+{
+    int i;
+    pthread_once(&cache_lock_once, cryptography_cache_lock_init);
+    for (i = 0; i < KEY_CACHE_SIZE; i++)
+    {
+        pthread_mutex_lock(&cipher_cache_lock[i]);
+        if (cipher_cache[i].in_use && (key_id == KEY_CACHE_ALL || cipher_cache[i].key_id == key_id))
+        {
+            cryptography_cipher_cache_evict(&cipher_cache[i]);
+        }
+        pthread_mutex_unlock(&cipher_cache_lock[i]);
+        pthread_mutex_lock(&mac_cache_lock[i]);
+        if (mac_cache[i].in_use && (key_id == KEY_CACHE_ALL || mac_cache[i].key_id == key_id))
+        {
+            cryptography_mac_cache_evict(&mac_cache[i]);
+        }
+        pthread_mutex_unlock(&mac_cache_lock[i]);
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: cryptography_cipher_acquire
+ * Returns a keyed cipher handle, reusing the cached one for the SA key when possible.
+ * Calls without an SA (OTAR / key verify), with oversized keys, or finding the slot in use by another
+ * thread get a one-shot handle, slot -1.
+ * @param tmp_hd: gcry_cipher_hd_t*
+ * @param slot: int32_t*
+ * @param sa_ptr: SecurityAssociation_t*
+ * @param ecs: uint8_t
+ * @param algo: int32_t
+ * @param mode: int32_t
+ * @param flags: uint32_t
+ * @param key_ptr: uint8_t*
+ * @param len_key: uint32_t
+ * @param gcry_error: gcry_error_t*
+ * @return int32: Success/Failure
+ **/
+static int32_t cryptography_cipher_acquire(gcry_cipher_hd_t* tmp_hd, int32_t* slot, SecurityAssociation_t* sa_ptr,
+                                           uint8_t ecs, int32_t algo, int32_t mode, uint32_t flags,
+                                           uint8_t* key_ptr, uint32_t len_key, gcry_error_t* gcry_error)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    cryptography_cipher_cache_t* entry = NULL;
+
+    *slot = -1;
+    pthread_once(&cache_lock_once, cryptography_cache_lock_init);
+    if (sa_ptr != NULL && len_key <= KEY_CACHE_MAX_KEY &&
+        pthread_mutex_trylock(&cipher_cache_lock[(sa_ptr->ekid ^ (ecs << 3)) % KEY_CACHE_SIZE]) == 0)
+    {
+        *slot = (sa_ptr->ekid ^ (ecs << 3)) % KEY_CACHE_SIZE;
+        entry = &cipher_cache[*slot];
+        if (entry->in_use && entry->key_id == sa_ptr->ekid && entry->suite == ecs && entry->algo == algo &&
+            entry->mode == mode && entry->flags == flags && entry->len_key == len_key &&
+            memcmp(entry->key, key_ptr, len_key) == 0)
+        {
+            *tmp_hd = entry->hd;
+            return status;
+        }
+        cryptography_cipher_cache_evict(entry);
+    }
+
+    *gcry_error = gcry_cipher_open(tmp_hd, algo, mode, flags);
+    if ((*gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    {
+        printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET, *gcry_error & GPG_ERR_CODE_MASK);
+        printf(KRED "Failure: %s/%s\n", gcry_strsource(*gcry_error), gcry_strerror(*gcry_error));
+        if (entry != NULL)
+        {
+            pthread_mutex_unlock(&cipher_cache_lock[*slot]);
+        }
+        *slot = -1;
+        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
+        return status;
+    }
+    *gcry_error = gcry_cipher_setkey(*tmp_hd, key_ptr, len_key);
+    if ((*gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    {
+        printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET, *gcry_error & GPG_ERR_CODE_MASK);
+        printf(KRED "Failure: %s/%s\n", gcry_strsource(*gcry_error), gcry_strerror(*gcry_error));
+        gcry_cipher_close(*tmp_hd);
+        if (entry != NULL)
+        {
+            pthread_mutex_unlock(&cipher_cache_lock[*slot]);
+        }
+        *slot = -1;
+        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
+        return status;
+    }
+
+    if (entry != NULL)
+    {
+        entry->in_use = 1;
+        entry->key_id = sa_ptr->ekid;
+        entry->suite = ecs;
+        entry->algo = algo;
+        entry->mode = mode;
+        entry->flags = flags;
+        entry->len_key = len_key;
+        memcpy(entry->key, key_ptr, len_key);
+        entry->hd = *tmp_hd;
+    }
+    return status;
+}
+
+/**
+ * @brief Function: cryptography_cipher_release
+ * Resets a cached handle for reuse, or closes it when uncached or the handle itself failed
+ * @param tmp_hd: gcry_cipher_hd_t
+ * @param slot: int32_t
+ * @param status: int32_t
+ **/
+static void cryptography_cipher_release(gcry_cipher_hd_t tmp_hd, int32_t slot, int32_t status)
+{
+    if (slot < 0)
+    {
+        gcry_cipher_close(tmp_hd);
+    }
+    else
+    {
+        // A frame failing verification says nothing about the handle, keep it rather than rekey per bad frame
+        if ((status != CRYPTO_LIB_SUCCESS) && (status != CRYPTO_LIB_ERR_MAC_VALIDATION_ERROR))
+        {
+            cryptography_cipher_cache_evict(&cipher_cache[slot]);
+        }
+        else
+        {
+            gcry_cipher_reset(tmp_hd);
+        }
+        pthread_mutex_unlock(&cipher_cache_lock[slot]);
+    }
+}
+
+/**
+ * @brief Function: cryptography_mac_acquire
+ * Returns a keyed MAC handle, reusing the cached one for the SA key when possible
+ * @param tmp_mac_hd: gcry_mac_hd_t*
+ * @param slot: int32_t*
+ * @param sa_ptr: SecurityAssociation_t*
+ * @param acs: uint8_t
+ * @param algo: int32_t
+ * @param key_ptr: uint8_t*
+ * @param len_key: uint32_t
+ * @param gcry_error: gcry_error_t*
+ * @return int32: Success/Failure
+ **/
+static int32_t cryptography_mac_acquire(gcry_mac_hd_t* tmp_mac_hd, int32_t* slot, SecurityAssociation_t* sa_ptr,
+                                        uint8_t acs, int32_t algo, uint8_t* key_ptr, uint32_t len_key,
+                                        gcry_error_t* gcry_error)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    cryptography_mac_cache_t* entry = NULL;
+
+    *slot = -1;
+    pthread_once(&cache_lock_once, cryptography_cache_lock_init);
+    if (sa_ptr != NULL && len_key <= KEY_CACHE_MAX_KEY &&
+        pthread_mutex_trylock(&mac_cache_lock[(sa_ptr->akid ^ (acs << 3)) % KEY_CACHE_SIZE]) == 0)
+    {
+        *slot = (sa_ptr->akid ^ (acs << 3)) % KEY_CACHE_SIZE;
+        entry = &mac_cache[*slot];
+        if (entry->in_use && entry->key_id == sa_ptr->akid && entry->suite == acs && entry->algo == algo &&
+            entry->len_key == len_key && memcmp(entry->key, key_ptr, len_key) == 0)
+        {
+            *tmp_mac_hd = entry->hd;
+            return status;
+        }
+        cryptography_mac_cache_evict(entry);
+    }
+
+    *gcry_error = gcry_mac_open(tmp_mac_hd, algo, GCRY_MAC_FLAG_SECURE, NULL);
+    if ((*gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    {
+        printf(KRED "ERROR: gcry_mac_open error code %d\n" RESET, *gcry_error & GPG_ERR_CODE_MASK);
+        printf(KRED "Failure: %s/%s\n" RESET, gcry_strsource(*gcry_error), gcry_strerror(*gcry_error));
+        if (entry != NULL)
+        {
+            pthread_mutex_unlock(&mac_cache_lock[*slot]);
+        }
+        *slot = -1;
+        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
+        return status;
+    }
+    *gcry_error = gcry_mac_setkey(*tmp_mac_hd, key_ptr, len_key);
+    if ((*gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    {
+        printf(KRED "ERROR: gcry_mac_setkey error code %d\n" RESET, *gcry_error & GPG_ERR_CODE_MASK);
+        printf(KRED "Failure: %s/%s\n" RESET, gcry_strsource(*gcry_error), gcry_strerror(*gcry_error));
+        gcry_mac_close(*tmp_mac_hd);
+        if (entry != NULL)
+        {
+            pthread_mutex_unlock(&mac_cache_lock[*slot]);
+        }
+        *slot = -1;
+        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
+        return status;
+    }
+
+    if (entry != NULL)
+    {
+        entry->in_use = 1;
+        entry->key_id = sa_ptr->akid;
+        entry->suite = acs;
+        entry->algo = algo;
+        entry->len_key = len_key;
+        memcpy(entry->key, key_ptr, len_key);
+        entry->hd = *tmp_mac_hd;
+    }
+    return status;
+}
+
+/**
+ * @brief Function: cryptography_mac_release
+ * Resets a cached MAC handle for reuse, or closes it when uncached or the handle itself failed
+ * @param tmp_mac_hd: gcry_mac_hd_t
+ * @param slot: int32_t
+ * @param status: int32_t
+ **/
+static void cryptography_mac_release(gcry_mac_hd_t tmp_mac_hd, int32_t slot, int32_t status)
+{
+    if (slot < 0)
+    {
+        gcry_mac_close(tmp_mac_hd);
+    }
+    else
+    {
+        if ((status != CRYPTO_LIB_SUCCESS) && (status != CRYPTO_LIB_ERR_MAC_VALIDATION_ERROR))
+        {
+            cryptography_mac_cache_evict(&mac_cache[slot]);
+        }
+        else
+        {
+            gcry_mac_reset(tmp_mac_hd);
+        }
+        pthread_mutex_unlock(&mac_cache_lock[slot]);
+    }
+}
+
 static int32_t cryptography_config(void)
 {
     return CRYPTO_LIB_SUCCESS;
@@ -119,7 +431,11 @@ static int32_t cryptography_init(void)
 
     return status;
 }
-static int32_t cryptography_shutdown(void){ return CRYPTO_LIB_SUCCESS; }
+static int32_t cryptography_shutdown(void)
+{
+    // Zeroise any retained key material
+    return cryptography_invalidate_key(KEY_CACHE_ALL);
+}
 
 static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
                                          uint8_t* data_in, size_t len_data_in,
@@ -135,12 +451,10 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
     int32_t status = CRYPTO_LIB_SUCCESS;
     uint8_t* key_ptr = key;
 
-    sa_ptr = sa_ptr; // Unused in this implementation
-
     // Need to copy the data over, since authentication won't change/move the data directly
     if(data_out != NULL)
     {
-        memcpy(data_out, data_in, len_data_in);
+        memmove(data_out, data_in, len_data_in);
     }
     else
     {
@@ -158,16 +472,12 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
         return CRYPTO_LIB_ERR_UNSUPPORTED_ACS;
     }
 
-    gcry_error = gcry_mac_open(&(tmp_mac_hd), algo, GCRY_MAC_FLAG_SECURE, NULL);
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    int32_t cache_slot = -1;
+    status = cryptography_mac_acquire(&tmp_mac_hd, &cache_slot, sa_ptr, acs, algo, key_ptr, len_key, &gcry_error);
+    if (status != CRYPTO_LIB_SUCCESS)
     {
-        printf(KRED "ERROR: gcry_mac_open error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
         return status;
     }
-    gcry_error = gcry_mac_setkey(tmp_mac_hd, key_ptr, len_key);
-    
 #ifdef SA_DEBUG
     uint32_t i;
     printf(KYEL "Auth MAC Printing Key:\n\t");
@@ -177,14 +487,6 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
     }
     printf("\n");
 #endif
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        printf(KRED "ERROR: gcry_mac_setkey error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
-        gcry_mac_close(tmp_mac_hd);
-        return status;
-    }
 
     // If MAC needs IV, set it (only for certain ciphers)
     if (iv_len > 0)
@@ -195,7 +497,7 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
             printf(KRED "ERROR: gcry_mac_setiv error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
             printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
             status = CRYPTO_LIB_ERROR;
-            gcry_mac_close(tmp_mac_hd);
+            cryptography_mac_release(tmp_mac_hd, cache_slot, status);
             return status;
         }
     }
@@ -210,7 +512,7 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
                 gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
         status = CRYPTO_LIB_ERROR;
-        gcry_mac_close(tmp_mac_hd);
+        cryptography_mac_release(tmp_mac_hd, cache_slot, status);
         return status;
     }
 
@@ -224,12 +526,11 @@ static int32_t cryptography_authenticate(uint8_t* data_out, size_t len_data_out,
         printf(KRED "ERROR: gcry_mac_read error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
         status = CRYPTO_LIB_ERR_MAC_RETRIEVAL_ERROR;
-        gcry_mac_close(tmp_mac_hd);
+        cryptography_mac_release(tmp_mac_hd, cache_slot, status);
         return status;
     }
 
-    // Zeroise any sensitive information
-    gcry_mac_close(tmp_mac_hd);
+    cryptography_mac_release(tmp_mac_hd, cache_slot, status);
     return status; 
 }
 static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t len_data_out,
@@ -248,14 +549,12 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
     size_t len_in = len_data_in; // Unused
     len_in = len_in;
 
-    sa_ptr = sa_ptr; // Unused in this implementation
-
     // Need to copy the data over, since authentication won't change/move the data directly
     // If you don't want data out, don't set a data out length
 
     if(data_out != NULL)
     {
-        memcpy(data_out, data_in, len_data_out);
+        memmove(data_out, data_in, len_data_out);
     }
     else
     {
@@ -272,16 +571,12 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
         return CRYPTO_LIB_ERR_UNSUPPORTED_ACS;
     }
 
-    gcry_error = gcry_mac_open(&(tmp_mac_hd), algo, GCRY_MAC_FLAG_SECURE, NULL);
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    int32_t cache_slot = -1;
+    status = cryptography_mac_acquire(&tmp_mac_hd, &cache_slot, sa_ptr, acs, algo, key_ptr, len_key, &gcry_error);
+    if (status != CRYPTO_LIB_SUCCESS)
     {
-        printf(KRED "ERROR: gcry_mac_open error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n" RESET, gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
         return status;
     }
-
-    gcry_error = gcry_mac_setkey(tmp_mac_hd, key_ptr, len_key);
 #ifdef SA_DEBUG
     uint32_t i;
     printf(KYEL "Validate MAC Printing Key:\n\t");
@@ -291,14 +586,7 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
     }
     printf("\n" RESET);
 #endif
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        printf(KRED "ERROR: gcry_mac_setkey error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n" RESET, gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        gcry_mac_close(tmp_mac_hd);
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
-        return status;
-    }
+
     // If MAC needs IV, set it (only for certain ciphers)
     if (iv_len > 0)
     {
@@ -307,8 +595,8 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
         {
             printf(KRED "ERROR: gcry_mac_setiv error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
             printf(KRED "Failure: %s/%s\n" RESET, gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-            gcry_mac_close(tmp_mac_hd);
             status = CRYPTO_LIB_ERROR;
+            cryptography_mac_release(tmp_mac_hd, cache_slot, status);
             return status;
         }
     }
@@ -321,8 +609,8 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
         printf(KRED "ERROR: gcry_mac_write error code %d\n" RESET,
                 gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n" RESET, gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        gcry_mac_close(tmp_mac_hd);
         status = CRYPTO_LIB_ERROR;
+        cryptography_mac_release(tmp_mac_hd, cache_slot, status);
         return status;
     }
 
@@ -337,6 +625,7 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
     {
         printf(KRED "ERROR: gcry_mac_read error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
         status = CRYPTO_LIB_ERR_MAC_RETRIEVAL_ERROR;
+        cryptography_mac_release(tmp_mac_hd, cache_slot, status);
         return status;
     }
 
@@ -368,8 +657,8 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
     {
         printf(KRED "ERROR: gcry_mac_verify error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n" RESET, gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        gcry_mac_close(tmp_mac_hd);
         status = CRYPTO_LIB_ERR_MAC_VALIDATION_ERROR;
+        cryptography_mac_release(tmp_mac_hd, cache_slot, status);
         return status;
     }
 #ifdef DEBUG
@@ -378,9 +667,7 @@ static int32_t cryptography_validate_authentication(uint8_t* data_out, size_t le
         printf("Mac verified!\n");
     }
 #endif
-    // Zeroise any sensitive information
-    gcry_mac_reset(tmp_mac_hd);
-    gcry_mac_close(tmp_mac_hd);
+    cryptography_mac_release(tmp_mac_hd, cache_slot, status);
     return status; 
 }
 
@@ -400,8 +687,6 @@ static int32_t cryptography_encrypt(uint8_t* data_out, size_t len_data_out,
     padding = padding;
     cam_cookies = cam_cookies;
 
-    sa_ptr = sa_ptr; // Unused in this implementation
-
     // Select correct libgcrypt algorith enum
     int32_t algo = -1;
     if (ecs != NULL)
@@ -425,16 +710,12 @@ static int32_t cryptography_encrypt(uint8_t* data_out, size_t len_data_out,
         return CRYPTO_LIB_ERR_UNSUPPORTED_MODE;
     }
 
-    gcry_error = gcry_cipher_open(&(tmp_hd), algo, mode, GCRY_CIPHER_NONE);
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    int32_t cache_slot = -1;
+    status = cryptography_cipher_acquire(&tmp_hd, &cache_slot, sa_ptr, *ecs, algo, mode, GCRY_CIPHER_NONE, key_ptr, len_key, &gcry_error);
+    if (status != CRYPTO_LIB_SUCCESS)
     {
-        printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
         return status;
     }
-    gcry_error = gcry_cipher_setkey(tmp_hd, key_ptr, len_key);
-
 #ifdef SA_DEBUG
     uint32_t i;
     printf(KYEL "Printing Key:\n\t");
@@ -445,21 +726,13 @@ static int32_t cryptography_encrypt(uint8_t* data_out, size_t len_data_out,
     printf("\n");
 #endif
 
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
-        gcry_cipher_close(tmp_hd);
-        return status;
-    }
     gcry_error = gcry_cipher_setiv(tmp_hd, iv, iv_len);
     if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
     {
         printf(KRED "ERROR: gcry_cipher_setiv error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
         status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
-        gcry_cipher_close(tmp_hd);
+        cryptography_cipher_release(tmp_hd, cache_slot, status);
         return status;
     }
 
@@ -491,7 +764,7 @@ static int32_t cryptography_encrypt(uint8_t* data_out, size_t len_data_out,
         printf(KRED "ERROR: gcry_cipher_encrypt error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
         status = CRYPTO_LIB_ERR_ENCRYPTION_ERROR;
-        gcry_cipher_close(tmp_hd);
+        cryptography_cipher_release(tmp_hd, cache_slot, status);
         return status;
     }
 
@@ -505,7 +778,7 @@ static int32_t cryptography_encrypt(uint8_t* data_out, size_t len_data_out,
     printf("\n");
 #endif
 
-    gcry_cipher_close(tmp_hd);
+    cryptography_cipher_release(tmp_hd, cache_slot, status);
     return status;
 }
 
@@ -537,26 +810,20 @@ int32_t cryptography_verify_ecs_enum_algo(uint8_t* ecs, int32_t* algo, int32_t*
     return status;
 }
 
-int32_t cryptography_gcry_setup(int32_t mode, int32_t algo, gcry_cipher_hd_t* tmp_hd, uint8_t* key_ptr, uint32_t len_key, uint8_t* iv, uint32_t iv_len, gcry_error_t* gcry_error)
+int32_t cryptography_gcry_setup(int32_t mode, int32_t algo, gcry_cipher_hd_t* tmp_hd, int32_t* cache_slot, SecurityAssociation_t* sa_ptr, uint8_t ecs, uint8_t* key_ptr, uint32_t len_key, uint8_t* iv, uint32_t iv_len, gcry_error_t* gcry_error)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
+    uint32_t flags = GCRY_CIPHER_NONE;
 
     if(mode == CRYPTO_CIPHER_AES256_CBC_MAC)
     {
-        *gcry_error = gcry_cipher_open(tmp_hd, algo, mode, GCRY_CIPHER_CBC_MAC);
+        flags = GCRY_CIPHER_CBC_MAC;
     }
-    else
+    status = cryptography_cipher_acquire(tmp_hd, cache_slot, sa_ptr, ecs, algo, mode, flags, key_ptr, len_key, gcry_error);
+    if (status != CRYPTO_LIB_SUCCESS)
     {
-        *gcry_error = gcry_cipher_open(tmp_hd, algo, mode, GCRY_CIPHER_NONE);
-    } 
-    if ((*gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET, *gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(*gcry_error), gcry_strerror(*gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
         return status;
     }
-    *gcry_error = gcry_cipher_setkey(*tmp_hd, key_ptr, len_key);
 #ifdef SA_DEBUG
     uint32_t i;
     printf(KYEL "AEAD MAC: Printing Key:\n\t");
@@ -567,21 +834,13 @@ int32_t cryptography_gcry_setup(int32_t mode, int32_t algo, gcry_cipher_hd_t* tm
     printf("\n");
 #endif
 
-    if ((*gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET, *gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(*gcry_error), gcry_strerror(*gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
-        gcry_cipher_close(*tmp_hd);
-        return status;
-    }
     *gcry_error = gcry_cipher_setiv(*tmp_hd, iv, iv_len);
     if ((*gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
     {
         printf(KRED "ERROR: gcry_cipher_setiv error code %d\n" RESET, *gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n", gcry_strsource(*gcry_error), gcry_strerror(*gcry_error));
         status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
-        gcry_cipher_close(*tmp_hd);
+        cryptography_cipher_release(*tmp_hd, *cache_slot, status);
         return status;
     }
     return status;
@@ -606,8 +865,6 @@ static int32_t cryptography_aead_encrypt(uint8_t* data_out, size_t len_data_out,
     acs = acs;
     cam_cookies = cam_cookies;
 
-    sa_ptr = sa_ptr; // Unused in this implementation
-
     // Select correct libgcrypt ecs enum
     int32_t algo = -1;
     int32_t mode = -1;
@@ -619,7 +876,8 @@ static int32_t cryptography_aead_encrypt(uint8_t* data_out, size_t len_data_out,
     }
    
     // TODO: Get Flag Functionality
-    status = cryptography_gcry_setup(mode, algo, &tmp_hd, key_ptr, len_key, iv, iv_len, &gcry_error);
+    int32_t cache_slot = -1;
+    status = cryptography_gcry_setup(mode, algo, &tmp_hd, &cache_slot, sa_ptr, *ecs, key_ptr, len_key, iv, iv_len, &gcry_error);
     if(status != CRYPTO_LIB_SUCCESS)
     {
         mc_if->mc_log(status);
@@ -649,7 +907,7 @@ static int32_t cryptography_aead_encrypt(uint8_t* data_out, size_t len_data_out,
                    gcry_error & GPG_ERR_CODE_MASK);
             printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
             status = CRYPTO_LIB_ERR_AUTHENTICATION_ERROR;
-            gcry_cipher_close(tmp_hd);
+            cryptography_cipher_release(tmp_hd, cache_slot, status);
             return status;
         }
     }
@@ -680,7 +938,7 @@ static int32_t cryptography_aead_encrypt(uint8_t* data_out, size_t len_data_out,
         printf(KRED "ERROR: gcry_cipher_encrypt error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
         status = CRYPTO_LIB_ERR_ENCRYPTION_ERROR;
-        gcry_cipher_close(tmp_hd);
+        cryptography_cipher_release(tmp_hd, cache_slot, status);
         return status;
     }
 
@@ -706,7 +964,7 @@ static int32_t cryptography_aead_encrypt(uint8_t* data_out, size_t len_data_out,
                    gcry_error & GPG_ERR_CODE_MASK);
             printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
             status = CRYPTO_LIB_ERR_MAC_RETRIEVAL_ERROR;
-            gcry_cipher_close(tmp_hd);
+            cryptography_cipher_release(tmp_hd, cache_slot, status);
             return status;
         }
 
@@ -721,7 +979,7 @@ static int32_t cryptography_aead_encrypt(uint8_t* data_out, size_t len_data_out,
 #endif
     }
 
-    gcry_cipher_close(tmp_hd);
+    cryptography_cipher_release(tmp_hd, cache_slot, status);
     return status;
 }
 
@@ -741,8 +999,6 @@ static int32_t cryptography_decrypt(uint8_t* data_out, size_t len_data_out,
     acs = acs;
     cam_cookies = cam_cookies;
 
-    sa_ptr = sa_ptr; // Unused in this implementation
-
     // Select correct libgcrypt ecs enum
     int32_t algo = -1;
     if (ecs != NULL)
@@ -766,21 +1022,10 @@ static int32_t cryptography_decrypt(uint8_t* data_out, size_t len_data_out,
         return CRYPTO_LIB_ERR_UNSUPPORTED_MODE;
     } 
 
-    gcry_error = gcry_cipher_open(&(tmp_hd), algo, mode, GCRY_CIPHER_NONE);
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
-        return status;
-    }
-    gcry_error = gcry_cipher_setkey(tmp_hd, key_ptr, len_key);
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    int32_t cache_slot = -1;
+    status = cryptography_cipher_acquire(&tmp_hd, &cache_slot, sa_ptr, *ecs, algo, mode, GCRY_CIPHER_NONE, key_ptr, len_key, &gcry_error);
+    if (status != CRYPTO_LIB_SUCCESS)
     {
-        printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        gcry_cipher_close(tmp_hd);
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
         return status;
     }
 
@@ -789,8 +1034,8 @@ static int32_t cryptography_decrypt(uint8_t* data_out, size_t len_data_out,
     {
         printf(KRED "ERROR: gcry_cipher_setiv error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        gcry_cipher_close(tmp_hd);
         status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
+        cryptography_cipher_release(tmp_hd, cache_slot, status);
         return status;
     }
 
@@ -803,13 +1048,13 @@ static int32_t cryptography_decrypt(uint8_t* data_out, size_t len_data_out,
     if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
     {
         printf(KRED "ERROR: gcry_cipher_decrypt error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        gcry_cipher_close(tmp_hd);
         status = CRYPTO_LIB_ERR_DECRYPT_ERROR;
+        cryptography_cipher_release(tmp_hd, cache_slot, status);
         return status;
     }
 
 
-    gcry_cipher_close(tmp_hd);
+    cryptography_cipher_release(tmp_hd, cache_slot, status);
     return status;
 
 }
@@ -833,8 +1078,6 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
     acs = acs;
     cam_cookies = cam_cookies;
 
-    sa_ptr = sa_ptr; // Unused in this implementation
-
     // Select correct libgcrypt ecs enum
     int32_t algo = -1;
     int32_t mode = -1;
@@ -864,30 +1107,20 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
         return status;
     }
 
-    gcry_error = gcry_cipher_open(&(tmp_hd), GCRY_CIPHER_AES256, mode, GCRY_CIPHER_NONE);
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    int32_t cache_slot = -1;
+    status = cryptography_cipher_acquire(&tmp_hd, &cache_slot, sa_ptr, *ecs, GCRY_CIPHER_AES256, mode, GCRY_CIPHER_NONE, key_ptr, len_key, &gcry_error);
+    if (status != CRYPTO_LIB_SUCCESS)
     {
-        printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
-        return status;
-    }
-    gcry_error = gcry_cipher_setkey(tmp_hd, key_ptr, len_key);
-    if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
-        printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        gcry_cipher_close(tmp_hd);
-        status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
         return status;
     }
+
     gcry_error = gcry_cipher_setiv(tmp_hd, iv, iv_len);
     if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
     {
         printf(KRED "ERROR: gcry_cipher_setiv error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
         printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-        gcry_cipher_close(tmp_hd);
         status = CRYPTO_LIB_ERR_LIBGCRYPT_ERROR;
+        cryptography_cipher_release(tmp_hd, cache_slot, status);
         return status;
     }
     
@@ -901,8 +1134,8 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
         {
             printf(KRED "ERROR: gcry_cipher_authenticate error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
             printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-            gcry_cipher_close(tmp_hd);
             status = CRYPTO_LIB_ERR_AUTHENTICATION_ERROR;
+            cryptography_cipher_release(tmp_hd, cache_slot, status);
             return status;
         }
     }
@@ -923,8 +1156,8 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
         {
             printf(KRED "ERROR: gcry_cipher_decrypt error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
             printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-            gcry_cipher_close(tmp_hd);
             status = CRYPTO_LIB_ERR_DECRYPT_ERROR;
+            cryptography_cipher_release(tmp_hd, cache_slot, status);
             return status;
         }
     }
@@ -933,14 +1166,14 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
         // Authenticate only! No input data passed into decryption function, only AAD.
         gcry_error = gcry_cipher_decrypt(tmp_hd,NULL,0, NULL,0);
         // If authentication only, don't decrypt the data. Just pass the data PDU through.
-        memcpy(data_out, data_in, len_data_in);
+        memmove(data_out, data_in, len_data_in);
 
         if ((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
         {
             printf(KRED "ERROR: gcry_cipher_decrypt error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
             printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-            gcry_cipher_close(tmp_hd);
             status = CRYPTO_LIB_ERR_DECRYPT_ERROR;
+            cryptography_cipher_release(tmp_hd, cache_slot, status);
             return status;
         }
     }
@@ -982,13 +1215,13 @@ static int32_t cryptography_aead_decrypt(uint8_t* data_out, size_t len_data_out,
         {
             printf(KRED "ERROR: gcry_cipher_checktag error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
             printf(KRED "Failure: %s/%s\n", gcry_strsource(gcry_error), gcry_strerror(gcry_error));
-            gcry_cipher_close(tmp_hd);
             status = CRYPTO_LIB_ERR_MAC_VALIDATION_ERROR;
+            cryptography_cipher_release(tmp_hd, cache_slot, status);
             return status;
         }
     }
 
-    gcry_cipher_close(tmp_hd);
+    cryptography_cipher_release(tmp_hd, cache_slot, status);
     return status;
 }
 
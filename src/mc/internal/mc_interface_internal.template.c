@@ -16,16 +16,50 @@
    jstar-development-team@mail.nasa.gov
 */
 #include "mc_interface.h"
+#include <pthread.h>
+#include <stdatomic.h>
 #include <time.h>
 
+/*
+** Error Log
+** mc_log is called on the frame path, often for frames an attacker controls, so it never touches the file.
+** It appends a fixed size record to a bounded MPSC ring and returns: each slot carries a sequence number,
+** a producer claims the slot at head with a CAS and publishes it by advancing the slot's sequence. The
+** flusher thread formats and writes whatever has been published every MC_LOG_FLUSH_MS.
+**
+** A full ring drops the record. An error code repeated within the same second is not queued again, so a
+** flood of bad frames costs one record per code per second; a dropped record does not count as queued.
+** Dropped and repeated records are counted separately, and the counts are written with the next batch.
+*/
+typedef struct
+{
+    atomic_uint seq; // == position: free for the producer claiming it, == position + 1: ready for the flusher
+    int32_t error_code;
+    time_t time;
+} mc_log_record_t;
+
 /* Variables */
 static FILE* mc_file_ptr;
 static McInterfaceStruct mc_if_struct;
+static mc_log_record_t mc_log_ring[MC_LOG_RING_SIZE];
+static atomic_uint mc_log_head;
+static uint32_t mc_log_tail; // Flusher only
+static uint8_t mc_log_ready = CRYPTO_FALSE;
+static atomic_uint mc_log_dropped;
+static atomic_uint mc_log_repeated;
+static atomic_uint_least64_t mc_log_last[MC_LOG_DEDUP_SLOTS]; // (second << 32) | error code, last queued
+static pthread_mutex_t mc_flusher_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t mc_flusher_wake = PTHREAD_COND_INITIALIZER;
+static pthread_t mc_flusher;
+static uint8_t mc_flusher_running = CRYPTO_FALSE;
+static uint8_t mc_flusher_stop = CRYPTO_FALSE;
 
 /* Prototypes */
 static int32_t mc_initialize(void);
 static void mc_log(int32_t error_code);
 static int32_t mc_shutdown(void);
+static void mc_flush(void);
+static void* mc_flusher_thread(void* arg);
 
 /* Functions */
 McInterface get_mc_interface_internal(void)
@@ -51,47 +85,228 @@ McInterface get_mc_interface_internal(void)
 static int32_t mc_initialize(void)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
-    
+
+    /* Already running, CryptoLib may be initialized again without a shutdown */
+    if (mc_flusher_running == CRYPTO_TRUE)
+    {
+        return status;
+    }
+
+    /* The ring outlives shutdown, records logged in between are written by the next flusher */
+    if (mc_log_ready == CRYPTO_FALSE)
+    {
+        for (uint32_t i = 0; i < MC_LOG_RING_SIZE; i++)
+        {
+            atomic_init(&mc_log_ring[i].seq, i);
+        }
+        atomic_init(&mc_log_head, 0);
+        mc_log_tail = 0;
+        mc_log_ready = CRYPTO_TRUE;
+    }
+
     /* Open log */
     mc_file_ptr = fopen(MC_LOG_PATH, "a");
     if (mc_file_ptr == NULL)
     {
         status = CRYPTO_LIB_ERR_MC_INIT;
         printf(KRED "ERROR: Monitoring and control initialization - internal failed\n" RESET);
+        return status;
+    }
+
+    mc_flusher_stop = CRYPTO_FALSE;
+    if (pthread_create(&mc_flusher, NULL, mc_flusher_thread, NULL) != 0)
+    {
+        status = CRYPTO_LIB_ERR_MC_INIT;
+        printf(KRED "ERROR: Monitoring and control initialization - internal failed\n" RESET);
+        fclose(mc_file_ptr);
+        mc_file_ptr = NULL;
+        return status;
     }
-    
+    mc_flusher_running = CRYPTO_TRUE;
+
     return status;
 }
 
 static void mc_log(int32_t error_code)
 {
-    time_t rawtime;
-    struct tm* timeinfo;
-    time(&rawtime);
-    timeinfo = localtime(&rawtime);
+    mc_log_record_t* record;
+    uint32_t pos;
+    int32_t diff;
+    uint64_t key;
+    uint64_t prev;
+    atomic_uint_least64_t* last;
+    time_t now;
 
     /* Write to log if error code is valid */
-    if (error_code != CRYPTO_LIB_SUCCESS)
+    if (error_code == CRYPTO_LIB_SUCCESS || mc_log_ready == CRYPTO_FALSE)
+    {
+        return;
+    }
+
+    /* Only the first of an error code each second is queued */
+    now = time(NULL);
+    key = ((uint64_t)now << 32) | (uint32_t)error_code;
+    last = &mc_log_last[(uint32_t)error_code & (MC_LOG_DEDUP_SLOTS - 1)];
+    prev = atomic_exchange_explicit(last, key, memory_order_relaxed);
+    if (prev == key)
+    {
+        atomic_fetch_add_explicit(&mc_log_repeated, 1, memory_order_relaxed);
+        return;
+    }
+
+    pos = atomic_load_explicit(&mc_log_head, memory_order_relaxed);
+    for (;;)
+    {
+        record = &mc_log_ring[pos & (MC_LOG_RING_SIZE - 1)];
+        diff = (int32_t)(atomic_load_explicit(&record->seq, memory_order_acquire) - pos);
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&mc_log_head, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* Ring full, the flusher is behind. Give the dedup slot back unless another code or second has
+               taken it since, so the next occurrence is queued rather than counted as a repeat */
+            atomic_fetch_add_explicit(&mc_log_dropped, 1, memory_order_relaxed);
+            atomic_compare_exchange_strong_explicit(last, &key, prev, memory_order_relaxed, memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&mc_log_head, memory_order_relaxed);
+        }
+    }
+
+    record->error_code = error_code;
+    record->time = now;
+    atomic_store_explicit(&record->seq, pos + 1, memory_order_release);
+
+    return;
+}
+
+/**
+ * @brief Function: mc_flush
+ * Writes every published record, then the dropped and repeated counts if any. Flusher thread, or
+ * shutdown once the flusher has stopped.
+ **/
+static void mc_flush(void)
+{
+    mc_log_record_t* record;
+    struct tm timebuf;
+    time_t formatted = (time_t)-1;
+    time_t now;
+    uint32_t written = 0;
+    uint32_t dropped;
+    uint32_t repeated;
+
+    for (;;)
     {
-        fprintf(mc_file_ptr, "[%d%d%d,%d:%d:%d], %d\n", 
-            timeinfo->tm_year + 1900, timeinfo->tm_mon + 1,  timeinfo->tm_mday, 
-            timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, error_code);
-        
+        record = &mc_log_ring[mc_log_tail & (MC_LOG_RING_SIZE - 1)];
+        if (atomic_load_explicit(&record->seq, memory_order_acquire) != mc_log_tail + 1)
+        {
+            break;
+        }
+
+        /* Records of a batch mostly share their second, convert it once */
+        if (record->time != formatted)
+        {
+            localtime_r(&record->time, &timebuf);
+            formatted = record->time;
+        }
+        if (mc_file_ptr != NULL)
+        {
+            fprintf(mc_file_ptr, "[%d%d%d,%d:%d:%d], %d\n",
+                timebuf.tm_year + 1900, timebuf.tm_mon + 1, timebuf.tm_mday,
+                timebuf.tm_hour, timebuf.tm_min, timebuf.tm_sec, record->error_code);
+            written++;
+        }
+
         /* Also print error if debug enabled */
         #ifdef DEBUG
-            printf("MC_Log: Error, [%d%d%d,%d:%d:%d], %d\n", 
-            timeinfo->tm_year + 1900, timeinfo->tm_mon + 1,  timeinfo->tm_mday, 
-            timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, error_code);
+            printf("MC_Log: Error, [%d%d%d,%d:%d:%d], %d\n",
+            timebuf.tm_year + 1900, timebuf.tm_mon + 1, timebuf.tm_mday,
+            timebuf.tm_hour, timebuf.tm_min, timebuf.tm_sec, record->error_code);
         #endif
+
+        atomic_store_explicit(&record->seq, mc_log_tail + MC_LOG_RING_SIZE, memory_order_release);
+        mc_log_tail++;
     }
 
-    return;
+    dropped = atomic_exchange_explicit(&mc_log_dropped, 0, memory_order_relaxed);
+    repeated = atomic_exchange_explicit(&mc_log_repeated, 0, memory_order_relaxed);
+    if ((dropped > 0 || repeated > 0) && mc_file_ptr != NULL)
+    {
+        now = time(NULL);
+        localtime_r(&now, &timebuf);
+        fprintf(mc_file_ptr, "[%d%d%d,%d:%d:%d], repeated %u, dropped %u\n",
+            timebuf.tm_year + 1900, timebuf.tm_mon + 1, timebuf.tm_mday,
+            timebuf.tm_hour, timebuf.tm_min, timebuf.tm_sec, repeated, dropped);
+        written++;
+    }
+
+    if (written > 0)
+    {
+        fflush(mc_file_ptr);
+    }
+}
+
+/**
+ * @brief Function: mc_flusher_thread
+ * Flushes queued records every MC_LOG_FLUSH_MS until mc_shutdown
+ **/
+static void* mc_flusher_thread(void* arg)
+{
+    struct timespec wake;
+    arg = arg;
+
+    pthread_mutex_lock(&mc_flusher_lock);
+    while (mc_flusher_stop == CRYPTO_FALSE)
+    {
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_sec += MC_LOG_FLUSH_MS / 1000;
+        wake.tv_nsec += (MC_LOG_FLUSH_MS % 1000) * 1000000L;
+        if (wake.tv_nsec >= 1000000000L)
+        {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&mc_flusher_wake, &mc_flusher_lock, &wake);
+        if (mc_flusher_stop == CRYPTO_FALSE)
+        {
+            pthread_mutex_unlock(&mc_flusher_lock);
+            mc_flush();
+            pthread_mutex_lock(&mc_flusher_lock);
+        }
+    }
+    pthread_mutex_unlock(&mc_flusher_lock);
+    return NULL;
 }
 
 static int32_t mc_shutdown(void)
 {
+    if (mc_flusher_running == CRYPTO_TRUE)
+    {
+        pthread_mutex_lock(&mc_flusher_lock);
+        mc_flusher_stop = CRYPTO_TRUE;
+        pthread_cond_signal(&mc_flusher_wake);
+        pthread_mutex_unlock(&mc_flusher_lock);
+        pthread_join(mc_flusher, NULL);
+        mc_flusher_running = CRYPTO_FALSE;
+
+        /* Whatever was queued since the last batch */
+        mc_flush();
+    }
+
     /* Close log */
-    fclose(mc_file_ptr);
+    if (mc_file_ptr != NULL)
+    {
+        fclose(mc_file_ptr);
+        mc_file_ptr = NULL;
+    }
 
     return CRYPTO_LIB_SUCCESS;
 }
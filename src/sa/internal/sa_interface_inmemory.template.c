@@ -13,8 +13,13 @@
  */
 
 #include "crypto.h"
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
 
 // Security Association Initialization Functions
 static int32_t sa_config(void);
@@ -34,6 +39,27 @@ static int32_t sa_create(void);
 static int32_t sa_setARSN(void);
 static int32_t sa_setARSNW(void);
 static int32_t sa_delete(void);
+// Security Association Index Functions
+static void sa_index_rebuild(void);
+static void sa_index_insert(uint16_t spi);
+static void sa_index_remove(uint16_t spi);
+static void sa_index_link(uint16_t spi);
+static uint8_t sa_index_current(uint16_t spi);
+static void sa_index_unlink(uint16_t spi);
+static void sa_index_reconcile(void);
+static void sa_bind_cold(void);
+// Security Association File Functions
+static int32_t sa_snapshot(void);
+static void sa_snapshot_request(void);
+static int32_t sa_journal_append(SecurityAssociation_t* sa_ptr);
+static int32_t sa_journal_sync(void);
+static void sa_journal_replay(void);
+static void sa_lease_resume(void);
+#ifdef SA_FILE
+static int32_t sa_journal_flusher_start(void);
+static void sa_journal_flusher_shutdown(void);
+static void* sa_journal_flusher_thread(void* arg);
+#endif
 
 /*
 ** Global Variables
@@ -41,6 +67,61 @@ static int32_t sa_delete(void);
 // Security
 static SaInterfaceStruct sa_if_struct;
 static SecurityAssociation_t sa[NUM_SA];
+static SecurityAssociationCold_t sa_cold[NUM_SA]; // ABM and key references of sa[x], bound by sa_bind_cold
+
+// Operational SA index, (tfvn, scid, vcid, mapid) -> SPI
+// Each bucket is a chain of operational SPIs in ascending order, so the first valid entry is the
+// same SA a linear scan would return.  SA management and saves re-index the SAs they change. Callers
+// may also change an SA through the pointer from sa_get_from_spi, so that marks the SA exposed, and a
+// lookup also checks the live state and GVCID of the exposed SAs below its chain match: the result is
+// always what a linear scan would find, at the cost of a scan bounded by the SAs in use. Only when an
+// exposed SA's state or GVCID actually moved does the lookup re-index it. Lookups share sa_index_lock,
+// anything that changes the chains holds it exclusively; a lookup never changes the chains under the
+// read lock.
+static pthread_rwlock_t sa_index_lock = PTHREAD_RWLOCK_INITIALIZER;
+static uint16_t sa_index_head[SA_INDEX_BUCKETS]; // SPI + 1, 0 = empty
+static uint16_t sa_index_next[NUM_SA];           // SPI + 1, 0 = end of chain
+static uint16_t sa_index_bucket[NUM_SA];         // bucket + 1, 0 = not indexed
+static uint8_t sa_index_unique_mapid;
+static atomic_uint_least64_t sa_index_exposed[(NUM_SA + 63) / 64]; // Bit per SPI handed out by sa_get_from_spi
+
+/*
+** SA File Journal
+** The full SADB (CRYPTO_SA_SAVE) is only rewritten as a snapshot: at init and shutdown, after SA
+** management and every SA_JOURNAL_COMPACT_RECORDS saves. In between, a save appends the SA's IV and
+** ARSN to CRYPTO_SA_JOURNAL. Appends are group committed, flushed and fsync'd once SA_JOURNAL_SYNC_FRAMES
+** records or SA_JOURNAL_SYNC_MS have accumulated, which bounds what a crash loses. The count is checked
+** on append, the time also by a flusher thread, so the tail is synced when traffic stops.
+** Snapshot and records carry a generation, and only records of the snapshot's generation are replayed,
+** so a journal left behind by an interrupted compaction can never roll counters back.
+** In lease mode (Crypto_Config_SA_Lease) only lease renewals reach the file, and a load resumes every
+** SA holding a lease from the lease. A clean shutdown drops the leases and saves the exact counters.
+*/
+typedef struct
+{
+    uint32_t generation;
+    uint16_t spi;
+    uint8_t iv_len;
+    uint8_t arsn_len;
+    uint8_t iv[IV_SIZE];
+    uint8_t arsn[ARSN_SIZE];
+    uint8_t leased; // CRYPTO_TRUE: iv and arsn are a lease, see Crypto_SA_Lease_Renew
+    uint16_t crc;   // CRC16 of the preceding fields, a torn record ends replay
+} sa_journal_record_t;
+
+static pthread_mutex_t sa_file_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE* sa_journal_file = NULL;
+static uint32_t sa_generation = 0;
+static uint32_t sa_journal_records = 0;  // Appended since the last snapshot
+static uint32_t sa_journal_unsynced = 0; // Appended since the last fsync
+static struct timespec sa_journal_synced_at;
+static uint8_t sa_snapshot_pending = CRYPTO_FALSE;
+#ifdef SA_FILE
+static pthread_cond_t sa_journal_flusher_wake = PTHREAD_COND_INITIALIZER; // Waits on sa_file_lock
+static pthread_t sa_journal_flusher;
+static uint8_t sa_journal_flusher_running = CRYPTO_FALSE;
+static uint8_t sa_journal_flusher_stop = CRYPTO_FALSE;
+#endif
 
 /**
  * @brief Function: get_sa_interface_inmemory
@@ -66,6 +147,252 @@ SaInterface get_sa_interface_inmemory(void)
     return &sa_if_struct;
 }
 
+/**
+ * @brief Function: sa_bind_cold
+ * Points each SA at its cold storage.  Needed before first use and after the SA array is reloaded.
+ **/
+static void sa_bind_cold(void)
+{
+    for (int x = 0; x < NUM_SA; x++)
+    {
+        sa[x].ek_ref = sa_cold[x].ek_ref;
+        sa[x].ak_ref = sa_cold[x].ak_ref;
+        sa[x].abm = sa_cold[x].abm;
+        sa[x].replay = &sa_cold[x].replay;
+    }
+}
+
+/*
+** Security Association Index Functions
+*/
+/**
+ * @brief Function: sa_index_hash
+ * MapID only takes part in the key when SAs are unique per MapID.
+ * @return uint16: bucket
+ **/
+static uint16_t sa_index_hash(uint8_t tfvn, uint16_t scid, uint16_t vcid, uint8_t mapid)
+{
+    uint64_t key;
+
+    if (sa_index_unique_mapid == TC_UNIQUE_SA_PER_MAP_ID_FALSE)
+    {
+        mapid = 0;
+    }
+    key = ((uint64_t)tfvn << 48) | ((uint64_t)scid << 32) | ((uint64_t)vcid << 16) | mapid;
+    key *= 0x9E3779B97F4A7C15ULL;
+    return (uint16_t)((key >> 32) & (SA_INDEX_BUCKETS - 1));
+}
+
+/**
+ * @brief Function: sa_index_matches
+ * @return uint8: CRYPTO_TRUE if SA spi is operational on the given channel
+ **/
+static uint8_t sa_index_matches(uint16_t spi, uint8_t tfvn, uint16_t scid, uint16_t vcid, uint8_t mapid)
+{
+    return ((sa[spi].gvcid_blk.tfvn == tfvn) && (sa[spi].gvcid_blk.scid == scid) &&
+            (sa[spi].gvcid_blk.vcid == vcid) && (sa[spi].sa_state == SA_OPERATIONAL) &&
+            (sa_index_unique_mapid == TC_UNIQUE_SA_PER_MAP_ID_FALSE || sa[spi].gvcid_blk.mapid == mapid))
+               ? CRYPTO_TRUE
+               : CRYPTO_FALSE;
+}
+
+/**
+ * @brief Function: sa_index_current
+ * Caller holds sa_index_lock.
+ * @return uint8: CRYPTO_TRUE if SA spi is indexed exactly when operational, under its current GVCID
+ **/
+static uint8_t sa_index_current(uint16_t spi)
+{
+    if (sa[spi].sa_state != SA_OPERATIONAL)
+    {
+        return (sa_index_bucket[spi] == 0) ? CRYPTO_TRUE : CRYPTO_FALSE;
+    }
+    return (sa_index_bucket[spi] == sa_index_hash(sa[spi].gvcid_blk.tfvn, sa[spi].gvcid_blk.scid,
+                                                  sa[spi].gvcid_blk.vcid, sa[spi].gvcid_blk.mapid) + 1)
+               ? CRYPTO_TRUE
+               : CRYPTO_FALSE;
+}
+
+/**
+ * @brief Function: sa_index_unlink
+ * Unlinks SA spi from the index, if present.  Caller holds sa_index_lock exclusively.
+ **/
+static void sa_index_unlink(uint16_t spi)
+{
+    uint16_t* link;
+
+    if (spi >= NUM_SA || sa_index_bucket[spi] == 0)
+    {
+        return;
+    }
+    link = &sa_index_head[sa_index_bucket[spi] - 1];
+    while (*link != 0)
+    {
+        if (*link == spi + 1)
+        {
+            *link = sa_index_next[spi];
+            break;
+        }
+        link = &sa_index_next[*link - 1];
+    }
+    sa_index_next[spi] = 0;
+    sa_index_bucket[spi] = 0;
+}
+
+/**
+ * @brief Function: sa_index_link
+ * (Re)indexes SA spi under its current GVCID if it is operational.  Caller holds sa_index_lock exclusively.
+ **/
+static void sa_index_link(uint16_t spi)
+{
+    uint16_t bucket;
+    uint16_t* link;
+
+    if (spi >= NUM_SA)
+    {
+        return;
+    }
+    sa_index_unlink(spi);
+    if (sa[spi].sa_state != SA_OPERATIONAL)
+    {
+        return;
+    }
+    bucket = sa_index_hash(sa[spi].gvcid_blk.tfvn, sa[spi].gvcid_blk.scid, sa[spi].gvcid_blk.vcid,
+                           sa[spi].gvcid_blk.mapid);
+    link = &sa_index_head[bucket];
+    while (*link != 0 && *link < spi + 1)
+    {
+        link = &sa_index_next[*link - 1];
+    }
+    sa_index_next[spi] = *link;
+    *link = spi + 1;
+    sa_index_bucket[spi] = bucket + 1;
+}
+
+/**
+ * @brief Function: sa_index_remove
+ * Unlinks SA spi from the index, if present.  Must precede any change to its GVCID.
+ **/
+static void sa_index_remove(uint16_t spi)
+{
+    pthread_rwlock_wrlock(&sa_index_lock);
+    sa_index_unlink(spi);
+    pthread_rwlock_unlock(&sa_index_lock);
+}
+
+/**
+ * @brief Function: sa_index_insert
+ * (Re)indexes SA spi under its current GVCID if it is operational.
+ **/
+static void sa_index_insert(uint16_t spi)
+{
+    pthread_rwlock_wrlock(&sa_index_lock);
+    sa_index_link(spi);
+    pthread_rwlock_unlock(&sa_index_lock);
+}
+
+/**
+ * @brief Function: sa_index_rebuild
+ * Indexes every operational SA, used after the SA array is (re)loaded.
+ **/
+static void sa_index_rebuild(void)
+{
+    uint16_t spi;
+
+    pthread_rwlock_wrlock(&sa_index_lock);
+    memset(sa_index_head, 0, sizeof(sa_index_head));
+    memset(sa_index_next, 0, sizeof(sa_index_next));
+    memset(sa_index_bucket, 0, sizeof(sa_index_bucket));
+    sa_index_unique_mapid = crypto_config.unique_sa_per_mapid;
+    for (spi = NUM_SA; spi > 0; spi--)
+    {
+        sa_index_link(spi - 1);
+    }
+    pthread_rwlock_unlock(&sa_index_lock);
+}
+
+/**
+ * @brief Function: sa_index_reconcile
+ * Re-indexes the exposed SAs whose state or GVCID moved since they were indexed.
+ **/
+static void sa_index_reconcile(void)
+{
+    uint64_t exposed;
+    uint16_t word;
+    uint16_t spi;
+
+    pthread_rwlock_wrlock(&sa_index_lock);
+    for (word = 0; word < (NUM_SA + 63) / 64; word++)
+    {
+        exposed = atomic_load_explicit(&sa_index_exposed[word], memory_order_acquire);
+        for (spi = word * 64; exposed != 0; spi++, exposed >>= 1)
+        {
+            if ((exposed & 1) && sa_index_current(spi) == CRYPTO_FALSE)
+            {
+                sa_index_link(spi);
+            }
+        }
+    }
+    pthread_rwlock_unlock(&sa_index_lock);
+}
+
+/**
+ * @brief Function: sa_index_lookup
+ * @return int32: SPI of the operational SA for the channel, -1 if none
+ **/
+static int32_t sa_index_lookup(uint8_t tfvn, uint16_t scid, uint16_t vcid, uint8_t mapid)
+{
+    uint64_t exposed;
+    uint16_t entry;
+    uint16_t word;
+    uint16_t x;
+    uint8_t moved = CRYPTO_FALSE;
+    int32_t spi = -1;
+
+    if (sa_index_unique_mapid != crypto_config.unique_sa_per_mapid)
+    {
+        sa_index_rebuild();
+    }
+
+    pthread_rwlock_rdlock(&sa_index_lock);
+    entry = sa_index_head[sa_index_hash(tfvn, scid, vcid, mapid)];
+    while (entry != 0)
+    {
+        // Chains are only changed under the write lock, an entry can still go stale through a held pointer
+        if (sa_index_matches(entry - 1, tfvn, scid, vcid, mapid) == CRYPTO_TRUE)
+        {
+            spi = entry - 1;
+            break;
+        }
+        entry = sa_index_next[entry - 1];
+    }
+    // An exposed SA below the match may have been moved onto this channel through its pointer
+    for (word = 0; word < (NUM_SA + 63) / 64; word++)
+    {
+        exposed = atomic_load_explicit(&sa_index_exposed[word], memory_order_acquire);
+        for (x = word * 64; exposed != 0 && (spi < 0 || x < spi); x++, exposed >>= 1)
+        {
+            if ((exposed & 1) == 0 || sa_index_current(x) == CRYPTO_TRUE)
+            {
+                continue;
+            }
+            moved = CRYPTO_TRUE;
+            if (sa_index_matches(x, tfvn, scid, vcid, mapid) == CRYPTO_TRUE)
+            {
+                spi = x;
+                break;
+            }
+        }
+    }
+    pthread_rwlock_unlock(&sa_index_lock);
+
+    if (moved == CRYPTO_TRUE)
+    {
+        sa_index_reconcile();
+    }
+    return spi;
+}
+
 /**
  * @brief Function: sa_load_file
  * Loads saved sa_file
@@ -92,9 +419,18 @@ int32_t sa_load_file()
     }
     if( status == CRYPTO_LIB_SUCCESS)
     {
-        success_flag = fread(&sa[0], SA_SIZE, NUM_SA, sa_save_file);
+        // Hot records then cold storage, the saved pointers are stale and are rebound below
+        success_flag = fread(&sa[0], SA_SIZE, NUM_SA, sa_save_file) == NUM_SA &&
+                       fread(&sa_cold[0], sizeof(SecurityAssociationCold_t), NUM_SA, sa_save_file) == NUM_SA;
+        sa_bind_cold();
         if(success_flag)
         {
+            // Files written before the journal have no generation
+            if (fread(&sa_generation, sizeof(sa_generation), 1, sa_save_file) != 1)
+            {
+                sa_generation = 0;
+            }
+            sa_journal_replay();
             status = CRYPTO_LIB_SUCCESS;
 #ifdef SA_DEBUG
             printf("SA Load Successfull!\n");
@@ -120,6 +456,7 @@ int32_t sa_load_file()
 void update_sa_from_ptr(SecurityAssociation_t* sa_ptr)
 {
     int location = sa_ptr->spi;
+    uint8_t indexed;
     sa[location].spi = sa_ptr->spi;
     sa[location].ekid = sa_ptr->ekid;
     sa[location].akid = sa_ptr->akid;
@@ -155,48 +492,344 @@ void update_sa_from_ptr(SecurityAssociation_t* sa_ptr)
     }
     sa[location].arsnw_len = sa_ptr->arsnw_len;
     sa[location].arsnw = sa_ptr->arsnw;
+    sa[location].arsnw_bitmap = sa_ptr->arsnw_bitmap;
+
+    // Saves are per frame, only take the index write lock when state or GVCID actually moved
+    pthread_rwlock_rdlock(&sa_index_lock);
+    indexed = sa_index_current(location);
+    pthread_rwlock_unlock(&sa_index_lock);
+    if (indexed == CRYPTO_FALSE)
+    {
+        sa_index_insert(location);
+    }
 }
 
 /**
- * @brief Function: sa_perform_save
- * Saves SA Array to file
+ * @brief Function: sa_snapshot
+ * Writes the whole SA Array to file and starts a new journal generation.
+ * Caller holds sa_file_lock.
+ * @return int32: Success/Failure
  **/
-int32_t sa_perform_save(SecurityAssociation_t* sa_ptr)
+static int32_t sa_snapshot(void)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
     FILE* sa_save_file;
     int success_flag = 0;
+    uint32_t generation = sa_generation + 1;
 
-    update_sa_from_ptr(sa_ptr);
-
-    sa_save_file = fopen(CRYPTO_SA_SAVE, "wb");
+    // Write aside and rename over, so a crash leaves either the old or the new snapshot
+    sa_save_file = fopen(CRYPTO_SA_SAVE ".tmp", "wb");
 
     if (sa_save_file == NULL)
     {
         status = CRYPTO_LIB_ERR_FAIL_SA_SAVE;
+        return status;
     }
 
-    if(status == CRYPTO_LIB_SUCCESS)
+    success_flag = fwrite(sa, SA_SIZE, NUM_SA, sa_save_file) == NUM_SA &&
+                   fwrite(sa_cold, sizeof(SecurityAssociationCold_t), NUM_SA, sa_save_file) == NUM_SA &&
+                   fwrite(&generation, sizeof(generation), 1, sa_save_file) == 1 &&
+                   fflush(sa_save_file) == 0 && fsync(fileno(sa_save_file)) == 0;
+    fclose(sa_save_file);
+
+    if (success_flag && rename(CRYPTO_SA_SAVE ".tmp", CRYPTO_SA_SAVE) == 0)
     {
-        success_flag = fwrite(sa, SA_SIZE, NUM_SA, sa_save_file); 
+        sa_generation = generation;
+        if (sa_journal_file != NULL)
+        {
+            fclose(sa_journal_file);
+            sa_journal_file = NULL;
+        }
+        remove(CRYPTO_SA_JOURNAL);
+        sa_journal_records = 0;
+        sa_journal_unsynced = 0;
+        sa_snapshot_pending = CRYPTO_FALSE;
+#ifdef SA_DEBUG
+        printf("SA Written Successfully to file!\n");
+#endif
+    }
+    else
+    {
+        remove(CRYPTO_SA_SAVE ".tmp");
+        status = CRYPTO_LIB_ERR_FAIL_SA_SAVE;
+#ifdef SA_DEBUG
+        printf("ERROR: SA Write FAILED!\n");
+#endif
+    }
+    return status;
+}
 
-        if(success_flag)
+/**
+ * @brief Function: sa_snapshot_request
+ * Makes the next save a snapshot, for changes that are not IV/ARSN (SA management)
+ **/
+static void sa_snapshot_request(void)
+{
+    pthread_mutex_lock(&sa_file_lock);
+    sa_snapshot_pending = CRYPTO_TRUE;
+    pthread_mutex_unlock(&sa_file_lock);
+}
+
+/**
+ * @brief Function: sa_journal_sync
+ * Makes every appended record durable. Caller holds sa_file_lock.
+ * @return int32: Success/Failure
+ **/
+static int32_t sa_journal_sync(void)
+{
+    if (sa_journal_file == NULL || sa_journal_unsynced == 0)
+    {
+        return CRYPTO_LIB_SUCCESS;
+    }
+    if (fflush(sa_journal_file) != 0 || fsync(fileno(sa_journal_file)) != 0)
+    {
+        return CRYPTO_LIB_ERR_FAIL_SA_SAVE;
+    }
+    sa_journal_unsynced = 0;
+    clock_gettime(CLOCK_MONOTONIC, &sa_journal_synced_at);
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: sa_journal_append
+ * Appends an SA's IV and ARSN to the journal, syncing per the group commit policy.
+ * Caller holds sa_file_lock.
+ * @param sa_ptr: SecurityAssociation_t*
+ * @return int32: Success/Failure
+ **/
+static int32_t sa_journal_append(SecurityAssociation_t* sa_ptr)
+{
+    sa_journal_record_t record;
+    struct timespec now;
+    int64_t elapsed_ms;
+
+    if (sa_journal_file == NULL)
+    {
+        sa_journal_file = fopen(CRYPTO_SA_JOURNAL, "ab");
+        if (sa_journal_file == NULL)
         {
-            status = CRYPTO_LIB_SUCCESS;
+            return CRYPTO_LIB_ERR_FAIL_SA_SAVE;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &sa_journal_synced_at);
+    }
 
-#ifdef SA_DEBUG
-            printf("SA Written Successfully to file!\n");
+    memset(&record, 0, sizeof(record));
+    record.generation = sa_generation;
+    record.spi = sa_ptr->spi;
+    record.iv_len = (sa_ptr->iv_len > IV_SIZE) ? IV_SIZE : sa_ptr->iv_len;
+    record.arsn_len = (sa_ptr->arsn_len > ARSN_SIZE) ? ARSN_SIZE : sa_ptr->arsn_len;
+    if (crypto_config.sa_lease_frames > 0 && sa_cold[sa_ptr->spi].lease.active == CRYPTO_TRUE)
+    {
+        record.leased = CRYPTO_TRUE;
+        memcpy(record.iv, sa_cold[sa_ptr->spi].lease.iv, record.iv_len);
+        memcpy(record.arsn, sa_cold[sa_ptr->spi].lease.arsn, record.arsn_len);
+    }
+    else
+    {
+        memcpy(record.iv, sa_ptr->iv, record.iv_len);
+        memcpy(record.arsn, sa_ptr->arsn, record.arsn_len);
+    }
+    record.crc = Crypto_Calc_CRC16((uint8_t*)&record, offsetof(sa_journal_record_t, crc));
+
+    if (fwrite(&record, sizeof(record), 1, sa_journal_file) != 1)
+    {
+        return CRYPTO_LIB_ERR_FAIL_SA_SAVE;
+    }
+    sa_journal_records++;
+    sa_journal_unsynced++;
+
+    // A lease must be durable before any counter past the previous one is used
+    if (record.leased == CRYPTO_TRUE)
+    {
+        return sa_journal_sync();
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed_ms = (int64_t)(now.tv_sec - sa_journal_synced_at.tv_sec) * 1000 +
+                 (now.tv_nsec - sa_journal_synced_at.tv_nsec) / 1000000;
+    if (sa_journal_unsynced >= SA_JOURNAL_SYNC_FRAMES || elapsed_ms >= SA_JOURNAL_SYNC_MS)
+    {
+        return sa_journal_sync();
+    }
+    return CRYPTO_LIB_SUCCESS;
+}
+
+#ifdef SA_FILE
+/**
+ * @brief Function: sa_journal_flusher_thread
+ * Syncs journal records left unsynced for SA_JOURNAL_SYNC_MS until sa_journal_flusher_shutdown
+ **/
+static void* sa_journal_flusher_thread(void* arg)
+{
+    struct timespec wake;
+    struct timespec now;
+    int64_t elapsed_ms;
+    arg = arg;
+
+    pthread_mutex_lock(&sa_file_lock);
+    while (sa_journal_flusher_stop == CRYPTO_FALSE)
+    {
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_sec += SA_JOURNAL_SYNC_MS / 1000;
+        wake.tv_nsec += (SA_JOURNAL_SYNC_MS % 1000) * 1000000L;
+        if (wake.tv_nsec >= 1000000000L)
+        {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&sa_journal_flusher_wake, &sa_file_lock, &wake);
+        if (sa_journal_flusher_stop == CRYPTO_FALSE && sa_journal_unsynced > 0)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            elapsed_ms = (int64_t)(now.tv_sec - sa_journal_synced_at.tv_sec) * 1000 +
+                         (now.tv_nsec - sa_journal_synced_at.tv_nsec) / 1000000;
+            if (elapsed_ms >= SA_JOURNAL_SYNC_MS)
+            {
+                sa_journal_sync();
+            }
+        }
+    }
+    pthread_mutex_unlock(&sa_file_lock);
+    return NULL;
+}
+
+/**
+ * @brief Function: sa_journal_flusher_start
+ * Starts the journal flusher, if not already running
+ * @return int32: Success/Failure
+ **/
+static int32_t sa_journal_flusher_start(void)
+{
+    if (sa_journal_flusher_running == CRYPTO_TRUE)
+    {
+        return CRYPTO_LIB_SUCCESS;
+    }
+    sa_journal_flusher_stop = CRYPTO_FALSE;
+    if (pthread_create(&sa_journal_flusher, NULL, sa_journal_flusher_thread, NULL) != 0)
+    {
+        return CRYPTO_LIB_ERROR;
+    }
+    sa_journal_flusher_running = CRYPTO_TRUE;
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: sa_journal_flusher_shutdown
+ * Stops the journal flusher, if running
+ **/
+static void sa_journal_flusher_shutdown(void)
+{
+    if (sa_journal_flusher_running == CRYPTO_FALSE)
+    {
+        return;
+    }
+    pthread_mutex_lock(&sa_file_lock);
+    sa_journal_flusher_stop = CRYPTO_TRUE;
+    pthread_cond_signal(&sa_journal_flusher_wake);
+    pthread_mutex_unlock(&sa_file_lock);
+    pthread_join(sa_journal_flusher, NULL);
+    sa_journal_flusher_running = CRYPTO_FALSE;
+}
 #endif
-        }       
-        else
+
+/**
+ * @brief Function: sa_journal_replay
+ * Applies the journal of the loaded snapshot's generation to the SA Array, up to the first torn record.
+ * The next save compacts, so nothing is appended after a torn record.
+ **/
+static void sa_journal_replay(void)
+{
+    FILE* sa_journal;
+    sa_journal_record_t record;
+    uint32_t replayed = 0;
+
+    sa_snapshot_pending = CRYPTO_TRUE;
+    sa_journal = fopen(CRYPTO_SA_JOURNAL, "rb");
+    if (sa_journal == NULL)
+    {
+        sa_lease_resume();
+        return;
+    }
+    while (fread(&record, sizeof(record), 1, sa_journal) == 1)
+    {
+        if (record.crc != Crypto_Calc_CRC16((uint8_t*)&record, offsetof(sa_journal_record_t, crc)))
+        {
+            break;
+        }
+        if (record.generation != sa_generation || record.spi >= NUM_SA || record.iv_len > IV_SIZE ||
+            record.arsn_len > ARSN_SIZE)
+        {
+            continue;
+        }
+        memcpy(sa[record.spi].iv, record.iv, record.iv_len);
+        memcpy(sa[record.spi].arsn, record.arsn, record.arsn_len);
+        sa_cold[record.spi].lease.active = CRYPTO_FALSE;
+        if (record.leased == CRYPTO_TRUE)
         {
-            status = CRYPTO_LIB_ERR_FAIL_SA_SAVE;
+            memcpy(sa_cold[record.spi].lease.iv, record.iv, record.iv_len);
+            memcpy(sa_cold[record.spi].lease.arsn, record.arsn, record.arsn_len);
+            sa_cold[record.spi].lease.active = CRYPTO_TRUE;
+        }
+        replayed++;
+    }
+    fclose(sa_journal);
 #ifdef SA_DEBUG
-            printf("ERROR: SA Write FAILED!\n");
+    printf("SA journal replayed %d records\n", replayed);
+#else
+    (void)replayed;
 #endif
+    sa_lease_resume();
+}
+
+/**
+ * @brief Function: sa_lease_resume
+ * Moves the counters of every SA holding a lease up to it, those in between may have been used
+ **/
+static void sa_lease_resume(void)
+{
+    for (int x = 0; x < NUM_SA; x++)
+    {
+        if (sa_cold[x].lease.active == CRYPTO_TRUE)
+        {
+            memcpy(sa[x].iv, sa_cold[x].lease.iv, (sa[x].iv_len > IV_SIZE) ? IV_SIZE : sa[x].iv_len);
+            memcpy(sa[x].arsn, sa_cold[x].lease.arsn, (sa[x].arsn_len > ARSN_SIZE) ? ARSN_SIZE : sa[x].arsn_len);
         }
     }
-    fclose(sa_save_file);
+}
+
+/**
+ * @brief Function: sa_perform_save
+ * Persists an SA, as a journal record or, when due, a snapshot of the SA Array
+ **/
+int32_t sa_perform_save(SecurityAssociation_t* sa_ptr)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+
+    update_sa_from_ptr(sa_ptr);
+
+    pthread_mutex_lock(&sa_file_lock);
+    // In lease mode nothing is written while the persisted lease still covers the counters
+    if (crypto_config.sa_lease_frames > 0 &&
+        Crypto_SA_Lease_Renew(&sa[sa_ptr->spi], &sa_cold[sa_ptr->spi].lease) == CRYPTO_FALSE &&
+        sa_snapshot_pending == CRYPTO_FALSE)
+    {
+        pthread_mutex_unlock(&sa_file_lock);
+        return status;
+    }
+    if (sa_snapshot_pending == CRYPTO_TRUE || sa_journal_records >= SA_JOURNAL_COMPACT_RECORDS)
+    {
+        status = sa_snapshot();
+    }
+    else
+    {
+        status = sa_journal_append(&sa[sa_ptr->spi]);
+    }
+    // A lease that did not reach the file covers nothing, the next save must try again
+    if (crypto_config.sa_lease_frames > 0 && status != CRYPTO_LIB_SUCCESS)
+    {
+        sa_cold[sa_ptr->spi].lease.active = CRYPTO_FALSE;
+    }
+    pthread_mutex_unlock(&sa_file_lock);
 
     return status;
 }
@@ -560,7 +1193,11 @@ void sa_populate(void)
     sa[15].gvcid_blk.vcid = 3;
     sa[15].gvcid_blk.mapid = TYPE_TC;
 
-    sa_perform_save(&sa[0]);
+#ifdef SA_FILE
+    pthread_mutex_lock(&sa_file_lock);
+    sa_snapshot();
+    pthread_mutex_unlock(&sa_file_lock);
+#endif
 }
 
 /**
@@ -618,6 +1255,7 @@ int32_t sa_config(void)
     int32_t status = CRYPTO_LIB_SUCCESS;
     int use_internal = 1;
 
+    sa_bind_cold();
 #ifdef SA_FILE
      use_internal = 0;
 #endif
@@ -630,6 +1268,7 @@ int32_t sa_config(void)
 #endif
     }
 
+    sa_index_rebuild();
     return status;
 }
 
@@ -643,9 +1282,19 @@ int32_t sa_init(void)
 
     int use_internal = 1;
 
+    sa_bind_cold();
     #ifdef SA_FILE
         use_internal = 0;
-        status = sa_load_file();
+        if (access(CRYPTO_SA_SAVE, F_OK) != 0)
+        {
+            // First start, nothing saved yet: begin from the in-memory SAs, the first save writes the snapshot
+            use_internal = 1;
+            sa_snapshot_request();
+        }
+        else
+        {
+            status = sa_load_file();
+        }
         if (status != CRYPTO_LIB_SUCCESS)  
         {
         #ifdef DEBUG
@@ -655,6 +1304,10 @@ int32_t sa_init(void)
             status = CRYPTO_LIB_SUCCESS;
         #endif 
         }
+        if (status == CRYPTO_LIB_SUCCESS)
+        {
+            status = sa_journal_flusher_start();
+        }
     #endif
 
     if(use_internal)
@@ -682,6 +1335,7 @@ int32_t sa_init(void)
                 sa[x].ek_ref[y] = '\0';
                 sa[x].ak_ref[y] = '\0';
             }
+            memset(&sa_cold[x].lease, 0, sizeof(SecurityAssociationLease_t));
             sa[x].abm_len = 0;
             sa[x].acs_len = 0;
             sa[x].acs = 0;
@@ -698,6 +1352,7 @@ int32_t sa_init(void)
         status = key_validation();
 #endif
     }    
+    sa_index_rebuild();
     return status;
 }
 
@@ -708,6 +1363,24 @@ int32_t sa_init(void)
 static int32_t sa_close(void)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
+#ifdef SA_FILE
+    sa_journal_flusher_shutdown();
+    // Fold the journal into a final snapshot, which also persists direct edits to the SA Array.
+    // The exact counters are saved, so outstanding leases can be dropped.
+    pthread_mutex_lock(&sa_file_lock);
+    for (int x = 0; x < NUM_SA; x++)
+    {
+        sa_cold[x].lease.active = CRYPTO_FALSE;
+    }
+    status = sa_snapshot();
+    if (sa_journal_file != NULL)
+    {
+        sa_journal_sync();
+        fclose(sa_journal_file);
+        sa_journal_file = NULL;
+    }
+    pthread_mutex_unlock(&sa_file_lock);
+#endif
     return status;
 }
 
@@ -729,6 +1402,11 @@ static int32_t sa_get_from_spi(uint16_t spi, SecurityAssociation_t** security_as
         return CRYPTO_LIB_ERR_SPI_INDEX_OOB;
     }
     *security_association = &sa[spi];
+    // The caller may change the SA through the pointer, have lookups check it
+    if ((atomic_load_explicit(&sa_index_exposed[spi / 64], memory_order_relaxed) & (1ULL << (spi % 64))) == 0)
+    {
+        atomic_fetch_or_explicit(&sa_index_exposed[spi / 64], 1ULL << (spi % 64), memory_order_release);
+    }
     // if (sa[spi].shivf_len > 0 && crypto_config.cryptography_type != CRYPTOGRAPHY_TYPE_KMCCRYPTO)
     // {
     //     return CRYPTO_LIB_ERR_NULL_IV;
@@ -748,43 +1426,30 @@ static int32_t sa_get_from_spi(uint16_t spi, SecurityAssociation_t** security_as
 int32_t sa_get_operational_sa_from_gvcid_find_iv(uint8_t tfvn, uint16_t scid, uint16_t vcid, uint8_t mapid, SecurityAssociation_t** security_association)
 {
     int32_t status = CRYPTO_LIB_ERR_NO_OPERATIONAL_SA;
-    int i = 0;
+    int32_t i = sa_index_lookup(tfvn, scid, vcid, mapid);
 
-    for (i = 0; i < NUM_SA; i++)
+    // If valid match found
+    // only require MapID match is unique SA per MapID set (only relevant
+    // when using segmentation hdrs)
+    if (i >= 0)
     {
-        // If valid match found
-        if ((sa[i].gvcid_blk.tfvn == tfvn) && (sa[i].gvcid_blk.scid == scid) &&
-            (sa[i].gvcid_blk.vcid == vcid) && (sa[i].sa_state == SA_OPERATIONAL) &&
-            (crypto_config.unique_sa_per_mapid == TC_UNIQUE_SA_PER_MAP_ID_FALSE ||
-             sa[i].gvcid_blk.mapid == mapid))
-             // only require MapID match is unique SA per MapID set (only relevant
-             // when using segmentation hdrs)
+        *security_association = &sa[i];
+
+        // Must have ABM if doing authentication
+        if (sa[i].ast && sa[i].abm_len <= 0)
         {
-            *security_association = &sa[i];
-
-            // Must have IV if using libgcrypt and auth/enc
-            // if (sa[i].iv == NULL && (sa[i].ast == 1 || sa[i].est == 1) && crypto_config.cryptography_type != CRYPTOGRAPHY_TYPE_KMCCRYPTO)
-            // {
-            //     //status =  CRYPTO_LIB_ERR_NULL_IV;
-            //     //return status;
-            // }
-            // Must have ABM if doing authentication
-            if (sa[i].ast && sa[i].abm_len <= 0)
-            {
-                status = CRYPTO_LIB_ERR_NULL_ABM;
-                return status;
-            } 
+            status = CRYPTO_LIB_ERR_NULL_ABM;
+            return status;
+        }
 
 #ifdef SA_DEBUG
-            printf("Valid operational SA found at index %d.\n", i);
-            printf("\t Tfvn: %d\n", tfvn);
-            printf("\t Scid: %d\n", scid);
-            printf("\t Vcid: %d\n", vcid);
+        printf("Valid operational SA found at index %d.\n", i);
+        printf("\t Tfvn: %d\n", tfvn);
+        printf("\t Scid: %d\n", scid);
+        printf("\t Vcid: %d\n", vcid);
 #endif
 
-            status = CRYPTO_LIB_SUCCESS;
-            break;
-        }
+        status = CRYPTO_LIB_SUCCESS;
     }
     return status;
 }
@@ -977,6 +1642,8 @@ static int32_t sa_start(TC_t* tc_frame)
     int x;
     int i;
 
+    sa_snapshot_request();
+
     // Read ingest
     spi = ((uint8_t)sdls_frame.pdu.data[0] << 8) | (uint8_t)sdls_frame.pdu.data[1];
 
@@ -990,6 +1657,7 @@ static int32_t sa_start(TC_t* tc_frame)
         if (sa[spi].sa_state == SA_KEYED)
         {
             count = 2;
+            sa_index_remove(spi);
 
             for (x = 0; x <= ((sdls_frame.pdu.pdu_len - 2) / 4); x++)
             { // Read in GVCID
@@ -997,7 +1665,7 @@ static int32_t sa_start(TC_t* tc_frame)
                 gvcid.scid = (sdls_frame.pdu.data[count] << 12) | (sdls_frame.pdu.data[count + 1] << 4) |
                              (sdls_frame.pdu.data[count + 2] >> 4);
                 gvcid.vcid = (sdls_frame.pdu.data[count + 2] << 4) | (sdls_frame.pdu.data[count + 3] && 0x3F);
-                if (current_managed_parameters_struct.has_segmentation_hdr == TC_HAS_SEGMENT_HDRS)
+                if (current_managed_parameters->has_segmentation_hdr == TC_HAS_SEGMENT_HDRS)
                 {
                     gvcid.mapid = (sdls_frame.pdu.data[count + 3]);
                 }
@@ -1077,6 +1745,7 @@ static int32_t sa_start(TC_t* tc_frame)
                 // Change to operational state
                 sa[spi].sa_state = SA_OPERATIONAL;
             }
+            sa_index_insert(spi);
         }
         else
         {
@@ -1105,6 +1774,8 @@ static int32_t sa_stop(void)
     uint16_t spi = 0x0000;
     int x;
 
+    sa_snapshot_request();
+
     // Read ingest
     spi = ((uint8_t)sdls_frame.pdu.data[0] << 8) | (uint8_t)sdls_frame.pdu.data[1];
     printf("spi = %d \n", spi);
@@ -1118,6 +1789,7 @@ static int32_t sa_stop(void)
     {
         if (sa[spi].sa_state == SA_OPERATIONAL)
         {
+            sa_index_remove(spi);
             // Remove all GVC/GMAP IDs
             sa[spi].gvcid_blk.tfvn = 0;
             sa[spi].gvcid_blk.scid = 0;
@@ -1166,6 +1838,8 @@ static int32_t sa_rekey(void)
     int count = 0;
     int x = 0;
 
+    sa_snapshot_request();
+
     // Read ingest
     spi = ((uint8_t)sdls_frame.pdu.data[count] << 8) | (uint8_t)sdls_frame.pdu.data[count + 1];
     count = count + 2;
@@ -1181,6 +1855,7 @@ static int32_t sa_rekey(void)
         { // Encryption Key
             sa[spi].ekid = ((uint8_t)sdls_frame.pdu.data[count] << 8) | (uint8_t)sdls_frame.pdu.data[count + 1];
             count = count + 2;
+            Crypto_Key_Invalidate_Cache(sa[spi].ekid);
 
             // Authentication Key
             // sa[spi].akid = ((uint8_t)sdls_frame.pdu.data[count] << 8) | (uint8_t)sdls_frame.pdu.data[count+1];
@@ -1244,6 +1919,8 @@ static int32_t sa_expire(void)
     // Local variables
     uint16_t spi = 0x0000;
 
+    sa_snapshot_request();
+
     // Read ingest
     spi = ((uint8_t)sdls_frame.pdu.data[0] << 8) | (uint8_t)sdls_frame.pdu.data[1];
     printf("spi = %d \n", spi);
@@ -1257,6 +1934,7 @@ static int32_t sa_expire(void)
     {
         if (sa[spi].sa_state == SA_KEYED)
         { // Change to 'Unkeyed' state
+            sa_index_remove(spi);
             sa[spi].sa_state = SA_UNKEYED;
 #ifdef PDU_DEBUG
             printf("SPI %d changed to UNKEYED state. \n", spi);
@@ -1286,6 +1964,8 @@ static int32_t sa_create(void)
     uint16_t spi = 0x0000;
     int x;
 
+    sa_snapshot_request();
+
     // Read sdls_frame.pdu.data
     spi = ((uint8_t)sdls_frame.pdu.data[0] << 8) | (uint8_t)sdls_frame.pdu.data[1];
     printf("spi = %d \n", spi);
@@ -1295,6 +1975,7 @@ static int32_t sa_create(void)
         (sdls_frame.pdu.type << 7) | (sdls_frame.pdu.uf << 6) | (sdls_frame.pdu.sg << 4) | sdls_frame.pdu.pid;
 
     // Write SA Configuration
+    sa_index_remove(spi);
     sa[spi].est = ((uint8_t)sdls_frame.pdu.data[2] & 0x80) >> 7;
     sa[spi].ast = ((uint8_t)sdls_frame.pdu.data[2] & 0x40) >> 6;
     sa[spi].shivf_len = ((uint8_t)sdls_frame.pdu.data[2] & 0x3F);
@@ -1354,6 +2035,8 @@ static int32_t sa_delete(void)
     // Local variables
     uint16_t spi = 0x0000;
 
+    sa_snapshot_request();
+
     // Read ingest
     spi = ((uint8_t)sdls_frame.pdu.data[0] << 8) | (uint8_t)sdls_frame.pdu.data[1];
     printf("spi = %d \n", spi);
@@ -1367,6 +2050,7 @@ static int32_t sa_delete(void)
     {
         if (sa[spi].sa_state == SA_UNKEYED)
         { // Change to 'None' state
+            sa_index_remove(spi);
             sa[spi].sa_state = SA_NONE;
 #ifdef PDU_DEBUG
             printf("SPI %d changed to NONE state. \n", spi);
@@ -1397,6 +2081,8 @@ static int32_t sa_setARSN(void)
     uint16_t spi = 0x0000;
     int x;
 
+    sa_snapshot_request();
+
     // Read ingest
     spi = ((uint8_t)sdls_frame.pdu.data[0] << 8) | (uint8_t)sdls_frame.pdu.data[1];
     printf("spi = %d \n", spi);
@@ -1447,6 +2133,8 @@ static int32_t sa_setARSNW(void)
     uint16_t spi = 0x0000;
     int x;
 
+    sa_snapshot_request();
+
     // Read ingest
     spi = ((uint8_t)sdls_frame.pdu.data[0] << 8) | (uint8_t)sdls_frame.pdu.data[1];
     printf("spi = %d \n", spi);
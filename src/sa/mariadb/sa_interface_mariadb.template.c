@@ -19,9 +19,12 @@
 #include "sa_interface.h"
 
 #include <mysql/mysql.h>
+#include <pthread.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 // Security Association Initialization Functions
 static int32_t sa_config(void);
@@ -43,30 +46,28 @@ static int32_t sa_setARSNW(void);
 static int32_t sa_delete(void);
 // MySQL local functions
 static int32_t finish_with_error(MYSQL **con_loc, int err);
-// MySQL Queries
+// MySQL Queries, prepared once in sa_init. Columns are read by position, see sa_bind_result.
+#define SQL_SADB_SA_COLUMNS                                                                                            \
+    "spi,ekid,akid,sa_state,tfvn,scid,vcid,mapid,lpid,est,ast,shivf_len,shsnf_len,shplf_len,stmacf_len,ecs_len,ecs"    \
+    ",iv,iv_len,acs_len,acs,abm_len,abm,arsn_len,arsn,arsnw"
 static const char* SQL_SADB_GET_SA_BY_SPI =
-        "SELECT "
-        "spi,ekid,akid,sa_state,tfvn,scid,vcid,mapid,lpid,est,ast,shivf_len,shsnf_len,shplf_len,stmacf_len,ecs_len,HEX(ecs)"
-        ",HEX(iv),iv_len,acs_len,HEX(acs),abm_len,HEX(abm),arsn_len,HEX(arsn),arsnw"
-        " FROM security_associations WHERE spi='%d'";
+        "SELECT " SQL_SADB_SA_COLUMNS
+        " FROM security_associations WHERE spi=?";
 static const char* SQL_SADB_GET_SA_BY_GVCID =
-        "SELECT "
-        "spi,ekid,akid,sa_state,tfvn,scid,vcid,mapid,lpid,est,ast,shivf_len,shsnf_len,shplf_len,stmacf_len,ecs_len,HEX(ecs)"
-        ",HEX(iv),iv_len,acs_len,HEX(acs),abm_len,HEX(abm),arsn_len,HEX(arsn),arsnw"
-        " FROM security_associations WHERE tfvn='%d' AND scid='%d' AND vcid='%d' AND mapid='%d' AND sa_state='%d'";
+        "SELECT " SQL_SADB_SA_COLUMNS
+        " FROM security_associations WHERE tfvn=? AND scid=? AND vcid=? AND mapid=? AND sa_state=?";
 static const char* SQL_SADB_UPDATE_IV_ARC_BY_SPI =
         "UPDATE security_associations"
-        " SET iv=X'%s', arsn=X'%s'"
-        " WHERE spi='%d' AND tfvn='%d' AND scid='%d' AND vcid='%d' AND mapid='%d'";
-static const char* SQL_SADB_UPDATE_IV_ARC_BY_SPI_NULL_IV =
-        "UPDATE security_associations"
-        " SET arsn=X'%s'"
-        " WHERE spi='%d' AND tfvn='%d' AND scid='%d' AND vcid='%d' AND mapid='%d'";
+        " SET iv=?, arsn=?"
+        " WHERE spi=? AND tfvn=? AND scid=? AND vcid=? AND mapid=?";
 
 // sa_if mariaDB private helper functions
-static int32_t parse_sa_from_mysql_query(char* query, SecurityAssociation_t** security_association);
-static int32_t convert_hexstring_to_byte_array(char* hexstr, uint8_t* byte_array);
-static void convert_byte_array_to_hexstring(void* src_buffer, size_t buffer_length, char* dest_str);
+static int32_t sa_prepare_statements(void);
+static void sa_close_statements(void);
+static void sa_bind_result(MYSQL_STMT* stmt);
+static void sa_bind_int(MYSQL_BIND* bind, int32_t* value);
+static int32_t sa_fetch_from_stmt(MYSQL_STMT* stmt, MYSQL_BIND* params, SecurityAssociation_t* sa);
+static int32_t finish_with_stmt_error(MYSQL_STMT* stmt, int err);
 
 /*
 ** Global Variables
@@ -75,6 +76,109 @@ static void convert_byte_array_to_hexstring(void* src_buffer, size_t buffer_leng
 static SaInterfaceStruct sa_if_struct;
 static MYSQL *con;
 
+/*
+** Prepared Statements
+** Statements go over the binary protocol, and result rows land in the preallocated sa_row buffers below,
+** so no SQL is built or parsed per frame and binary columns are never hex encoded. The shared buffers
+** and connection are serialized by sa_mariadb_lock.
+*/
+#define SA_ROW_COLUMNS 26
+typedef struct
+{
+    int32_t ints[SA_ROW_COLUMNS]; // Integer columns, by column position
+    char ekid[REF_SIZE];
+    char akid[REF_SIZE];
+    uint8_t ecs[ECS_SIZE];
+    uint8_t iv[IV_SIZE];
+    uint8_t acs[ECS_SIZE];
+    uint8_t abm[ABM_SIZE];
+    uint8_t arsn[ARSN_SIZE];
+    unsigned long length[SA_ROW_COLUMNS];
+    my_bool is_null[SA_ROW_COLUMNS];
+    my_bool error[SA_ROW_COLUMNS];
+} sa_row_t;
+
+// Column positions in SQL_SADB_SA_COLUMNS
+enum
+{
+    SA_COL_SPI, SA_COL_EKID, SA_COL_AKID, SA_COL_SA_STATE, SA_COL_TFVN, SA_COL_SCID, SA_COL_VCID, SA_COL_MAPID,
+    SA_COL_LPID, SA_COL_EST, SA_COL_AST, SA_COL_SHIVF_LEN, SA_COL_SHSNF_LEN, SA_COL_SHPLF_LEN, SA_COL_STMACF_LEN,
+    SA_COL_ECS_LEN, SA_COL_ECS, SA_COL_IV, SA_COL_IV_LEN, SA_COL_ACS_LEN, SA_COL_ACS, SA_COL_ABM_LEN, SA_COL_ABM,
+    SA_COL_ARSN_LEN, SA_COL_ARSN, SA_COL_ARSNW
+};
+
+static pthread_mutex_t sa_mariadb_lock = PTHREAD_MUTEX_INITIALIZER;
+static MYSQL_STMT* stmt_get_by_spi = NULL;
+static MYSQL_STMT* stmt_get_by_gvcid = NULL;
+static MYSQL_STMT* stmt_update_iv_arsn = NULL;
+static sa_row_t sa_row;
+static MYSQL_BIND sa_row_bind[SA_ROW_COLUMNS];
+
+/*
+** SA Cache
+** Each SA read from the database is kept in a cache entry for the rest of the session, and the pointer to
+** it is what the lookups hand out, so a frame costs no query and no allocation. An entry older than
+** SA_MARIADB_CACHE_TTL_MS is re-read on its next lookup and updated in place: row values replace the
+** configuration, while the live IV/ARSN are kept as long as the row still holds the counters CryptoLib
+** last wrote. A row whose counters changed was updated outside of CryptoLib (rekey, reset), and its
+** counters take over.
+**
+** With SA_MARIADB_FLUSH_MS 0 every save writes the counters before it returns. Otherwise saves are
+** write-behind: the counters are copied to the entry and the flusher thread writes every dirty entry each
+** SA_MARIADB_FLUSH_MS, so sa_init requires lease mode (Crypto_Config_SA_Lease), where only lease renewals
+** are written and those are flushed before the save returns. sa_stop, sa_rekey and sa_close flush
+** synchronously.
+**
+** Locking: the SA lock (Crypto_SA_Lock) of a cached SA is taken before sa_mariadb_lock (connection,
+** statements, row buffers), which is taken before sa_cache_lock (entries). Frames use a cached SA under its
+** SA lock, so a re-read only updates it in place while holding that lock. Entries are only freed by
+** sa_close, once the flusher has stopped.
+*/
+typedef struct sa_cache_entry
+{
+    SecurityAssociation_t* sa;
+    struct sa_cache_entry* next;      // SPI bucket chain
+    uint64_t fetched_ms;              // When sa was last read from the database, 0 if invalidated
+    uint8_t stored_iv[IV_SIZE];       // IV/ARSN the database row holds
+    uint8_t stored_arsn[ARSN_SIZE];
+    uint8_t pending_iv[IV_SIZE];      // IV/ARSN waiting for the flusher
+    uint8_t pending_arsn[ARSN_SIZE];
+    crypto_gvcid_t pending_gvcid;
+    uint8_t dirty;
+    SecurityAssociationLease_t lease;
+} sa_cache_entry_t;
+
+typedef struct
+{
+    uint8_t tfvn;
+    uint16_t scid;
+    uint16_t vcid;
+    uint8_t mapid;
+    uint16_t spi;
+    uint64_t fetched_ms; // 0 if unused
+} sa_cache_gvcid_t;
+
+static pthread_mutex_t sa_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sa_flusher_wake = PTHREAD_COND_INITIALIZER;
+static pthread_t sa_flusher;
+static uint8_t sa_flusher_running = CRYPTO_FALSE;
+static uint8_t sa_flusher_stop = CRYPTO_FALSE;
+static sa_cache_entry_t* sa_cache[SA_MARIADB_CACHE_BUCKETS];
+static sa_cache_gvcid_t sa_cache_gvcid[SA_MARIADB_CACHE_BUCKETS];
+static uint32_t sa_cache_dirty = 0;
+static SecurityAssociation_t* sa_scratch = NULL; // Row being read, guarded by sa_mariadb_lock
+
+static uint64_t sa_cache_now_ms(void);
+static sa_cache_entry_t* sa_cache_find(uint16_t spi);
+static uint32_t sa_cache_gvcid_slot(uint8_t tfvn, uint16_t scid, uint16_t vcid, uint8_t mapid);
+static void sa_cache_copy(SecurityAssociation_t* dest, const SecurityAssociation_t* src, uint8_t keep_counters);
+static int32_t sa_cache_load(MYSQL_STMT* stmt, MYSQL_BIND* params, sa_cache_entry_t** locked,
+                             SecurityAssociation_t** security_association);
+static void sa_cache_invalidate(void);
+static void sa_cache_free(void);
+static int32_t sa_flush(void);
+static void* sa_flusher_thread(void* arg);
+
 SaInterface get_sa_interface_mariadb(void)
 {
     sa_if_struct.sa_config = sa_config;
@@ -103,6 +207,13 @@ static int32_t sa_config(void)
 static int32_t sa_init(void)
 {
     int32_t status = CRYPTO_LIB_ERROR;
+
+    // Without a lease, write-behind would return from saves before their IV/ARSN are durable
+    if (SA_MARIADB_FLUSH_MS > 0 && crypto_config.sa_lease_frames == 0)
+    {
+        fprintf(stderr, "Error: sa_init() SA_MARIADB_FLUSH_MS write-behind requires Crypto_Config_SA_Lease\n");
+        return CRYPTO_MARIADB_CONFIGURATION_NOT_COMPLETE;
+    }
     if (sa_mariadb_config != NULL)
     {
         con = mysql_init(con);
@@ -151,7 +262,24 @@ static int32_t sa_init(void)
                 finish_with_error(&con, SADB_MARIADB_CONNECTION_FAILED);
                 status = CRYPTO_LIB_ERROR;
             } else {
-                status = CRYPTO_LIB_SUCCESS;
+                status = sa_prepare_statements();
+                if (status == CRYPTO_LIB_SUCCESS && sa_scratch == NULL)
+                {
+                    sa_scratch = Crypto_SA_Alloc();
+                    sa_flusher_stop = CRYPTO_FALSE;
+                    if (sa_scratch == NULL ||
+                        (SA_MARIADB_FLUSH_MS > 0 && pthread_create(&sa_flusher, NULL, sa_flusher_thread, NULL) != 0))
+                    {
+                        free(sa_scratch);
+                        sa_scratch = NULL;
+                        sa_close_statements();
+                        status = finish_with_error(&con, CRYPTO_LIB_ERROR);
+                    }
+                    else
+                    {
+                        sa_flusher_running = (SA_MARIADB_FLUSH_MS > 0) ? CRYPTO_TRUE : CRYPTO_FALSE;
+                    }
+                }
                 if (status == CRYPTO_LIB_SUCCESS) {
 #ifdef DEBUG
                     printf("sa_init created mysql connection successfully. \n");
@@ -171,24 +299,63 @@ static int32_t sa_init(void)
 
 static int32_t sa_close(void)
 {
+    int32_t status = CRYPTO_LIB_SUCCESS;
+
+    if (sa_flusher_running == CRYPTO_TRUE)
+    {
+        pthread_mutex_lock(&sa_cache_lock);
+        sa_flusher_stop = CRYPTO_TRUE;
+        pthread_cond_signal(&sa_flusher_wake);
+        pthread_mutex_unlock(&sa_cache_lock);
+        pthread_join(sa_flusher, NULL);
+        sa_flusher_running = CRYPTO_FALSE;
+    }
+    // Last write-behind flush. The database keeps the leases, a new session resumes from them
+    status = sa_flush();
+    sa_cache_free();
+    free(sa_scratch);
+    sa_scratch = NULL;
+
+    sa_close_statements();
     if(con)
     {
         mysql_close(con);
         con = NULL;
     }
     
-    return CRYPTO_LIB_SUCCESS;
+    return status;
 }
 
 // Security Association Interaction Functions
 static int32_t sa_get_from_spi(uint16_t spi, SecurityAssociation_t** security_association)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
+    sa_cache_entry_t* entry;
+    MYSQL_BIND params[1];
+    int32_t spi_param = spi;
 
-    char spi_query[2048];
-    snprintf(spi_query, sizeof(spi_query), SQL_SADB_GET_SA_BY_SPI, spi);
+    pthread_mutex_lock(&sa_cache_lock);
+    entry = sa_cache_find(spi);
+    if (entry != NULL && entry->fetched_ms > 0 && sa_cache_now_ms() - entry->fetched_ms < SA_MARIADB_CACHE_TTL_MS)
+    {
+        *security_association = entry->sa;
+        pthread_mutex_unlock(&sa_cache_lock);
+        return status;
+    }
+    pthread_mutex_unlock(&sa_cache_lock);
 
-    status = parse_sa_from_mysql_query(&spi_query[0], security_association);
+    memset(params, 0, sizeof(params));
+    sa_bind_int(&params[0], &spi_param);
+
+    // Re-reading a cached SA rewrites it, keep frames out of it meanwhile
+    do
+    {
+        if (entry != NULL)
+        {
+            Crypto_SA_Lock(entry->sa);
+        }
+        status = sa_cache_load(stmt_get_by_spi, params, &entry, security_association);
+    } while (status == CRYPTO_LIB_SUCCESS && *security_association == NULL);
 
     return status;
 }
@@ -196,74 +363,114 @@ static int32_t sa_get_operational_sa_from_gvcid(uint8_t tfvn, uint16_t scid, uin
                                                   SecurityAssociation_t** security_association)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
+    sa_cache_gvcid_t* slot = &sa_cache_gvcid[sa_cache_gvcid_slot(tfvn, scid, vcid, mapid)];
+    sa_cache_entry_t* entry = NULL;
+    MYSQL_BIND params[5];
+    int32_t values[5] = {tfvn, scid, vcid, mapid, SA_OPERATIONAL};
 
-    char gvcid_query[2048];
-    snprintf(gvcid_query, sizeof(gvcid_query), SQL_SADB_GET_SA_BY_GVCID, tfvn, scid, vcid, mapid, SA_OPERATIONAL);
+    pthread_mutex_lock(&sa_cache_lock);
+    if (slot->fetched_ms > 0 && slot->tfvn == tfvn && slot->scid == scid && slot->vcid == vcid &&
+        slot->mapid == mapid)
+    {
+        entry = sa_cache_find(slot->spi);
+    }
+    if (entry != NULL && sa_cache_now_ms() - slot->fetched_ms < SA_MARIADB_CACHE_TTL_MS && entry->fetched_ms > 0 &&
+        entry->sa->sa_state == SA_OPERATIONAL)
+    {
+        *security_association = entry->sa;
+        pthread_mutex_unlock(&sa_cache_lock);
+        return status;
+    }
+    pthread_mutex_unlock(&sa_cache_lock);
+
+    memset(params, 0, sizeof(params));
+    for (int i = 0; i < 5; i++)
+    {
+        sa_bind_int(&params[i], &values[i]);
+    }
 
-    status = parse_sa_from_mysql_query(&gvcid_query[0], security_association);
+    // Starting from the SA last found for this GVCID, see sa_get_from_spi
+    do
+    {
+        if (entry != NULL)
+        {
+            Crypto_SA_Lock(entry->sa);
+        }
+        status = sa_cache_load(stmt_get_by_gvcid, params, &entry, security_association);
+    } while (status == CRYPTO_LIB_SUCCESS && *security_association == NULL);
+    if (status == CRYPTO_LIB_SUCCESS)
+    {
+        pthread_mutex_lock(&sa_cache_lock);
+        slot->tfvn = tfvn;
+        slot->scid = scid;
+        slot->vcid = vcid;
+        slot->mapid = mapid;
+        slot->spi = (*security_association)->spi;
+        slot->fetched_ms = sa_cache_now_ms();
+        pthread_mutex_unlock(&sa_cache_lock);
+    }
 
     return status;
 }
 static int32_t sa_save_sa(SecurityAssociation_t* sa)
 {
     int32_t status = CRYPTO_LIB_SUCCESS;
+    sa_cache_entry_t* entry;
+    uint8_t flush_now = CRYPTO_FALSE;
+
     if (sa == NULL)
     {
         return SADB_NULL_SA_USED;
     }
 
-    char update_sa_query[2048];    
-    char* iv_h = malloc(sa->iv_len * 2 + 1);
-    
-    if(sa->iv != NULL){
-        convert_byte_array_to_hexstring(sa->iv, sa->iv_len, iv_h);
+    pthread_mutex_lock(&sa_cache_lock);
+    entry = sa_cache_find(sa->spi);
+    if (entry == NULL || entry->sa != sa)
+    {
+        // Not an SA handed out by this interface
+        pthread_mutex_unlock(&sa_cache_lock);
+        return SADB_NULL_SA_USED;
     }
-    
-    char* arsn_h = malloc(sa->arsn_len * 2 + 1);
-    convert_byte_array_to_hexstring(sa->arsn, sa->arsn_len, arsn_h);
 
-    if(sa->iv != NULL){
-        snprintf(update_sa_query, sizeof(update_sa_query), SQL_SADB_UPDATE_IV_ARC_BY_SPI,
-             iv_h,
-             arsn_h, sa->spi, sa->gvcid_blk.tfvn,
-             sa->gvcid_blk.scid, sa->gvcid_blk.vcid, sa->gvcid_blk.mapid);
-        
-        free(iv_h);
+    if (crypto_config.sa_lease_frames > 0 && sa->iv_len <= IV_SIZE && sa->arsn_len <= ARSN_SIZE)
+    {
+        // In lease mode only a renewed lease is written, in place of the counters
+        if (Crypto_SA_Lease_Renew(sa, &entry->lease) == CRYPTO_FALSE)
+        {
+            pthread_mutex_unlock(&sa_cache_lock);
+            return status;
+        }
+        memcpy(entry->pending_iv, entry->lease.iv, IV_SIZE);
+        memcpy(entry->pending_arsn, entry->lease.arsn, ARSN_SIZE);
+        flush_now = CRYPTO_TRUE;
     }
     else
     {
-        snprintf(update_sa_query, sizeof(update_sa_query), SQL_SADB_UPDATE_IV_ARC_BY_SPI_NULL_IV,
-             arsn_h,
-             sa->spi, sa->gvcid_blk.tfvn,
-             sa->gvcid_blk.scid, sa->gvcid_blk.vcid, sa->gvcid_blk.mapid);
-        free(iv_h);
+        memcpy(entry->pending_iv, sa->iv, IV_SIZE);
+        memcpy(entry->pending_arsn, sa->arsn, ARSN_SIZE);
+        flush_now = (SA_MARIADB_FLUSH_MS == 0) ? CRYPTO_TRUE : CRYPTO_FALSE;
     }
-    
-    free(arsn_h);
-#ifdef SA_DEBUG
-    fprintf(stderr, "MySQL Insert SA Query: %s \n", update_sa_query);
-#endif
-
-    // Crypto_saPrint(sa);
-    if (mysql_query(con, update_sa_query))
+    entry->pending_gvcid = sa->gvcid_blk;
+    if (entry->dirty == CRYPTO_FALSE)
     {
-        status = finish_with_error(&con, SADB_QUERY_FAILED);
+        entry->dirty = CRYPTO_TRUE;
+        sa_cache_dirty++;
     }
-    // todo - if query fails, need to push failure message to error stack instead of just return code.
-
-    // We free the allocated SA memory in the save function.
-    if (sa->ek_ref[0] != '\0')
-        clean_ekref(sa);
-    if (sa->ak_ref[0] != '\0')
-        clean_akref(sa);
-    free(sa);
+    pthread_mutex_unlock(&sa_cache_lock);
 
+    if (flush_now == CRYPTO_TRUE)
+    {
+        status = sa_flush();
+    }
     return status;
 }
 // Security Association Utility Functions
 static int32_t sa_stop(void)
 {
-    return CRYPTO_LIB_SUCCESS;
+    // SA state is managed in the database, make ours current and re-read it
+    int32_t status = sa_flush();
+    sa_cache_invalidate();
+    return status;
 }
 static int32_t sa_start(TC_t* tc_frame)
 {
@@ -276,7 +483,9 @@ static int32_t sa_expire(void)
 }
 static int32_t sa_rekey(void)
 {
-    return CRYPTO_LIB_SUCCESS;
+    int32_t status = sa_flush();
+    sa_cache_invalidate();
+    return status;
 }
 static int32_t sa_status(uint8_t* ingest)
 {
@@ -301,228 +510,224 @@ static int32_t sa_delete(void)
 }
 
 // sa_if private helper functions
-static int32_t parse_sa_from_mysql_query(char* query, SecurityAssociation_t** security_association)
+/**
+ * @brief Function: sa_prepare_statements
+ * Prepares the SA statements on the open connection and binds the result row buffers
+ * @return int32: Success/Failure
+ **/
+static int32_t sa_prepare_statements(void)
 {
-    int32_t status = CRYPTO_LIB_SUCCESS;
-    SecurityAssociation_t* sa = calloc(1,sizeof(SecurityAssociation_t));
+    MYSQL_STMT** stmts[3] = {&stmt_get_by_spi, &stmt_get_by_gvcid, &stmt_update_iv_arsn};
+    const char* queries[3] = {SQL_SADB_GET_SA_BY_SPI, SQL_SADB_GET_SA_BY_GVCID, SQL_SADB_UPDATE_IV_ARC_BY_SPI};
 
-#ifdef SA_DEBUG
-    fprintf(stderr, "MySQL Query: %s \n", query);
-#endif
-
-    if (mysql_real_query(con, query, strlen(query)))
-    { // query should be NUL terminated!
-        status = finish_with_error(&con, SADB_QUERY_FAILED);
-        return status;
+    for (int i = 0; i < 3; i++)
+    {
+        *stmts[i] = mysql_stmt_init(con);
+        if (*stmts[i] == NULL)
+        {
+            sa_close_statements();
+            return finish_with_error(&con, SADB_QUERY_FAILED);
+        }
+        if (mysql_stmt_prepare(*stmts[i], queries[i], strlen(queries[i])))
+        {
+            fprintf(stderr, "%s\n", mysql_stmt_error(*stmts[i]));
+            sa_close_statements();
+            return finish_with_error(&con, SADB_QUERY_FAILED);
+        }
     }
-    // todo - if query fails, need to push failure message to error stack instead of just return code.
+    sa_bind_result(stmt_get_by_spi);
+    sa_bind_result(stmt_get_by_gvcid);
+    return CRYPTO_LIB_SUCCESS;
+}
+
+/**
+ * @brief Function: sa_close_statements
+ **/
+static void sa_close_statements(void)
+{
+    MYSQL_STMT** stmts[3] = {&stmt_get_by_spi, &stmt_get_by_gvcid, &stmt_update_iv_arsn};
 
-    MYSQL_RES *result = mysql_store_result(con);
-    if (result == NULL)
+    for (int i = 0; i < 3; i++)
     {
-        status = finish_with_error(&con, SADB_QUERY_EMPTY_RESULTS);
-        return status;
+        if (*stmts[i] != NULL)
+        {
+            mysql_stmt_close(*stmts[i]);
+            *stmts[i] = NULL;
+        }
     }
+}
+
+/**
+ * @brief Function: sa_bind_int
+ * Binds a 32-bit integer parameter or result, the server converts from the narrower column types
+ **/
+static void sa_bind_int(MYSQL_BIND* bind, int32_t* value)
+{
+    bind->buffer_type = MYSQL_TYPE_LONG;
+    bind->buffer = value;
+}
 
-    int num_rows = mysql_num_rows(result);
-    if(num_rows == 0) // No rows returned in query!!
+/**
+ * @brief Function: sa_bind_result
+ * Binds every SA column of a SELECT to its sa_row buffer
+ * @param stmt: MYSQL_STMT*
+ **/
+static void sa_bind_result(MYSQL_STMT* stmt)
+{
+    memset(sa_row_bind, 0, sizeof(sa_row_bind));
+    for (int i = 0; i < SA_ROW_COLUMNS; i++)
     {
-        status = finish_with_error(&con, SADB_QUERY_EMPTY_RESULTS);
-        return status;
+        sa_bind_int(&sa_row_bind[i], &sa_row.ints[i]);
+    }
+    struct
+    {
+        int column;
+        enum enum_field_types type;
+        void* buffer;
+        unsigned long size;
+    } buffers[] = {
+        {SA_COL_EKID, MYSQL_TYPE_STRING, sa_row.ekid, REF_SIZE - 1},
+        {SA_COL_AKID, MYSQL_TYPE_STRING, sa_row.akid, REF_SIZE - 1},
+        {SA_COL_ECS, MYSQL_TYPE_BLOB, sa_row.ecs, ECS_SIZE},
+        {SA_COL_IV, MYSQL_TYPE_BLOB, sa_row.iv, IV_SIZE},
+        {SA_COL_ACS, MYSQL_TYPE_BLOB, sa_row.acs, ECS_SIZE},
+        {SA_COL_ABM, MYSQL_TYPE_BLOB, sa_row.abm, ABM_SIZE},
+        {SA_COL_ARSN, MYSQL_TYPE_BLOB, sa_row.arsn, ARSN_SIZE},
+    };
+    for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++)
+    {
+        sa_row_bind[buffers[i].column].buffer_type = buffers[i].type;
+        sa_row_bind[buffers[i].column].buffer = buffers[i].buffer;
+        sa_row_bind[buffers[i].column].buffer_length = buffers[i].size;
+    }
+    for (int i = 0; i < SA_ROW_COLUMNS; i++)
+    {
+        sa_row_bind[i].length = &sa_row.length[i];
+        sa_row_bind[i].is_null = &sa_row.is_null[i];
+        sa_row_bind[i].error = &sa_row.error[i];
     }
+    mysql_stmt_bind_result(stmt, sa_row_bind);
+}
 
-    int num_fields = mysql_num_fields(result);
+/**
+ * @brief Function: sa_fetch_from_stmt
+ * Executes a prepared SELECT and fills sa from its row. Caller holds sa_mariadb_lock.
+ * @param stmt: MYSQL_STMT*
+ * @param params: MYSQL_BIND*
+ * @param sa: SecurityAssociation_t*, reset first
+ * @return int32: Success/Failure
+ **/
+static int32_t sa_fetch_from_stmt(MYSQL_STMT* stmt, MYSQL_BIND* params, SecurityAssociation_t* sa)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    char* ek_ref = sa->ek_ref;
+    char* ak_ref = sa->ak_ref;
+    uint8_t* abm = sa->abm;
+    SecurityAssociationReplay_t* replay = sa->replay;
+    int fetch;
+    int rows = 0;
 
-    MYSQL_ROW row;
-    MYSQL_FIELD *field;
+    if (stmt == NULL)
+    {
+        return SADB_QUERY_FAILED;
+    }
+    if (mysql_stmt_bind_param(stmt, params) || mysql_stmt_execute(stmt))
+    {
+        return finish_with_stmt_error(stmt, SADB_QUERY_FAILED);
+    }
+    // todo - if query fails, need to push failure message to error stack instead of just return code.
 
-    char* field_names[num_fields]; //[64]; 64 == max length of column name in MySQL
+    memset(sa, 0, sizeof(SecurityAssociation_t));
+    sa->ek_ref = ek_ref;
+    sa->ak_ref = ak_ref;
+    sa->abm = abm;
+    sa->replay = replay;
+    memset(sa->ek_ref, 0, REF_SIZE);
+    memset(sa->ak_ref, 0, REF_SIZE);
+    memset(sa->abm, 0, ABM_SIZE);
+    memset(sa->replay, 0, sizeof(SecurityAssociationReplay_t));
 
-    // TODO -- Need to store mysql query hex string and then malloc sa->iv according to size.
-    // TODO -- IV && arsn && abm as uint8_t* instead of uint8[]!!!
-    char* iv_byte_str = NULL;
-    char* arc_byte_str = NULL;
-    char* abm_byte_str = NULL;
-    char* ecs_byte_str = NULL;
-    char* acs_byte_str = NULL;
-    while ((row = mysql_fetch_row(result)))
+    // Several rows should not happen, the last one wins as it always has
+    while ((fetch = mysql_stmt_fetch(stmt)) == 0 || fetch == MYSQL_DATA_TRUNCATED)
     {
-        for (int i = 0; i < num_fields; i++)
+        if (fetch == MYSQL_DATA_TRUNCATED)
         {
-            // Parse out all the field names.
-            if (i == 0)
-            {
-                int field_idx = 0;
-                while ((field = mysql_fetch_field(result)))
-                {
-                    field_names[field_idx] = field->name;
-                    field_idx++;
-                }
-            }
-            // Handle query results
-            if (row[i] == NULL)
-            {
-                continue;
-            } // Don't do anything with NULL fields from MySQL query.
-            if (strcmp(field_names[i], "spi") == 0)
-            {
-                sa->spi = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "ekid") == 0)
-            {
-                if(crypto_config.cryptography_type==CRYPTOGRAPHY_TYPE_LIBGCRYPT)
-                {
-                    sa->ekid = atoi(row[i]);
-                } else // Cryptography Type KMC Crypto Service with PKCS12 String Key References
-                {
-                    sa->ekid = 0;
-                    memcpy(sa->ek_ref, row[i], strlen(row[i])+1);
-                }
-                continue;
-            }
-            if (strcmp(field_names[i], "akid") == 0)
-            {
-                if(crypto_config.cryptography_type==CRYPTOGRAPHY_TYPE_LIBGCRYPT)
-                {
-                    sa->akid = atoi(row[i]);
-                } else // Cryptography Type KMC Crypto Service with PKCS12 String Key References
-                {
-                    memcpy(sa->ak_ref, row[i], strlen(row[i])+1);
-                }
-                continue;
-            }
-            if (strcmp(field_names[i], "sa_state") == 0)
-            {
-                sa->sa_state = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "tfvn") == 0)
-            {
-                sa->gvcid_blk.tfvn = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "scid") == 0)
-            {
-                sa->gvcid_blk.scid = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "vcid") == 0)
-            {
-                sa->gvcid_blk.vcid = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "mapid") == 0)
-            {
-                sa->gvcid_blk.mapid = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "lpid") == 0)
-            {
-                sa->lpid = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "est") == 0)
-            {
-                sa->est = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "ast") == 0)
-            {
-                sa->ast = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "shivf_len") == 0)
-            {
-                sa->shivf_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "iv_len") == 0)
-            {
-                sa->iv_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "shsnf_len") == 0)
-            {
-                sa->shsnf_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "shplf_len") == 0)
-            {
-                sa->shplf_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "stmacf_len") == 0)
-            {
-                sa->stmacf_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "ecs_len") == 0)
-            {
-                sa->ecs_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "HEX(ecs)") == 0)
-            {
-                ecs_byte_str = row[i];
-                continue;
-            }
-            // if(strcmp(field_names[i],"HEX(iv)")==0){memcpy(&(sa->iv),&row[i],IV_SIZE);continue;}
-            if (strcmp(field_names[i], "HEX(iv)") == 0)
-            {
-                iv_byte_str = row[i];
-                continue;
-            }
-            if (strcmp(field_names[i], "acs_len") == 0)
-            {
-                sa->acs_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "HEX(acs)") == 0)
-            {
-                acs_byte_str = row[i];
-                continue;
-            }
-            if (strcmp(field_names[i], "abm_len") == 0)
+            // A binary column longer than CryptoLib's buffer for it
+            status = SADB_QUERY_FAILED;
+            break;
+        }
+        rows++;
+        memset(sa_row.ekid + (sa_row.is_null[SA_COL_EKID] ? 0 : sa_row.length[SA_COL_EKID]), 0, 1);
+        memset(sa_row.akid + (sa_row.is_null[SA_COL_AKID] ? 0 : sa_row.length[SA_COL_AKID]), 0, 1);
+
+        sa->spi = sa_row.ints[SA_COL_SPI];
+        if (!sa_row.is_null[SA_COL_EKID])
+        {
+            if(crypto_config.cryptography_type==CRYPTOGRAPHY_TYPE_LIBGCRYPT)
             {
-                sa->abm_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "HEX(abm)") == 0)
+                sa->ekid = atoi(sa_row.ekid);
+            } else // Cryptography Type KMC Crypto Service with PKCS12 String Key References
             {
-                abm_byte_str = row[i];
-                continue;
+                sa->ekid = 0;
+                memcpy(sa->ek_ref, sa_row.ekid, sa_row.length[SA_COL_EKID] + 1);
             }
-            // if(strcmp(field_names[i],"HEX(abm)")==0){convert_hexstring_to_byte_array(row[i],sa->abm);continue;}
-            if (strcmp(field_names[i], "arsn_len") == 0)
-            {
-                sa->arsn_len = atoi(row[i]);
-                continue;
-            }
-            if (strcmp(field_names[i], "HEX(arsn)") == 0)
+        }
+        if (!sa_row.is_null[SA_COL_AKID])
+        {
+            if(crypto_config.cryptography_type==CRYPTOGRAPHY_TYPE_LIBGCRYPT)
             {
-                arc_byte_str = row[i];
-                continue;
-            }
-            // if(strcmp(field_names[i],"HEX(arsn)")==0){convert_hexstring_to_byte_array(row[i],sa->arsn);continue;}
-            if (strcmp(field_names[i], "arsnw") == 0)
+                sa->akid = atoi(sa_row.akid);
+            } else // Cryptography Type KMC Crypto Service with PKCS12 String Key References
             {
-                sa->arsnw = atoi(row[i]);
-                continue;
+                memcpy(sa->ak_ref, sa_row.akid, sa_row.length[SA_COL_AKID] + 1);
             }
-            // printf("%s:%s ",field_names[i], row[i] ? row[i] : "NULL");
         }
-        // printf("\n");
+        sa->sa_state = sa_row.ints[SA_COL_SA_STATE];
+        sa->gvcid_blk.tfvn = sa_row.ints[SA_COL_TFVN];
+        sa->gvcid_blk.scid = sa_row.ints[SA_COL_SCID];
+        sa->gvcid_blk.vcid = sa_row.ints[SA_COL_VCID];
+        sa->gvcid_blk.mapid = sa_row.ints[SA_COL_MAPID];
+        if (!sa_row.is_null[SA_COL_LPID])
+            sa->lpid = sa_row.ints[SA_COL_LPID];
+        sa->est = sa_row.ints[SA_COL_EST];
+        sa->ast = sa_row.ints[SA_COL_AST];
+        sa->shivf_len = sa_row.ints[SA_COL_SHIVF_LEN];
+        sa->shsnf_len = sa_row.ints[SA_COL_SHSNF_LEN];
+        sa->shplf_len = sa_row.ints[SA_COL_SHPLF_LEN];
+        sa->stmacf_len = sa_row.ints[SA_COL_STMACF_LEN];
+        sa->ecs_len = sa_row.ints[SA_COL_ECS_LEN];
+        sa->iv_len = sa_row.ints[SA_COL_IV_LEN];
+        sa->acs_len = sa_row.ints[SA_COL_ACS_LEN];
+        if (!sa_row.is_null[SA_COL_ABM_LEN])
+            sa->abm_len = sa_row.ints[SA_COL_ABM_LEN];
+        sa->arsn_len = sa_row.ints[SA_COL_ARSN_LEN];
+        sa->arsnw = sa_row.ints[SA_COL_ARSNW];
+
+        if (sa->iv_len > 0 && !sa_row.is_null[SA_COL_IV])
+            memcpy(sa->iv, sa_row.iv, sa_row.length[SA_COL_IV]);
+        if (sa->arsn_len > 0)
+            memcpy(sa->arsn, sa_row.arsn, sa_row.length[SA_COL_ARSN]);
+        if (sa->abm_len > 0)
+            memcpy(sa->abm, sa_row.abm, sa_row.length[SA_COL_ABM]);
+        if (sa->ecs_len > 0 && sa_row.length[SA_COL_ECS] > 0)
+            sa->ecs = sa_row.ecs[0];
+        if (sa->acs_len > 0 && sa_row.length[SA_COL_ACS] > 0)
+            sa->acs = sa_row.acs[0];
     }
+    mysql_stmt_free_result(stmt);
 
-    if(iv_byte_str != NULL){
-        if(sa->iv_len > 0)   convert_hexstring_to_byte_array(iv_byte_str, sa->iv);
+    if (status == CRYPTO_LIB_SUCCESS && fetch != MYSQL_NO_DATA)
+    {
+        status = finish_with_stmt_error(stmt, SADB_QUERY_FAILED);
+    }
+    else if (status == CRYPTO_LIB_SUCCESS && rows == 0) // No rows returned in query!!
+    {
+        status = SADB_QUERY_EMPTY_RESULTS;
+    }
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        return status;
     }
-    
-    if(sa->arsn_len > 0) convert_hexstring_to_byte_array(arc_byte_str, sa->arsn);
-    if(sa->abm_len > 0)  convert_hexstring_to_byte_array(abm_byte_str, sa->abm);
-    if(sa->ecs_len > 0)  convert_hexstring_to_byte_array(ecs_byte_str, &sa->ecs);
-    if(sa->acs_len > 0)  convert_hexstring_to_byte_array(acs_byte_str, &sa->acs);
 
     //arsnw_len is not necessary for mariadb interface, putty dummy/default value for prints.
     sa->arsnw_len = 1;
@@ -532,42 +737,347 @@ static int32_t parse_sa_from_mysql_query(char* query, SecurityAssociation_t** se
     Crypto_saPrint(sa);
 #endif
 
-    *security_association = sa;
-    mysql_free_result(result);
+    return status;
+}
+
+/**
+ * @brief Function: sa_cache_now_ms
+ * @return uint64: Monotonic clock in ms, never 0
+ **/
+static uint64_t sa_cache_now_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000 + 1;
+}
+
+/**
+ * @brief Function: sa_cache_find
+ * Caller holds sa_cache_lock
+ * @param spi: uint16_t
+ * @return sa_cache_entry_t*: NULL if the SA was never read
+ **/
+static sa_cache_entry_t* sa_cache_find(uint16_t spi)
+{
+    sa_cache_entry_t* entry = sa_cache[spi & (SA_MARIADB_CACHE_BUCKETS - 1)];
+
+    while (entry != NULL && entry->sa->spi != spi)
+    {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+/**
+ * @brief Function: sa_cache_gvcid_slot
+ * @return uint32: Index into sa_cache_gvcid
+ **/
+static uint32_t sa_cache_gvcid_slot(uint8_t tfvn, uint16_t scid, uint16_t vcid, uint8_t mapid)
+{
+    uint32_t key = ((uint32_t)tfvn << 28) ^ ((uint32_t)scid << 12) ^ ((uint32_t)vcid << 6) ^ mapid;
+
+    return ((key * 2654435761u) >> 16) & (SA_MARIADB_CACHE_BUCKETS - 1);
+}
+
+/**
+ * @brief Function: sa_cache_copy
+ * Updates a cached SA in place from a row. Caller holds dest's SA lock. When keep_counters is set the
+ * IV, ARSN and anti-replay window are left untouched rather than rewritten with the same values.
+ * @param dest: SecurityAssociation_t*, cache entry
+ * @param src: const SecurityAssociation_t*, row read from the database
+ * @param keep_counters: uint8_t
+ **/
+static void sa_cache_copy(SecurityAssociation_t* dest, const SecurityAssociation_t* src, uint8_t keep_counters)
+{
+    // Configuration is everything ahead of the counters, the cold storage pointers follow them
+    memcpy(dest, src, offsetof(SecurityAssociation_t, iv));
+    memcpy(dest->ek_ref, src->ek_ref, REF_SIZE);
+    memcpy(dest->ak_ref, src->ak_ref, REF_SIZE);
+    memcpy(dest->abm, src->abm, ABM_SIZE);
+    if (keep_counters == CRYPTO_FALSE)
+    {
+        memcpy(dest->iv, src->iv, IV_SIZE);
+        memcpy(dest->arsn, src->arsn, ARSN_SIZE);
+        memset(dest->replay, 0, sizeof(SecurityAssociationReplay_t));
+    }
+}
+
+/**
+ * @brief Function: sa_cache_load
+ * Reads an SA with a prepared SELECT into its cache entry, creating the entry on first read. An entry
+ * already cached is only updated if it is *locked. If the row belongs to another entry, *locked is set to
+ * it and *security_association to NULL, and the caller retries holding that entry's SA lock.
+ * @param stmt: MYSQL_STMT*
+ * @param params: MYSQL_BIND*
+ * @param locked: sa_cache_entry_t**, entry whose SA lock the caller holds, or NULL
+ * @param security_association: SecurityAssociation_t**, owned by the cache
+ * @return int32: Success/Failure
+ **/
+static int32_t sa_cache_load(MYSQL_STMT* stmt, MYSQL_BIND* params, sa_cache_entry_t** locked,
+                             SecurityAssociation_t** security_association)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    sa_cache_entry_t* entry;
+    uint8_t keep_counters;
+    uint32_t bucket;
+
+    pthread_mutex_lock(&sa_mariadb_lock);
+    if (sa_scratch == NULL)
+    {
+        pthread_mutex_unlock(&sa_mariadb_lock);
+        return SADB_QUERY_FAILED;
+    }
+    status = sa_fetch_from_stmt(stmt, params, sa_scratch);
+    if (status != CRYPTO_LIB_SUCCESS)
+    {
+        pthread_mutex_unlock(&sa_mariadb_lock);
+        return status;
+    }
+
+    pthread_mutex_lock(&sa_cache_lock);
+    entry = sa_cache_find(sa_scratch->spi);
+    if (entry == NULL)
+    {
+        entry = calloc(1, sizeof(sa_cache_entry_t));
+        if (entry != NULL)
+        {
+            entry->sa = Crypto_SA_Alloc();
+        }
+        if (entry == NULL || entry->sa == NULL)
+        {
+            free(entry);
+            pthread_mutex_unlock(&sa_cache_lock);
+            pthread_mutex_unlock(&sa_mariadb_lock);
+            return CRYPTO_LIB_ERROR;
+        }
+        keep_counters = CRYPTO_FALSE;
+        sa_cache_copy(entry->sa, sa_scratch, keep_counters);
+        bucket = sa_scratch->spi & (SA_MARIADB_CACHE_BUCKETS - 1);
+        entry->next = sa_cache[bucket];
+        sa_cache[bucket] = entry;
+    }
+    else if (entry != *locked)
+    {
+        *locked = entry;
+        *security_association = NULL;
+        pthread_mutex_unlock(&sa_cache_lock);
+        pthread_mutex_unlock(&sa_mariadb_lock);
+        return status;
+    }
+    else
+    {
+        // The row still holds what we wrote last, the live counters are ahead of it
+        keep_counters = (sa_scratch->iv_len == entry->sa->iv_len && sa_scratch->arsn_len == entry->sa->arsn_len &&
+                         sa_scratch->iv_len <= IV_SIZE && sa_scratch->arsn_len <= ARSN_SIZE &&
+                         memcmp(sa_scratch->iv, entry->stored_iv, sa_scratch->iv_len) == 0 &&
+                         memcmp(sa_scratch->arsn, entry->stored_arsn, sa_scratch->arsn_len) == 0)
+                            ? CRYPTO_TRUE
+                            : CRYPTO_FALSE;
+        sa_cache_copy(entry->sa, sa_scratch, keep_counters);
+    }
+    if (keep_counters == CRYPTO_FALSE)
+    {
+#ifdef SA_DEBUG
+        printf("SA %d counters read from the database\n", sa_scratch->spi);
+#endif
+        memcpy(entry->stored_iv, sa_scratch->iv, IV_SIZE);
+        memcpy(entry->stored_arsn, sa_scratch->arsn, ARSN_SIZE);
+        memset(&entry->lease, 0, sizeof(SecurityAssociationLease_t));
+        if (entry->dirty == CRYPTO_TRUE)
+        {
+            entry->dirty = CRYPTO_FALSE;
+            sa_cache_dirty--;
+        }
+    }
+    entry->fetched_ms = sa_cache_now_ms();
+    *security_association = entry->sa;
+    pthread_mutex_unlock(&sa_cache_lock);
+    pthread_mutex_unlock(&sa_mariadb_lock);
 
     return status;
 }
-static int32_t convert_hexstring_to_byte_array(char* source_str, uint8_t* dest_buffer)
-{ // https://stackoverflow.com/questions/3408706/hexadecimal-string-to-byte-array-in-c/56247335#56247335
-    char* line = source_str;
-    char* data = line;
-    int offset;
-    unsigned int read_byte;
-    uint32_t data_len = 0;
 
-    while (sscanf(data, " %02x%n", &read_byte, &offset) == 1)
+/**
+ * @brief Function: sa_cache_invalidate
+ * Makes the next lookup of every SA read it from the database
+ **/
+static void sa_cache_invalidate(void)
+{
+    sa_cache_entry_t* entry;
+
+    pthread_mutex_lock(&sa_cache_lock);
+    for (uint32_t i = 0; i < SA_MARIADB_CACHE_BUCKETS; i++)
     {
-        dest_buffer[data_len++] = read_byte;
-        data += offset;
+        for (entry = sa_cache[i]; entry != NULL; entry = entry->next)
+        {
+            entry->fetched_ms = 0;
+        }
     }
-    return data_len;
+    memset(sa_cache_gvcid, 0, sizeof(sa_cache_gvcid));
+    pthread_mutex_unlock(&sa_cache_lock);
 }
 
-static void convert_byte_array_to_hexstring(void* src_buffer, size_t buffer_length, char* dest_str)
+/**
+ * @brief Function: sa_cache_free
+ * Releases every cached SA, pointers handed out before are no longer valid
+ **/
+static void sa_cache_free(void)
 {
-    unsigned char* bytes = src_buffer;
+    sa_cache_entry_t* entry;
 
-    if (src_buffer != NULL)
+    pthread_mutex_lock(&sa_cache_lock);
+    for (uint32_t i = 0; i < SA_MARIADB_CACHE_BUCKETS; i++)
     {
-        for (size_t i = 0; i < buffer_length; i++)
+        while (sa_cache[i] != NULL)
         {
-            uint8_t nib1 = (bytes[i] >> 4) & 0x0F;
-            uint8_t nib2 = (bytes[i]) & 0x0F;
-            dest_str[i * 2 + 0] = nib1 < 0xA ? '0' + nib1 : 'A' + nib1 - 0xA;
-            dest_str[i * 2 + 1] = nib2 < 0xA ? '0' + nib2 : 'A' + nib2 - 0xA;
+            entry = sa_cache[i];
+            sa_cache[i] = entry->next;
+            free(entry->sa);
+            free(entry);
         }
-        dest_str[buffer_length * 2] = '\0';
     }
+    memset(sa_cache_gvcid, 0, sizeof(sa_cache_gvcid));
+    sa_cache_dirty = 0;
+    pthread_mutex_unlock(&sa_cache_lock);
+}
+
+/**
+ * @brief Function: sa_flush
+ * Writes the buffered IV/ARSN of every dirty SA. A failed write stays buffered for the next flush, and the
+ * SA's lease is dropped so its next save renews it.
+ * @return int32: Success/Failure
+ **/
+static int32_t sa_flush(void)
+{
+    int32_t status = CRYPTO_LIB_SUCCESS;
+    sa_cache_entry_t* entry;
+    MYSQL_BIND params[7];
+    uint8_t iv[IV_SIZE];
+    uint8_t arsn[ARSN_SIZE];
+    unsigned long iv_len;
+    unsigned long arsn_len;
+    int32_t values[5];
+    uint8_t written;
+
+    pthread_mutex_lock(&sa_mariadb_lock);
+    pthread_mutex_lock(&sa_cache_lock);
+    for (uint32_t i = 0; i < SA_MARIADB_CACHE_BUCKETS && sa_cache_dirty > 0; i++)
+    {
+        // Entries are only unlinked by sa_cache_free, so the chain survives dropping the lock below
+        for (entry = sa_cache[i]; entry != NULL; entry = entry->next)
+        {
+            if (entry->dirty == CRYPTO_FALSE)
+            {
+                continue;
+            }
+            memcpy(iv, entry->pending_iv, IV_SIZE);
+            memcpy(arsn, entry->pending_arsn, ARSN_SIZE);
+            iv_len = (entry->sa->iv_len > IV_SIZE) ? IV_SIZE : entry->sa->iv_len;
+            arsn_len = (entry->sa->arsn_len > ARSN_SIZE) ? ARSN_SIZE : entry->sa->arsn_len;
+            values[0] = entry->sa->spi;
+            values[1] = entry->pending_gvcid.tfvn;
+            values[2] = entry->pending_gvcid.scid;
+            values[3] = entry->pending_gvcid.vcid;
+            values[4] = entry->pending_gvcid.mapid;
+            entry->dirty = CRYPTO_FALSE;
+            sa_cache_dirty--;
+            pthread_mutex_unlock(&sa_cache_lock);
+
+            memset(params, 0, sizeof(params));
+            params[0].buffer_type = MYSQL_TYPE_BLOB;
+            params[0].buffer = iv;
+            params[0].buffer_length = iv_len;
+            params[0].length = &iv_len;
+            params[1].buffer_type = MYSQL_TYPE_BLOB;
+            params[1].buffer = arsn;
+            params[1].buffer_length = arsn_len;
+            params[1].length = &arsn_len;
+            for (int j = 0; j < 5; j++)
+            {
+                sa_bind_int(&params[2 + j], &values[j]);
+            }
+            written = CRYPTO_FALSE;
+            if (stmt_update_iv_arsn != NULL)
+            {
+                if (mysql_stmt_bind_param(stmt_update_iv_arsn, params) || mysql_stmt_execute(stmt_update_iv_arsn))
+                {
+                    finish_with_stmt_error(stmt_update_iv_arsn, SADB_QUERY_FAILED);
+                }
+                else
+                {
+                    written = CRYPTO_TRUE;
+                }
+            }
+#ifdef SA_DEBUG
+            fprintf(stderr, "MySQL Update SA %d IV/ARSN, written %d\n", values[0], written);
+#endif
+            // todo - if query fails, need to push failure message to error stack instead of just return code.
+
+            pthread_mutex_lock(&sa_cache_lock);
+            if (written == CRYPTO_TRUE)
+            {
+                memcpy(entry->stored_iv, iv, IV_SIZE);
+                memcpy(entry->stored_arsn, arsn, ARSN_SIZE);
+            }
+            else
+            {
+                status = SADB_QUERY_FAILED;
+                // A lease that did not reach the row covers nothing, every save renews and writes it again
+                entry->lease.active = CRYPTO_FALSE;
+                if (entry->dirty == CRYPTO_FALSE)
+                {
+                    entry->dirty = CRYPTO_TRUE;
+                    sa_cache_dirty++;
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock(&sa_cache_lock);
+    pthread_mutex_unlock(&sa_mariadb_lock);
+
+    return status;
+}
+
+/**
+ * @brief Function: sa_flusher_thread
+ * Write-behind, flushes the dirty SAs every SA_MARIADB_FLUSH_MS until sa_close
+ **/
+static void* sa_flusher_thread(void* arg)
+{
+    struct timespec wake;
+    arg = arg;
+
+    pthread_mutex_lock(&sa_cache_lock);
+    while (sa_flusher_stop == CRYPTO_FALSE)
+    {
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_sec += SA_MARIADB_FLUSH_MS / 1000;
+        wake.tv_nsec += (SA_MARIADB_FLUSH_MS % 1000) * 1000000L;
+        if (wake.tv_nsec >= 1000000000L)
+        {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&sa_flusher_wake, &sa_cache_lock, &wake);
+        if (sa_cache_dirty > 0 && sa_flusher_stop == CRYPTO_FALSE)
+        {
+            pthread_mutex_unlock(&sa_cache_lock);
+            sa_flush();
+            pthread_mutex_lock(&sa_cache_lock);
+        }
+    }
+    pthread_mutex_unlock(&sa_cache_lock);
+    return NULL;
+}
+
+/**
+ * @brief Function: finish_with_stmt_error
+ * Reports a failed statement. Unlike finish_with_error, the connection and its statements stay usable.
+ **/
+static int32_t finish_with_stmt_error(MYSQL_STMT* stmt, int err)
+{
+    fprintf(stderr, "%s\n", mysql_stmt_error(stmt)); // todo - if query fails, need to push failure message to error stack
+    return err;
 }
 
 static int32_t finish_with_error(MYSQL **con_loc, int err)
@@ -982,4 +982,76 @@ UTEST(AOS_PROCESS, AOS_SA_SEGFAULT_TEST)
     free(ptr_processed_frame);
 }
 
+/**
+ * @brief Unit Test: ProcessSecurity in place
+ * The AEAD_GCM_BITMASK_1 frame processed over its own buffer must match the truth frame.
+ **/
+UTEST(AOS_PROCESS, PROCESS_INTO_IN_PLACE)
+{
+    remove("sa_save_file.bin");
+    // Local Variables
+    uint16_t processed_aos_len = 0;
+    uint16_t pdu_offset = 0;
+    uint16_t pdu_len = 0;
+    SecurityAssociation_t *sa_ptr = NULL;
+
+    // Configure Parameters
+    Crypto_Config_CryptoLib(KEY_TYPE_INTERNAL, MC_TYPE_INTERNAL, SA_TYPE_INMEMORY, CRYPTOGRAPHY_TYPE_LIBGCRYPT, 
+                            IV_INTERNAL, CRYPTO_AOS_CREATE_FECF_TRUE, TC_PROCESS_SDLS_PDUS_TRUE, TC_HAS_PUS_HDR,
+                            TC_IGNORE_SA_STATE_FALSE, TC_IGNORE_ANTI_REPLAY_FALSE, TC_UNIQUE_SA_PER_MAP_ID_FALSE,
+                            AOS_CHECK_FECF_TRUE, 0x3F, SA_INCREMENT_NONTRANSMITTED_IV_TRUE);
+    GvcidManagedParameters_t AOS_UT_Managed_Parameters = {1, 0x002c, 0, AOS_HAS_FECF, AOS_FHEC_NA, AOS_IZ_NA, 0, AOS_SEGMENT_HDRS_NA, 1786, AOS_NO_OCF, 1};  
+    Crypto_Config_Add_Gvcid_Managed_Parameters(AOS_UT_Managed_Parameters);
+    Crypto_Init();
+
+    char* framed_aos_h = "42C000000000000B0000000000000000000000000000000010df143c92a39b3568cc9916c9d06c715bf8017168f88ef107a8016a03207f7d12fe4ccd79ab24043982fe6a8b9675c3b819e2d7dfad32bd85381fb54544d76668a6ab58b988158702e91afe55cd71f1ba50d72bbd1ccc41529101ee1a39c46ecd8a7feb503444606611239d31102dc6371b0e2152dd301e3268d0a45e1bcb58779642e883b6a26546094ba39fb0ce11b39c49092c9b366059e773e4789052311a465f39ba677458510c09826f1ea580fa5c9d5b9677ede38e46fc33fe8d303f9529c15c2bed4c879c5bfdacd86210a431e0f3852b3798369ae1230b4ed5ae66e153757508ead77e85ddac804e8a409cca8b9d3cef0dd1d0298bcdbda1dda336d66ee6b59f2f10ffa6d4bf99885b9082b83cd20c9a44a002c460530a9741e26e78b6e8f9349df8e618b904ed01306ee9ed3a389374efe43e5ed2bcd528943057762f9dc1d392fe2dd2fc6d9cab9e347a25839c07ba47113bad0633b6b5f09228be87631cc1538c2f6e79e9df0f18d658bd8b3ac45b396cfeadd1700ca2ec95cdbe38e5ec013c74cd68d0035bb975c392f5116b661a928bf113c3cacc801a84cbd3f8d3dc2273e0c5270d656648a48db16f860e4a36ee7e8979da4135e40e6952041a0d16b6f51cf67519b80a472b4cf5614d5a0b18dd755b7c8d63936e43de25a3cdf0d03179aebd5cc85fa1cc0c03fbdd240dd878d647619cbf367a7e486e572c5636c7a7d9b517c565a547597d311b69110985b5f7c5d47904a6f6699e93c02ea7559d4ba94d139824e9ef0840ad3e31afdaaa71f7baba8835d568443b0dab10a4f40043160fde9961038bcb823ab570bac0e609e17311a6b0edab4fce98f8df059194393f5109e766f6bf7e21c9a4441acff0cfd28658d48304331cb0c982da833c94cf6a7aadc8e2a696b69df49efcd7efadfd2e95bd3a9ab605c221e08b5f61f3aff2496b7c89f98a76aa305116220c50142cfa4490916f7a6b8732839280d39a402d87ff7e7b1f71b6a243c316307e82b16071ad18e99a548bacc4ed648df49c6eafca0db764b98c75a9e953161cb6d384421b473f95d6801d5413dbde4373abab3269c0fade85ab66a9beea1d32462796dac0024f44ade919286b5e92488e52b51ada1deb0730c9b2e66b9b3c75dab5194cf452cb626ea4d9425b28e6d97a9d93d5c61d1fd02eea18d2b42058de6453abac1165740be3c352d7291f8df7abd0c24e90bc8fbdadc32c31942e82f09f74f3ff75e20e597d87d136998b94d99370a8d6c3eedf44503ccc2d7d560a3c068f8914fb67a976cb15d3be212bc549b26613113a509079ad19e5abd26467e26571c98f17e248e31ad5b0f489a05b71e38725574e9a076bf55d546f970cbc1892801b6a4b4bc7e3b82723cf251dcf3bfee0cb3b8c54a51a99d5272e8165a6cf8b2b05a549d091090c8b7a623541f2b29542eecc1234bc172038f8fcb0fe14413601f2d255708e4a30a789ec92a3f7bb286c80899886d2f59edfe5e120039b2e0e6fce7fa81dd15b14c61afc0c334015cf975b42cb53bc33dc511c6aac87f1e38f48287c4ede88b8a22ab013200d4d894709bc0668ac5ff06add5c28ef3764e3a6f51ba519256574734b0ad395d80ee886018ce0a1b935b1af4747b47011eb030c2ca2ab77cf33019cfca4bbbde219d32666ce9a2db7a9e1f0f3fdff22a0b2cf6d245f0c5de470a40025a9f2e743c1fd626a01eb34293544c3dee8b72892c8a2d4fbe0cb2dec2bda572ba4a1246b811331d80e5078b310eb9090a89216b390df62671425f89e73ca736e49848368be1eca4cc5c3036df2dcee5ca648d199f64b9bb792a2b7eb7ddc5ae43f35bcd9b9a7f4b9b8d493f958666af4dff6a2dec6a4ca908cd67f98d8845a631b3ecff4c5e527a0654ae737885885425f6780da2e53f4e612ee8caf42e4d25cec899e7788e1652f0aa1536c488df58f750b7b63a1573d4df0e3eda5c8359daae006269cc4f79aab4360ce37b2227bc17a7feb2bd62108404b9d4ec6ca9d4a2c903a34d03db5d68004d5235789e61a22ec75f98680b0829cbf905668c9631a5157d39d73d1ab7e558ae6ced855939ea79b80f7256dc29fbf01bacbd718e96916218e41c3fb221f5b9ac58eb3bb694edfc60a9a518f392ba97d542034d17cba204ea92572677c3b6af86383f013fb537ba8441d1b8f645289d8c1347377f3698a830aa82ebe9123808eb105ef216502cee4cd7ef05a14f1e87b5a66eb937a5f7dfd704fb6ad693c90c941a3e4853a148ada9269de95852b412d4d9fc8920120835156c0c6ed168027115535edbf4ff5b72a3f556234c68245c604188572d3a372a898bd6a439bd4a8d6402b28260e81ece7bbf0cdf5a2a2983403289cb060f81d3aedf8b4a82dcdadfed35a86a8b6df4d57801f7718a15660f9b03e0c0450a717e14e92e278d65cc11b7e07277b6992050f69a101af8A2A043A6420DEC5FF4F7B14B80E26374173";
+    char* framed_aos_b = NULL;
+    int framed_aos_len = 0;
+    hex_conversion(framed_aos_h, &framed_aos_b, &framed_aos_len);
+
+    char* truth_aos_h = "42C000000000000000000000000000000000000000000000000015C1B5DB5CF084716870EB0A784FC8285D766989E0DB22E3BD68B9E0C7F7D629E5998ECCE605A62C7C42CE5645FF7670E16486D056BA0C2F2127E15B2988046A7854A97A17A5ACC4A3BDF4999F96700BD6D1D19DCAF7257AE8D5A07D65FDB24E09CB9475AFFE99DBFE26A927A77CA1778290E756D969B9DC596635152EE907648ED47AF49A795FC6B6006FB9EA0BC627413FDE38A151D42D91A9B0DE910BF3DDFED55EF475959EFEE324DD367134E476DCADB086C03ED80FC9DFB91475181EBCEFDF511BDCC06B76DA5D9E64736C9AEE79CF631808ABB97D0240D6745B19F49F2F8CC635643EE90992F759A0B5BC31BDEC1DC99B857743F15F9CD7CAB941CEF28B71C230347A0D81A2E78C68A3739314D19AF3E281ECDFC82CC07FE1CE8521722BE567CE77D15BF5A7FEBE77D47338796E03F7D62B7B014659AD2FEBA369FDD25044F5F99615977B04CA7DA8244EAA53022E9DEA10D60797251A3DEC9C729705663119E5F6D659FC3C0C5D6D62EAD0793CE5DA578C6D7A856677694A8C8B905FE07E5F7ACE5BA7B7D0210184C14D8D2925DDCA5E2AC9239862A5F17CBF7BEC99BB8E4A05791C7C62F9C196687EBF599DDA66830EF3CDBCF983451E9136F6D6E2B2A6004911A9D24576B9448BB074961280ECF97CD62CB27CA4B4B67A0BCCC642E8B77A03246E49DFB8C32807745D65756B56CEA4841D6074116FF398ABB5F9ABA13B2AB4A964CBD8DB884790D3CCE3A0DB3E07D8CB89077A645874C241F406CDC090A59EBD106E9DCA615A051ED4273B50AF10F770E78925E6F72AF9F23AA6A55F0E0CBCF7622D15214073A34A9DF1A50BF672ADC15A6E0BF0B119CF6C9CFC57F53B1301D39C0DC5AA7333340C2F36143040BB88F220E9716B1AA3296E98A8AB5DBD48540E6D09E5D5DEABA1F9A9B3E3A8D0A929D339148D3735CF8E990004401764BA4C229F592FB8259BEC408CC8B0C9B2C744D3C06E5550AE46F3BF0AB8EBA1390C6D69533FCBB103685FDAFF48C20965596A76C3FF2806BB43E5FA0ADB3AAA30880E19D7D2A453669E364155F40A74982A35BE8E6943AE616FA434672307537222684939A5D5CE49B972F80963F1AE7A46FC6325FD48161E7AD8CD53ADB6A191F3C5BC9BA17175289473C6FD554C7B694247A5958B0F7D1D5D28D1174A36FF43F3FF7373769B819C8306494645963665441072CFD53D731BAFD1730E538C9CC325F849B5BA88C52B4912A4BC65B73FC6302CA6D100D965060AE206A7E9AD12911DC183B61125C336AA1BC0DDD1A6082520D8C8F8AAC8D8B210582E4ED9DD940BCC83FA009297DBE2099D741F3DA828064574D6F5BAF88D009A93EF786A124D6C6BC176E34A588D0B8969D881AF84232351FA9A2613D57F3153AC69409D9B609F60EDD483F5967414400CF08D11875F2435E6CE72623739DC52E5986D48CD4BD135564304983694727FE2B90E0488FB6E680D197181145613F0B1F4CFA3756C025EB2B4E0C8E691D1856F5911963FFA6AABCCD9D3FD6F26A481BC74E69D25393E6E3AAADDDBCAD96A801A56F7DFD4100D8FCC196CDD8029B8823AA5C73FA03B51B47E119DE79F969C4E19A4216F68AD17EBA83BD6EABC84D32335B0318B2252A05A87E23EB3304D42489D1E31A94D94043C7FDFEE75054692FCB3E20E8A950E424749962EEDF3A9A7B775E43AD475509893A85387FBDA3A036CE40A8C05092CC93A9F79ABD65C2181D26A9E4A8BB6E29E8B679CAC8DD64A59312A710FC31A709533DC58C2E32AC092B9149A2CD75803DCF9460021EFAA1F9051605797CDDEE9A5346C155B0AB63BE2AFDD6A8D69C747A3AE8FF2608C8D83CF6A2957AFC5E7A5E6D68196612498291FB9D793CEC1A68FECFD59F50DA7285CEBE67E71A0AA48FEE85128C6C5D4A7A1709E75060432700E4CB334FA64F03A03946ED845BC2D4775C535F376B15A17B92A3FA4D3708F36A16715B7FD8F2BFF24D7176C2148D0F4E7737027ECD6AE6358AB053BEF97B174DAE966AFE02EE02A0A70AD0E51A3DE418E78EE8D39000A397F5CECBF48D38DA89797B7434335B07989E739601BE66305455E08EE8531F0618FAF9CC61E305C58C634BE60D67985DB44E223CAF6105A4EC22F25BECD9F615F0D226EF6E0BFD30E2BFC46F7DB5BF3C1E75E32C160E8B5F6AD69B2D1283AB0EA3B51841FE438C4775620F34609E93BB4C2403B819FBC0437AA078A21E58E3189104CB830868E5F01472009B70A5F2A66BC08B6187D48643B425F6AC01E8C653B0B64A319F756E0147FACB7183EA7721839DB6E3B2B876BC78A3BC98E032019E0437533D5E6CB1F1C38EEFA743AC0ED7B1AA151BF49544A3D88A85357D3A79D0D59CCECBDCDAFD4FD813C20B6243247E2C6684B68E2FA22CF3B99C50EEE588BDD402276E24CAD6DE47A056B6D0790E709FCECE2D917408F8EACED04B6E2D6F543D737D704D3A4000000000000000000000000000000000000";
+    char* truth_aos_b = NULL;
+    int truth_aos_len = 0;
+    hex_conversion(truth_aos_h, &truth_aos_b, &truth_aos_len);
+
+    SaInterface sa_if = get_sa_interface_inmemory();
+    sa_if->sa_get_from_spi(10, &sa_ptr); //Disable SPI 10
+    sa_ptr->sa_state = SA_KEYED;
+    sa_if->sa_get_from_spi(11, &sa_ptr);  // Enable and setup 11
+    sa_ptr->sa_state = SA_OPERATIONAL;
+    sa_ptr->akid = 0;
+    sa_ptr->ekid = 130;
+    sa_ptr->est = 1;
+    sa_ptr->ast = 1;
+    sa_ptr->acs_len = 0;
+    sa_ptr->ecs_len = 1;
+    sa_ptr->ecs = CRYPTO_CIPHER_AES256_GCM;
+    sa_ptr->stmacf_len = 16;
+    sa_ptr->abm_len = ABM_SIZE;
+    sa_ptr->gvcid_blk.scid = 44;
+    sa_ptr->iv_len = 16;
+    sa_ptr->shivf_len = 16;
+    sa_ptr->shsnf_len = 0;
+    sa_ptr->shplf_len = 0;
+    memset(sa_ptr->abm, 0xFF, (sa_ptr->abm_len * sizeof(uint8_t))); // Bitmask of ones
+
+    ASSERT_EQ(CRYPTO_LIB_ERR_NULL_BUFFER,
+              Crypto_AOS_ProcessSecurity_Into((uint8_t*)framed_aos_b, framed_aos_len, NULL, framed_aos_len, NULL, NULL, &processed_aos_len));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS,
+              Crypto_AOS_ProcessSecurity_Into((uint8_t*)framed_aos_b, framed_aos_len, (uint8_t*)framed_aos_b, framed_aos_len,
+                                              &pdu_offset, &pdu_len, &processed_aos_len));
+    ASSERT_EQ(1786, processed_aos_len);
+    // Security header ahead of the data field, MAC and FECF behind it
+    ASSERT_TRUE(pdu_offset >= 6 + 2 + 16);
+    ASSERT_EQ(1786 - 16 - 2, pdu_offset + pdu_len);
+    for(int i=0; i < processed_aos_len; i++)
+    {
+        ASSERT_EQ((uint8_t)framed_aos_b[i], (uint8_t)*(truth_aos_b + i));
+    }
+
+    Crypto_Shutdown();
+    free(framed_aos_b);
+    free(truth_aos_b);
+}
+
 UTEST_MAIN();
\ No newline at end of file
@@ -0,0 +1,290 @@
+/* Copyright (C) 2009 - 2022 National Aeronautics and Space Administration.
+   All Foreign Rights are Reserved to the U.S. Government.
+
+   This software is provided "as is" without any warranty of any kind, either expressed, implied, or statutory,
+   including, but not limited to, any warranty that the software will conform to specifications, any implied warranties
+   of merchantability, fitness for a particular purpose, and freedom from infringement, and any warranty that the
+   documentation will conform to the program, or any warranty that the software will be error free.
+
+   In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or
+   consequential damages, arising out of, resulting from, or in any way connected with the software or its
+   documentation, whether or not based upon warranty, contract, tort or otherwise, and whether or not loss was sustained
+   from, or arose out of the results of, or use of, the software, documentation or services provided hereunder.
+
+   ITC Team
+   NASA IV&V
+   jstar-development-team@mail.nasa.gov
+*/
+
+/**
+ *  Unit Tests that cross-check the base64_simd decode engines against the scalar engine.
+ **/
+#include "ut_base64_simd.h"
+#include "utest.h"
+
+#define UT_BASE64_DATA_SIZE 600
+
+static const char* ut_base64_chars[2] = {
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"};
+
+/**
+ * @brief Function: ut_base64_encode
+ * Reference encoder for the decode tests
+ * @return size_t: Characters written to out
+ **/
+static size_t ut_base64_encode(const uint8_t* data, size_t len, uint8_t alphabet, uint8_t pad, char* out)
+{
+    const char* chars = ut_base64_chars[alphabet];
+    uint32_t value;
+    size_t n = 0;
+    size_t i;
+
+    for (i = 0; i + 2 < len; i += 3)
+    {
+        value = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        out[n++] = chars[(value >> 18) & 0x3F];
+        out[n++] = chars[(value >> 12) & 0x3F];
+        out[n++] = chars[(value >> 6) & 0x3F];
+        out[n++] = chars[value & 0x3F];
+    }
+    if (len - i == 1)
+    {
+        value = (uint32_t)data[i] << 16;
+        out[n++] = chars[(value >> 18) & 0x3F];
+        out[n++] = chars[(value >> 12) & 0x3F];
+        if (pad)
+        {
+            out[n++] = '=';
+            out[n++] = '=';
+        }
+    }
+    else if (len - i == 2)
+    {
+        value = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8);
+        out[n++] = chars[(value >> 18) & 0x3F];
+        out[n++] = chars[(value >> 12) & 0x3F];
+        out[n++] = chars[(value >> 6) & 0x3F];
+        if (pad)
+        {
+            out[n++] = '=';
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Unit Test: Base64 decode engines match the scalar engine on random lengths and windows
+ **/
+UTEST(BASE64_SIMD, DECODE_ENGINES)
+{
+    uint8_t engines[] = {BASE64_ENGINE_SCALAR, BASE64_ENGINE_SSSE3, BASE64_ENGINE_AVX2};
+    size_t windows[] = {1, 7, 48, 100, UT_BASE64_DATA_SIZE};
+    uint8_t data[UT_BASE64_DATA_SIZE];
+    char encoded[UT_BASE64_DATA_SIZE / 3 * 4 + 4];
+    uint8_t expected[UT_BASE64_DATA_SIZE];
+    uint8_t decoded[UT_BASE64_DATA_SIZE];
+    size_t lengths[264];
+    size_t encoded_len;
+    size_t expected_len;
+    size_t decoded_len;
+    size_t wanted;
+    uint8_t default_engine;
+    uint32_t seed = 0x1acffc1d;
+    int32_t expected_status;
+    uint8_t alphabet;
+    uint8_t pad;
+    size_t offset;
+    int e;
+    int l;
+    int w;
+
+    for (l = 0; l < UT_BASE64_DATA_SIZE; l++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[l] = (uint8_t)(seed >> 16);
+    }
+    // Every length up to 200, then random ones up to the buffer size
+    for (l = 0; l < (int)(sizeof(lengths) / sizeof(lengths[0])); l++)
+    {
+        seed = seed * 1103515245 + 12345;
+        lengths[l] = (l <= 200) ? (size_t)l : (seed >> 8) % (UT_BASE64_DATA_SIZE + 1);
+    }
+    default_engine = base64SimdGetEngine();
+
+    for (e = 0; e < (int)sizeof(engines); e++)
+    {
+        if (base64SimdSetEngine(engines[e]) != NO_ERROR)
+        {
+            // SSSE3 and AVX2 are optional, scalar must be available
+            ASSERT_NE(BASE64_ENGINE_SCALAR, engines[e]);
+            continue;
+        }
+        ASSERT_EQ(engines[e], base64SimdGetEngine());
+        for (alphabet = BASE64_ALPHABET_STANDARD; alphabet <= BASE64_ALPHABET_URL; alphabet++)
+        {
+            for (pad = 0; pad <= 1; pad++)
+            {
+                for (l = 0; l < (int)(sizeof(lengths) / sizeof(lengths[0])); l++)
+                {
+                    encoded_len = ut_base64_encode(data, lengths[l], alphabet, pad, encoded);
+                    ASSERT_EQ(lengths[l], base64SimdDecodedLen(encoded, encoded_len));
+                    for (offset = 0; offset < 5; offset++)
+                    {
+                        for (w = 0; w < (int)(sizeof(windows) / sizeof(windows[0])); w++)
+                        {
+                            ASSERT_EQ(NO_ERROR, base64SimdSetEngine(BASE64_ENGINE_SCALAR));
+                            expected_status = base64SimdDecode(encoded, encoded_len, alphabet, offset, expected,
+                                                               windows[w], &expected_len);
+                            ASSERT_EQ(NO_ERROR, base64SimdSetEngine(engines[e]));
+                            memset(decoded, 0xA5, sizeof(decoded));
+                            ASSERT_EQ(expected_status, base64SimdDecode(encoded, encoded_len, alphabet, offset,
+                                                                        decoded, windows[w], &decoded_len));
+                            ASSERT_EQ(NO_ERROR, expected_status);
+                            ASSERT_EQ(expected_len, decoded_len);
+                            ASSERT_EQ(0, memcmp(expected, decoded, decoded_len));
+                            ASSERT_EQ(0, memcmp(data + offset, decoded, decoded_len));
+                            wanted = (offset < lengths[l]) ? lengths[l] - offset : 0;
+                            ASSERT_EQ((windows[w] < wanted) ? windows[w] : wanted, decoded_len);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    ASSERT_EQ(NO_ERROR, base64SimdSetEngine(default_engine));
+}
+
+/**
+ * @brief Unit Test: Base64 decode of every padding case, RFC 4648 section 10 vectors
+ **/
+UTEST(BASE64_SIMD, DECODE_PADDING)
+{
+    uint8_t engines[] = {BASE64_ENGINE_SCALAR, BASE64_ENGINE_SSSE3, BASE64_ENGINE_AVX2};
+    const char* plain[] = {"", "f", "fo", "foo", "foob", "fooba", "foobar", "foobarfoobarfoobarfoobarfoobarfo"};
+    const char* padded[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy",
+                            "Zm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFyZm8="};
+    const char* unpadded[] = {"", "Zg", "Zm8", "Zm9v", "Zm9vYg", "Zm9vYmE", "Zm9vYmFy",
+                              "Zm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFyZm8"};
+    uint8_t decoded[64];
+    size_t decoded_len;
+    uint8_t default_engine;
+    int e;
+    int i;
+
+    default_engine = base64SimdGetEngine();
+    for (e = 0; e < (int)sizeof(engines); e++)
+    {
+        if (base64SimdSetEngine(engines[e]) != NO_ERROR)
+        {
+            continue;
+        }
+        for (i = 0; i < (int)(sizeof(plain) / sizeof(plain[0])); i++)
+        {
+            ASSERT_EQ(strlen(plain[i]), base64SimdDecodedLen(padded[i], strlen(padded[i])));
+            ASSERT_EQ(NO_ERROR, base64SimdDecode(padded[i], strlen(padded[i]), BASE64_ALPHABET_STANDARD, 0, decoded,
+                                                 sizeof(decoded), &decoded_len));
+            ASSERT_EQ(strlen(plain[i]), decoded_len);
+            ASSERT_EQ(0, memcmp(plain[i], decoded, decoded_len));
+
+            ASSERT_EQ(strlen(plain[i]), base64SimdDecodedLen(unpadded[i], strlen(unpadded[i])));
+            ASSERT_EQ(NO_ERROR, base64SimdDecode(unpadded[i], strlen(unpadded[i]), BASE64_ALPHABET_URL, 0, decoded,
+                                                 sizeof(decoded), &decoded_len));
+            ASSERT_EQ(strlen(plain[i]), decoded_len);
+            ASSERT_EQ(0, memcmp(plain[i], decoded, decoded_len));
+        }
+
+        // A single character left over cannot encode a byte
+        ASSERT_EQ((size_t)0, base64SimdDecodedLen("Zm9vY", 5));
+        ASSERT_EQ(ERROR_INVALID_LENGTH,
+                  base64SimdDecode("Zm9vY", 5, BASE64_ALPHABET_STANDARD, 0, decoded, sizeof(decoded), &decoded_len));
+        // Padding in the wrong place
+        ASSERT_EQ(ERROR_INVALID_CHARACTER,
+                  base64SimdDecode("Zm9vY===", 8, BASE64_ALPHABET_STANDARD, 0, decoded, sizeof(decoded), &decoded_len));
+        ASSERT_EQ(ERROR_INVALID_CHARACTER,
+                  base64SimdDecode("Zg=A", 4, BASE64_ALPHABET_STANDARD, 0, decoded, sizeof(decoded), &decoded_len));
+        ASSERT_EQ(ERROR_INVALID_CHARACTER,
+                  base64SimdDecode("Zm==Zm9v", 8, BASE64_ALPHABET_STANDARD, 1, decoded, sizeof(decoded), &decoded_len));
+    }
+    ASSERT_EQ(NO_ERROR, base64SimdSetEngine(default_engine));
+}
+
+/**
+ * @brief Unit Test: Base64 decode engines reject an invalid character in every lane, like the scalar engine
+ **/
+UTEST(BASE64_SIMD, DECODE_INVALID)
+{
+    uint8_t engines[] = {BASE64_ENGINE_SCALAR, BASE64_ENGINE_SSSE3, BASE64_ENGINE_AVX2};
+    // Outside both alphabets, then the characters only the other alphabet has
+    const char bad[] = {'!', '.', ' ', '\0', '\n', '@', '[', '`', '{', '~', '\x7F', '\x80', '\xC0', '\xFF', '='};
+    const char other[2][2] = {{'-', '_'}, {'+', '/'}};
+    uint8_t data[192];
+    char encoded[256];
+    char corrupt[256];
+    uint8_t decoded[192];
+    size_t decoded_len;
+    uint8_t default_engine;
+    uint32_t seed = 0x1acffc1d;
+    uint8_t alphabet;
+    size_t encoded_len;
+    size_t pos;
+    int e;
+    int c;
+
+    for (pos = 0; pos < sizeof(data); pos++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[pos] = (uint8_t)(seed >> 16);
+    }
+    default_engine = base64SimdGetEngine();
+
+    for (e = 0; e < (int)sizeof(engines); e++)
+    {
+        if (base64SimdSetEngine(engines[e]) != NO_ERROR)
+        {
+            continue;
+        }
+        for (alphabet = BASE64_ALPHABET_STANDARD; alphabet <= BASE64_ALPHABET_URL; alphabet++)
+        {
+            // 256 characters, every SSSE3 and AVX2 lane several times over
+            encoded_len = ut_base64_encode(data, sizeof(data), alphabet, 1, encoded);
+            ASSERT_EQ(sizeof(encoded), encoded_len);
+            for (pos = 0; pos < encoded_len; pos++)
+            {
+                for (c = 0; c < (int)(sizeof(bad) + sizeof(other[alphabet])); c++)
+                {
+                    memcpy(corrupt, encoded, encoded_len);
+                    corrupt[pos] = (c < (int)sizeof(bad)) ? bad[c] : other[alphabet][c - sizeof(bad)];
+                    if (corrupt[pos] == '=' && pos >= encoded_len - 2)
+                    {
+                        // Padding where padding may be
+                        continue;
+                    }
+                    ASSERT_EQ(ERROR_INVALID_CHARACTER, base64SimdDecode(corrupt, encoded_len, alphabet, 0, decoded,
+                                                                        sizeof(decoded), &decoded_len));
+                    ASSERT_EQ((size_t)0, decoded_len);
+                }
+            }
+            // Characters outside the decoded window are not looked at
+            memcpy(corrupt, encoded, encoded_len);
+            corrupt[0] = '!';
+            ASSERT_EQ(NO_ERROR, base64SimdDecode(corrupt, encoded_len, alphabet, 3, decoded, sizeof(decoded),
+                                                 &decoded_len));
+            ASSERT_EQ(sizeof(data) - 3, decoded_len);
+            ASSERT_EQ(0, memcmp(data + 3, decoded, decoded_len));
+        }
+    }
+
+    ASSERT_EQ(ERROR_INVALID_PARAMETER, base64SimdDecode(encoded, 4, BASE64_ALPHABET_URL + 1, 0, decoded,
+                                                        sizeof(decoded), &decoded_len));
+    ASSERT_EQ(ERROR_INVALID_PARAMETER,
+              base64SimdDecode(encoded, 4, BASE64_ALPHABET_STANDARD, 0, decoded, sizeof(decoded), NULL));
+    ASSERT_EQ(ERROR_INVALID_PARAMETER,
+              base64SimdDecode(NULL, 4, BASE64_ALPHABET_STANDARD, 0, decoded, sizeof(decoded), &decoded_len));
+    ASSERT_EQ(ERROR_INVALID_PARAMETER,
+              base64SimdDecode(encoded, 4, BASE64_ALPHABET_STANDARD, 0, NULL, sizeof(decoded), &decoded_len));
+    ASSERT_EQ(ERROR_INVALID_PARAMETER, base64SimdSetEngine(0xFF));
+    ASSERT_EQ(NO_ERROR, base64SimdSetEngine(default_engine));
+}
+
+UTEST_MAIN();
@@ -47,6 +47,415 @@ UTEST(CRYPTO_C, CALC_CRC16)
     ASSERT_EQ(crc, validated_crc);
 }
 
+/**
+ * @brief Unit Test: Crypto Calc FECF engines match the bitwise reference
+ **/
+UTEST(CRYPTO_C, CALC_FECF_ENGINES)
+{
+    uint8_t engines[] = {FECF_ENGINE_TABLE, FECF_ENGINE_SLICE8, FECF_ENGINE_PCLMUL};
+    uint8_t data[TM_FRAME_DATA_SIZE + 64];
+    uint8_t default_engine;
+    uint32_t seed = 0x1acffc1d;
+    int e;
+    int len;
+    int offset;
+
+    for (len = 0; len < (int)sizeof(data); len++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[len] = (uint8_t)(seed >> 16);
+    }
+
+    // Known answer, CRC-16/CCITT-FALSE check value
+    ASSERT_EQ(0x29B1, Crypto_Calc_FECF((const uint8_t*)"123456789", 9));
+    default_engine = Crypto_Calc_FECF_Get_Engine();
+
+    for (e = 0; e < (int)sizeof(engines); e++)
+    {
+        if (Crypto_Calc_FECF_Set_Engine(engines[e]) != CRYPTO_LIB_SUCCESS)
+        {
+            // PCLMUL is optional, everything else must be available
+            ASSERT_EQ(FECF_ENGINE_PCLMUL, engines[e]);
+            continue;
+        }
+        for (offset = 0; offset < 3; offset++)
+        {
+            for (len = 0; len <= 200; len++)
+            {
+                ASSERT_EQ(Crypto_Calc_FECF_Bitwise(data + offset, len), Crypto_Calc_FECF(data + offset, len));
+            }
+            for (len = TM_FRAME_DATA_SIZE - 70; len <= TM_FRAME_DATA_SIZE; len++)
+            {
+                ASSERT_EQ(Crypto_Calc_FECF_Bitwise(data + offset, len), Crypto_Calc_FECF(data + offset, len));
+            }
+        }
+    }
+    ASSERT_EQ(CRYPTO_LIB_ERROR, Crypto_Calc_FECF_Set_Engine(0xFF));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Calc_FECF_Set_Engine(default_engine));
+}
+
+/**
+ * @brief Unit Test: Crypto Apply ABM engines match the bytewise reference
+ **/
+UTEST(CRYPTO_C, APPLY_ABM_ENGINES)
+{
+    uint8_t engines[] = {ABM_ENGINE_RUNS, ABM_ENGINE_AVX2};
+    uint8_t data[ABM_SIZE + 8];
+    uint8_t abm[ABM_SIZE + 8];
+    uint8_t mask[ABM_SIZE];
+    uint8_t aad[ABM_SIZE];
+    uint8_t truth[ABM_SIZE];
+    uint8_t default_engine;
+    uint32_t seed = 0x1acffc1d;
+    int e;
+    int i;
+    int len;
+    int offset;
+
+    // Runs of ones and zeros of assorted lengths, broken up by mixed bytes
+    for (i = 0; i < (int)sizeof(data); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (uint8_t)(seed >> 16);
+        abm[i] = ((i / 37) % 3 == 0) ? 0xFF : ((i / 37) % 3 == 1) ? 0x00 : (uint8_t)(seed >> 8);
+    }
+    default_engine = Crypto_Apply_ABM_Get_Engine();
+
+    for (e = 0; e < (int)sizeof(engines); e++)
+    {
+        if (Crypto_Apply_ABM_Set_Engine(engines[e]) != CRYPTO_LIB_SUCCESS)
+        {
+            // AVX2 is optional, everything else must be available
+            ASSERT_EQ(ABM_ENGINE_AVX2, engines[e]);
+            continue;
+        }
+        for (offset = 0; offset < 3; offset++)
+        {
+            for (len = 0; len <= ABM_SIZE; len += (len < 100) ? 1 : 97)
+            {
+                Crypto_Apply_ABM_Bytewise(data + offset, len, abm + offset, truth);
+                memset(aad, 0xA5, sizeof(aad));
+                Crypto_Apply_ABM(data + offset, len, abm + offset, aad);
+                ASSERT_EQ(0, memcmp(truth, aad, len));
+            }
+        }
+        // Whole-frame masks, in their own buffer so the patterned mask is intact for the next engine
+        memset(mask, 0xFF, ABM_SIZE);
+        Crypto_Apply_ABM(data, ABM_SIZE, mask, aad);
+        ASSERT_EQ(0, memcmp(data, aad, ABM_SIZE));
+        memset(mask, 0x00, ABM_SIZE);
+        Crypto_Apply_ABM(data, ABM_SIZE, mask, aad);
+        ASSERT_EQ(0, (aad[0] | aad[ABM_SIZE / 2] | aad[ABM_SIZE - 1]));
+    }
+    ASSERT_EQ(CRYPTO_LIB_ERROR, Crypto_Apply_ABM_Set_Engine(0xFF));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Apply_ABM_Set_Engine(default_engine));
+}
+
+/**
+ * @brief Unit Test: Crypto_window matches stepping the expected value through the window
+ **/
+UTEST(CRYPTO_C, WINDOW_MATCHES_INCREMENT)
+{
+    uint8_t actual[ARSN_SIZE];
+    uint8_t expected[ARSN_SIZE];
+    uint8_t temp[ARSN_SIZE];
+    uint32_t seed = 0x2badc0de;
+    int windows[] = {1, 2, 5, 255, 256, 1000, 4096, 65535};
+    int length;
+    int w;
+    int step;
+    int i;
+    int in_window;
+
+    for (length = 1; length <= ARSN_SIZE; length++)
+    {
+        for (w = 0; w < (int)(sizeof(windows) / sizeof(windows[0])); w++)
+        {
+            for (step = 0; step < 24; step++)
+            {
+                // Expected counter near a byte boundary, so carries cross the 64-bit words
+                for (i = 0; i < length; i++)
+                {
+                    seed = seed * 1103515245 + 12345;
+                    expected[i] = (step & 1) ? 0xFF : (uint8_t)(seed >> 16);
+                }
+                expected[0] = (step & 2) ? 0xFF : expected[0];
+
+                // Offsets on, just inside and just outside both window edges, and far away
+                memcpy(actual, expected, length);
+                int offsets[] = {0, 1, windows[w] - 1, windows[w], windows[w] + 1, windows[w] + 300};
+                int offset = offsets[step % 6];
+                for (i = 0; i < offset; i++)
+                {
+                    Crypto_increment(actual, length);
+                }
+                if (step >= 18)
+                {
+                    actual[length / 2] ^= 0x10;
+                }
+
+                // Reference: step the expected value through the window one increment at a time
+                in_window = 0;
+                memcpy(temp, expected, length);
+                for (i = 0; i < windows[w] && !in_window; i++)
+                {
+                    Crypto_increment(temp, length);
+                    in_window = (memcmp(temp, actual, length) == 0);
+                }
+                ASSERT_EQ(in_window ? CRYPTO_LIB_SUCCESS : CRYPTO_LIB_ERROR,
+                          Crypto_window(actual, expected, length, windows[w]));
+            }
+        }
+    }
+
+    // Both counters zero is accepted, a repeat of any other value is not
+    memset(actual, 0, ARSN_SIZE);
+    memset(expected, 0, ARSN_SIZE);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_window(actual, expected, ARSN_SIZE, 1));
+    actual[ARSN_SIZE - 1] = expected[ARSN_SIZE - 1] = 7;
+    ASSERT_EQ(CRYPTO_LIB_ERROR, Crypto_window(actual, expected, ARSN_SIZE, 65535));
+}
+
+/**
+ * @brief Unit Test: Sliding anti-replay bitmap accepts reordered counters once
+ **/
+UTEST(CRYPTO_C, ANTI_REPLAY_BITMAP)
+{
+    remove("sa_save_file.bin");
+    Crypto_Init_TC_Unit_Test();
+    SecurityAssociation_t* sa_ptr = Crypto_SA_Alloc();
+    uint8_t arsn[4] = {0x00, 0x00, 0x01, 0x00};
+    uint8_t* iv = NULL;
+    ASSERT_TRUE(sa_ptr != NULL);
+
+    sa_ptr->ecs = CRYPTO_CIPHER_NONE;
+    sa_ptr->arsn_len = 4;
+    sa_ptr->shsnf_len = 4;
+    sa_ptr->arsnw = 100;
+    memcpy(sa_ptr->arsn, arsn, 4);
+
+    // Forward only by default
+    arsn[3] = 0x05;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[3] = 0x03;
+    ASSERT_EQ(CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+
+    // With the bitmap, unseen counters behind the stored one pass once and do not move it
+    sa_ptr->arsnw_bitmap = CRYPTO_TRUE;
+    ASSERT_EQ(CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv)); // Before first anchor
+    arsn[3] = 0x40;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[3] = 0x10;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    ASSERT_EQ(0x40, sa_ptr->arsn[3]);
+    ASSERT_EQ(CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[3] = 0x40;
+    ASSERT_EQ(CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+
+    // Slide across a byte and several bitmap words, then reach back arsnw and no further
+    arsn[3] = 0xA0;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[2] = 0x02;
+    arsn[3] = 0x00;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[3] = 0x20;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[2] = 0x01;
+    arsn[3] = 0xBC;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    ASSERT_EQ(CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[3] = 0xBB;
+    ASSERT_EQ(CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[3] = 0xC0;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+
+    // Editing the stored counter re-anchors, conservatively treating everything behind it as seen
+    sa_ptr->arsn[2] = 0x03;
+    sa_ptr->arsn[3] = 0x00;
+    arsn[2] = 0x02;
+    arsn[3] = 0xF0;
+    ASSERT_EQ(CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+    arsn[2] = 0x03;
+    arsn[3] = 0x01;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Check_Anti_Replay(sa_ptr, arsn, iv));
+
+    free(sa_ptr);
+    Crypto_Shutdown();
+}
+
+/**
+ * @brief Unit Test: Counter leases are renewed only when the counters reach them
+ **/
+UTEST(CRYPTO_C, SA_LEASE_RENEW)
+{
+    SecurityAssociation_t* sa_ptr = Crypto_SA_Alloc();
+    SecurityAssociationLease_t lease;
+    uint8_t iv[12] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8};
+    uint8_t lease_iv[12] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x08};
+    uint8_t lease_arsn[2] = {0x00, 0x10};
+    int i;
+    ASSERT_TRUE(sa_ptr != NULL);
+
+    memset(&lease, 0, sizeof(lease));
+    sa_ptr->iv_len = 12;
+    sa_ptr->arsn_len = 2;
+    memcpy(sa_ptr->iv, iv, 12);
+    Crypto_Config_SA_Lease(16);
+
+    // First save takes a lease 16 ahead, with carry
+    ASSERT_EQ(CRYPTO_TRUE, Crypto_SA_Lease_Renew(sa_ptr, &lease));
+    ASSERT_EQ(0, memcmp(lease.iv, lease_iv, 12));
+    ASSERT_EQ(0, memcmp(lease.arsn, lease_arsn, 2));
+
+    // Counters below the lease need no save, reaching it renews
+    for (i = 0; i < 15; i++)
+    {
+        Crypto_increment(sa_ptr->iv, 12);
+        Crypto_increment(sa_ptr->arsn, 2);
+        ASSERT_EQ(CRYPTO_FALSE, Crypto_SA_Lease_Renew(sa_ptr, &lease));
+    }
+    Crypto_increment(sa_ptr->iv, 12);
+    ASSERT_EQ(CRYPTO_TRUE, Crypto_SA_Lease_Renew(sa_ptr, &lease));
+    lease_iv[11] = 0x18;
+    ASSERT_EQ(0, memcmp(lease.iv, lease_iv, 12));
+
+    // A counter moved outside the lease, e.g. reset on rekey, renews
+    memset(sa_ptr->iv, 0, 12);
+    ASSERT_EQ(CRYPTO_TRUE, Crypto_SA_Lease_Renew(sa_ptr, &lease));
+    ASSERT_EQ(0x10, lease.iv[11]);
+
+    Crypto_Config_SA_Lease(0);
+    free(sa_ptr);
+}
+
+/**
+ * @brief Unit Test: Operational SA lookup by GVCID tracks SA changes
+ **/
+UTEST(CRYPTO_C, SA_GVCID_LOOKUP)
+{
+    remove("sa_save_file.bin");
+    Crypto_Init_TC_Unit_Test();
+    SaInterface sa_if = get_sa_interface_inmemory();
+    SecurityAssociation_t* sa_ptr = NULL;
+    SecurityAssociation_t* found = NULL;
+    uint16_t spi;
+
+    // Park two SAs on a channel nothing else uses
+    for (spi = 5; spi <= 6; spi++)
+    {
+        sa_if->sa_get_from_spi(spi, &sa_ptr);
+        sa_ptr->sa_state = SA_OPERATIONAL;
+        sa_ptr->ast = 0;
+        sa_ptr->gvcid_blk.tfvn = 0;
+        sa_ptr->gvcid_blk.scid = 0x2A;
+        sa_ptr->gvcid_blk.vcid = 7;
+        sa_ptr->gvcid_blk.mapid = 0;
+    }
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_get_operational_sa_from_gvcid(0, 0x2A, 7, 0, &found));
+    ASSERT_EQ(5, found->spi);
+
+    // Lowest SPI leaves the channel, next one takes over
+    sa_if->sa_get_from_spi(5, &sa_ptr);
+    sa_ptr->sa_state = SA_KEYED;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_get_operational_sa_from_gvcid(0, 0x2A, 7, 0, &found));
+    ASSERT_EQ(6, found->spi);
+
+    // Moving the SA to another VCID must not leave it reachable on the old one
+    sa_if->sa_get_from_spi(6, &sa_ptr);
+    sa_ptr->gvcid_blk.vcid = 8;
+    ASSERT_EQ(CRYPTO_LIB_ERR_NO_OPERATIONAL_SA, sa_if->sa_get_operational_sa_from_gvcid(0, 0x2A, 7, 0, &found));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_get_operational_sa_from_gvcid(0, 0x2A, 8, 0, &found));
+    ASSERT_EQ(6, found->spi);
+
+    // Pointers held across lookups still move their SAs, no new sa_get_from_spi needed
+    sa_ptr->gvcid_blk.vcid = 9;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_get_operational_sa_from_gvcid(0, 0x2A, 9, 0, &found));
+    ASSERT_EQ(6, found->spi);
+    sa_if->sa_get_from_spi(5, &sa_ptr);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_get_operational_sa_from_gvcid(0, 0x2A, 9, 0, &found));
+    sa_ptr->gvcid_blk.vcid = 9;
+    sa_ptr->sa_state = SA_OPERATIONAL;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_get_operational_sa_from_gvcid(0, 0x2A, 9, 0, &found));
+    ASSERT_EQ(5, found->spi);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_get_operational_sa_from_gvcid(0, 0x2A, 9, 0, &found));
+    ASSERT_EQ(5, found->spi);
+
+    Crypto_Shutdown();
+}
+
+/**
+ * @brief Unit Test: SA state and GVCID are checked again once the SA lock is held
+ **/
+UTEST(CRYPTO_C, SA_LOCK_RECHECK)
+{
+    remove("sa_save_file.bin");
+    Crypto_Init_TC_Unit_Test();
+    SaInterface sa_if = get_sa_interface_inmemory();
+    SecurityAssociation_t* sa_ptr = NULL;
+
+    sa_if->sa_get_from_spi(5, &sa_ptr);
+    sa_ptr->sa_state = SA_OPERATIONAL;
+    sa_ptr->gvcid_blk.tfvn = 0;
+    sa_ptr->gvcid_blk.scid = 0x2A;
+    sa_ptr->gvcid_blk.vcid = 7;
+    sa_ptr->gvcid_blk.mapid = 0;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_SA_Lock_GVCID(sa_ptr, 0, 0x2A, 7, 0));
+    Crypto_SA_Unlock();
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_SA_Lock_State(sa_ptr, SA_OPERATIONAL));
+    Crypto_SA_Unlock();
+
+    // Moved or stopped between the lookup and the lock
+    ASSERT_EQ(CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL, Crypto_SA_Lock_GVCID(sa_ptr, 0, 0x2A, 8, 0));
+    Crypto_SA_Unlock();
+    sa_ptr->sa_state = SA_KEYED;
+    ASSERT_EQ(CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL, Crypto_SA_Lock_GVCID(sa_ptr, 0, 0x2A, 7, 0));
+    Crypto_SA_Unlock();
+    ASSERT_EQ(CRYPTO_LIB_ERR_SA_NOT_OPERATIONAL, Crypto_SA_Lock_State(sa_ptr, SA_OPERATIONAL));
+    Crypto_SA_Unlock();
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_SA_Lock_State(sa_ptr, SA_KEYED));
+    Crypto_SA_Unlock();
+
+    Crypto_Shutdown();
+}
+
+/**
+ * @brief Unit Test: SA hot records are cache aligned and reach their own cold storage
+ **/
+UTEST(CRYPTO_C, SA_HOT_COLD_SPLIT)
+{
+    remove("sa_save_file.bin");
+    Crypto_Init_TC_Unit_Test();
+    SaInterface sa_if = get_sa_interface_inmemory();
+    SecurityAssociation_t* sa_ptr = NULL;
+    SecurityAssociation_t* sa_next = NULL;
+
+    ASSERT_LE(sizeof(SecurityAssociation_t), (size_t)128);
+
+    sa_if->sa_get_from_spi(5, &sa_ptr);
+    sa_if->sa_get_from_spi(6, &sa_next);
+    ASSERT_EQ((uintptr_t)0, (uintptr_t)sa_ptr % 64);
+    ASSERT_TRUE(sa_ptr->abm != NULL && sa_ptr->ek_ref != NULL && sa_ptr->ak_ref != NULL);
+    ASSERT_TRUE(sa_ptr->abm != sa_next->abm);
+
+    // Cold storage writes stay with their SA
+    memset(sa_ptr->abm, 0xA5, ABM_SIZE);
+    strcpy(sa_ptr->ek_ref, "kmc/test/key130");
+    ASSERT_EQ(0x00, sa_next->abm[0]);
+    sa_if->sa_get_from_spi(5, &sa_next);
+    ASSERT_EQ(0xA5, sa_next->abm[ABM_SIZE - 1]);
+    ASSERT_STREQ("kmc/test/key130", sa_next->ek_ref);
+
+    // Standalone SAs carry their cold storage in the same allocation
+    sa_ptr = Crypto_SA_Alloc();
+    ASSERT_TRUE(sa_ptr != NULL);
+    ASSERT_EQ((uintptr_t)0, (uintptr_t)sa_ptr % 64);
+    ASSERT_EQ(0x00, sa_ptr->abm[ABM_SIZE - 1]);
+    ASSERT_EQ('\0', sa_ptr->ak_ref[0]);
+    free(sa_ptr);
+
+    Crypto_Shutdown();
+}
+
 /**
  * @brief Unit Test: Crypto Bad CC Flag
  **/
@@ -191,6 +191,61 @@ UTEST(CRYPTO_CONFIG, CRYPTO_CONFIG_KMC)
     ASSERT_EQ(CRYPTO_LIB_SUCCESS, status);
 }
 
+/**
+ * @brief Unit Test: Managed parameter lookup by GVCID
+ **/
+UTEST(CRYPTO_CONFIG, MANAGED_PARAMETERS_LOOKUP)
+{
+    int32_t status = CRYPTO_LIB_ERROR;
+    const GvcidManagedParameters_t* mp = NULL;
+    GvcidManagedParameters_t entry = {0, 0, 0, TC_HAS_FECF, AOS_FHEC_NA, AOS_IZ_NA, 0, TC_HAS_SEGMENT_HDRS, 0, TC_OCF_NA, 1};
+    uint16_t i;
+
+    Crypto_Config_CryptoLib(KEY_TYPE_INTERNAL, MC_TYPE_INTERNAL, SA_TYPE_INMEMORY, CRYPTOGRAPHY_TYPE_LIBGCRYPT,
+                            IV_INTERNAL, CRYPTO_TC_CREATE_FECF_TRUE, TC_PROCESS_SDLS_PDUS_TRUE, TC_HAS_PUS_HDR,
+                            TC_IGNORE_SA_STATE_FALSE, TC_IGNORE_ANTI_REPLAY_FALSE, TC_UNIQUE_SA_PER_MAP_ID_FALSE,
+                            TC_CHECK_FECF_TRUE, 0x3F, SA_INCREMENT_NONTRANSMITTED_IV_TRUE);
+    for (i = 0; i < 200; i++)
+    {
+        entry.scid = i;
+        entry.vcid = i % 64;
+        entry.max_frame_size = 100 + i;
+        Crypto_Config_Add_Gvcid_Managed_Parameters(entry);
+    }
+    // Duplicate GVCID, the first entry configured must win
+    entry.scid = 10;
+    entry.vcid = 10;
+    entry.max_frame_size = 9;
+    Crypto_Config_Add_Gvcid_Managed_Parameters(entry);
+    status = Crypto_Init();
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, status);
+
+    for (i = 0; i < 200; i++)
+    {
+        status = Crypto_Get_Managed_Parameters_Ptr(0, i, i % 64, &mp);
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, status);
+        ASSERT_EQ(100 + i, mp->max_frame_size);
+    }
+
+    // Miss leaves the output untouched
+    status = Crypto_Get_Managed_Parameters_Ptr(1, 10, 10, &mp);
+    ASSERT_EQ(MANAGED_PARAMETERS_FOR_GVCID_NOT_FOUND, status);
+    ASSERT_EQ(100 + 199, mp->max_frame_size);
+
+    // Entries added after init are indexed too
+    entry.scid = 0x3FF;
+    entry.vcid = 1;
+    entry.max_frame_size = 1024;
+    Crypto_Config_Add_Gvcid_Managed_Parameters(entry);
+    status = Crypto_Get_Managed_Parameters_Ptr(0, 0x3FF, 1, &mp);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, status);
+    ASSERT_EQ(1024, mp->max_frame_size);
+
+    Crypto_Shutdown();
+    status = Crypto_Get_Managed_Parameters_Ptr(0, 0x3FF, 1, &mp);
+    ASSERT_EQ(MANAGED_PARAMETERS_FOR_GVCID_NOT_FOUND, status);
+}
+
 #ifdef TODO_NEEDSWORK
 UTEST(CRYPTO_CONFIG, CRYPTO_INIT_KMC_OK)
 {
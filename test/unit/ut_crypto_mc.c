@@ -24,6 +24,7 @@
 #include "crypto_error.h"
 #include "sa_interface.h"
 #include "utest.h"
+#include <pthread.h>
 
 
 /**
@@ -65,6 +66,44 @@ UTEST(CRYPTO_MC, ERASE)
     ASSERT_EQ(11, count);
 }
 
+/**
+ * @brief Unit Test: Crypto MC Event Log Wrap Test
+ * A full log replaces its oldest events, dumps oldest first, and counts what it replaced
+ **/
+UTEST(CRYPTO_MC, EVENT_LOG_WRAP)
+{
+    remove("sa_save_file.bin");
+    int count = 0;
+    uint8_t ingest[1024] = {0};
+    uint8_t emv[EMV_SIZE] = {0x01, 0x02, 0x03, 0x04};
+
+    // Initialization logs two startup events
+    Crypto_Init_TC_Unit_Test();
+    ASSERT_EQ(2, log_count);
+
+    for (int i = 0; i < LOG_SIZE + 5; i++)
+    {
+        Crypto_Event_Log((uint8_t)i, emv);
+    }
+    ASSERT_EQ(LOG_SIZE, log_count);
+    ASSERT_EQ(7u, log_overwritten);
+    ASSERT_EQ(LOG_SIZE + 7, log_summary.num_se);
+    ASSERT_EQ(0, log_summary.rs);
+
+    count = Crypto_MC_dump(ingest);
+    ASSERT_EQ(((LOG_SIZE * 4) + (LOG_SIZE * 2) + 9), count);
+    ASSERT_EQ(5, ingest[9]);
+    ASSERT_EQ(EMV_SIZE, ingest[10]);
+    ASSERT_EQ(0x04, ingest[14]);
+    ASSERT_EQ(LOG_SIZE + 4, ingest[9 + (LOG_SIZE - 1) * 6]);
+
+    count = Crypto_MC_erase(ingest);
+    ASSERT_EQ(11, count);
+    ASSERT_EQ(0, log_count);
+    ASSERT_EQ(0, log_summary.num_se);
+    ASSERT_EQ(LOG_SIZE, log_summary.rs);
+}
+
 /**
  * @brief Unit Test: Crypto MC SelfTest Test
  **/
@@ -125,4 +164,89 @@ UTEST(CRYPTO_MC, TMLENGTH)
     ASSERT_EQ(1145, length);
 }
 
+#define UT_MC_LOG_THREADS 4
+#define UT_MC_LOG_REPEATS 20000
+#define UT_MC_LOG_FLOOD_CODE -1234
+#define UT_MC_LOG_DISTINCT (MC_LOG_RING_SIZE + 100)
+
+static void* ut_mc_log_flood(void* arg)
+{
+    arg = arg;
+    for (int i = 0; i < UT_MC_LOG_REPEATS; i++)
+    {
+        mc_if->mc_log(UT_MC_LOG_FLOOD_CODE);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Unit Test: Crypto MC Log Flood Test
+ * Repeats of an error code are counted rather than written, and every distinct error is either written
+ * or counted as dropped
+ **/
+UTEST(CRYPTO_MC, LOG_FLOOD)
+{
+    pthread_t threads[UT_MC_LOG_THREADS];
+    char line[128];
+    uint32_t flood_lines = 0;
+    uint32_t distinct_lines = 0;
+    uint32_t repeated_total = 0;
+    uint32_t dropped_total = 0;
+    uint32_t repeated;
+    uint32_t dropped;
+    int32_t code;
+    FILE* log_file;
+
+    // Start from an empty log, anything earlier tests queued is written by this shutdown
+    Crypto_Init_TC_Unit_Test();
+    Crypto_Shutdown();
+    remove(MC_LOG_PATH);
+    Crypto_Init_TC_Unit_Test();
+
+    for (int i = 0; i < UT_MC_LOG_THREADS; i++)
+    {
+        ASSERT_EQ(0, pthread_create(&threads[i], NULL, ut_mc_log_flood, NULL));
+    }
+    for (int i = 0; i < UT_MC_LOG_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < UT_MC_LOG_DISTINCT; i++)
+    {
+        mc_if->mc_log(-2000 - i);
+    }
+    Crypto_Shutdown();
+
+    log_file = fopen(MC_LOG_PATH, "r");
+    ASSERT_TRUE(log_file != NULL);
+    while (fgets(line, sizeof(line), log_file) != NULL)
+    {
+        char* fields = strstr(line, "], ");
+        ASSERT_TRUE(fields != NULL);
+        if (sscanf(fields, "], repeated %u, dropped %u", &repeated, &dropped) == 2)
+        {
+            repeated_total += repeated;
+            dropped_total += dropped;
+        }
+        else if (sscanf(fields, "], %d", &code) == 1)
+        {
+            if (code == UT_MC_LOG_FLOOD_CODE)
+            {
+                flood_lines++;
+            }
+            else if (code <= -2000 && code > -2000 - UT_MC_LOG_DISTINCT)
+            {
+                distinct_lines++;
+            }
+        }
+    }
+    fclose(log_file);
+
+    // One record per second, the flood takes well under one, at worst it straddles a boundary or two
+    ASSERT_GE(flood_lines, 1u);
+    ASSERT_LE(flood_lines, 3u);
+    ASSERT_EQ((uint32_t)(UT_MC_LOG_THREADS * UT_MC_LOG_REPEATS), flood_lines + repeated_total);
+    ASSERT_EQ((uint32_t)UT_MC_LOG_DISTINCT, distinct_lines + dropped_total);
+}
+
 UTEST_MAIN();
\ No newline at end of file
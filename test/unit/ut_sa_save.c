@@ -32,6 +32,7 @@
 #include "crypto_error.h"
 #include "sa_interface.h"
 #include "utest.h"
+#include <unistd.h>
 
 UTEST(SA_SAVE, VERIFY_INTERNAL)
 {
@@ -779,4 +780,192 @@ UTEST(SA_SAVE, VERIFY_SAVE_EDGES)
 }
 
 
+// The journal and leases only exist with SA_FILE
+#ifdef SA_FILE
+UTEST(SA_SAVE, JOURNAL_REPLAY)
+{
+    remove(CRYPTO_SA_SAVE);
+    remove(CRYPTO_SA_JOURNAL);
+    Crypto_Init_TC_Unit_Test();
+    char* raw_tc_sdls_ping_h = "20030015000080d2c70008197f0b00310000b1fe3128";
+    char* raw_tc_sdls_ping_b = NULL;
+    int raw_tc_sdls_ping_len = 0;
+    uint8_t* ptr_enc_frame = NULL;
+    uint16_t enc_frame_len = 0;
+    uint8_t expected_iv[IV_SIZE];
+    int32_t return_val = CRYPTO_LIB_ERROR;
+    FILE* journal;
+
+    SaInterface sa_if = get_sa_interface_inmemory();
+    hex_conversion(raw_tc_sdls_ping_h, &raw_tc_sdls_ping_b, &raw_tc_sdls_ping_len);
+
+    SecurityAssociation_t* test_association;
+    sa_if->sa_get_from_spi(1, &test_association);
+    test_association->sa_state = SA_NONE;
+    sa_if->sa_get_from_spi(4, &test_association);
+    test_association->gvcid_blk.vcid = 0;
+    test_association->sa_state = SA_OPERATIONAL;
+    test_association->shivf_len = 6;
+    test_association->iv_len = 12;
+    test_association->arsn_len = 0;
+    clean_akref(test_association);
+    clean_ekref(test_association);
+
+    // Enough frames for one group commit, the IVs reach disk only through the journal
+    for (int i = 0; i < SA_JOURNAL_SYNC_FRAMES; i++)
+    {
+        return_val =
+            Crypto_TC_ApplySecurity((uint8_t*)raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, &ptr_enc_frame, &enc_frame_len);
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+        free(ptr_enc_frame);
+        ptr_enc_frame = NULL;
+    }
+    memcpy(expected_iv, test_association->iv, test_association->iv_len);
+
+    // Torn record at the tail, as left by a crash mid-append
+    journal = fopen(CRYPTO_SA_JOURNAL, "ab");
+    ASSERT_TRUE(journal != NULL);
+    fwrite(raw_tc_sdls_ping_b, 1, 7, journal);
+    fclose(journal);
+
+    // Reload without a clean shutdown: the synced IV is recovered, not the one in the snapshot
+    memset(test_association->iv, 0, IV_SIZE);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_init());
+    sa_if->sa_get_from_spi(4, &test_association);
+    for (int i = 0; i < 12; i++)
+    {
+        ASSERT_EQ(expected_iv[i], test_association->iv[i]);
+    }
+
+    Crypto_Shutdown();
+    free(raw_tc_sdls_ping_b);
+}
+
+UTEST(SA_SAVE, JOURNAL_TIMED_SYNC)
+{
+    remove(CRYPTO_SA_SAVE);
+    remove(CRYPTO_SA_JOURNAL);
+    Crypto_Init_TC_Unit_Test();
+    char* raw_tc_sdls_ping_h = "20030015000080d2c70008197f0b00310000b1fe3128";
+    char* raw_tc_sdls_ping_b = NULL;
+    int raw_tc_sdls_ping_len = 0;
+    uint8_t* ptr_enc_frame = NULL;
+    uint16_t enc_frame_len = 0;
+    uint8_t expected_iv[IV_SIZE];
+
+    SaInterface sa_if = get_sa_interface_inmemory();
+    hex_conversion(raw_tc_sdls_ping_h, &raw_tc_sdls_ping_b, &raw_tc_sdls_ping_len);
+
+    SecurityAssociation_t* test_association;
+    sa_if->sa_get_from_spi(1, &test_association);
+    test_association->sa_state = SA_NONE;
+    sa_if->sa_get_from_spi(4, &test_association);
+    test_association->gvcid_blk.vcid = 0;
+    test_association->sa_state = SA_OPERATIONAL;
+    test_association->shivf_len = 6;
+    test_association->iv_len = 12;
+    test_association->arsn_len = 0;
+    clean_akref(test_association);
+    clean_ekref(test_association);
+
+    // Too few frames for a group commit, then traffic stops
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TC_ApplySecurity((uint8_t*)raw_tc_sdls_ping_b, raw_tc_sdls_ping_len,
+                                                              &ptr_enc_frame, &enc_frame_len));
+        free(ptr_enc_frame);
+        ptr_enc_frame = NULL;
+    }
+    memcpy(expected_iv, test_association->iv, test_association->iv_len);
+    usleep(3 * SA_JOURNAL_SYNC_MS * 1000);
+
+    // Reload without a clean shutdown: the idle tail was synced by time
+    memset(test_association->iv, 0, IV_SIZE);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_init());
+    sa_if->sa_get_from_spi(4, &test_association);
+    for (int i = 0; i < 12; i++)
+    {
+        ASSERT_EQ(expected_iv[i], test_association->iv[i]);
+    }
+
+    Crypto_Shutdown();
+    free(raw_tc_sdls_ping_b);
+}
+
+UTEST(SA_SAVE, LEASE_RESUME)
+{
+    remove(CRYPTO_SA_SAVE);
+    remove(CRYPTO_SA_JOURNAL);
+    Crypto_Init_TC_Unit_Test();
+    Crypto_Config_SA_Lease(16);
+    char* raw_tc_sdls_ping_h = "20030015000080d2c70008197f0b00310000b1fe3128";
+    char* raw_tc_sdls_ping_b = NULL;
+    int raw_tc_sdls_ping_len = 0;
+    uint8_t* ptr_enc_frame = NULL;
+    uint16_t enc_frame_len = 0;
+    uint8_t lease_iv[IV_SIZE];
+    uint8_t last_used_iv[IV_SIZE];
+    FILE* journal;
+    long journal_len;
+
+    SaInterface sa_if = get_sa_interface_inmemory();
+    hex_conversion(raw_tc_sdls_ping_h, &raw_tc_sdls_ping_b, &raw_tc_sdls_ping_len);
+
+    SecurityAssociation_t* test_association;
+    sa_if->sa_get_from_spi(1, &test_association);
+    test_association->sa_state = SA_NONE;
+    sa_if->sa_get_from_spi(4, &test_association);
+    test_association->gvcid_blk.vcid = 0;
+    test_association->sa_state = SA_OPERATIONAL;
+    test_association->shivf_len = 6;
+    test_association->iv_len = 12;
+    test_association->arsn_len = 0;
+    clean_akref(test_association);
+    clean_ekref(test_association);
+
+    // The first frame persists a lease 16 IVs ahead, the next ones write nothing
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TC_ApplySecurity((uint8_t*)raw_tc_sdls_ping_b, raw_tc_sdls_ping_len,
+                                                              &ptr_enc_frame, &enc_frame_len));
+        free(ptr_enc_frame);
+        ptr_enc_frame = NULL;
+        if (i == 0)
+        {
+            memcpy(lease_iv, test_association->iv, IV_SIZE);
+            for (int j = 0; j < 16; j++)
+            {
+                Crypto_increment(lease_iv, test_association->iv_len);
+            }
+        }
+    }
+    memcpy(last_used_iv, test_association->iv, IV_SIZE);
+    journal = fopen(CRYPTO_SA_JOURNAL, "rb");
+    ASSERT_TRUE(journal != NULL);
+    fseek(journal, 0, SEEK_END);
+    journal_len = ftell(journal);
+    fclose(journal);
+
+    // Reload without a clean shutdown: SA 4 resumes from its lease, never behind a used IV
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_init());
+    sa_if->sa_get_from_spi(4, &test_association);
+    for (int i = 0; i < 12; i++)
+    {
+        ASSERT_EQ(lease_iv[i], test_association->iv[i]);
+    }
+    ASSERT_TRUE(journal_len > 0);
+    ASSERT_TRUE(journal_len < 2 * 64);
+
+    // The next frame's IV is past every IV used before the reload
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TC_ApplySecurity((uint8_t*)raw_tc_sdls_ping_b, raw_tc_sdls_ping_len,
+                                                          &ptr_enc_frame, &enc_frame_len));
+    free(ptr_enc_frame);
+    ASSERT_TRUE(memcmp(test_association->iv, last_used_iv, test_association->iv_len) > 0);
+
+    Crypto_Config_SA_Lease(0);
+    Crypto_Shutdown();
+    free(raw_tc_sdls_ping_b);
+}
+#endif
+
 UTEST_MAIN();
\ No newline at end of file
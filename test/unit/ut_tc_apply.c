@@ -155,6 +155,72 @@ UTEST(TC_APPLY_SECURITY, HAPPY_PATH_ENC)
     ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
 }
 
+/**
+ * @brief Unit Test: Key material changed between frames
+ *
+ * Keyed contexts retained by the cryptography interface must never outlive the key they were built from.
+ **/
+UTEST(TC_APPLY_SECURITY, HAPPY_PATH_ENC_KEY_CHANGED)
+{
+    remove("sa_save_file.bin");
+    // Setup & Initialize CryptoLib
+    Crypto_Init_TC_Unit_Test();
+    char* raw_tc_sdls_ping_h = "20030015000080d2c70008197f0b00310000b1fe3128";
+    char* raw_tc_sdls_ping_b = NULL;
+    int raw_tc_sdls_ping_len = 0;
+    SaInterface sa_if = get_sa_interface_inmemory();
+
+    hex_conversion(raw_tc_sdls_ping_h, &raw_tc_sdls_ping_b, &raw_tc_sdls_ping_len);
+
+    uint8_t* ptr_enc_frame = NULL;
+    uint8_t* ptr_enc_frame_rekeyed = NULL;
+    uint8_t* ptr_enc_frame_restored = NULL;
+    uint16_t enc_frame_len = 0;
+    uint8_t iv[IV_SIZE];
+    uint8_t key[32];
+
+    int32_t return_val = CRYPTO_LIB_ERROR;
+
+    SecurityAssociation_t* test_association;
+    // Expose the SADB Security Association for test edits.
+    sa_if->sa_get_from_spi(1, &test_association);
+    test_association->sa_state = SA_NONE;
+    sa_if->sa_get_from_spi(4, &test_association);
+    test_association->ekid = 130;
+    test_association->gvcid_blk.vcid = 0;
+    test_association->sa_state = SA_OPERATIONAL;
+    test_association->ast = 0;
+    test_association->arsn_len = 0;
+    memcpy(iv, test_association->iv, IV_SIZE);
+
+    crypto_key_t* ekp = key_if->get_key(test_association->ekid);
+    memcpy(key, ekp->value, sizeof(key));
+
+    return_val = Crypto_TC_ApplySecurity((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, &ptr_enc_frame, &enc_frame_len);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+
+    // Same IV, different key -- ciphertext must change
+    memcpy(test_association->iv, iv, IV_SIZE);
+    ekp->value[0] ^= 0xFF;
+    return_val = Crypto_TC_ApplySecurity((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, &ptr_enc_frame_rekeyed, &enc_frame_len);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    ASSERT_NE(0, memcmp(ptr_enc_frame, ptr_enc_frame_rekeyed, enc_frame_len));
+
+    // Original key after an explicit invalidation -- ciphertext must match the first frame
+    memcpy(test_association->iv, iv, IV_SIZE);
+    memcpy(ekp->value, key, sizeof(key));
+    Crypto_Key_Invalidate_Cache(test_association->ekid);
+    return_val = Crypto_TC_ApplySecurity((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, &ptr_enc_frame_restored, &enc_frame_len);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    ASSERT_EQ(0, memcmp(ptr_enc_frame, ptr_enc_frame_restored, enc_frame_len));
+
+    Crypto_Shutdown();
+    free(raw_tc_sdls_ping_b);
+    free(ptr_enc_frame);
+    free(ptr_enc_frame_rekeyed);
+    free(ptr_enc_frame_restored);
+}
+
 /**
  * @brief Unit Test: Nominal Encryption CBC
  **/
@@ -1292,4 +1358,299 @@ UTEST(TC_APPLY_SECURITY, PLAINTEXT_W_ARSN)
     ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
 }
 
+/**
+ * @brief Unit Test: ApplySecurity into a caller buffer
+ *
+ * The allocation-free entry point must produce the same frame as Crypto_TC_ApplySecurity and refuse a short buffer.
+ **/
+UTEST(TC_APPLY_SECURITY, APPLY_INTO_MATCHES_ALLOCATING)
+{
+    remove("sa_save_file.bin");
+    // Setup & Initialize CryptoLib
+    Crypto_Init_TC_Unit_Test();
+    char* raw_tc_sdls_ping_h = "20030015000080d2c70008197f0b00310000b1fe3128";
+    char* raw_tc_sdls_ping_b = NULL;
+    int raw_tc_sdls_ping_len = 0;
+    SaInterface sa_if = get_sa_interface_inmemory();
+
+    hex_conversion(raw_tc_sdls_ping_h, &raw_tc_sdls_ping_b, &raw_tc_sdls_ping_len);
+
+    uint8_t* ptr_enc_frame = NULL;
+    uint16_t enc_frame_len = 0;
+    uint8_t out_frame[TC_MAX_FRAME_SIZE];
+    uint16_t out_frame_len = 0;
+    uint16_t max_len = 0;
+    uint8_t iv[IV_SIZE];
+
+    int32_t return_val = CRYPTO_LIB_ERROR;
+
+    SecurityAssociation_t* test_association;
+    // Expose the SADB Security Association for test edits.
+    sa_if->sa_get_from_spi(1, &test_association);
+    test_association->sa_state = SA_NONE;
+    sa_if->sa_get_from_spi(4, &test_association);
+    test_association->ekid = 130;
+    test_association->gvcid_blk.vcid = 0;
+    test_association->sa_state = SA_OPERATIONAL;
+    test_association->ast = 0;
+    test_association->arsn_len = 0;
+    memcpy(iv, test_association->iv, IV_SIZE);
+
+    return_val = Crypto_TC_Get_Max_Output_Len(4, &max_len);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    ASSERT_GT(max_len, 0);
+    ASSERT_LE(max_len, TC_MAX_FRAME_SIZE);
+
+    return_val = Crypto_TC_ApplySecurity((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, &ptr_enc_frame, &enc_frame_len);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    ASSERT_LE(enc_frame_len, max_len);
+
+    // Same IV into the caller buffer -- frame must match
+    memcpy(test_association->iv, iv, IV_SIZE);
+    return_val = Crypto_TC_ApplySecurity_Into((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, out_frame, max_len, &out_frame_len);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    ASSERT_EQ(enc_frame_len, out_frame_len);
+    ASSERT_EQ(0, memcmp(ptr_enc_frame, out_frame, enc_frame_len));
+
+    // Buffer one byte short of the frame
+    return_val = Crypto_TC_ApplySecurity_Into((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, out_frame, enc_frame_len - 1, &out_frame_len);
+    ASSERT_EQ(CRYPTO_LIB_ERR_OUTPUT_BUFFER_TOO_SMALL, return_val);
+
+    Crypto_Shutdown();
+    free(raw_tc_sdls_ping_b);
+    free(ptr_enc_frame);
+}
+
+/*
+** Asynchronous backend stand-in: queues AEAD encrypts with copies of their inputs, like a remote backend,
+** and completes them newest first on poll.
+*/
+typedef struct
+{
+    uint8_t* data_out;
+    size_t len_data_out;
+    uint8_t data_in[TC_MAX_FRAME_SIZE];
+    size_t len_data_in;
+    uint8_t* key;
+    uint32_t len_key;
+    SecurityAssociation_t* sa_ptr;
+    uint8_t iv[IV_SIZE];
+    uint32_t iv_len;
+    uint8_t* mac;
+    uint32_t mac_size;
+    uint8_t aad[TC_MAX_FRAME_SIZE];
+    uint32_t aad_len;
+    uint8_t encrypt_bool;
+    uint8_t authenticate_bool;
+    uint8_t aad_bool;
+    uint8_t ecs;
+    uint8_t acs;
+    cryptography_async_done_t done;
+    void* op_ctx;
+} ut_async_op_t;
+
+static ut_async_op_t ut_async_ops[8];
+static int ut_async_op_count = 0;
+static int ut_async_delivered[8];
+static int ut_async_delivered_count = 0;
+
+static int32_t ut_async_aead_encrypt(uint8_t* data_out, size_t len_data_out, uint8_t* data_in, size_t len_data_in,
+                                     uint8_t* key, uint32_t len_key, SecurityAssociation_t* sa_ptr, uint8_t* iv,
+                                     uint32_t iv_len, uint8_t* mac, uint32_t mac_size, uint8_t* aad, uint32_t aad_len,
+                                     uint8_t encrypt_bool, uint8_t authenticate_bool, uint8_t aad_bool, uint8_t* ecs,
+                                     uint8_t* acs, char* cam_cookies, cryptography_async_done_t done, void* op_ctx)
+{
+    ut_async_op_t* op = &ut_async_ops[ut_async_op_count++];
+    cam_cookies = cam_cookies;
+    op->data_out = data_out;
+    op->len_data_out = len_data_out;
+    memcpy(op->data_in, data_in, len_data_in);
+    op->len_data_in = len_data_in;
+    op->key = key;
+    op->len_key = len_key;
+    op->sa_ptr = sa_ptr;
+    memcpy(op->iv, iv, iv_len);
+    op->iv_len = iv_len;
+    op->mac = mac;
+    op->mac_size = mac_size;
+    memcpy(op->aad, aad, aad_len);
+    op->aad_len = aad_len;
+    op->encrypt_bool = encrypt_bool;
+    op->authenticate_bool = authenticate_bool;
+    op->aad_bool = aad_bool;
+    op->ecs = *ecs;
+    op->acs = *acs;
+    op->done = done;
+    op->op_ctx = op_ctx;
+    return CRYPTO_LIB_SUCCESS;
+}
+
+static int32_t ut_async_poll(int32_t timeout_ms)
+{
+    int32_t completed = ut_async_op_count;
+    ut_async_op_t* op;
+    timeout_ms = timeout_ms;
+    while (ut_async_op_count > 0)
+    {
+        op = &ut_async_ops[--ut_async_op_count];
+        op->done(op->op_ctx, cryptography_if->cryptography_aead_encrypt(
+                                 op->data_out, op->len_data_out, op->data_in, op->len_data_in, op->key, op->len_key,
+                                 op->sa_ptr, op->iv, op->iv_len, op->mac, op->mac_size, op->aad, op->aad_len,
+                                 op->encrypt_bool, op->authenticate_bool, op->aad_bool, &op->ecs, &op->acs, NULL));
+    }
+    return completed;
+}
+
+static void ut_async_callback(void* ctx, int32_t status, uint8_t* p_frame, uint16_t frame_len)
+{
+    p_frame = p_frame;
+    frame_len = frame_len;
+    ut_async_delivered[ut_async_delivered_count++] = (status == CRYPTO_LIB_SUCCESS) ? (int)(intptr_t)ctx : -1;
+}
+
+/**
+ * @brief Unit Test: Asynchronous apply, with and without an asynchronous backend, matches the blocking apply
+ **/
+UTEST(TC_APPLY_SECURITY, APPLY_ASYNC_MATCHES_BLOCKING)
+{
+    remove("sa_save_file.bin");
+    // Setup & Initialize CryptoLib
+    Crypto_Init_TC_Unit_Test();
+    char* raw_tc_sdls_ping_h = "20030015000080d2c70008197f0b00310000b1fe3128";
+    char* raw_tc_sdls_ping_b = NULL;
+    int raw_tc_sdls_ping_len = 0;
+    SaInterface sa_if = get_sa_interface_inmemory();
+
+    hex_conversion(raw_tc_sdls_ping_h, &raw_tc_sdls_ping_b, &raw_tc_sdls_ping_len);
+
+    uint8_t expected[3][TC_MAX_FRAME_SIZE];
+    uint16_t expected_len[3];
+    uint8_t out_frame[3][TC_MAX_FRAME_SIZE];
+    uint32_t delivered = 0;
+    uint8_t iv[IV_SIZE];
+    int i;
+
+    int32_t return_val = CRYPTO_LIB_ERROR;
+
+    SecurityAssociation_t* test_association;
+    // Expose the SADB Security Association for test edits.
+    sa_if->sa_get_from_spi(1, &test_association);
+    test_association->sa_state = SA_NONE;
+    sa_if->sa_get_from_spi(4, &test_association);
+    test_association->ekid = 130;
+    test_association->gvcid_blk.vcid = 0;
+    test_association->sa_state = SA_OPERATIONAL;
+    test_association->arsn_len = 0;
+    memcpy(iv, test_association->iv, IV_SIZE);
+
+    for (i = 0; i < 3; i++)
+    {
+        return_val = Crypto_TC_ApplySecurity_Into((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, expected[i],
+                                                  TC_MAX_FRAME_SIZE, &expected_len[i]);
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    }
+
+    // Blocking backend, the frame is complete at submission and handed back by the next poll
+    memcpy(test_association->iv, iv, IV_SIZE);
+    ut_async_delivered_count = 0;
+    return_val = Crypto_TC_ApplySecurity_Async((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, out_frame[0],
+                                               TC_MAX_FRAME_SIZE, ut_async_callback, (void*)(intptr_t)0);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    ASSERT_EQ(1, (int)Crypto_Async_Pending());
+    ASSERT_EQ(0, ut_async_delivered_count);
+    return_val = Crypto_Async_Poll(0, &delivered);
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    ASSERT_EQ(1, (int)delivered);
+    ASSERT_EQ(0, (int)Crypto_Async_Pending());
+    ASSERT_EQ(0, ut_async_delivered[0]);
+    ASSERT_EQ(0, memcmp(expected[0], out_frame[0], expected_len[0]));
+
+    // Asynchronous backend completing out of order, frames still come back in order with their FECF
+    memcpy(test_association->iv, iv, IV_SIZE);
+    memset(out_frame, 0, sizeof(out_frame));
+    ut_async_delivered_count = 0;
+    cryptography_if->cryptography_aead_encrypt_async = ut_async_aead_encrypt;
+    cryptography_if->cryptography_async_poll = ut_async_poll;
+    for (i = 0; i < 3; i++)
+    {
+        return_val = Crypto_TC_ApplySecurity_Async((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len, out_frame[i],
+                                                   TC_MAX_FRAME_SIZE, ut_async_callback, (void*)(intptr_t)i);
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    }
+    ASSERT_EQ(3, ut_async_op_count);
+    ASSERT_EQ(3, (int)Crypto_Async_Pending());
+    return_val = Crypto_Async_Poll(100, &delivered);
+    cryptography_if->cryptography_aead_encrypt_async = NULL;
+    cryptography_if->cryptography_async_poll = NULL;
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, return_val);
+    ASSERT_EQ(3, (int)delivered);
+    for (i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(i, ut_async_delivered[i]);
+        ASSERT_EQ(0, memcmp(expected[i], out_frame[i], expected_len[i]));
+    }
+
+    Crypto_Shutdown();
+    free(raw_tc_sdls_ping_b);
+}
+
+/**
+ * @brief Unit Test: Metrics count applied frames per SA and VC, and lookup misses
+ **/
+UTEST(TC_APPLY_SECURITY, METRICS_COUNT_FRAMES)
+{
+    remove("sa_save_file.bin");
+    // Setup & Initialize CryptoLib
+    Crypto_Init_TC_Unit_Test();
+    char* raw_tc_sdls_ping_h = "20030015000080d2c70008197f0b00310000b1fe3128";
+    char* raw_tc_sdls_ping_bad_scid_h = "20010015000080d2c70008197f0b00310000b1fe3128";
+    char* raw_tc_sdls_ping_b = NULL;
+    char* raw_tc_sdls_ping_bad_scid_b = NULL;
+    int raw_tc_sdls_ping_len = 0;
+    int raw_tc_sdls_ping_bad_scid_len = 0;
+
+    hex_conversion(raw_tc_sdls_ping_h, &raw_tc_sdls_ping_b, &raw_tc_sdls_ping_len);
+    hex_conversion(raw_tc_sdls_ping_bad_scid_h, &raw_tc_sdls_ping_bad_scid_b, &raw_tc_sdls_ping_bad_scid_len);
+
+    Crypto_Metrics_t* before = calloc(1, sizeof(Crypto_Metrics_t));
+    Crypto_Metrics_t* after = calloc(1, sizeof(Crypto_Metrics_t));
+    SecurityAssociation_t* sa_ptr = NULL;
+    const GvcidManagedParameters_t* mp = NULL;
+    uint8_t* ptr_enc_frame = NULL;
+    uint16_t enc_frame_len = 0;
+
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, sa_if->sa_get_operational_sa_from_gvcid(0, 3, 0, 0, &sa_ptr));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Get_Managed_Parameters_Ptr(0, 3, 0, &mp));
+    uint16_t spi = sa_ptr->spi;
+    int vc = (int)(mp - gvcid_managed_parameters_array);
+
+    ASSERT_EQ(CRYPTO_LIB_ERR_NULL_BUFFER, Crypto_Get_Metrics(NULL));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Get_Metrics(before));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TC_ApplySecurity((uint8_t* )raw_tc_sdls_ping_b, raw_tc_sdls_ping_len,
+                                                          &ptr_enc_frame, &enc_frame_len));
+    free(ptr_enc_frame);
+    ptr_enc_frame = NULL;
+    ASSERT_EQ(MANAGED_PARAMETERS_FOR_GVCID_NOT_FOUND,
+              Crypto_TC_ApplySecurity((uint8_t* )raw_tc_sdls_ping_bad_scid_b, raw_tc_sdls_ping_bad_scid_len,
+                                      &ptr_enc_frame, &enc_frame_len));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Get_Metrics(after));
+
+    ASSERT_EQ(before->total[CRYPTO_COUNTER_FRAMES_APPLIED] + 1, after->total[CRYPTO_COUNTER_FRAMES_APPLIED]);
+    ASSERT_EQ(before->total[CRYPTO_COUNTER_BYTES_APPLIED] + raw_tc_sdls_ping_len,
+              after->total[CRYPTO_COUNTER_BYTES_APPLIED]);
+    ASSERT_EQ(before->sa[spi][CRYPTO_COUNTER_FRAMES_APPLIED] + 1, after->sa[spi][CRYPTO_COUNTER_FRAMES_APPLIED]);
+    ASSERT_EQ(before->vc[vc][CRYPTO_COUNTER_FRAMES_APPLIED] + 1, after->vc[vc][CRYPTO_COUNTER_FRAMES_APPLIED]);
+    ASSERT_EQ(before->total[CRYPTO_COUNTER_SA_MISSES] + 1, after->total[CRYPTO_COUNTER_SA_MISSES]);
+#ifdef CRYPTO_METRICS_LATENCY
+    ASSERT_LT(before->stage[CRYPTO_STAGE_SA_LOOKUP].count, after->stage[CRYPTO_STAGE_SA_LOOKUP].count);
+#endif
+
+    Crypto_Shutdown();
+    free(raw_tc_sdls_ping_b);
+    free(raw_tc_sdls_ping_bad_scid_b);
+    free(ptr_enc_frame);
+    free(before);
+    free(after);
+}
+
 UTEST_MAIN();
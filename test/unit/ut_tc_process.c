@@ -143,6 +143,107 @@ UTEST(TC_PROCESS, EXERCISE_IV)
     free(tc_nist_processed_frame);
 }
 
+/**
+ * @brief Unit Test: Batch processing enforces anti-replay in order
+ *
+ * Frames in one batch are checked against the window as it advances through the batch,
+ * so a frame replayed later in the same batch must still be rejected.
+ **/
+UTEST(TC_PROCESS, BATCH_ARSN)
+{
+    remove("sa_save_file.bin");
+    // Setup & Initialize CryptoLib
+    Crypto_Config_CryptoLib(KEY_TYPE_INTERNAL, MC_TYPE_INTERNAL, SA_TYPE_INMEMORY, CRYPTOGRAPHY_TYPE_LIBGCRYPT, 
+                            IV_INTERNAL, CRYPTO_TC_CREATE_FECF_TRUE, TC_PROCESS_SDLS_PDUS_TRUE, TC_HAS_PUS_HDR,
+                            TC_IGNORE_SA_STATE_FALSE, TC_IGNORE_ANTI_REPLAY_FALSE, TC_UNIQUE_SA_PER_MAP_ID_FALSE,
+                            TC_CHECK_FECF_TRUE, 0x3F, SA_INCREMENT_NONTRANSMITTED_IV_TRUE);
+    GvcidManagedParameters_t TC_UT_Managed_Parameters = {0, 0x0003, 0, TC_HAS_FECF, AOS_FHEC_NA, AOS_IZ_NA, 0, TC_HAS_SEGMENT_HDRS, 1024, TC_OCF_NA, 1};  
+    Crypto_Config_Add_Gvcid_Managed_Parameters(TC_UT_Managed_Parameters);
+    Crypto_Init();
+    SaInterface sa_if = get_sa_interface_inmemory();
+    crypto_key_t* akp = NULL;
+    int status = 0;
+
+    // NIST supplied vectors, same as EXERCISE_ARSN
+    char* buffer_nist_key_h = "ef9f9284cf599eac3b119905a7d18851e7e374cf63aea04358586b0f757670f8";
+    char* buffer_arsn_h = "0123"; // The last valid ARSN that was seen by the SA
+    char* frames_h[5] = {
+        "2003002B00FF000901231224DFEFB72A20D49E09256908874979fd56ca1ffc2697a700dbe6292c10e9ef1B49", // Replay
+        "2003002B00FF000904441224DFEFB72A20D49E09256908874979fd56ca1ffc2697a700dbe6292c10e9ef9C5C", // Outside window
+        "2003002B00FF000901241224DFEFB72A20D49E09256908874979fd56ca1ffc2697a700dbe6292c10e9ef8A3E", // Next expected
+        "2003002B00FF000901291224DFEFB72A20D49E09256908874979fd56ca1ffc2697a700dbe6292c10e9ef3EB4", // Valid, with gap
+        "2003002B00FF000901241224DFEFB72A20D49E09256908874979fd56ca1ffc2697a700dbe6292c10e9ef8A3E"  // Replay of frame 3
+    };
+    int32_t expected[5] = {CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, CRYPTO_LIB_SUCCESS,
+                           CRYPTO_LIB_SUCCESS, CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW};
+    uint8_t* frames_b[5] = {NULL};
+    int frames_len[5] = {0};
+    int32_t results[5] = {0};
+    uint8_t *buffer_arsn_b, *buffer_nist_key_b = NULL;
+    int buffer_arsn_len, buffer_nist_key_len = 0;
+
+    TC_t* tc_processed_frames = calloc(5, sizeof(TC_t));
+
+    // Expose/setup SAs for testing
+    SecurityAssociation_t* test_association;
+    // Deactivate SA 1
+    sa_if->sa_get_from_spi(1, &test_association);
+    test_association->sa_state = SA_NONE;
+    // Activate SA 9
+    sa_if->sa_get_from_spi(9, &test_association);
+    test_association->sa_state = SA_OPERATIONAL;
+    test_association->ecs_len = 1;
+    test_association->ecs = CRYPTO_CIPHER_NONE;
+    test_association->acs_len = 1;
+    test_association->acs = CRYPTO_MAC_CMAC_AES256;
+    test_association->est = 0;
+    test_association->ast = 1;
+    test_association->shivf_len = 0;
+    test_association->iv_len = 0;
+    test_association->shsnf_len = 2;
+    test_association->arsn_len = 2;
+    test_association->arsnw = 5;
+    test_association->abm_len = 1024;
+    test_association->akid = 136;
+    test_association->ekid = 0;
+    test_association->stmacf_len = 16;
+    // Insert key into keyring of SA 9
+    hex_conversion(buffer_nist_key_h, (char**) &buffer_nist_key_b, &buffer_nist_key_len);
+    akp = key_if->get_key(test_association->akid);
+    memcpy(akp->value, buffer_nist_key_b, buffer_nist_key_len);
+    // Convert/Set input ARSN
+    hex_conversion(buffer_arsn_h, (char**) &buffer_arsn_b, &buffer_arsn_len);
+    memcpy(test_association->arsn, buffer_arsn_b, buffer_arsn_len);
+    for (int i = 0; i < 5; i++)
+    {
+        hex_conversion(frames_h[i], (char**) &frames_b[i], &frames_len[i]);
+    }
+
+    status = Crypto_TC_ProcessSecurity_Batch(frames_b, frames_len, tc_processed_frames, 5, results);
+    ASSERT_EQ(CRYPTO_LIB_ERR_ARSN_OUTSIDE_WINDOW, status);
+    // The SA lock shared by the run of frames is released with the batch
+    ASSERT_EQ(-1, Crypto_SA_Held_SPI());
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_EQ(expected[i], results[i]);
+    }
+
+    // SA ARSN must reflect the last accepted frame
+    for (int i = 0; i < test_association->shsnf_len; i++)
+    {
+        ASSERT_EQ(*(test_association->arsn + i), *(frames_b[3] + 8 + i)); // 8 is ARSN offset into packet
+    }
+
+    Crypto_Shutdown();
+    free(tc_processed_frames);
+    free(buffer_nist_key_b);
+    free(buffer_arsn_b);
+    for (int i = 0; i < 5; i++)
+    {
+        free(frames_b[i]);
+    }
+}
+
 /**
  * @brief Exercise the ARSN window checking logic using AES CMAC
  * Test Cases: Replay, outside of window
@@ -323,7 +323,7 @@ UTEST(TM_PROCESS_SECURITY, SECONDARY_HDR_PRESENT_MAC)
     status = Crypto_TM_ProcessSecurity((uint8_t* )framed_tm_b, framed_tm_len, &ptr_processed_frame, &processed_tm_len);
     ASSERT_EQ(CRYPTO_LIB_SUCCESS, status);
     // Now, byte by byte verify the static frame in memory is equivalent to what we started with
-    for(int i=0; i < current_managed_parameters_struct.max_frame_size; i++)
+    for(int i=0; i < current_managed_parameters->max_frame_size; i++)
     {
         // printf("Checking %02x against %02X\n", ptr_processed_frame[i], (uint8_t)*(truth_tm_b + i));
         ASSERT_EQ(ptr_processed_frame[i], (uint8_t)*(truth_tm_b + i));
@@ -1202,4 +1202,166 @@ UTEST(TM_PROCESS, TM_OCF_TEST)
     free(ptr_processed_frame);
 }
 
+/**
+ * @brief Unit Test: Worker pool output matches sequential ProcessSecurity
+ *
+ * Frames on several VCs are pushed through the TM worker pool. Every frame must come back processed
+ * exactly as a direct Crypto_TM_ProcessSecurity call would, and frames of each VC in submission order.
+ **/
+UTEST(TM_PROCESS_SECURITY, POOL_MATCHES_SEQUENTIAL)
+{
+    remove("sa_save_file.bin");
+    // Configure Parameters
+    Crypto_Config_CryptoLib(KEY_TYPE_INTERNAL, MC_TYPE_INTERNAL, SA_TYPE_INMEMORY, CRYPTOGRAPHY_TYPE_LIBGCRYPT, 
+                            IV_INTERNAL, CRYPTO_TM_CREATE_FECF_TRUE, TC_PROCESS_SDLS_PDUS_TRUE, TC_HAS_PUS_HDR,
+                            TC_IGNORE_SA_STATE_FALSE, TC_IGNORE_ANTI_REPLAY_FALSE, TC_UNIQUE_SA_PER_MAP_ID_FALSE,
+                            TM_CHECK_FECF_TRUE, 0x3F, SA_INCREMENT_NONTRANSMITTED_IV_TRUE);
+    for (uint8_t vcid = 0; vcid < 4; vcid++)
+    {
+        GvcidManagedParameters_t TM_UT_Managed_Parameters = {0, 0x002c, vcid, TM_HAS_FECF, AOS_FHEC_NA, AOS_IZ_NA, 0, TM_SEGMENT_HDRS_NA, 64, TM_NO_OCF, 1};
+        Crypto_Config_Add_Gvcid_Managed_Parameters(TM_UT_Managed_Parameters);
+    }
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_Init());
+
+    // Clear mode frames on SPI 5, SCID 44, VCIDs 0-3
+    uint8_t frames[4][16][64];
+    TM_Pool_Frame_t collected[64];
+    uint32_t next_seq[4] = {0, 0, 0, 0};
+    uint32_t total = 0;
+    uint32_t count = 0;
+    for (uint8_t vcid = 0; vcid < 4; vcid++)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            memset(frames[vcid][i], 0xA0 + i, 64);
+            frames[vcid][i][0] = 0x02;
+            frames[vcid][i][1] = 0xC0 | (vcid << 1);
+            frames[vcid][i][2] = 0x00;
+            frames[vcid][i][3] = i;
+            frames[vcid][i][4] = 0x18;
+            frames[vcid][i][5] = 0x00;
+            frames[vcid][i][6] = 0x00;
+            frames[vcid][i][7] = 0x05;
+            uint16_t fecf = Crypto_Calc_FECF(frames[vcid][i], 62);
+            frames[vcid][i][62] = (fecf >> 8) & 0xFF;
+            frames[vcid][i][63] = fecf & 0xFF;
+        }
+    }
+
+    ASSERT_EQ(CRYPTO_LIB_ERR_TM_POOL_NOT_RUNNING, Crypto_TM_Pool_Submit(frames[0][0], 64, NULL));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TM_Pool_Start(4));
+    ASSERT_EQ(CRYPTO_LIB_ERR_NULL_BUFFER, Crypto_TM_Pool_Submit(NULL, 64, NULL));
+    for (int i = 0; i < 16; i++)
+    {
+        for (uint8_t vcid = 0; vcid < 4; vcid++)
+        {
+            ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TM_Pool_Submit(frames[vcid][i], 64, (void*)(intptr_t)((vcid << 8) | i)));
+        }
+    }
+    // Stop drains everything already submitted
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TM_Pool_Stop());
+    ASSERT_EQ(CRYPTO_LIB_ERR_TM_POOL_NOT_RUNNING, Crypto_TM_Pool_Submit(frames[0][0], 64, NULL));
+    while (total < 64)
+    {
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TM_Pool_Collect(&collected[total], 64 - total, &count));
+        ASSERT_NE(0u, count);
+        total += count;
+    }
+
+    for (uint32_t n = 0; n < 64; n++)
+    {
+        uint8_t vcid = ((intptr_t)collected[n].user_ctx >> 8) & 0xFF;
+        uint32_t seq = (intptr_t)collected[n].user_ctx & 0xFF;
+        ASSERT_EQ(next_seq[vcid], seq);
+        next_seq[vcid]++;
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, collected[n].status);
+        ASSERT_TRUE(collected[n].p_ingest == frames[vcid][seq]);
+
+        uint8_t* ptr_processed_frame = NULL;
+        uint16_t processed_tm_len = 0;
+        ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TM_ProcessSecurity(frames[vcid][seq], 64, &ptr_processed_frame, &processed_tm_len));
+        ASSERT_EQ(processed_tm_len, collected[n].decrypted_length);
+        ASSERT_EQ(0, memcmp(ptr_processed_frame, collected[n].p_processed_frame, processed_tm_len));
+        free(ptr_processed_frame);
+        free(collected[n].p_processed_frame);
+    }
+
+    Crypto_Shutdown();
+}
+
+/**
+ * @brief Unit Test: ProcessSecurity into a caller buffer and in place
+ *
+ * Crypto_TM_ProcessSecurity_Into must produce exactly the frame Crypto_TM_ProcessSecurity allocates,
+ * whether writing to a separate buffer or over the ingest frame.
+ **/
+UTEST(TM_PROCESS_SECURITY, PROCESS_INTO_MATCHES_ALLOCATING)
+{
+    remove("sa_save_file.bin");
+    uint8_t* ptr_processed_frame = NULL;
+    uint16_t processed_tm_len = 0;
+    uint16_t into_len = 0;
+    uint16_t pdu_offset = 0;
+    uint16_t pdu_len = 0;
+
+    // Setup & Initialize CryptoLib
+    Crypto_Config_CryptoLib(KEY_TYPE_INTERNAL, MC_TYPE_INTERNAL, SA_TYPE_INMEMORY, CRYPTOGRAPHY_TYPE_LIBGCRYPT, 
+                            IV_INTERNAL, CRYPTO_TM_CREATE_FECF_TRUE, TC_PROCESS_SDLS_PDUS_TRUE, TC_HAS_PUS_HDR,
+                            TC_IGNORE_SA_STATE_FALSE, TC_IGNORE_ANTI_REPLAY_FALSE, TC_UNIQUE_SA_PER_MAP_ID_FALSE,
+                            TC_CHECK_FECF_TRUE, 0x3F, SA_INCREMENT_NONTRANSMITTED_IV_TRUE);
+    GvcidManagedParameters_t TM_UT_Managed_Parameters = {0, 0x002c, 0, TM_HAS_FECF, AOS_FHEC_NA, AOS_IZ_NA, 0, TM_SEGMENT_HDRS_NA, 1786, TM_NO_OCF, 1};
+    Crypto_Config_Add_Gvcid_Managed_Parameters(TM_UT_Managed_Parameters);
+    Crypto_Init();
+    SaInterface sa_if = get_sa_interface_inmemory();
+
+    // Same AES-GCM frame as TM_PROCESS_ENC_VAL.AES_GCM_BITMASK_1
+    char* framed_tm_h = "02c0000018000005deadbeefdeadbeefdeadbeefdeadbeef0b355a29091cc09b6434ca743273c0a1f0529d44cedd32f09b9dbb45ab35c4b607c4783aaefe7068f6924f069e335dacbf11cb0aba3268b6e1f5b12d6a9ce5e26bf249125ce02cecd90f17f642a9ed8524e73cbca4a125d16a00babca86146b264f2e36d3f81a8645b8b8a66214c473efdbf6f8faa435c9dc3b839bde4fadea2d8a5c9edfd7e1db8b1ba6c1b10e20f82d98c3959104e826c5dc4f63228f5d3fda431adcb775a2300000113e3fee4b87f2f87550b66fa001494c23357a2f095f3593790f6bbbc6eddc301422a8ab70c51b20924c02d202da34523823c8e08b7973e6eb4ab7ba5f7a78dd5513c911bc5213087091629f3600856b9d4a756337f92dd3f853d442f1f0c9966eb7d5e7954f5963ad83382ee13b20f2866ae7393e54b81e25e7598da37959b9f195aa2a9c858c867ff84af8e079baffeeb19102b22800d42938819771eb622aac490bcedaa7ea2481b0547e687ccb95e26a2922166d7cab077ef0e06ec3bf07764de160c3c0db07a9f93d41ece84521ec0e82d9a3658b502850b19cac88e6b5d0c975f850616bd3f2a950b01a38f903108a1a12f38ede3b6833b7126e2af81b719147bcda0aee5bd60e90a8dd800ef5f967400773ee79334f08480b110dfabb2946826828aca98c16004d1d78c1c18c384a19a0afb73792abfdfc55dbe7b36496114b85c28c954d8ff6d661b92e5cd1541d5843e55cfa1f48f08423301012583a7f770c3d3c0ca1a54bafaece16e35c45423474de63d98e966a6a65abaa012798562f18fde35426bea7e75f06f3e2a2538ae992e6996f2fa48f8c2ca179ed76c0f817b47b64bba561f7502b672188200c360d709de7da7443abbfe5506604a6394d3dc7914e71df54efed8dcb264e07b8b7eb50015dd33a11354fa85fcda7b225b1a89ac68827946d1c94fe6e926fda7c4ee8cbf8dafb2bb2fc3900914f04dff504ccec0a45bd78784aa43d9aaa3eff8f72eac5c2e7fbdd9c78f49dad8624dc84329ca1753840284f4dab6102ebd1da47ed9a7e7cb055318d359a5ba9e55434740731ead208457ae94a169135fd02e99e68775f5f99550be0ff79ad2bafe7d4c08fab79d101273f3cae8c6e66585248779238705a1d1d4531347eb593edf7d55e85c91c633f6185782dcb3942ddc78be75ee20bd42ad42cac5440f5579c690d3a127c0962c4d6250dbafc2622b47d1ee505d3dba523592530d78644e2ac4b2e352d584c14191599df0eb1f8e78a20fcf3be1b76e6efa374a8a9f119ae92a707e056bcc5a4b9ad27739fc7cfca27e3ed0d33a0e724089930cf5a947e9eff24c4a3bf5147150d65f4a781723b4ffe230af61e25f5e1a7d74565a52411af43700a05ac1a3e778b7d85b1570895726f394a7345aeb634c4185ff6c2603efc4f00422163b37bd5ec98bd320139ec0e3b69563e9216c236f9516cf2305fc8cc7995e7813a9dc6ada3ab6d503368103eb349199345a449e636524dfc87ece09bb2a8c5323eca50875dec26d25eedff6e3908b9086ca182cc93300008623074f1ad52f1cfe6ef32a6bcf78ad4621cdcc5ff4e6282eed12c3939e28f66faa2b47ab4c0bed328a883995f8616ffa8ee3e66905e9719e7c980d2bcbe0744fc1795956c46adca32b9d3fce5c968b65794b9b10526821f82be34d7c76ce097e5973335015b99c1d8398d0b1d17353f221f9657f90e2bbbfa0f196664edb5b22f4d352e5b1bf3734d6a95678ad5d3a5cb3a76a8938ff2058a4e0297ae9a50df6b4231ea6319db77476aedd7dcbc091d018c89a66eb8e05b42b7e2ef76776b563d432bb3b51827e73212e68d693bbbea8922c5a184394dfd7ec296324f7d91dc4ba950a9edb25f29112b843d662cebc630ca24e4b93a31e7e0b644bafad2435167fa6f9195b3b23971effb4bdbd0f65af8ef2cd1146fc533b7c83cc83fe1540294de3e16154e8fca507b2fc0154677aca2d3718a76924b9e8585bf25f14729fce656b426704293ae6a8181e3929f1352304ef0ca7747fa2db0db7dcf32d2a5b0f68933acb58f32712ef50aefc28a1b7e4315e8b8bcdcacf230200bdc4f41b320969def240c21a259ee319e69711f2c44ed08d7be40e905078534906cb2ae09e653ae3e33ece1e056512798a9525883ad5eaafc394b0c788e57d21b7d076926dd6d583fe220814f4473e67245a3fe732de8bf814baff99d3aad1ca671269bd3f84560e98398aa9f6ba625e9bc516bb88a4fb2a7ec4b3017ac74362f58653b6b7a2226fcbd484a834fe5e8f4a7432fecf8974d57088c7955eee593bd806bb84b46dc2e75c2709c37468866df97e66f49bece821aa8997ec766d6e6529cf96c18a14435ee0ded2bde56d77b2091d4ca1346830edda23d114efe1596201d80fe213b8b7dffa79fc84a2a63c77ac9fae6cb1b8bb99521b43309915da6b28316e400f10fda0f1dbdd25761de798dc894009f391fd96d2471558a2c9656251af547a43";
+    char* framed_tm_b = NULL;
+    int framed_tm_len = 0;
+    hex_conversion(framed_tm_h, &framed_tm_b, &framed_tm_len);
+
+    // Expose/setup SAs for testing
+    SecurityAssociation_t* test_association = NULL;
+    // Deactivate SA 1
+    sa_if->sa_get_from_spi(1, &test_association);
+    test_association->sa_state = SA_NONE;
+    // Activate SA 5
+    sa_if->sa_get_from_spi(5, &test_association);
+    test_association->arsn_len = 0;
+    test_association->abm_len = 1786;
+    memset(test_association->abm, 0xFF, (test_association->abm_len * sizeof(uint8_t))); // Bitmask
+    test_association->sa_state = SA_OPERATIONAL;
+    test_association->ecs_len = 1;
+    test_association->ecs = CRYPTO_CIPHER_AES256_GCM;
+    test_association->acs_len = 1;
+    test_association->acs = CRYPTO_MAC_NONE;
+    test_association->iv_len = 16;
+    test_association->shivf_len = 16;
+
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS, Crypto_TM_ProcessSecurity((uint8_t*)framed_tm_b, framed_tm_len, &ptr_processed_frame, &processed_tm_len));
+
+    // Separate, dirty output buffer
+    uint8_t* out = malloc(framed_tm_len);
+    memset(out, 0x5A, framed_tm_len);
+    ASSERT_EQ(CRYPTO_LIB_ERR_OUTPUT_BUFFER_TOO_SMALL,
+              Crypto_TM_ProcessSecurity_Into((uint8_t*)framed_tm_b, framed_tm_len, out, framed_tm_len - 1, NULL, NULL, &into_len));
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS,
+              Crypto_TM_ProcessSecurity_Into((uint8_t*)framed_tm_b, framed_tm_len, out, framed_tm_len, &pdu_offset, &pdu_len, &into_len));
+    ASSERT_EQ(processed_tm_len, into_len);
+    ASSERT_EQ(0, memcmp(ptr_processed_frame, out, framed_tm_len));
+    // Security header ahead of the data field, MAC and FECF behind it
+    ASSERT_TRUE(pdu_offset > 6 + 2);
+    ASSERT_EQ(1786 - test_association->stmacf_len - 2, pdu_offset + pdu_len);
+
+    // In place
+    ASSERT_EQ(CRYPTO_LIB_SUCCESS,
+              Crypto_TM_ProcessSecurity_Into((uint8_t*)framed_tm_b, framed_tm_len, (uint8_t*)framed_tm_b, framed_tm_len, NULL, NULL, &into_len));
+    ASSERT_EQ(0, memcmp(ptr_processed_frame, framed_tm_b, framed_tm_len));
+
+    Crypto_Shutdown();
+    free(out);
+    free(framed_tm_b);
+    free(ptr_processed_frame);
+}
+
 UTEST_MAIN();
\ No newline at end of file